@@ -1,12 +1,25 @@
 // https://learnopengl.com/
 
 #include <iostream>
+#include <string>
+#include <vector>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "../shader-lesson-1.4/Shader.h"
+#include "../frame-pacing/FramePacer.h"
+#include "../geometry-heap/GeometryHeap.h"
+#include "../mipmap-generator/MipGenerator.h"
+#include "../frame-memory/AllocationTracker.h"
+#include "../gl-trace/GLTrace.h"
+#include "../scene-graph/SceneGraph.h"
+#include "../picking/RayPicker.h"
+#include "../init-graph/InitGraph.h"
+#include "../gpu-memory/GpuMemory.h"
+#include "../pipeline-stats/PipelineStats.h"
+#include "../pipeline-stats/OverdrawView.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <std_image/stb_image.h>
@@ -26,6 +39,8 @@ float pitch = 0.0f;
 float fov = 45.0f;
 
 bool firstMouse = true;
+// TAB frees the cursor: the view stops turning and clicks pick under the cursor
+bool cursorFree = false;
 
 // camera positions
 glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 3.0f);
@@ -36,43 +51,19 @@ void framebufferResizeCallback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
 void mouseCallback(GLFWwindow* window, double xpos, double ypos);
 void scrollCallback(GLFWwindow* window, double xoffset, double yoffset);
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
 
-int main() {
-	// initialize GLFW
-	glfwInit();
-	// set version and core profile
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+FramePacer* framePacer = NULL;
+RayPicker* picker = NULL;
+PipelineStats* pipelineStats = NULL;
+OverdrawView* overdrawView = NULL;
+bool showOverdraw = false;
+int selectedCube = -1; // spins until another click
 
-#ifdef __APPLE__
-	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#endif
-
-	// create a window
-	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
-	if (window == NULL) {
-		std::cout << "Failed to create GLFW window" << std::endl;
-		glfwTerminate();
-		return -1;
-	}
-
-	glfwMakeContextCurrent(window);
-	// set callback to handle when window is resized
-	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
-	glfwSetCursorPosCallback(window, mouseCallback);
-	glfwSetScrollCallback(window, scrollCallback);
-
-	// initialize GLAD
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-	{
-		std::cout << "Failed to initialize GLAD" << std::endl;
-		return -1;
-	}
-
-	// initialize vertex and fragment shaders
-	Shader shader("../coordinate-systems-1.6/les1.6-vShader.vert",
-		"../coordinate-systems-1.6/les1.6-fShader.frag");
+int main(int argc, char** argv) {
+	// --serial runs the same startup tasks one after another, to compare
+	bool serialStartup = argc > 1 && std::string(argv[1]) == "--serial";
 
 	//////////////////////////////////////////////////////////
 	// positions and colors
@@ -133,98 +124,212 @@ int main() {
 		glm::vec3(-1.3f,  1.0f, -1.5f)
 	};
 
-	// indices for te EBO. this will determine which vertex to draw first
-	// unsigned int indices[] = {
-	// 	0, 1, 3, // first triangle
-	// 	1, 2, 3  // second triangle
-	// };
-
-	// generate a vertex buffer object and a vertex array object
-	unsigned int VBO, VAO, EBO;
-	glGenVertexArrays(1, &VAO);
-	glGenBuffers(1, &VBO);
-	glGenBuffers(1, &EBO);
+	// everything startup produces, filled in by the tasks below
+	GLFWwindow* window = NULL;
+	bool glReady = false;
+	std::string vertexSource, fragmentSource;
+	Shader* shader = NULL;
+	std::vector<MipLevel> image, image2;
+	unsigned int texture = 0, texture2 = 0;
+	GeometryHeap* geometry = NULL;
+	unsigned int cubeMesh = 0;
+	SceneGraph* scene = NULL;
+	unsigned int firstCube = 0;
+
+	// mips are filtered on the CPU in linear light instead of glGenerateMipmap
+	MipGenerator mipGenerator;
+	stbi_set_flip_vertically_on_load(true);
 
-	// bind the VAO. any subsequent VBO, EBO, 
-	// glVertex... glEnable... calls will be stored in this VAO.
-	glBindVertexArray(VAO);
+	// file reads and decodes run on the pool while the main thread creates the context,
+	// the GL work is ordered so shader compiles are in flight during the texture uploads
+	InitGraph startup;
+	unsigned int windowTask = startup.add("create window", InitGraph::MAIN_THREAD, [&] {
+		// initialize GLFW
+		glfwInit();
+		// set version and core profile
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-	// bind the buffer to an array buffer and assign the vertices to it
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+#ifdef __APPLE__
+		glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
 
-	// bind the buffer to an element array buffer and assign the indices to it
-	// glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	// glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+		// create a window
+		window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+		if (window == NULL) {
+			std::cout << "Failed to create GLFW window" << std::endl;
+			return;
+		}
 
-	// tell OpenGL how should it operate with the vertex data
-	// position attribute
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	// texture attribute
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
+		glfwMakeContextCurrent(window);
+		// set callback to handle when window is resized
+		glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+		glfwSetCursorPosCallback(window, mouseCallback);
+		glfwSetScrollCallback(window, scrollCallback);
+		glfwSetKeyCallback(window, keyCallback);
+		glfwSetMouseButtonCallback(window, mouseButtonCallback);
+	});
+	unsigned int glTask = startup.add("load GL", InitGraph::MAIN_THREAD, [&] {
+		// initialize GLAD
+		if (!window || !gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+		{
+			std::cout << "Failed to initialize GLAD" << std::endl;
+			return;
+		}
+		glReady = true;
+		// record every GL call, the last 120 frames stay in memory (C toggles, T saves)
+		GLTrace::install(120);
+		// size of every buffer, texture and program by category, printed on exit
+		GpuMemory::install();
+
+		// present on vblank, the frame pacer decides when each frame starts
+		glfwSwapInterval(1);
+	}, { windowTask });
+
+	// view and projection come from the Camera uniform block, model from the scene graph
+	unsigned int readShadersTask = startup.add("read shaders", InitGraph::ANY_THREAD, [&] {
+		vertexSource = Shader::readSource("../scene-graph/scene-node.vert");
+		fragmentSource = Shader::readSource("../coordinate-systems-1.6/les1.6-fShader.frag");
+	});
+	unsigned int decodeTask = startup.add("decode container.jpg", InitGraph::ANY_THREAD, [&] {
+		int width, height, nrChannels;
+		unsigned char* data = stbi_load("textures-lesson-1.5/container.jpg", &width, &height, &nrChannels, 0);
+		if (data) {
+			image = mipGenerator.generate(data, width, height, nrChannels);
+		}
+		else {
+			std::cout << "Failed to load texture" << std::endl;
+		}
+		stbi_image_free(data);
+	});
+	unsigned int decode2Task = startup.add("decode awesomeface.png", InitGraph::ANY_THREAD, [&] {
+		int width, height, nrChannels;
+		unsigned char* data = stbi_load("textures-lesson-1.5/awesomeface.png", &width, &height, &nrChannels, 0);
+		if (data) {
+			image2 = mipGenerator.generate(data, width, height, nrChannels);
+		}
+		else {
+			std::cout << "Failed to load texture" << std::endl;
+		}
+		stbi_image_free(data);
+	});
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	// issued first, the driver compiles while the textures go up
+	unsigned int compileTask = startup.add("compile shaders", InitGraph::MAIN_THREAD, [&] {
+		if (glReady) {
+			shader = new Shader(vertexSource, fragmentSource, true);
+		}
+	}, { glTask, readShadersTask });
 
-	// generate a texture
-	unsigned int texture, texture2;
+	// the cubes never move: their world matrices are computed and uploaded once.
+	// waits for the compile to be issued so that overlaps this as well
+	unsigned int sceneTask = startup.add("scene graph", InitGraph::MAIN_THREAD, [&] {
+		if (!glReady) {
+			return;
+		}
+		scene = new SceneGraph(16);
+		unsigned int root = scene->addNode(SceneGraph::INVALID_NODE, glm::mat4(1.0f));
+		firstCube = scene->getNodeCount();
+		for (unsigned int i = 0; i < 10; ++i) {
+			glm::mat4 model = glm::mat4(1.0f);
+			model = glm::translate(model, cubePositions[i]);
+			// vary angle
+			float angle = 20.0f * i;
+			model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+			scene->addNode(root, model);
+		}
+		scene->update();
+	}, { compileTask });
 
-	// texture 1
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
+	// clicks are answered on the CPU from a BVH over the same cube triangles
+	startup.add("build picker", InitGraph::ANY_THREAD, [&] {
+		if (!scene) {
+			return;
+		}
+		picker = new RayPicker();
+		unsigned int cubePickMesh = picker->addMesh(vertices, 36, GeometryHeap::VERTEX_FLOATS);
+		for (unsigned int i = 0; i < 10; ++i) {
+			picker->addObject(cubePickMesh, scene->getWorld(firstCube + i));
+		}
+		picker->update();
+	}, { sceneTask });
 
-	// set the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	// set texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// every mesh goes into the shared geometry heap, there is no per mesh VAO/VBO
+	unsigned int geometryTask = startup.add("upload geometry", InitGraph::MAIN_THREAD, [&] {
+		if (!glReady) {
+			return;
+		}
+		GpuMemoryScope memoryScope(GpuMemory::category("geometry"));
+		geometry = new GeometryHeap(64 * 1024, 64 * 1024);
+		cubeMesh = geometry->addMesh(vertices, 36);
+
+		// instance i of the cube reads the world matrix of node firstCube + i
+		geometry->bind();
+		scene->bindWorldMatrices(2, firstCube);
+		glBindVertexArray(0);
+	}, { sceneTask });
+
+	unsigned int uploadTask = startup.add("upload container.jpg", InitGraph::MAIN_THREAD, [&] {
+		if (!glReady) {
+			return;
+		}
+		GpuMemoryScope memoryScope(GpuMemory::category("textures"));
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
 
+		// set the texture wrapping parameters
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		// set texture filtering parameters
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-	stbi_set_flip_vertically_on_load(true);
-	// load image, create texture and generate mipmaps
-	int width, height, nrChannels;
-	unsigned char* data = stbi_load("textures-lesson-1.5/container.jpg", &width, &height, &nrChannels, 0);
-	if (data) {
 		// create the texture
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else {
-		std::cout << "Failed to load texture" << std::endl;
-	}
-
-	stbi_image_free(data);
+		if (!image.empty()) {
+			MipGenerator::upload(image);
+		}
+		image.clear();
+	}, { compileTask, decodeTask });
+	unsigned int upload2Task = startup.add("upload awesomeface.png", InitGraph::MAIN_THREAD, [&] {
+		if (!glReady) {
+			return;
+		}
+		GpuMemoryScope memoryScope(GpuMemory::category("textures"));
+		glGenTextures(1, &texture2);
+		glBindTexture(GL_TEXTURE_2D, texture2);
 
-	// texture 2
-	glGenTextures(1, &texture2);
-	glBindTexture(GL_TEXTURE_2D, texture2);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		if (!image2.empty()) {
+			MipGenerator::upload(image2);
+		}
+		image2.clear();
+	}, { compileTask, decode2Task });
 
-	data = stbi_load("textures-lesson-1.5/awesomeface.png", &width, &height, &nrChannels, 0);
-	if (data) {
-		// create the texture
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else {
-		std::cout << "Failed to load texture" << std::endl;
+	// last, by now the compile had the whole upload time to finish
+	startup.add("link shaders", InitGraph::MAIN_THREAD, [&] {
+		if (!shader) {
+			return;
+		}
+		shader->checkStatus();
+		shader->bindUniformBlock("Camera", CAMERA_UBO_BINDING);
+		shader->use();
+		// tell the shader the corresponding unit texture of each texture
+		shader->setInt("texture1", 0);
+		shader->setInt("texture2", 1);
+	}, { compileTask, uploadTask, upload2Task, geometryTask });
+
+	startup.run(serialStartup);
+	if (!glReady) {
+		glfwTerminate();
+		return -1;
 	}
 
-	stbi_image_free(data);
-
-	shader.use();
-	// tell the shader the corresponding unit texture of each texture
-	shader.setInt("texture1", 0);
-	shader.setInt("texture2", 1);
-
 	// set wireframe mode
 	// glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
@@ -234,18 +339,50 @@ int main() {
 
 	glm::mat4 projection;
 
+	// press P to cycle between pacing modes, stats are printed on exit
+	framePacer = new FramePacer(FramePacer::MODE_LATE_START, 1);
+
+	// press I to count the pipeline per draw group, O to cycle the overdraw heat map
+	pipelineStats = new PipelineStats();
+	const unsigned int renderTargetMemory = GpuMemory::category("render targets");
+	{
+		GpuMemoryScope memoryScope(renderTargetMemory);
+		overdrawView = new OverdrawView();
+	}
+
 	// render loop
+	// split the per frame allocation count by what the frame is doing
+	const unsigned int allocInput = AllocationTracker::subsystem("input");
+	const unsigned int allocDraw = AllocationTracker::subsystem("draw");
+	const unsigned int allocPresent = AllocationTracker::subsystem("present");
+
+	bool firstFrame = true;
 	while (!glfwWindowShouldClose(window)) {
+		AllocationTracker::beginFrame();
+
+		// sleep until the latest point the frame can start and still make the vblank
+		framePacer->beginFrame();
+		GLTrace::beginFrame();
+
 		float currentFrame = glfwGetTime();
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
 
-		processInput(window);
-
 		// clear screen
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+		int framebufferWidth, framebufferHeight;
+		glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+		pipelineStats->beginFrame(framebufferWidth, framebufferHeight);
+		// O is read by the late latch poll below, the toggle waits for the next frame
+		const bool overdraw = showOverdraw;
+		if (overdraw) {
+			GpuMemoryScope memoryScope(renderTargetMemory);
+			overdrawView->resize(framebufferWidth, framebufferHeight);
+			overdrawView->begin();
+		}
+
 		// bind textures
 		glActiveTexture(GL_TEXTURE0); // texture unit 0
 		glBindTexture(GL_TEXTURE_2D, texture);
@@ -253,47 +390,100 @@ int main() {
 		glActiveTexture(GL_TEXTURE1); // texture unit 1
 		glBindTexture(GL_TEXTURE_2D, texture2);
 
-		projection = glm::perspective(glm::radians(fov), 800.0f / 600.0f, 0.1f, 100.0f);
+		// use shader
+		shader->use();
 
-		shader.setMat4("projection", projection);
+		shader->setFloat("percentage", percentage);
 
-		// use shader
-		shader.use();
+		// draw triangle
+		// one VAO bind for the whole pass
+		geometry->bind();
+
+		// late latch: sample input only after everything that does not depend on it
+		{
+			AllocationScope scope(allocInput);
+			glfwPollEvents();
+			processInput(window);
+			framePacer->markInput();
+		}
 
-		shader.setFloat("percentage", percentage);
+		projection = glm::perspective(glm::radians(fov), 800.0f / 600.0f, 0.1f, 100.0f);
 
 		// transform the image
 		glm::mat4 view = glm::mat4(1.0f);
-
-		const float radius = 10.0f;
-		float camX = sin(glfwGetTime()) * radius;
-		float camZ = cos(glfwGetTime()) * radius;
-
 		view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
 
-		shader.setMat4("view", view);
-
-		// draw triangle
-		glBindVertexArray(VAO);
+		framePacer->latchCamera(view, projection);
 
 		// render 10 cubes
-		for (unsigned int i = 0; i < 10; ++i) {
-			glm::mat4 model = glm::mat4(1.0f);
-			model = glm::translate(model, cubePositions[i]);
-			// vary angle
-			float angle = 20.0f * i;
-			model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-			shader.setMat4("model", model);
+		{
+			AllocationScope scope(allocDraw);
+			// nothing is dirty, so this returns without touching the buffer
+			// the picked cube spins, only its node is recomputed, uploaded and refit
+			if (selectedCube >= 0) {
+				unsigned int node = firstCube + selectedCube;
+				scene->setLocal(node, glm::rotate(scene->getLocal(node), glm::radians(90.0f) * deltaTime, glm::vec3(0.0f, 1.0f, 0.0f)));
+			}
+			scene->update();
+			if (selectedCube >= 0) {
+				picker->setTransform(selectedCube, scene->getWorld(firstCube + selectedCube));
+				picker->update();
+			}
+			pipelineStats->begin("scene", "cubes");
+			geometry->drawInstanced(cubeMesh, 10);
+			pipelineStats->end();
+			geometry->endFrame();
+		}
+
+		if (overdraw) {
+			overdrawView->end(0);
+		}
+		pipelineStats->endFrame();
 
-			glDrawArrays(GL_TRIANGLES, 0, 36);
+		{
+			AllocationScope scope(allocPresent);
+			framePacer->endFrame(window);
+		}
+		// after the present, so the pacer's queries, swap and fence stay in this frame
+		GLTrace::endFrame();
+		// cold start: process start to the first frame handed to the display
+		if (firstFrame) {
+			std::cout << "STARTUP::first frame presented after " << InitGraph::sinceProcessStart() << " ms ("
+				<< (serialStartup ? "serial" : "parallel") << " startup)" << std::endl;
+			startup.printTimeline();
+			firstFrame = false;
 		}
 
-		glfwSwapBuffers(window);
-		glfwPollEvents();
+		AllocationTracker::endFrame();
+		GpuMemory::endFrame();
 	}
+	AllocationTracker::report("camera-1.7");
+	framePacer->report();
+	geometry->printStats();
+	scene->printStats();
+	picker->printStats();
+	GLTrace::printStats();
+	GpuMemory::printStats("camera-1.7");
+	pipelineStats->report();
+	overdrawView->printStats();
+
 	// deallocate objects
-	glDeleteVertexArrays(1, &VAO);
-	glDeleteBuffers(1, &VBO);
+	delete framePacer;
+	framePacer = NULL;
+	delete scene;
+	delete picker;
+	picker = NULL;
+	delete geometry;
+	delete pipelineStats;
+	pipelineStats = NULL;
+	delete overdrawView;
+	overdrawView = NULL;
+	glDeleteProgram(shader->ID);
+	delete shader;
+	glDeleteTextures(1, &texture);
+	glDeleteTextures(1, &texture2);
+	// anything still listed here was never deleted
+	GpuMemory::printLive("camera-1.7");
 
 	glfwTerminate();
 	return 0;
@@ -327,6 +517,13 @@ void processInput(GLFWwindow* window) {
 }
 
 void mouseCallback(GLFWwindow* window, double xpos, double ypos) {
+	// free cursor: only remember where it is for picking
+	if (cursorFree) {
+		lastMouseX = xpos;
+		lastMouseY = ypos;
+		return;
+	}
+
 	// if is the first time entering the screen, update the mouse pos
 	if (firstMouse) {
 		lastMouseX = xpos;
@@ -363,4 +560,66 @@ void scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
 
 	if (fov > 45.0f) fov = 45.0f;
 	if (fov < 1.0f) fov = 1.0f;
+}
+
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	// cycle frame pacing modes
+	if (key == GLFW_KEY_P && action == GLFW_PRESS && framePacer) {
+		framePacer->nextMode();
+	}
+	// trace capture on/off, save the last frames
+	if (key == GLFW_KEY_C && action == GLFW_PRESS) {
+		GLTrace::setCapturing(!GLTrace::isCapturing());
+	}
+	if (key == GLFW_KEY_T && action == GLFW_PRESS) {
+		GLTrace::save("camera-1.7.gltrace");
+	}
+	// pipeline statistics per draw group on/off, reported on exit
+	if (key == GLFW_KEY_I && action == GLFW_PRESS && pipelineStats) {
+		pipelineStats->setEnabled(!pipelineStats->isEnabled());
+	}
+	// overdraw heat map: off, every rasterized fragment, fragments that passed the depth test
+	if (key == GLFW_KEY_O && action == GLFW_PRESS && overdrawView) {
+		if (!showOverdraw) {
+			showOverdraw = true;
+			overdrawView->setCount(OverdrawView::COUNT_RASTERIZED);
+		}
+		else if (overdrawView->getCount() == OverdrawView::COUNT_RASTERIZED) {
+			overdrawView->setCount(OverdrawView::COUNT_DEPTH_PASSED);
+		}
+		else {
+			showOverdraw = false;
+		}
+	}
+	// free the cursor for picking, or grab it again for mouse look
+	if (key == GLFW_KEY_TAB && action == GLFW_PRESS) {
+		cursorFree = !cursorFree;
+		glfwSetInputMode(window, GLFW_CURSOR, cursorFree ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
+		// no jump when the look resumes
+		firstMouse = true;
+	}
+}
+
+// left click picks the cube under the cursor (screen center while the cursor is grabbed)
+void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+	if (button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS || !picker) {
+		return;
+	}
+
+	int width, height;
+	glfwGetWindowSize(window, &width, &height);
+	float x = cursorFree ? lastMouseX : width * 0.5f;
+	float y = cursorFree ? lastMouseY : height * 0.5f;
+
+	glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+	glm::mat4 projection = glm::perspective(glm::radians(fov), 800.0f / 600.0f, 0.1f, 100.0f);
+	glm::vec3 origin, direction;
+	RayPicker::screenRay(x, y, (float)width, (float)height, view, projection, origin, direction);
+
+	PickHit hit = picker->pick(origin, direction, 100.0f);
+	selectedCube = hit.hit ? (int)hit.object : -1;
+	if (hit.hit) {
+		std::cout << "PICK::cube " << hit.object << " | triangle " << hit.triangle
+			<< " | distance " << hit.distance << std::endl;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,348 @@
+#include "ClusteredLights.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CLUSTERED_LIGHTS_SSE
+#endif
+
+// marks a light that touches no cluster
+const int CULLED = -1;
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+ClusteredLights::ClusteredLights(ThreadPool& pool, bool uploadToGPU)
+	: pool(pool), uploadToGPU(uploadToGPU), useSIMD(true), threadCount(pool.getConcurrency()),
+	indexCount(0), lightBuffer(0), gridBuffer(0), indexBuffer(0),
+	lightTexture(0), gridTexture(0), indexTexture(0),
+	boundsTime(0.0), assignTime(0.0), uploadTime(0.0) {
+	sliceCounts.resize(CLUSTER_COUNT);
+	grid.resize(CLUSTER_COUNT * 2);
+	setProjection(45.0f, 800.0f / 600.0f, 0.1f, 100.0f);
+
+	if (!uploadToGPU) {
+		return;
+	}
+
+	// one buffer texture per stream
+	unsigned int* buffers[] = { &lightBuffer, &gridBuffer, &indexBuffer };
+	unsigned int* textures[] = { &lightTexture, &gridTexture, &indexTexture };
+	GLenum formats[] = { GL_RGBA32F, GL_RG32UI, GL_R32UI };
+	for (int i = 0; i < 3; ++i) {
+		glGenBuffers(1, buffers[i]);
+		glBindBuffer(GL_TEXTURE_BUFFER, *buffers[i]);
+		glBufferData(GL_TEXTURE_BUFFER, 16, NULL, GL_STREAM_DRAW);
+
+		glGenTextures(1, textures[i]);
+		glBindTexture(GL_TEXTURE_BUFFER, *textures[i]);
+		glTexBuffer(GL_TEXTURE_BUFFER, formats[i], *buffers[i]);
+	}
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+ClusteredLights::~ClusteredLights() {
+	if (!uploadToGPU) {
+		return;
+	}
+	glDeleteTextures(1, &lightTexture);
+	glDeleteTextures(1, &gridTexture);
+	glDeleteTextures(1, &indexTexture);
+	glDeleteBuffers(1, &lightBuffer);
+	glDeleteBuffers(1, &gridBuffer);
+	glDeleteBuffers(1, &indexBuffer);
+}
+
+void ClusteredLights::setProjection(float newFovY, float newAspect, float newNear, float newFar) {
+	fovY = newFovY;
+	aspect = newAspect;
+	nearPlane = newNear;
+	farPlane = newFar;
+
+	// same terms glm::perspective puts on the diagonal
+	float tanHalfFov = std::tan(glm::radians(fovY) * 0.5f);
+	projX = 1.0f / (aspect * tanHalfFov);
+	projY = 1.0f / tanHalfFov;
+
+	// exponential slices: every slice is the same ratio deeper than the last
+	float logRatio = std::log(farPlane / nearPlane);
+	sliceScale = CLUSTERS_Z / logRatio;
+	sliceBias = -(float)CLUSTERS_Z * std::log(nearPlane) / logRatio;
+}
+
+void ClusteredLights::update(const std::vector<PointLight>& lights, const glm::mat4& view) {
+	unsigned int lightCount = (unsigned int)lights.size();
+	bounds.resize(lightCount);
+
+	// pass 1: cluster range of every light
+	auto start = std::chrono::high_resolution_clock::now();
+	unsigned int grain = std::max(256u, lightCount / std::max(1u, threadCount) + 1);
+	pool.parallelFor(lightCount, grain, [&](unsigned int begin, unsigned int end) {
+		if (useSIMD) {
+			computeBoundsSIMD(lights, view, begin, end);
+		}
+		else {
+			computeBoundsScalar(lights, view, begin, end);
+		}
+	});
+	boundsTime = elapsedMs(start);
+
+	// pass 2: light lists, threads own whole depth slices so nothing is shared
+	start = std::chrono::high_resolution_clock::now();
+	unsigned int sliceGrain = (CLUSTERS_Z + threadCount - 1) / std::max(1u, threadCount);
+	const unsigned int sliceSize = CLUSTERS_X * CLUSTERS_Y;
+
+	pool.parallelFor(CLUSTERS_Z, sliceGrain, [&](unsigned int zBegin, unsigned int zEnd) {
+		std::fill(sliceCounts.begin() + zBegin * sliceSize, sliceCounts.begin() + zEnd * sliceSize, 0u);
+		for (unsigned int i = 0; i < lightCount; ++i) {
+			const LightBounds& b = bounds[i];
+			int z0 = std::max(b.z0, (int)zBegin);
+			int z1 = std::min(b.z1, (int)zEnd - 1);
+			for (int z = z0; z <= z1; ++z) {
+				for (int y = b.y0; y <= b.y1; ++y) {
+					unsigned int* row = &sliceCounts[(z * CLUSTERS_Y + y) * CLUSTERS_X];
+					for (int x = b.x0; x <= b.x1; ++x) {
+						++row[x];
+					}
+				}
+			}
+		}
+	});
+
+	// offsets, clamped so the index list never outgrows its buffer
+	indexCount = 0;
+	for (unsigned int cluster = 0; cluster < CLUSTER_COUNT; ++cluster) {
+		unsigned int count = std::min(sliceCounts[cluster], MAX_LIGHT_INDICES - indexCount);
+		grid[cluster * 2] = indexCount;
+		grid[cluster * 2 + 1] = count;
+		indexCount += count;
+	}
+	if (indices.size() < indexCount) {
+		indices.resize(indexCount);
+	}
+
+	pool.parallelFor(CLUSTERS_Z, sliceGrain, [&](unsigned int zBegin, unsigned int zEnd) {
+		// reuse the counts as write cursors
+		for (unsigned int cluster = zBegin * sliceSize; cluster < zEnd * sliceSize; ++cluster) {
+			sliceCounts[cluster] = 0;
+		}
+		for (unsigned int i = 0; i < lightCount; ++i) {
+			const LightBounds& b = bounds[i];
+			int z0 = std::max(b.z0, (int)zBegin);
+			int z1 = std::min(b.z1, (int)zEnd - 1);
+			for (int z = z0; z <= z1; ++z) {
+				for (int y = b.y0; y <= b.y1; ++y) {
+					for (int x = b.x0; x <= b.x1; ++x) {
+						unsigned int cluster = (z * CLUSTERS_Y + y) * CLUSTERS_X + x;
+						unsigned int cursor = sliceCounts[cluster]++;
+						if (cursor < grid[cluster * 2 + 1]) {
+							indices[grid[cluster * 2] + cursor] = i;
+						}
+					}
+				}
+			}
+		}
+	});
+	assignTime = elapsedMs(start);
+
+	if (!uploadToGPU) {
+		return;
+	}
+
+	// lights go up in view space, the shader lights in view space too
+	start = std::chrono::high_resolution_clock::now();
+	lightData.resize((size_t)lightCount * 8);
+	for (unsigned int i = 0; i < lightCount; ++i) {
+		glm::vec4 viewPos = view * glm::vec4(lights[i].position, 1.0f);
+		float* dst = &lightData[(size_t)i * 8];
+		dst[0] = viewPos.x;
+		dst[1] = viewPos.y;
+		dst[2] = viewPos.z;
+		dst[3] = lights[i].radius;
+		dst[4] = lights[i].color.x * lights[i].intensity;
+		dst[5] = lights[i].color.y * lights[i].intensity;
+		dst[6] = lights[i].color.z * lights[i].intensity;
+		dst[7] = 0.0f;
+	}
+	upload(lightBuffer, lightData.data(), lightData.size() * sizeof(float));
+	upload(gridBuffer, grid.data(), grid.size() * sizeof(unsigned int));
+	upload(indexBuffer, indices.data(), (size_t)indexCount * sizeof(unsigned int));
+	uploadTime = elapsedMs(start);
+}
+
+void ClusteredLights::bind(const Shader& shader, float viewportWidth, float viewportHeight) const {
+	glActiveTexture(GL_TEXTURE0 + LIGHTS_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, lightTexture);
+	glActiveTexture(GL_TEXTURE0 + GRID_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, gridTexture);
+	glActiveTexture(GL_TEXTURE0 + INDICES_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+	glActiveTexture(GL_TEXTURE0);
+
+	shader.setInt("lights", LIGHTS_UNIT);
+	shader.setInt("lightGrid", GRID_UNIT);
+	shader.setInt("lightIndices", INDICES_UNIT);
+	shader.setFloat("tileWidth", viewportWidth / CLUSTERS_X);
+	shader.setFloat("tileHeight", viewportHeight / CLUSTERS_Y);
+	shader.setFloat("sliceScale", sliceScale);
+	shader.setFloat("sliceBias", sliceBias);
+}
+
+int ClusteredLights::depthSlice(float depth) const {
+	int slice = (int)std::floor(std::log(depth) * sliceScale + sliceBias);
+	return std::max(0, std::min((int)CLUSTERS_Z - 1, slice));
+}
+
+static int toTile(float ndc, unsigned int tiles) {
+	int tile = (int)std::floor((ndc * 0.5f + 0.5f) * tiles);
+	return std::max(0, std::min((int)tiles - 1, tile));
+}
+
+void ClusteredLights::computeBoundsScalar(const std::vector<PointLight>& lights, const glm::mat4& view,
+	unsigned int begin, unsigned int end) {
+	for (unsigned int i = begin; i < end; ++i) {
+		const PointLight& light = lights[i];
+		glm::vec4 viewPos = view * glm::vec4(light.position, 1.0f);
+		float depth = -viewPos.z;
+		float r = light.radius;
+		LightBounds& b = bounds[i];
+
+		if (depth + r < nearPlane || depth - r > farPlane) {
+			b.x0 = b.y0 = b.z0 = 0;
+			b.x1 = b.y1 = b.z1 = CULLED;
+			continue;
+		}
+
+		// closest and furthest depth of the sphere inside the frustum
+		float dMin = std::max(depth - r, nearPlane);
+		float dMax = std::min(depth + r, farPlane);
+
+		// conservative: negative extents shrink least at the near depth
+		float left = viewPos.x - r, right = viewPos.x + r;
+		float bottom = viewPos.y - r, top = viewPos.y + r;
+		float ndcLeft = projX * left / (left < 0.0f ? dMin : dMax);
+		float ndcRight = projX * right / (right > 0.0f ? dMin : dMax);
+		float ndcBottom = projY * bottom / (bottom < 0.0f ? dMin : dMax);
+		float ndcTop = projY * top / (top > 0.0f ? dMin : dMax);
+
+		if (ndcLeft > 1.0f || ndcRight < -1.0f || ndcBottom > 1.0f || ndcTop < -1.0f) {
+			b.x0 = b.y0 = b.z0 = 0;
+			b.x1 = b.y1 = b.z1 = CULLED;
+			continue;
+		}
+
+		b.x0 = toTile(ndcLeft, CLUSTERS_X);
+		b.x1 = toTile(ndcRight, CLUSTERS_X);
+		b.y0 = toTile(ndcBottom, CLUSTERS_Y);
+		b.y1 = toTile(ndcTop, CLUSTERS_Y);
+		b.z0 = depthSlice(dMin);
+		b.z1 = depthSlice(dMax);
+	}
+}
+
+void ClusteredLights::computeBoundsSIMD(const std::vector<PointLight>& lights, const glm::mat4& view,
+	unsigned int begin, unsigned int end) {
+#ifdef CLUSTERED_LIGHTS_SSE
+	// only the rows of the view matrix that produce x, y and z
+	const __m128 m00 = _mm_set1_ps(view[0][0]), m10 = _mm_set1_ps(view[1][0]), m20 = _mm_set1_ps(view[2][0]), m30 = _mm_set1_ps(view[3][0]);
+	const __m128 m01 = _mm_set1_ps(view[0][1]), m11 = _mm_set1_ps(view[1][1]), m21 = _mm_set1_ps(view[2][1]), m31 = _mm_set1_ps(view[3][1]);
+	const __m128 m02 = _mm_set1_ps(view[0][2]), m12 = _mm_set1_ps(view[1][2]), m22 = _mm_set1_ps(view[2][2]), m32 = _mm_set1_ps(view[3][2]);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 nearV = _mm_set1_ps(nearPlane);
+	const __m128 farV = _mm_set1_ps(farPlane);
+	const __m128 projXV = _mm_set1_ps(projX);
+	const __m128 projYV = _mm_set1_ps(projY);
+	const __m128 tilesX = _mm_set1_ps((float)CLUSTERS_X);
+	const __m128 tilesY = _mm_set1_ps((float)CLUSTERS_Y);
+	const __m128 maxX = _mm_set1_ps((float)(CLUSTERS_X - 1));
+	const __m128 maxY = _mm_set1_ps((float)(CLUSTERS_Y - 1));
+
+	// (mask ? a : b) without SSE4.1
+	auto select = [](__m128 mask, __m128 a, __m128 b) {
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	};
+	// ndc -> tile, clamped before the truncation so it acts as floor
+	auto tiles = [&](__m128 ndc, __m128 count, __m128 maxTile) {
+		__m128 t = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(ndc, half), half), count);
+		return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(t, zero), maxTile));
+	};
+
+	unsigned int i = begin;
+	for (; i + 4 <= end; i += 4) {
+		const PointLight* l = &lights[i];
+		__m128 px = _mm_setr_ps(l[0].position.x, l[1].position.x, l[2].position.x, l[3].position.x);
+		__m128 py = _mm_setr_ps(l[0].position.y, l[1].position.y, l[2].position.y, l[3].position.y);
+		__m128 pz = _mm_setr_ps(l[0].position.z, l[1].position.z, l[2].position.z, l[3].position.z);
+		__m128 r = _mm_setr_ps(l[0].radius, l[1].radius, l[2].radius, l[3].radius);
+
+		__m128 vx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, px), _mm_mul_ps(m10, py)), _mm_add_ps(_mm_mul_ps(m20, pz), m30));
+		__m128 vy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, px), _mm_mul_ps(m11, py)), _mm_add_ps(_mm_mul_ps(m21, pz), m31));
+		__m128 vz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, px), _mm_mul_ps(m12, py)), _mm_add_ps(_mm_mul_ps(m22, pz), m32));
+		__m128 depth = _mm_sub_ps(zero, vz);
+
+		__m128 dMin = _mm_max_ps(_mm_sub_ps(depth, r), nearV);
+		__m128 dMax = _mm_min_ps(_mm_add_ps(depth, r), farV);
+
+		__m128 left = _mm_sub_ps(vx, r), right = _mm_add_ps(vx, r);
+		__m128 bottom = _mm_sub_ps(vy, r), top = _mm_add_ps(vy, r);
+		__m128 ndcLeft = _mm_div_ps(_mm_mul_ps(projXV, left), select(_mm_cmplt_ps(left, zero), dMin, dMax));
+		__m128 ndcRight = _mm_div_ps(_mm_mul_ps(projXV, right), select(_mm_cmpgt_ps(right, zero), dMin, dMax));
+		__m128 ndcBottom = _mm_div_ps(_mm_mul_ps(projYV, bottom), select(_mm_cmplt_ps(bottom, zero), dMin, dMax));
+		__m128 ndcTop = _mm_div_ps(_mm_mul_ps(projYV, top), select(_mm_cmpgt_ps(top, zero), dMin, dMax));
+
+		// outside the depth range or outside the screen
+		__m128 culled = _mm_or_ps(
+			_mm_or_ps(_mm_cmplt_ps(_mm_add_ps(depth, r), nearV), _mm_cmpgt_ps(_mm_sub_ps(depth, r), farV)),
+			_mm_or_ps(
+				_mm_or_ps(_mm_cmpgt_ps(ndcLeft, one), _mm_cmplt_ps(ndcRight, _mm_sub_ps(zero, one))),
+				_mm_or_ps(_mm_cmpgt_ps(ndcBottom, one), _mm_cmplt_ps(ndcTop, _mm_sub_ps(zero, one)))));
+
+		alignas(16) int x0[4], x1[4], y0[4], y1[4];
+		alignas(16) float dMinOut[4], dMaxOut[4];
+		_mm_store_si128((__m128i*)x0, tiles(ndcLeft, tilesX, maxX));
+		_mm_store_si128((__m128i*)x1, tiles(ndcRight, tilesX, maxX));
+		_mm_store_si128((__m128i*)y0, tiles(ndcBottom, tilesY, maxY));
+		_mm_store_si128((__m128i*)y1, tiles(ndcTop, tilesY, maxY));
+		_mm_store_ps(dMinOut, dMin);
+		_mm_store_ps(dMaxOut, dMax);
+		int culledMask = _mm_movemask_ps(culled);
+
+		for (int k = 0; k < 4; ++k) {
+			LightBounds& b = bounds[i + k];
+			if (culledMask & (1 << k)) {
+				b.x0 = b.y0 = b.z0 = 0;
+				b.x1 = b.y1 = b.z1 = CULLED;
+				continue;
+			}
+			b.x0 = x0[k];
+			b.x1 = x1[k];
+			b.y0 = y0[k];
+			b.y1 = y1[k];
+			b.z0 = depthSlice(dMinOut[k]);
+			b.z1 = depthSlice(dMaxOut[k]);
+		}
+	}
+
+	// leftovers that do not fill a vector
+	computeBoundsScalar(lights, view, i, end);
+#else
+	computeBoundsScalar(lights, view, begin, end);
+#endif
+}
+
+void ClusteredLights::upload(unsigned int buffer, const void* data, size_t bytes) {
+	glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+	// orphan, last frame's lists may still be in use
+	glBufferData(GL_TEXTURE_BUFFER, std::max<size_t>(bytes, 16), NULL, GL_STREAM_DRAW);
+	if (bytes > 0) {
+		glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+	}
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
\ No newline at end of file
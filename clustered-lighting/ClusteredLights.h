@@ -0,0 +1,96 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "../shader-lesson-1.4/Shader.h"
+#include "../thread-pool/ThreadPool.h"
+
+struct PointLight {
+	glm::vec3 position;
+	float radius;
+	glm::vec3 color;
+	float intensity;
+};
+
+// Clustered forward shading: the view frustum is cut into a froxel grid
+// (screen tiles x exponential depth slices), every light is assigned on the CPU
+// to the clusters its sphere touches and the fragment shader only loops over
+// the lights of its own cluster.
+//
+// GPU layout, all texture buffers so it runs on a 3.3 context:
+//   lights   RGBA32F, 2 texels per light: position + radius, color * intensity
+//   grid     RG32UI, one texel per cluster: offset + count into the index list
+//   indices  R32UI, light indices of every cluster back to back
+class ClusteredLights {
+public:
+	static const unsigned int CLUSTERS_X = 16;
+	static const unsigned int CLUSTERS_Y = 9;
+	static const unsigned int CLUSTERS_Z = 24;
+	static const unsigned int CLUSTER_COUNT = CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z;
+	static const unsigned int MAX_LIGHT_INDICES = 1 << 22;
+
+	// texture units the shader samplers are bound to
+	static const unsigned int LIGHTS_UNIT = 4;
+	static const unsigned int GRID_UNIT = 5;
+	static const unsigned int INDICES_UNIT = 6;
+
+	// uploadToGPU = false keeps everything on the CPU (benchmarks)
+	ClusteredLights(ThreadPool& pool, bool uploadToGPU = true);
+	~ClusteredLights();
+
+	// same parameters as the glm::perspective of the camera
+	void setProjection(float fovY, float aspect, float nearPlane, float farPlane);
+
+	// assign lights to clusters and upload the result
+	void update(const std::vector<PointLight>& lights, const glm::mat4& view);
+
+	// bind the buffers to their units and set the shader uniforms
+	void bind(const Shader& shader, float viewportWidth, float viewportHeight) const;
+
+	// SIMD bounds pass on/off, and number of threads used for the list pass
+	void setUseSIMD(bool enabled) { useSIMD = enabled; }
+	void setThreadCount(unsigned int threads) { threadCount = threads; }
+
+	unsigned int getIndexCount() const { return indexCount; }
+	const std::vector<unsigned int>& getGrid() const { return grid; }
+	const std::vector<unsigned int>& getIndices() const { return indices; }
+	// timings of the last update in milliseconds
+	double getBoundsTime() const { return boundsTime; }
+	double getAssignTime() const { return assignTime; }
+	double getUploadTime() const { return uploadTime; }
+
+private:
+	// cluster range a light touches, inclusive
+	struct LightBounds {
+		int x0, x1, y0, y1, z0, z1;
+	};
+
+	ThreadPool& pool;
+	bool uploadToGPU;
+	bool useSIMD;
+	unsigned int threadCount;
+
+	float fovY, aspect, nearPlane, farPlane;
+	float projX, projY; // projection[0][0] and [1][1]
+	float sliceScale, sliceBias; // slice = log(depth) * scale + bias
+
+	std::vector<LightBounds> bounds;
+	std::vector<unsigned int> sliceCounts; // per cluster light count, then offsets
+	std::vector<unsigned int> grid;        // offset, count per cluster
+	std::vector<unsigned int> indices;
+	std::vector<float> lightData;
+	unsigned int indexCount;
+
+	unsigned int lightBuffer, gridBuffer, indexBuffer;
+	unsigned int lightTexture, gridTexture, indexTexture;
+
+	double boundsTime, assignTime, uploadTime;
+
+	int depthSlice(float depth) const;
+	void computeBoundsScalar(const std::vector<PointLight>& lights, const glm::mat4& view, unsigned int begin, unsigned int end);
+	void computeBoundsSIMD(const std::vector<PointLight>& lights, const glm::mat4& view, unsigned int begin, unsigned int end);
+	void upload(unsigned int buffer, const void* data, size_t bytes);
+};
\ No newline at end of file
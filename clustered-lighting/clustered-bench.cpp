@@ -0,0 +1,62 @@
+// light assignment benchmark, runs without a GL context
+// scales the light count from 10 to 10k for scalar/SIMD and 1/N threads
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "ClusteredLights.h"
+
+int main() {
+	const unsigned int lightCounts[] = { 10, 100, 1000, 5000, 10000 };
+	const int ITERATIONS = 200;
+
+	ThreadPool& pool = ThreadPool::global();
+	ClusteredLights clusters(pool, false);
+	clusters.setProjection(45.0f, 800.0f / 600.0f, 0.1f, 100.0f);
+
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> spread(-40.0f, 40.0f);
+	std::uniform_real_distribution<float> depth(-95.0f, 2.0f);
+	std::uniform_real_distribution<float> radius(0.5f, 4.0f);
+
+	struct Config { const char* name; bool simd; unsigned int threads; };
+	const Config configs[] = {
+		{ "scalar 1 thread", false, 1 },
+		{ "simd 1 thread", true, 1 },
+		{ "simd all threads", true, pool.getConcurrency() }
+	};
+
+	std::cout << "threads available: " << pool.getConcurrency() << std::endl;
+	for (unsigned int count : lightCounts) {
+		std::vector<PointLight> lights(count);
+		for (PointLight& light : lights) {
+			light.position = glm::vec3(spread(rng), spread(rng) * 0.5f, depth(rng));
+			light.radius = radius(rng);
+			light.color = glm::vec3(1.0f);
+			light.intensity = 1.0f;
+		}
+
+		for (const Config& config : configs) {
+			clusters.setUseSIMD(config.simd);
+			clusters.setThreadCount(config.threads);
+
+			double bounds = 0.0, assign = 0.0;
+			for (int i = 0; i < ITERATIONS; ++i) {
+				clusters.update(lights, view);
+				bounds += clusters.getBoundsTime();
+				assign += clusters.getAssignTime();
+			}
+
+			std::cout << count << " lights, " << config.name
+				<< ": bounds " << bounds / ITERATIONS << " ms"
+				<< " | lists " << assign / ITERATIONS << " ms"
+				<< " | light indices " << clusters.getIndexCount() << std::endl;
+		}
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,286 @@
+// clustered forward lighting demo: a field of cubes lit by thousands of point lights
+// usage: clustered-lighting [light count], up/down arrows double/halve the lights
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "../shader-lesson-1.4/Shader.h"
+#include "../geometry-heap/GeometryHeap.h"
+#include "ClusteredLights.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <std_image/stb_image.h>
+
+const unsigned int WIDTH = 800;
+const unsigned int HEIGHT = 600;
+const int FIELD_SIZE = 40;
+
+unsigned int lightCount = 1000;
+bool lightCountChanged = true;
+
+void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+unsigned int loadTexture(const char* path);
+
+int main(int argc, char** argv) {
+	if (argc > 1) {
+		lightCount = std::stoul(argv[1]);
+	}
+
+	// initialize GLFW
+	glfwInit();
+	// set version and core profile
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// create a window
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	// set callback to handle when window is resized
+	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+	glfwSetKeyCallback(window, keyCallback);
+
+	// initialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// no vsync, we want to see the frame time
+	glfwSwapInterval(0);
+
+	Shader shader("clustered.vert", "clustered.frag");
+
+	// positions and texture coords
+	float vertices[] = {
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+	};
+
+	GeometryHeap* geometry = new GeometryHeap(1024, 0);
+	unsigned int cubeMesh = geometry->addMesh(vertices, 36);
+
+	stbi_set_flip_vertically_on_load(true);
+	unsigned int texture = loadTexture("../textures-lesson-1.5/container.jpg");
+	unsigned int texture2 = loadTexture("../textures-lesson-1.5/awesomeface.png");
+
+	shader.use();
+	shader.setInt("texture1", 0);
+	shader.setInt("texture2", 1);
+	shader.setFloat("percentage", 0.2f);
+
+	glEnable(GL_DEPTH_TEST);
+
+	// same projection as camera-1.7, the cluster grid is derived from it
+	const float fov = 45.0f;
+	const float nearPlane = 0.1f;
+	const float farPlane = 100.0f;
+	glm::mat4 projection = glm::perspective(glm::radians(fov), (float)WIDTH / (float)HEIGHT, nearPlane, farPlane);
+
+	ClusteredLights* clusters = new ClusteredLights(ThreadPool::global());
+	clusters->setProjection(fov, (float)WIDTH / (float)HEIGHT, nearPlane, farPlane);
+
+	std::vector<PointLight> lights;
+	std::vector<glm::vec3> lightOrigins;
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	double lastReport = glfwGetTime();
+	double frameTimeSum = 0.0, boundsSum = 0.0, assignSum = 0.0, uploadSum = 0.0;
+	unsigned int frames = 0;
+
+	// render loop
+	while (!glfwWindowShouldClose(window)) {
+		double frameStart = glfwGetTime();
+		float time = (float)frameStart;
+
+		if (lightCountChanged) {
+			// lights scattered over the cube field with random colors
+			lights.resize(lightCount);
+			lightOrigins.resize(lightCount);
+			for (unsigned int i = 0; i < lightCount; ++i) {
+				lightOrigins[i] = glm::vec3((unit(rng) - 0.5f) * FIELD_SIZE * 2.0f, unit(rng) * 4.0f - 1.0f,
+					(unit(rng) - 0.5f) * FIELD_SIZE * 2.0f);
+				lights[i].radius = 1.5f + unit(rng) * 2.5f;
+				lights[i].color = glm::vec3(unit(rng), unit(rng), unit(rng));
+				lights[i].intensity = 1.5f;
+			}
+			std::cout << "CLUSTEREDLIGHTS::lights " << lightCount << std::endl;
+			lightCountChanged = false;
+		}
+
+		// lights bob up and down
+		for (unsigned int i = 0; i < lightCount; ++i) {
+			lights[i].position = lightOrigins[i] + glm::vec3(0.0f, sin(time + i * 0.37f), 0.0f);
+		}
+
+		// camera circles above the field
+		glm::vec3 cameraPos = glm::vec3(sin(time * 0.1f) * 30.0f, 8.0f, cos(time * 0.1f) * 30.0f);
+		glm::mat4 view = glm::lookAt(cameraPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+		clusters->update(lights, view);
+
+		// clear screen
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, texture2);
+
+		shader.use();
+		shader.setMat4("view", view);
+		shader.setMat4("projection", projection);
+		clusters->bind(shader, (float)WIDTH, (float)HEIGHT);
+
+		geometry->bind();
+		for (int z = -FIELD_SIZE / 2; z < FIELD_SIZE / 2; ++z) {
+			for (int x = -FIELD_SIZE / 2; x < FIELD_SIZE / 2; ++x) {
+				glm::mat4 model = glm::mat4(1.0f);
+				model = glm::translate(model, glm::vec3(x * 2.0f, -1.5f, z * 2.0f));
+				shader.setMat4("model", model);
+				geometry->draw(cubeMesh);
+			}
+		}
+		geometry->endFrame();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		// averages once per second
+		frameTimeSum += glfwGetTime() - frameStart;
+		boundsSum += clusters->getBoundsTime();
+		assignSum += clusters->getAssignTime();
+		uploadSum += clusters->getUploadTime();
+		++frames;
+		if (glfwGetTime() - lastReport > 1.0) {
+			std::cout << "CLUSTEREDLIGHTS::lights " << lightCount
+				<< " | frame " << frameTimeSum * 1000.0 / frames << " ms"
+				<< " | bounds " << boundsSum / frames << " ms"
+				<< " | lists " << assignSum / frames << " ms"
+				<< " | upload " << uploadSum / frames << " ms"
+				<< " | light indices " << clusters->getIndexCount() << std::endl;
+			frameTimeSum = boundsSum = assignSum = uploadSum = 0.0;
+			frames = 0;
+			lastReport = glfwGetTime();
+		}
+	}
+
+	// deallocate objects
+	delete clusters;
+	delete geometry;
+	glDeleteTextures(1, &texture);
+	glDeleteTextures(1, &texture2);
+
+	glfwTerminate();
+	return 0;
+}
+
+// whenever the window is resized this function gets called
+void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+	// tell OpenGL the size of the window
+	glViewport(0, 0, width, height);
+}
+
+// react to key presses
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	if (action != GLFW_PRESS) {
+		return;
+	}
+	if (key == GLFW_KEY_ESCAPE) {
+		glfwSetWindowShouldClose(window, true);
+	}
+	if (key == GLFW_KEY_UP && lightCount < 100000) {
+		lightCount *= 2;
+		lightCountChanged = true;
+	}
+	if (key == GLFW_KEY_DOWN && lightCount > 10) {
+		lightCount /= 2;
+		lightCountChanged = true;
+	}
+}
+
+// load an image into a mipmapped texture
+unsigned int loadTexture(const char* path) {
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width, height, nrChannels;
+	unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 4);
+	if (data) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else {
+		std::cout << "Failed to load texture" << std::endl;
+	}
+
+	stbi_image_free(data);
+	return texture;
+}
\ No newline at end of file
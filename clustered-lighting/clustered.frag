@@ -0,0 +1,51 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec3 ViewPos;
+
+uniform sampler2D texture1;
+uniform sampler2D texture2;
+uniform float percentage;
+
+// filled by ClusteredLights, must match its CLUSTERS_* constants
+const int CLUSTERS_X = 16;
+const int CLUSTERS_Y = 9;
+const int CLUSTERS_Z = 24;
+
+uniform samplerBuffer lights;        // position + radius, color (view space)
+uniform usamplerBuffer lightGrid;    // offset + count per cluster
+uniform usamplerBuffer lightIndices;
+uniform float tileWidth;
+uniform float tileHeight;
+uniform float sliceScale;
+uniform float sliceBias;
+
+void main()
+{
+	vec4 albedo = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), percentage);
+
+	// the cube has no normals, take the face normal from the screen derivatives
+	vec3 normal = normalize(cross(dFdx(ViewPos), dFdy(ViewPos)));
+
+	// find the cluster of this fragment
+	int x = min(int(gl_FragCoord.x / tileWidth), CLUSTERS_X - 1);
+	int y = min(int(gl_FragCoord.y / tileHeight), CLUSTERS_Y - 1);
+	int z = clamp(int(floor(log(-ViewPos.z) * sliceScale + sliceBias)), 0, CLUSTERS_Z - 1);
+	uvec2 cell = texelFetch(lightGrid, (z * CLUSTERS_Y + y) * CLUSTERS_X + x).rg;
+
+	// only the lights touching this cluster
+	vec3 lighting = vec3(0.05f);
+	for (uint i = 0u; i < cell.y; ++i) {
+		int light = int(texelFetch(lightIndices, int(cell.x + i)).r);
+		vec4 positionRadius = texelFetch(lights, light * 2);
+		vec3 color = texelFetch(lights, light * 2 + 1).rgb;
+
+		vec3 toLight = positionRadius.xyz - ViewPos;
+		float dist = length(toLight);
+		float attenuation = clamp(1.0f - dist / positionRadius.w, 0.0f, 1.0f);
+		lighting += color * max(dot(normal, toLight / dist), 0.0f) * attenuation * attenuation;
+	}
+
+	FragColor = vec4(albedo.rgb * lighting, albedo.a);
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+out vec2 TexCoord;
+out vec3 ViewPos;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+	vec4 viewPos = view * model * vec4(aPos, 1.0f);
+	ViewPos = viewPos.xyz;
+	gl_Position = projection * viewPos;
+	TexCoord = aTexCoord;
+}
\ No newline at end of file
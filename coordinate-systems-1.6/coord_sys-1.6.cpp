@@ -7,6 +7,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "../shader-lesson-1.4/Shader.h"
+#include "../frame-memory/AllocationTracker.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <std_image/stb_image.h>
@@ -214,6 +215,8 @@ int main() {
 
 	// render loop
 	while (!glfwWindowShouldClose(window)) {
+		AllocationTracker::beginFrame();
+
 		processInput(window);
 
 		// clear screen
@@ -307,7 +310,12 @@ int main() {
 
 		glfwSwapBuffers(window);
 		glfwPollEvents();
+
+		AllocationTracker::endFrame();
 	}
+	// heap allocations per frame, should be 0 in steady state
+	AllocationTracker::report("coord_sys-1.6");
+
 	// deallocate objects
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteBuffers(1, &VBO);
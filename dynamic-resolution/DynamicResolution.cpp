@@ -0,0 +1,104 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+// react to this much over budget, only grow while below (1 - HEADROOM) of it
+const double HEADROOM = 0.1;
+// largest scale increase per measurement
+const float GROW_STEP = 0.02f;
+// changes smaller than this are not worth a different resolution
+const float MIN_CHANGE = 0.01f;
+
+DynamicResolution::DynamicResolution(double targetMs, float minScale, float maxScale)
+	: targetMs(targetMs), minScale(minScale), maxScale(maxScale), scale(maxScale), enabled(true),
+	frame(0), lastGpuMs(0.0), smoothedMs(0.0), settleFrames(0), scaleChanges(0) {
+	glGenQueries(QUERY_COUNT, queries);
+	for (unsigned int i = 0; i < QUERY_COUNT; ++i) {
+		queryPending[i] = false;
+		queryScales[i] = scale;
+	}
+}
+
+DynamicResolution::~DynamicResolution() {
+	glDeleteQueries(QUERY_COUNT, queries);
+}
+
+void DynamicResolution::beginFrame() {
+	unsigned int slot = frame % QUERY_COUNT;
+	if (queryPending[slot]) {
+		// the GPU is more than QUERY_COUNT frames behind, wait for the oldest result
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &nanoseconds);
+		queryPending[slot] = false;
+		if (queryScales[slot] == scale) {
+			update(nanoseconds / 1000000.0);
+		}
+	}
+	queryScales[slot] = scale;
+	glBeginQuery(GL_TIME_ELAPSED, queries[slot]);
+}
+
+void DynamicResolution::endFrame() {
+	unsigned int slot = frame % QUERY_COUNT;
+	glEndQuery(GL_TIME_ELAPSED);
+	queryPending[slot] = true;
+	++frame;
+
+	// oldest first, stop at the first one that is not done
+	for (unsigned int i = QUERY_COUNT - 1; i > 0; --i) {
+		unsigned int older = (frame + QUERY_COUNT - i) % QUERY_COUNT;
+		if (!queryPending[older]) {
+			continue;
+		}
+		int available = 0;
+		glGetQueryObjectiv(queries[older], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) {
+			break;
+		}
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(queries[older], GL_QUERY_RESULT, &nanoseconds);
+		queryPending[older] = false;
+		// frames from before the last change say nothing about the current scale
+		if (queryScales[older] == scale) {
+			update(nanoseconds / 1000000.0);
+		}
+	}
+}
+
+void DynamicResolution::setScale(float scale) {
+	this->scale = std::max(minScale, std::min(maxScale, scale));
+	smoothedMs = 0.0;
+}
+
+void DynamicResolution::update(double gpuMs) {
+	lastGpuMs = gpuMs;
+	// the first frame at a new scale replaces the average instead of dragging it
+	smoothedMs = smoothedMs == 0.0 ? gpuMs : smoothedMs * 0.8 + gpuMs * 0.2;
+	if (settleFrames > 0) {
+		--settleFrames;
+		return;
+	}
+	if (!enabled) {
+		return;
+	}
+
+	// scale that would land on the target if time follows the pixel count
+	float fit = scale * (float)std::sqrt(targetMs * (1.0 - 0.5 * HEADROOM) / std::max(smoothedMs, 0.001));
+	float next = scale;
+	if (gpuMs > targetMs * (1.0 + HEADROOM) || smoothedMs > targetMs) {
+		// over budget: drop at once, a single spike counts
+		next = std::min(scale, scale * (float)std::sqrt(targetMs * (1.0 - 0.5 * HEADROOM) / std::max(gpuMs, smoothedMs)));
+	}
+	else if (smoothedMs < targetMs * (1.0 - HEADROOM)) {
+		next = std::min(fit, scale + GROW_STEP);
+	}
+	next = std::max(minScale, std::min(maxScale, next));
+
+	if (std::fabs(next - scale) >= MIN_CHANGE || (next != scale && (next == minScale || next == maxScale))) {
+		scale = next;
+		smoothedMs = 0.0;
+		settleFrames = 1;
+		++scaleChanges;
+	}
+}
\ No newline at end of file
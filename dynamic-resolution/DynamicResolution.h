@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <vector>
+
+// Picks the scene render scale from measured GPU frame time. Every frame is
+// wrapped in a GL_TIME_ELAPSED query that is read a few frames later, once
+// it is available, so the CPU never waits on the GPU. GPU time is taken to
+// follow the pixel count (scale squared): over budget the scale drops straight
+// to what the measurement says fits, under budget it climbs back slowly, and
+// after every change the controller waits for frames rendered at the new scale.
+class DynamicResolution {
+public:
+	static const unsigned int QUERY_COUNT = 4;
+
+	DynamicResolution(double targetMs, float minScale = 0.5f, float maxScale = 1.0f);
+	~DynamicResolution();
+
+	// start timing the frame, call before the first draw of the scene
+	void beginFrame();
+	// stop timing, pick up finished queries and update the scale
+	void endFrame();
+
+	// off = the scale stays where it is, times are still measured
+	void setEnabled(bool enabled) { this->enabled = enabled; }
+	bool isEnabled() const { return enabled; }
+	void setScale(float scale);
+	float getScale() const { return scale; }
+	void setTarget(double ms) { targetMs = ms; }
+	double getTarget() const { return targetMs; }
+
+	// latest GPU time that came back, and its smoothed value the controller acts on
+	double getGpuTime() const { return lastGpuMs; }
+	double getSmoothedGpuTime() const { return smoothedMs; }
+	unsigned int getScaleChanges() const { return scaleChanges; }
+
+private:
+	double targetMs;
+	float minScale, maxScale;
+	float scale;
+	bool enabled;
+
+	unsigned int queries[QUERY_COUNT];
+	float queryScales[QUERY_COUNT]; // scale the frame was rendered at
+	bool queryPending[QUERY_COUNT];
+	unsigned int frame;
+
+	double lastGpuMs;
+	double smoothedMs;
+	unsigned int settleFrames; // measurements to skip after a change
+	unsigned int scaleChanges;
+
+	void update(double gpuMs);
+};
\ No newline at end of file
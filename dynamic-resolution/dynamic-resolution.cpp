@@ -0,0 +1,309 @@
+// dynamic resolution demo: the glowing cube field from post-processing with a fragment load that
+// ramps up and back down, once at native resolution and once with the scene resolution picked from
+// the measured GPU time.
+// usage: dynamic-resolution [target GPU ms], default 8
+// prints frame time, its spread and the render scale every second, D toggles the controller after
+// the sweep
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../shader-lesson-1.4/Shader.h"
+#include "../geometry-heap/GeometryHeap.h"
+#include "../post-processing/PostProcessChain.h"
+#include "DynamicResolution.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <std_image/stb_image.h>
+
+const unsigned int WIDTH = 1280;
+const unsigned int HEIGHT = 720;
+const int FIELD_SIZE = 30;
+// texture taps per pixel at the top of the ramp
+const int MAX_WORK = 256;
+const double RAMP_SECONDS = 10.0;
+
+bool controllerEnabled = false;
+bool settingsChanged = true;
+int windowWidth = WIDTH;
+int windowHeight = HEIGHT;
+
+void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+unsigned int loadTexture(const char* path);
+
+int main(int argc, char** argv) {
+	double targetMs = argc > 1 ? std::stod(argv[1]) : 8.0;
+
+	// initialize GLFW
+	glfwInit();
+	// set version and core profile
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// create a window
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	// set callback to handle when window is resized
+	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+	glfwSetKeyCallback(window, keyCallback);
+
+	// initialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// no vsync, we want to see the frame time
+	glfwSwapInterval(0);
+
+	Shader shader("../coordinate-systems-1.6/les1.6-vShader.vert", "heavy.frag");
+
+	// positions and texture coords
+	float vertices[] = {
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+	};
+
+	GeometryHeap* geometry = new GeometryHeap(1024, 0);
+	unsigned int cubeMesh = geometry->addMesh(vertices, 36);
+
+	stbi_set_flip_vertically_on_load(true);
+	unsigned int texture = loadTexture("../textures-lesson-1.5/container.jpg");
+
+	glfwGetFramebufferSize(window, &windowWidth, &windowHeight);
+	PostProcessChain* chain = new PostProcessChain(windowWidth, windowHeight);
+	chain->add(PostProcessChain::EFFECT_BLOOM);
+	chain->add(PostProcessChain::EFFECT_TONEMAP);
+	chain->add(PostProcessChain::EFFECT_FXAA);
+
+	DynamicResolution* resolution = new DynamicResolution(targetMs);
+
+	glEnable(GL_DEPTH_TEST);
+
+	// first ramp at native resolution, second with the controller, then the keys take over
+	bool sweeping = true;
+	double rampStart = glfwGetTime();
+	double lastReport = rampStart;
+	double lastFrame = rampStart;
+	double frameSum = 0.0, frameSquares = 0.0, frameMax = 0.0;
+	double rampSum = 0.0, rampSquares = 0.0;
+	unsigned int frames = 0, overBudget = 0;
+	unsigned int rampFrames = 0, rampOverBudget = 0;
+
+	// render loop
+	while (!glfwWindowShouldClose(window)) {
+		float time = (float)glfwGetTime();
+		if (settingsChanged) {
+			chain->resize(windowWidth, windowHeight);
+			resolution->setEnabled(controllerEnabled);
+			if (!controllerEnabled) {
+				resolution->setScale(1.0f);
+			}
+			settingsChanged = false;
+		}
+
+		// load goes up and comes back down over two ramps
+		double rampTime = glfwGetTime() - rampStart;
+		double ramp = sweeping ? rampTime / RAMP_SECONDS : 1.0;
+		int work = (int)(MAX_WORK * (ramp < 1.0 ? ramp : std::max(0.0, 2.0 - ramp)));
+
+		resolution->beginFrame();
+		chain->setRenderScale(resolution->getScale());
+
+		// scene into the HDR target, at the render scale
+		chain->beginScene();
+		glClearColor(0.02f, 0.02f, 0.03f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		glm::vec3 cameraPos = glm::vec3(sin(time * 0.1f) * 30.0f, 8.0f, cos(time * 0.1f) * 30.0f);
+		glm::mat4 view = glm::lookAt(cameraPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)windowWidth / (float)windowHeight, 0.1f, 100.0f);
+		shader.use();
+		shader.setInt("texture1", 0);
+		shader.setInt("work", work);
+		shader.setMat4("view", view);
+		shader.setMat4("projection", projection);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		geometry->bind();
+		for (int z = -FIELD_SIZE / 2; z < FIELD_SIZE / 2; ++z) {
+			for (int x = -FIELD_SIZE / 2; x < FIELD_SIZE / 2; ++x) {
+				bool glowing = (x * 7 + z * 3) % 7 == 0;
+				glm::mat4 model = glm::mat4(1.0f);
+				model = glm::translate(model, glm::vec3(x * 2.0f, glowing ? -1.0f + sin(time + x) * 0.5f : -1.5f, z * 2.0f));
+				shader.setMat4("model", model);
+				shader.setFloat("intensity", glowing ? 8.0f : 1.0f);
+				geometry->draw(cubeMesh);
+			}
+		}
+		geometry->endFrame();
+
+		// upscale, effects and present
+		chain->apply();
+		resolution->endFrame();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		double now = glfwGetTime();
+		double frameMs = (now - lastFrame) * 1000.0;
+		lastFrame = now;
+		frameSum += frameMs;
+		frameSquares += frameMs * frameMs;
+		frameMax = std::max(frameMax, frameMs);
+		rampSum += frameMs;
+		rampSquares += frameMs * frameMs;
+		if (frameMs > targetMs) {
+			++overBudget;
+			++rampOverBudget;
+		}
+		++frames;
+		++rampFrames;
+
+		if (now - lastReport > 1.0) {
+			double mean = frameSum / frames;
+			std::cout << "DYNAMICRES::" << (controllerEnabled ? "dynamic" : "native")
+				<< " | load " << work
+				<< " | scale " << resolution->getScale()
+				<< " (" << chain->getRenderWidth() << "x" << chain->getRenderHeight() << ")"
+				<< " | GPU " << resolution->getSmoothedGpuTime() << " ms"
+				<< " | frame " << mean << " ms, stddev " << std::sqrt(std::max(0.0, frameSquares / frames - mean * mean))
+				<< ", max " << frameMax
+				<< " | over " << targetMs << " ms " << 100.0 * overBudget / frames << "%" << std::endl;
+			frameSum = frameSquares = frameMax = 0.0;
+			frames = overBudget = 0;
+			lastReport = now;
+		}
+
+		// a whole ramp done: summary, then run it again the other way
+		if (sweeping && rampTime > 2.0 * RAMP_SECONDS) {
+			double mean = rampSum / rampFrames;
+			std::cout << "DYNAMICRES::ramp " << (controllerEnabled ? "dynamic" : "native")
+				<< " | frame " << mean << " ms, stddev " << std::sqrt(std::max(0.0, rampSquares / rampFrames - mean * mean))
+				<< " | over budget " << 100.0 * rampOverBudget / rampFrames << "%"
+				<< " | scale changes " << resolution->getScaleChanges() << std::endl;
+			rampSum = rampSquares = 0.0;
+			rampFrames = rampOverBudget = 0;
+			rampStart = now;
+			if (controllerEnabled) {
+				sweeping = false;
+				chain->printStats();
+			}
+			controllerEnabled = true;
+			settingsChanged = true;
+		}
+	}
+
+	// deallocate objects
+	delete resolution;
+	delete chain;
+	delete geometry;
+	glDeleteTextures(1, &texture);
+
+	glfwTerminate();
+	return 0;
+}
+
+// whenever the window is resized this function gets called
+void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+	windowWidth = width;
+	windowHeight = height;
+	settingsChanged = true;
+}
+
+// react to key presses
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	if (action != GLFW_PRESS) {
+		return;
+	}
+	if (key == GLFW_KEY_ESCAPE) {
+		glfwSetWindowShouldClose(window, true);
+	}
+	if (key == GLFW_KEY_D) {
+		controllerEnabled = !controllerEnabled;
+		settingsChanged = true;
+	}
+}
+
+// load an image into a mipmapped texture
+unsigned int loadTexture(const char* path) {
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width, height, nrChannels;
+	unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 4);
+	if (data) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else {
+		std::cout << "Failed to load texture" << std::endl;
+	}
+
+	stbi_image_free(data);
+	return texture;
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#version 330 core
+// textured cube in HDR with a tunable per pixel cost, so the load follows the resolution
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D texture1;
+uniform float intensity;
+uniform int work; // extra texture taps
+
+void main()
+{
+	vec3 color = texture(texture1, TexCoord).rgb;
+	for (int i = 0; i < work; ++i) {
+		color = color * 0.99f + texture(texture1, TexCoord + vec2(i) * 0.0007f).rgb * 0.01f;
+	}
+	FragColor = vec4(color * intensity, 1.0f);
+}
\ No newline at end of file
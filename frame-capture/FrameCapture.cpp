@@ -0,0 +1,362 @@
+#include "FrameCapture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+FrameCapture::FrameCapture(ThreadPool& pool, Format format, const std::string& output,
+	unsigned int ringSize, unsigned int maxQueuedFrames)
+	: pool(pool), format(format), output(output), stream(NULL), pipe(false),
+	nextSlot(0), oldestSlot(0), inFlight(0), sequence(0),
+	pendingJobs(0), nextWrite(0), writing(false), encoded(0),
+	captured(0), droppedInFlight(0), droppedBackpressure(0), captureTime(0.0), encodedBytes(0) {
+	slots.resize(std::max(1u, ringSize));
+	for (Slot& slot : slots) {
+		slot.buffer = 0;
+		slot.fence = 0;
+		slot.width = 0;
+		slot.height = 0;
+	}
+	frames.resize(std::max(1u, maxQueuedFrames));
+	for (Frame& frame : frames) {
+		frame.width = 0;
+		frame.height = 0;
+		frame.sequence = 0;
+		frame.busy = false;
+		frame.queued = false;
+	}
+
+	if (format == FORMAT_RAW && !output.empty()) {
+		pipe = output[0] == '|';
+		stream = pipe ? popen(output.c_str() + 1, "wb") : fopen(output.c_str(), "wb");
+		if (!stream) {
+			std::cout << "ERROR::FRAMECAPTURE::OPEN_FAILED " << output << std::endl;
+		}
+	}
+}
+
+FrameCapture::~FrameCapture() {
+	flush();
+
+	if (stream) {
+		if (pipe) {
+			pclose(stream);
+		}
+		else {
+			fclose(stream);
+		}
+	}
+	for (Slot& slot : slots) {
+		if (slot.buffer) {
+			glDeleteBuffers(1, &slot.buffer);
+		}
+	}
+}
+
+void FrameCapture::capture(int width, int height) {
+	auto start = std::chrono::high_resolution_clock::now();
+	poll();
+
+	if (width != slots[0].width || height != slots[0].height) {
+		resize(width, height);
+	}
+
+	if (inFlight == slots.size()) {
+		++droppedInFlight;
+		captureTime = elapsedMs(start);
+		return;
+	}
+
+	// the copy into the pack buffer is queued like a draw, nothing waits here
+	Slot& slot = slots[nextSlot];
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	nextSlot = (nextSlot + 1) % slots.size();
+	++inFlight;
+	++captured;
+	captureTime = elapsedMs(start);
+}
+
+void FrameCapture::poll() {
+	while (inFlight > 0) {
+		Slot& slot = slots[oldestSlot];
+		// zero timeout: only asks, never waits
+		GLenum status = glClientWaitSync(slot.fence, 0, 0);
+		if (status == GL_TIMEOUT_EXPIRED) {
+			break;
+		}
+		glDeleteSync(slot.fence);
+		slot.fence = 0;
+		oldestSlot = (oldestSlot + 1) % slots.size();
+		--inFlight;
+		if (status == GL_WAIT_FAILED) {
+			continue;
+		}
+
+		// a free CPU frame or the frame is dropped, the render loop never waits for encoders
+		unsigned int index = (unsigned int)frames.size();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (unsigned int i = 0; i < frames.size(); ++i) {
+				if (!frames[i].busy) {
+					index = i;
+					break;
+				}
+			}
+			if (index == frames.size()) {
+				++droppedBackpressure;
+				continue;
+			}
+			frames[index].busy = true;
+			++pendingJobs;
+		}
+
+		Frame& frame = frames[index];
+		size_t bytes = (size_t)slot.width * slot.height * 4;
+		frame.width = slot.width;
+		frame.height = slot.height;
+		frame.sequence = sequence++;
+		frame.pixels.resize(bytes);
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+		void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+		if (mapped) {
+			std::memcpy(frame.pixels.data(), mapped, bytes);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		pool.submit([this, index] { encode(index); });
+	}
+}
+
+void FrameCapture::flush() {
+	// the last readbacks have to finish now
+	while (inFlight > 0) {
+		glClientWaitSync(slots[oldestSlot].fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+		{
+			// make room so poll() does not drop them
+			std::unique_lock<std::mutex> lock(mutex);
+			frameCondition.wait(lock, [this] { return pendingJobs < frames.size(); });
+		}
+		poll();
+	}
+
+	std::unique_lock<std::mutex> lock(mutex);
+	frameCondition.wait(lock, [this] { return pendingJobs == 0; });
+}
+
+const char* FrameCapture::formatName(Format format) {
+	switch (format) {
+	case FORMAT_QOI: return "qoi";
+	case FORMAT_RAW: return "raw";
+	default: return "unknown";
+	}
+}
+
+unsigned int FrameCapture::getEncoded() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return encoded;
+}
+
+void FrameCapture::printStats() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	std::cout << "FRAMECAPTURE::" << formatName(format)
+		<< " | captured " << captured
+		<< " | encoded " << encoded
+		<< " | dropped in flight " << droppedInFlight
+		<< " backpressure " << droppedBackpressure
+		<< " | average frame " << (encoded > 0 ? encodedBytes / encoded / 1024.0 : 0.0) << " KB" << std::endl;
+}
+
+void FrameCapture::encodeQOI(const unsigned char* pixels, int width, int height, std::vector<unsigned char>& out) {
+	out.clear();
+	out.reserve((size_t)width * height * 5 + 22);
+
+	// header: magic, big endian size, 4 channels, sRGB
+	const unsigned char magic[4] = { 'q', 'o', 'i', 'f' };
+	out.insert(out.end(), magic, magic + 4);
+	for (int value : { width, height }) {
+		out.push_back((unsigned char)(value >> 24));
+		out.push_back((unsigned char)(value >> 16));
+		out.push_back((unsigned char)(value >> 8));
+		out.push_back((unsigned char)value);
+	}
+	out.push_back(4);
+	out.push_back(0);
+
+	unsigned char index[64][4] = {};
+	unsigned char previous[4] = { 0, 0, 0, 255 };
+	unsigned int run = 0;
+	size_t pixelCount = (size_t)width * height;
+	size_t written = 0;
+
+	// GL rows are bottom up, images are top down
+	for (int y = height - 1; y >= 0; --y) {
+		const unsigned char* row = pixels + (size_t)y * width * 4;
+		for (int x = 0; x < width; ++x) {
+			const unsigned char* pixel = row + x * 4;
+			++written;
+
+			if (std::memcmp(pixel, previous, 4) == 0) {
+				++run;
+				if (run == 62 || written == pixelCount) {
+					out.push_back((unsigned char)(0xc0 | (run - 1)));
+					run = 0;
+				}
+				continue;
+			}
+			if (run > 0) {
+				out.push_back((unsigned char)(0xc0 | (run - 1)));
+				run = 0;
+			}
+
+			unsigned int hash = (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64;
+			if (std::memcmp(index[hash], pixel, 4) == 0) {
+				out.push_back((unsigned char)hash);
+			}
+			else {
+				std::memcpy(index[hash], pixel, 4);
+				if (pixel[3] == previous[3]) {
+					signed char vr = (signed char)(pixel[0] - previous[0]);
+					signed char vg = (signed char)(pixel[1] - previous[1]);
+					signed char vb = (signed char)(pixel[2] - previous[2]);
+					signed char vgr = (signed char)(vr - vg);
+					signed char vgb = (signed char)(vb - vg);
+					if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+						out.push_back((unsigned char)(0x40 | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2)));
+					}
+					else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32 && vgb > -9 && vgb < 8) {
+						out.push_back((unsigned char)(0x80 | (vg + 32)));
+						out.push_back((unsigned char)((vgr + 8) << 4 | (vgb + 8)));
+					}
+					else {
+						out.push_back(0xfe);
+						out.insert(out.end(), pixel, pixel + 3);
+					}
+				}
+				else {
+					out.push_back(0xff);
+					out.insert(out.end(), pixel, pixel + 4);
+				}
+			}
+			std::memcpy(previous, pixel, 4);
+		}
+	}
+
+	const unsigned char end[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+	out.insert(out.end(), end, end + 8);
+}
+
+void FrameCapture::encode(unsigned int index) {
+	Frame& frame = frames[index];
+	size_t bytes = 0;
+
+	if (format == FORMAT_QOI) {
+		encodeQOI(frame.pixels.data(), frame.width, frame.height, frame.encoded);
+		bytes = frame.encoded.size();
+		if (!output.empty()) {
+			char name[16];
+			snprintf(name, sizeof(name), "%05u.qoi", frame.sequence + 1);
+			std::string path = output + name;
+			FILE* file = fopen(path.c_str(), "wb");
+			if (file) {
+				fwrite(frame.encoded.data(), 1, bytes, file);
+				fclose(file);
+			}
+			else {
+				std::cout << "ERROR::FRAMECAPTURE::WRITE_FAILED " << path << std::endl;
+			}
+		}
+	}
+	else {
+		bytes = frame.pixels.size();
+		if (stream) {
+			// one stream: queue the frame, whichever job finds the next one in
+			// sequence writes it and every queued frame after it, the others
+			// return to the pool instead of waiting for their turn
+			std::unique_lock<std::mutex> lock(mutex);
+			frame.queued = true;
+			if (!writing) {
+				drainRaw(lock);
+			}
+			return;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		release(frame, bytes);
+	}
+	frameCondition.notify_all();
+}
+
+void FrameCapture::drainRaw(std::unique_lock<std::mutex>& lock) {
+	writing = true;
+	while (true) {
+		Frame* next = NULL;
+		for (Frame& frame : frames) {
+			if (frame.queued && frame.sequence == nextWrite) {
+				next = &frame;
+				break;
+			}
+		}
+		if (!next) {
+			break;
+		}
+
+		lock.unlock();
+		size_t rowBytes = (size_t)next->width * 4;
+		for (int y = next->height - 1; y >= 0; --y) {
+			fwrite(next->pixels.data() + y * rowBytes, 1, rowBytes, stream);
+		}
+		lock.lock();
+
+		++nextWrite;
+		next->queued = false;
+		release(*next, next->pixels.size());
+		frameCondition.notify_all();
+	}
+	writing = false;
+}
+
+void FrameCapture::release(Frame& frame, size_t bytes) {
+	frame.busy = false;
+	--pendingJobs;
+	++encoded;
+	encodedBytes += bytes;
+}
+
+void FrameCapture::resize(int width, int height) {
+	// readbacks of the old size are not worth finishing
+	while (inFlight > 0) {
+		glDeleteSync(slots[oldestSlot].fence);
+		slots[oldestSlot].fence = 0;
+		oldestSlot = (oldestSlot + 1) % slots.size();
+		--inFlight;
+	}
+
+	for (Slot& slot : slots) {
+		if (!slot.buffer) {
+			glGenBuffers(1, &slot.buffer);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+		glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, NULL, GL_STREAM_READ);
+		slot.width = width;
+		slot.height = height;
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
\ No newline at end of file
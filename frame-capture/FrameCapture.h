@@ -0,0 +1,107 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../thread-pool/ThreadPool.h"
+
+// Reads the default framebuffer back without stalling the render loop.
+// glReadPixels goes into one of a ring of pixel pack buffers with a fence
+// behind it; a few frames later, once the fence has passed, the pixels are
+// copied out and encoded on the thread pool. Memory is bounded: when every
+// ring slot is still in flight or every CPU frame is still being encoded, the
+// frame is dropped instead of waiting.
+class FrameCapture {
+public:
+	enum Format {
+		FORMAT_QOI, // one .qoi file per frame
+		FORMAT_RAW, // RGBA frames back to back in one stream, e.g. piped into ffmpeg
+		FORMAT_COUNT
+	};
+
+	// QOI: output is the file name prefix, frames become <output>00001.qoi
+	// RAW: output is a file, or "|command" to pipe into an encoder
+	// an empty output encodes and throws the result away (benchmarks)
+	FrameCapture(ThreadPool& pool, Format format, const std::string& output,
+		unsigned int ringSize = 3, unsigned int maxQueuedFrames = 4);
+	// waits for every frame in flight
+	~FrameCapture();
+
+	// queue a readback of the current back buffer, call after drawing and before swapping
+	void capture(int width, int height);
+	// hand finished readbacks to the encoders, capture() does this too
+	void poll();
+	// block until everything captured so far is written
+	void flush();
+
+	static const char* formatName(Format format);
+
+	unsigned int getCaptured() const { return captured; }
+	unsigned int getEncoded() const;
+	// ring full, the GPU is more than ringSize frames behind
+	unsigned int getDroppedInFlight() const { return droppedInFlight; }
+	// no free CPU frame, the encoders are behind
+	unsigned int getDroppedBackpressure() const { return droppedBackpressure; }
+	// render thread cost of the last capture() in milliseconds
+	double getCaptureTime() const { return captureTime; }
+	void printStats() const;
+
+	// RGBA8 rows bottom up as read from GL, flipped while encoding
+	static void encodeQOI(const unsigned char* pixels, int width, int height, std::vector<unsigned char>& out);
+
+private:
+	struct Slot {
+		unsigned int buffer;
+		GLsync fence;
+		int width, height;
+	};
+
+	// CPU copy of a frame plus its encode scratch, reused
+	struct Frame {
+		std::vector<unsigned char> pixels;
+		std::vector<unsigned char> encoded;
+		int width, height;
+		unsigned int sequence;
+		bool busy;
+		bool queued; // raw: waiting for its turn in the stream
+	};
+
+	ThreadPool& pool;
+	Format format;
+	std::string output;
+	FILE* stream;
+	bool pipe;
+
+	std::vector<Slot> slots;
+	unsigned int nextSlot;   // next one to read into
+	unsigned int oldestSlot; // next one to complete
+	unsigned int inFlight;
+	unsigned int sequence;
+
+	// shared with the encode jobs
+	mutable std::mutex mutex;
+	std::condition_variable frameCondition;
+	std::vector<Frame> frames;
+	unsigned int pendingJobs;
+	unsigned int nextWrite; // raw frames are written in capture order
+	bool writing;           // a job is draining the queued raw frames
+	unsigned int encoded;
+
+	unsigned int captured;
+	unsigned int droppedInFlight;
+	unsigned int droppedBackpressure;
+	double captureTime;
+	unsigned long long encodedBytes;
+
+	void encode(unsigned int frame);
+	// write queued raw frames while the next one in sequence is there, called with the lock held
+	void drainRaw(std::unique_lock<std::mutex>& lock);
+	// called with the lock held
+	void release(Frame& frame, size_t bytes);
+	void resize(int width, int height);
+};
\ No newline at end of file
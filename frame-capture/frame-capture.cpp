@@ -0,0 +1,310 @@
+// frame capture demo: a field of cubes at 1080p, read back every frame
+// usage: frame-capture [raw output], e.g. frame-capture "|ffmpeg -f rawvideo -pixel_format rgba
+// -video_size 1920x1080 -framerate 60 -i - capture.mp4"
+// first compares the frame time without capture, with a blocking glReadPixels and with the async
+// pipeline (QOI encoded and discarded), then K starts/stops recording to QOI files or the raw output
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../shader-lesson-1.4/Shader.h"
+#include "../geometry-heap/GeometryHeap.h"
+#include "FrameCapture.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <std_image/stb_image.h>
+
+const unsigned int WIDTH = 1920;
+const unsigned int HEIGHT = 1080;
+const int FIELD_SIZE = 40;
+const unsigned int SWEEP_FRAMES = 300;
+
+enum CaptureMode {
+	CAPTURE_OFF,
+	CAPTURE_BLOCKING, // glReadPixels into client memory, waits for the GPU every frame
+	CAPTURE_ASYNC,    // FrameCapture ring + encoder threads
+	CAPTURE_MODE_COUNT
+};
+const char* CAPTURE_MODE_NAMES[] = { "off", "blocking glReadPixels", "async pbo ring" };
+
+bool recordToggled = false;
+int windowWidth = WIDTH;
+int windowHeight = HEIGHT;
+
+void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+unsigned int loadTexture(const char* path);
+
+int main(int argc, char** argv) {
+	std::string rawOutput = argc > 1 ? argv[1] : "";
+
+	// initialize GLFW
+	glfwInit();
+	// set version and core profile
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// create a window
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	// set callback to handle when window is resized
+	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+	glfwSetKeyCallback(window, keyCallback);
+
+	// initialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// no vsync, we want to see the frame time
+	glfwSwapInterval(0);
+	glfwGetFramebufferSize(window, &windowWidth, &windowHeight);
+
+	Shader shader("../coordinate-systems-1.6/les1.6-vShader.vert", "../coordinate-systems-1.6/les1.6-fShader.frag");
+
+	// positions and texture coords
+	float vertices[] = {
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+	};
+
+	GeometryHeap* geometry = new GeometryHeap(1024, 0);
+	unsigned int cubeMesh = geometry->addMesh(vertices, 36);
+
+	stbi_set_flip_vertically_on_load(true);
+	unsigned int texture = loadTexture("../textures-lesson-1.5/container.jpg");
+	unsigned int texture2 = loadTexture("../textures-lesson-1.5/awesomeface.png");
+
+	shader.use();
+	shader.setInt("texture1", 0);
+	shader.setInt("texture2", 1);
+	shader.setFloat("percentage", 0.2f);
+
+	glEnable(GL_DEPTH_TEST);
+
+	// the sweep encodes and discards, recording (K) writes files or feeds the raw output
+	ThreadPool& pool = ThreadPool::global();
+	FrameCapture* benchCapture = new FrameCapture(pool, FrameCapture::FORMAT_QOI, "");
+	FrameCapture* recording = NULL;
+	std::vector<unsigned char> blockingPixels;
+
+	CaptureMode mode = CAPTURE_OFF;
+	bool sweeping = true;
+	unsigned int sweepFrame = 0;
+	double lastFrame = glfwGetTime();
+	double lastReport = lastFrame;
+	double frameSum = 0.0, captureSum = 0.0;
+	unsigned int frames = 0;
+
+	// render loop
+	while (!glfwWindowShouldClose(window)) {
+		float time = (float)glfwGetTime();
+
+		// clear screen
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, texture2);
+
+		// camera circles the field
+		glm::vec3 cameraPos = glm::vec3(sin(time * 0.1f) * 30.0f, 8.0f, cos(time * 0.1f) * 30.0f);
+		glm::mat4 view = glm::lookAt(cameraPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)windowWidth / (float)windowHeight, 0.1f, 100.0f);
+		shader.use();
+		shader.setMat4("view", view);
+		shader.setMat4("projection", projection);
+
+		geometry->bind();
+		for (int z = -FIELD_SIZE / 2; z < FIELD_SIZE / 2; ++z) {
+			for (int x = -FIELD_SIZE / 2; x < FIELD_SIZE / 2; ++x) {
+				glm::mat4 model = glm::mat4(1.0f);
+				model = glm::translate(model, glm::vec3(x * 2.0f, sin(time + x * 0.3f + z * 0.2f) * 0.5f, z * 2.0f));
+				shader.setMat4("model", model);
+				geometry->draw(cubeMesh);
+			}
+		}
+		geometry->endFrame();
+
+		// read the finished frame before it is swapped away
+		auto start = std::chrono::high_resolution_clock::now();
+		if (mode == CAPTURE_BLOCKING) {
+			blockingPixels.resize((size_t)windowWidth * windowHeight * 4);
+			glReadPixels(0, 0, windowWidth, windowHeight, GL_RGBA, GL_UNSIGNED_BYTE, blockingPixels.data());
+		}
+		else if (mode == CAPTURE_ASYNC) {
+			benchCapture->capture(windowWidth, windowHeight);
+		}
+		if (recording) {
+			recording->capture(windowWidth, windowHeight);
+		}
+		captureSum += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		if (recordToggled) {
+			if (recording) {
+				// waits for the last frames in flight
+				recording->flush();
+				recording->printStats();
+				delete recording;
+				recording = NULL;
+			}
+			else if (!rawOutput.empty()) {
+				recording = new FrameCapture(pool, FrameCapture::FORMAT_RAW, rawOutput);
+			}
+			else {
+				recording = new FrameCapture(pool, FrameCapture::FORMAT_QOI, "frame-capture-");
+			}
+			std::cout << "FRAMECAPTURE::recording " << (recording ? "on" : "off") << std::endl;
+			recordToggled = false;
+		}
+
+		double now = glfwGetTime();
+		frameSum += (now - lastFrame) * 1000.0;
+		lastFrame = now;
+		++frames;
+
+		// the sweep steps through every capture mode, then hands over to the keys
+		bool report = sweeping ? ++sweepFrame % SWEEP_FRAMES == 0 : now - lastReport > 1.0;
+		if (report) {
+			std::cout << "FRAMECAPTURE::" << windowWidth << "x" << windowHeight
+				<< " | " << CAPTURE_MODE_NAMES[mode]
+				<< " | frame " << frameSum / frames << " ms"
+				<< " | capture call " << captureSum / frames << " ms" << std::endl;
+			if (mode == CAPTURE_ASYNC) {
+				benchCapture->printStats();
+			}
+			frameSum = captureSum = 0.0;
+			frames = 0;
+			lastReport = now;
+		}
+		if (sweeping && report) {
+			mode = (CaptureMode)(mode + 1);
+			if (mode == CAPTURE_MODE_COUNT) {
+				mode = CAPTURE_OFF;
+				sweeping = false;
+			}
+		}
+	}
+
+	// deallocate objects
+	delete recording;
+	delete benchCapture;
+	delete geometry;
+	glDeleteTextures(1, &texture);
+	glDeleteTextures(1, &texture2);
+
+	glfwTerminate();
+	return 0;
+}
+
+// whenever the window is resized this function gets called
+void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+	// tell OpenGL the size of the window
+	glViewport(0, 0, width, height);
+	windowWidth = width;
+	windowHeight = height;
+}
+
+// react to key presses
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	if (action != GLFW_PRESS) {
+		return;
+	}
+	if (key == GLFW_KEY_ESCAPE) {
+		glfwSetWindowShouldClose(window, true);
+	}
+	// start/stop recording
+	if (key == GLFW_KEY_K) {
+		recordToggled = true;
+	}
+}
+
+// load an image into a mipmapped texture
+unsigned int loadTexture(const char* path) {
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width, height, nrChannels;
+	unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 4);
+	if (data) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else {
+		std::cout << "Failed to load texture" << std::endl;
+	}
+
+	stbi_image_free(data);
+	return texture;
+}
\ No newline at end of file
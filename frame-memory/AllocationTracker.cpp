@@ -0,0 +1,147 @@
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+// everything here is plain static data: operator new can run before main
+// and must not allocate itself
+namespace {
+	struct Counter {
+		std::atomic<unsigned long long> allocations;
+		std::atomic<unsigned long long> bytes;
+	};
+
+	// per frame totals of one subsystem
+	struct FrameStats {
+		unsigned long long startAllocations, startBytes;
+		unsigned long long firstFrame;
+		unsigned long long steadyAllocations, steadyBytes; // summed after warm up
+		unsigned long long steadyMax;
+	};
+
+	Counter counters[AllocationTracker::MAX_SUBSYSTEMS];
+	FrameStats frameStats[AllocationTracker::MAX_SUBSYSTEMS];
+	const char* names[AllocationTracker::MAX_SUBSYSTEMS] = { "other" };
+	std::atomic<unsigned int> subsystemCount(1);
+
+	unsigned long long frames = 0;
+	unsigned long long lastFrameAllocations = 0;
+
+	thread_local unsigned int currentSubsystem = 0;
+
+	void* trackedAllocate(size_t size) {
+		void* memory = std::malloc(size ? size : 1);
+		if (!memory) {
+			throw std::bad_alloc();
+		}
+		Counter& counter = counters[currentSubsystem];
+		counter.allocations.fetch_add(1, std::memory_order_relaxed);
+		counter.bytes.fetch_add(size, std::memory_order_relaxed);
+		return memory;
+	}
+
+	void* trackedAllocateNoThrow(size_t size) noexcept {
+		void* memory = std::malloc(size ? size : 1);
+		if (memory) {
+			Counter& counter = counters[currentSubsystem];
+			counter.allocations.fetch_add(1, std::memory_order_relaxed);
+			counter.bytes.fetch_add(size, std::memory_order_relaxed);
+		}
+		return memory;
+	}
+}
+
+void* operator new(size_t size) { return trackedAllocate(size); }
+void* operator new[](size_t size) { return trackedAllocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return trackedAllocateNoThrow(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return trackedAllocateNoThrow(size); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+
+unsigned int AllocationTracker::subsystem(const char* name) {
+	unsigned int count = subsystemCount.load();
+	for (unsigned int i = 0; i < count; ++i) {
+		if (std::strcmp(names[i], name) == 0) {
+			return i;
+		}
+	}
+	if (count == MAX_SUBSYSTEMS) {
+		std::cout << "ERROR::ALLOCATIONTRACKER::TOO_MANY_SUBSYSTEMS " << name << std::endl;
+		return 0;
+	}
+	// registration happens on the main thread during startup
+	names[count] = name;
+	subsystemCount.store(count + 1);
+	return count;
+}
+
+void AllocationTracker::beginFrame() {
+	for (unsigned int i = 0; i < subsystemCount.load(); ++i) {
+		frameStats[i].startAllocations = counters[i].allocations.load();
+		frameStats[i].startBytes = counters[i].bytes.load();
+	}
+}
+
+void AllocationTracker::endFrame() {
+	lastFrameAllocations = 0;
+	for (unsigned int i = 0; i < subsystemCount.load(); ++i) {
+		FrameStats& stats = frameStats[i];
+		unsigned long long allocations = counters[i].allocations.load() - stats.startAllocations;
+		unsigned long long bytes = counters[i].bytes.load() - stats.startBytes;
+		lastFrameAllocations += allocations;
+
+		if (frames == 0) {
+			stats.firstFrame = allocations;
+		}
+		else if (frames >= WARMUP_FRAMES) {
+			stats.steadyAllocations += allocations;
+			stats.steadyBytes += bytes;
+			if (allocations > stats.steadyMax) {
+				stats.steadyMax = allocations;
+			}
+		}
+	}
+	++frames;
+}
+
+unsigned long long AllocationTracker::getLastFrameAllocations() {
+	return lastFrameAllocations;
+}
+
+unsigned long long AllocationTracker::getTotalAllocations() {
+	unsigned long long total = 0;
+	for (unsigned int i = 0; i < subsystemCount.load(); ++i) {
+		total += counters[i].allocations.load();
+	}
+	return total;
+}
+
+void AllocationTracker::report(const char* label) {
+	unsigned long long steadyFrames = frames > WARMUP_FRAMES ? frames - WARMUP_FRAMES : 0;
+	double perFrame = steadyFrames > 0 ? 1.0 / steadyFrames : 0.0;
+
+	std::cout << "ALLOCATIONS::" << label << " frames " << frames
+		<< " | total allocations " << getTotalAllocations() << std::endl;
+	for (unsigned int i = 0; i < subsystemCount.load(); ++i) {
+		const FrameStats& stats = frameStats[i];
+		std::cout << "ALLOCATIONS::" << label << "::" << names[i]
+			<< " first frame " << stats.firstFrame
+			<< " | steady state " << stats.steadyAllocations * perFrame << "/frame"
+			<< " (max " << stats.steadyMax << ", " << stats.steadyBytes * perFrame << " bytes/frame)" << std::endl;
+	}
+}
+
+AllocationScope::AllocationScope(unsigned int subsystem) : previous(currentSubsystem) {
+	currentSubsystem = subsystem < AllocationTracker::MAX_SUBSYSTEMS ? subsystem : 0;
+}
+
+AllocationScope::~AllocationScope() {
+	currentSubsystem = previous;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+// Counts heap allocations made through operator new, per frame and per subsystem.
+// Linking AllocationTracker.cpp replaces the global operator new/delete; memory
+// the driver or GLFW get with malloc is not seen.
+// Frames are the allocations between beginFrame() and endFrame(), subsystems are
+// whatever AllocationScope is active on the allocating thread.
+class AllocationTracker {
+public:
+	static const unsigned int MAX_SUBSYSTEMS = 16;
+	// frames left out of the steady state numbers, caches and pools fill up here
+	static const unsigned int WARMUP_FRAMES = 30;
+
+	// id for a subsystem name, the same name always gives the same id.
+	// 0 is "other", anything allocated outside a scope
+	static unsigned int subsystem(const char* name);
+
+	static void beginFrame();
+	static void endFrame();
+
+	// allocations of the last finished frame
+	static unsigned long long getLastFrameAllocations();
+	// allocations since the program started, frames or not
+	static unsigned long long getTotalAllocations();
+
+	// per frame numbers of every frame so far, label is printed in front
+	static void report(const char* label);
+};
+
+// allocations on this thread count towards subsystem until the scope ends
+class AllocationScope {
+public:
+	AllocationScope(unsigned int subsystem);
+	~AllocationScope();
+
+private:
+	unsigned int previous;
+};
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+FrameArena::FrameArena(size_t capacity)
+	: block(NULL), capacity(capacity), used(0), peak(0), overflows(0) {
+	block = static_cast<unsigned char*>(std::malloc(capacity));
+}
+
+FrameArena::~FrameArena() {
+	reset();
+	std::free(block);
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment) {
+	uintptr_t base = (uintptr_t)block;
+	uintptr_t aligned = (base + used + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	size_t end = (size_t)(aligned - base) + bytes;
+
+	if (used <= capacity && end <= capacity) {
+		used = end;
+		return (void*)aligned;
+	}
+
+	// does not fit, this frame gets a heap block and the arena grows at reset
+	if (overflowBlocks.empty()) {
+		++overflows;
+	}
+	void* memory = std::malloc(bytes + alignment);
+	overflowBlocks.push_back(memory);
+	used = std::max(used, capacity) + bytes + alignment;
+	return (void*)(((uintptr_t)memory + alignment - 1) & ~(uintptr_t)(alignment - 1));
+}
+
+void FrameArena::reset() {
+	peak = std::max(peak, used);
+	if (!overflowBlocks.empty()) {
+		for (void* memory : overflowBlocks) {
+			std::free(memory);
+		}
+		overflowBlocks.clear();
+
+		// room for the biggest frame so far plus some slack
+		capacity = peak + peak / 2;
+		std::free(block);
+		block = static_cast<unsigned char*>(std::malloc(capacity));
+	}
+	used = 0;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator for memory that only lives until the end of the frame.
+// allocate() moves a pointer forward, reset() drops everything at once.
+// When a frame needs more than the block holds the rest comes from the heap
+// and the block is grown at the next reset, so steady state frames never
+// touch the heap.
+class FrameArena {
+public:
+	FrameArena(size_t capacity = 64 * 1024);
+	~FrameArena();
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+	// uninitialized storage for count objects, nothing is ever destroyed
+	template <typename T>
+	T* allocate(size_t count) {
+		static_assert(std::is_trivially_destructible<T>::value, "frame arena memory is never destroyed");
+		return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+	}
+
+	// start a new frame, every pointer handed out before is invalid
+	void reset();
+
+	size_t getCapacity() const { return capacity; }
+	size_t getUsed() const { return used; }
+	size_t getPeak() const { return peak; }
+	// frames that did not fit the block and had to go to the heap
+	unsigned int getOverflowCount() const { return overflows; }
+
+private:
+	unsigned char* block;
+	size_t capacity;
+	size_t used;     // bytes handed out this frame, overflow included
+	size_t peak;
+	unsigned int overflows;
+	std::vector<void*> overflowBlocks;
+};
\ No newline at end of file
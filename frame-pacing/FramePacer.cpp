@@ -0,0 +1,235 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+// time kept in reserve between the predicted end of the frame and the present
+const double SAFETY_MARGIN = 0.001;
+// amount of samples kept per stat before the oldest get dropped
+const size_t MAX_SAMPLES = 4096;
+
+FramePacer::FramePacer(Mode mode, unsigned int maxFramesInFlight)
+	: mode(mode), maxFramesInFlight(std::max(1u, maxFramesInFlight)), cameraUBO(0),
+	refreshInterval(1.0 / 60.0), gpuClockOffset(0.0), wakeTime(0.0), inputTime(0.0),
+	lastSwapTime(0.0), lastPresentTime(0.0), predictedFrameCost(0.0), frameCount(0) {
+	// camera block: view + projection, std140
+	glGenBuffers(1, &cameraUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, cameraUBO);
+	glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_UBO_BINDING, cameraUBO);
+
+	// size everything up front, endFrame() must not allocate
+	pending.reserve(16);
+	freeQueries.reserve(16);
+	for (Stats& modeStats : stats) {
+		modeStats.swapLatency.reserve(MAX_SAMPLES);
+		modeStats.presentLatency.reserve(MAX_SAMPLES);
+		modeStats.frameTime.reserve(MAX_SAMPLES);
+	}
+
+	// presents happen on the monitor refresh grid
+	GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+	const GLFWvidmode* videoMode = monitor ? glfwGetVideoMode(monitor) : NULL;
+	if (videoMode && videoMode->refreshRate > 0) {
+		refreshInterval = 1.0 / videoMode->refreshRate;
+	}
+
+	calibrateGpuClock();
+}
+
+FramePacer::~FramePacer() {
+	for (const PendingFrame& frame : pending) {
+		glDeleteSync(frame.fence);
+		glDeleteQueries(1, &frame.query);
+	}
+	if (!freeQueries.empty()) {
+		glDeleteQueries((GLsizei)freeQueries.size(), freeQueries.data());
+	}
+	glDeleteBuffers(1, &cameraUBO);
+}
+
+void FramePacer::setMode(Mode newMode) {
+	mode = newMode;
+	// the previous mode's prediction does not apply anymore
+	predictedFrameCost = 0.0;
+	std::cout << "FRAMEPACER::MODE " << modeName(mode) << std::endl;
+}
+
+void FramePacer::nextMode() {
+	setMode((Mode)((mode + 1) % MODE_COUNT));
+}
+
+const char* FramePacer::modeName(Mode mode) {
+	switch (mode) {
+	case MODE_VSYNC: return "vsync";
+	case MODE_FENCED: return "fenced";
+	case MODE_LATE_START: return "late-start";
+	default: return "unknown";
+	}
+}
+
+void FramePacer::beginFrame() {
+	// every other mode waits until the GPU drained enough frames
+	retireFrames(mode != MODE_VSYNC);
+
+	if (mode == MODE_LATE_START && lastSwapTime > 0.0) {
+		// the next present is one refresh after the last one we observed
+		double now = glfwGetTime();
+		double nextPresent = std::max(lastSwapTime, lastPresentTime) + refreshInterval;
+		while (nextPresent < now) {
+			nextPresent += refreshInterval;
+		}
+		sleepUntil(nextPresent - predictedFrameCost - SAFETY_MARGIN);
+	}
+
+	wakeTime = glfwGetTime();
+	inputTime = wakeTime;
+
+	// GPU and CPU clocks drift apart slowly
+	if (++frameCount % 600 == 0) {
+		calibrateGpuClock();
+	}
+}
+
+void FramePacer::markInput() {
+	inputTime = glfwGetTime();
+}
+
+void FramePacer::latchCamera(const glm::mat4& view, const glm::mat4& projection) {
+	glBindBuffer(GL_UNIFORM_BUFFER, cameraUBO);
+	// orphan the storage so we never wait on a frame still reading the old matrices
+	glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), &view[0][0]);
+	glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), &projection[0][0]);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void FramePacer::endFrame(GLFWwindow* window) {
+	PendingFrame frame;
+	if (freeQueries.empty()) {
+		glGenQueries(1, &frame.query);
+	}
+	else {
+		frame.query = freeQueries.back();
+		freeQueries.pop_back();
+	}
+	// GPU timestamp once every draw of the frame has executed
+	glQueryCounter(frame.query, GL_TIMESTAMP);
+
+	glfwSwapBuffers(window);
+	double swapTime = glfwGetTime();
+
+	frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	frame.wakeTime = wakeTime;
+	frame.inputTime = inputTime;
+	frame.mode = mode;
+	pending.push_back(frame);
+
+	Stats& current = stats[mode];
+	addSample(current.swapLatency, (float)((swapTime - inputTime) * 1000.0));
+	if (lastSwapTime > 0.0) {
+		addSample(current.frameTime, (float)((swapTime - lastSwapTime) * 1000.0));
+	}
+	lastSwapTime = swapTime;
+}
+
+void FramePacer::report() const {
+	for (int i = 0; i < MODE_COUNT; ++i) {
+		const Stats& s = stats[i];
+		if (s.swapLatency.empty()) {
+			continue;
+		}
+
+		auto summary = [](std::vector<float> samples, float& avg, float& p99) {
+			avg = 0.0f;
+			p99 = 0.0f;
+			if (samples.empty()) {
+				return;
+			}
+			for (float v : samples) {
+				avg += v;
+			}
+			avg /= samples.size();
+			std::sort(samples.begin(), samples.end());
+			p99 = samples[(samples.size() - 1) * 99 / 100];
+		};
+
+		float swapAvg, swapP99, presentAvg, presentP99, frameAvg, frameP99;
+		summary(s.swapLatency, swapAvg, swapP99);
+		summary(s.presentLatency, presentAvg, presentP99);
+		summary(s.frameTime, frameAvg, frameP99);
+
+		std::cout << "FRAMEPACER::" << modeName((Mode)i)
+			<< " frames " << s.swapLatency.size()
+			<< " | input->swap avg " << swapAvg << " ms p99 " << swapP99
+			<< " | input->gpu done avg " << presentAvg << " ms p99 " << presentP99
+			<< " | frame avg " << frameAvg << " ms p99 " << frameP99 << std::endl;
+	}
+}
+
+void FramePacer::calibrateGpuClock() {
+	GLint64 gpuTime = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+	gpuClockOffset = glfwGetTime() - gpuTime * 1e-9;
+}
+
+void FramePacer::retireFrames(bool block) {
+	while (!pending.empty()) {
+		PendingFrame& frame = pending.front();
+
+		if (block && pending.size() >= maxFramesInFlight) {
+			// too many frames queued, wait for the oldest one
+			GLenum result;
+			do {
+				result = glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+			} while (result == GL_TIMEOUT_EXPIRED);
+		}
+		else {
+			int available = 0;
+			glGetQueryObjectiv(frame.query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available) {
+				break;
+			}
+		}
+
+		GLuint64 gpuDone = 0;
+		glGetQueryObjectui64v(frame.query, GL_QUERY_RESULT, &gpuDone);
+		double doneTime = gpuDone * 1e-9 + gpuClockOffset;
+
+		addSample(stats[frame.mode].presentLatency, (float)((doneTime - frame.inputTime) * 1000.0));
+		lastPresentTime = std::max(lastPresentTime, doneTime);
+
+		// rise instantly on a slow frame, decay slowly after it
+		double cost = doneTime - frame.wakeTime;
+		if (cost > predictedFrameCost) {
+			predictedFrameCost = cost;
+		}
+		else {
+			predictedFrameCost = predictedFrameCost * 0.95 + cost * 0.05;
+		}
+
+		glDeleteSync(frame.fence);
+		freeQueries.push_back(frame.query);
+		pending.erase(pending.begin());
+	}
+}
+
+void FramePacer::addSample(std::vector<float>& samples, float value) {
+	if (samples.size() >= MAX_SAMPLES) {
+		samples.erase(samples.begin(), samples.begin() + MAX_SAMPLES / 4);
+	}
+	samples.push_back(value);
+}
+
+void FramePacer::sleepUntil(double time) {
+	// OS sleeps overshoot by a millisecond or more, spin for the tail
+	while (time - glfwGetTime() > 0.002) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	while (glfwGetTime() < time) {
+		std::this_thread::yield();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// binding point of the Camera uniform block, std140 { mat4 view; mat4 projection; }
+const unsigned int CAMERA_UBO_BINDING = 0;
+
+// Paces the render loop so input is sampled as close to the present as possible.
+// Frames in flight are limited with fences, the start of each frame is delayed
+// until (next present - predicted frame cost), and the camera matrices are
+// written into a UBO right before the draw calls that use them.
+class FramePacer {
+public:
+	enum Mode {
+		MODE_VSYNC,      // plain swap, the driver decides how far ahead we run
+		MODE_FENCED,     // cap the number of frames queued on the GPU
+		MODE_LATE_START, // fenced + sleep so the frame starts as late as possible
+		MODE_COUNT
+	};
+
+	FramePacer(Mode mode = MODE_LATE_START, unsigned int maxFramesInFlight = 1);
+	~FramePacer();
+
+	void setMode(Mode mode);
+	void nextMode();
+	Mode getMode() const { return mode; }
+	static const char* modeName(Mode mode);
+
+	// wait for a free frame slot and, in late start mode, sleep until the start point
+	void beginFrame();
+	// timestamp of the input sample the camera of this frame is built from
+	void markInput();
+	// write view/projection into the Camera UBO, call right before the draws
+	void latchCamera(const glm::mat4& view, const glm::mat4& projection);
+	// swap buffers and record present timing of this frame
+	void endFrame(GLFWwindow* window);
+
+	// print latency stats for every mode that has been measured
+	void report() const;
+
+private:
+	struct PendingFrame {
+		GLsync fence;
+		unsigned int query; // GL_TIMESTAMP written after the last draw
+		double wakeTime;
+		double inputTime;
+		Mode mode; // the frame is counted under the mode it was submitted in
+	};
+
+	struct Stats {
+		std::vector<float> swapLatency;    // input sample -> swap returned (ms)
+		std::vector<float> presentLatency; // input sample -> GPU finished the frame (ms)
+		std::vector<float> frameTime;      // swap -> swap (ms)
+	};
+
+	Mode mode;
+	unsigned int maxFramesInFlight;
+	unsigned int cameraUBO;
+
+	std::vector<PendingFrame> pending; // oldest first, a handful at most
+	std::vector<unsigned int> freeQueries;
+	Stats stats[MODE_COUNT];
+
+	double refreshInterval;
+	double gpuClockOffset; // cpu time - gpu time, both in seconds
+	double wakeTime;
+	double inputTime;
+	double lastSwapTime;
+	double lastPresentTime;
+	double predictedFrameCost; // wake up -> GPU done, tracks recent peaks
+	unsigned int frameCount;
+
+	void calibrateGpuClock();
+	void retireFrames(bool block);
+	void addSample(std::vector<float>& samples, float value);
+	static void sleepUntil(double time);
+};
\ No newline at end of file
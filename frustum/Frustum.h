@@ -0,0 +1,45 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// View frustum culling shared by the renderers that skip what the camera can't see.
+// Planes point inwards: a point is inside when dot(normal, p) + w >= 0 for all six.
+
+// frustum planes straight from the matrix rows, normalized so distances are in world units
+inline void frustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]) {
+	const glm::mat4& m = viewProjection;
+	glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+	glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+	glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+	glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+	planes[0] = row3 + row0;
+	planes[1] = row3 - row0;
+	planes[2] = row3 + row1;
+	planes[3] = row3 - row1;
+	planes[4] = row3 + row2;
+	planes[5] = row3 - row2;
+	for (int i = 0; i < 6; ++i) {
+		planes[i] = planes[i] * (1.0f / glm::length(glm::vec3(planes[i])));
+	}
+}
+
+inline bool boxVisible(const glm::vec4 planes[6], const glm::vec3& min, const glm::vec3& max) {
+	// only the corner furthest along the plane normal has to be checked
+	for (int i = 0; i < 6; ++i) {
+		glm::vec3 corner(planes[i].x >= 0.0f ? max.x : min.x, planes[i].y >= 0.0f ? max.y : min.y,
+			planes[i].z >= 0.0f ? max.z : min.z);
+		if (glm::dot(glm::vec3(planes[i]), corner) + planes[i].w < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+inline bool sphereVisible(const glm::vec4 planes[6], const glm::vec3& center, float radius) {
+	for (int i = 0; i < 6; ++i) {
+		if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius) {
+			return false;
+		}
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include "GeometryHeap.h"
+
+#include <algorithm>
+#include <iostream>
+
+const unsigned int VERTEX_SIZE = GeometryHeap::VERTEX_FLOATS * sizeof(float);
+
+GeometryHeap::GeometryHeap(unsigned int vertexCapacity, unsigned int indexCapacity)
+	: VAO(0), VBO(0), EBO(0), vertexAllocator(vertexCapacity), indexAllocator(indexCapacity),
+	vaoBinds(0), drawCalls(0), frames(0), defragmentations(0) {
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCapacity * VERTEX_SIZE, NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)indexCapacity * sizeof(unsigned int), NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	setupVertexArray();
+}
+
+GeometryHeap::~GeometryHeap() {
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+}
+
+unsigned int GeometryHeap::addMesh(const float* vertices, unsigned int vertexCount,
+	const unsigned int* indices, unsigned int indexCount) {
+	Mesh mesh;
+	mesh.vertexCount = vertexCount;
+	mesh.indexCount = indices ? indexCount : 0;
+	mesh.baseVertex = 0;
+	mesh.firstIndex = 0;
+	mesh.alive = true;
+
+	if (!allocateRanges(mesh)) {
+		// enough space in total but scattered: pack the live meshes first
+		bool fitsAfterCompaction = vertexAllocator.getFree() >= mesh.vertexCount
+			&& indexAllocator.getFree() >= mesh.indexCount;
+		if (fitsAfterCompaction) {
+			defragment();
+		}
+		if (!allocateRanges(mesh)) {
+			// still no room, double the buffers. growing keeps the old offsets, so the
+			// free space added at the end has to hold the whole mesh on its own
+			unsigned int vertexCapacity = std::max(vertexAllocator.getSize() * 2,
+				vertexAllocator.getSize() + mesh.vertexCount);
+			unsigned int indexCapacity = std::max(indexAllocator.getSize() * 2,
+				indexAllocator.getSize() + mesh.indexCount);
+			reallocate(vertexCapacity, indexCapacity, false);
+			if (!allocateRanges(mesh)) {
+				std::cout << "ERROR::GEOMETRYHEAP::OUT_OF_SPACE " << mesh.vertexCount << " vertices, "
+					<< mesh.indexCount << " indices" << std::endl;
+				return INVALID_MESH;
+			}
+		}
+	}
+
+	// upload through the copy target so the VAO bindings stay untouched
+	glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)mesh.baseVertex * VERTEX_SIZE,
+		(GLsizeiptr)vertexCount * VERTEX_SIZE, vertices);
+	if (mesh.indexCount > 0) {
+		glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)mesh.firstIndex * sizeof(unsigned int),
+			(GLsizeiptr)indexCount * sizeof(unsigned int), indices);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	unsigned int id;
+	if (freeIds.empty()) {
+		id = (unsigned int)meshes.size();
+		meshes.push_back(mesh);
+	}
+	else {
+		id = freeIds.back();
+		freeIds.pop_back();
+		meshes[id] = mesh;
+	}
+	return id;
+}
+
+void GeometryHeap::removeMesh(unsigned int id) {
+	Mesh& mesh = meshes[id];
+	if (!mesh.alive) {
+		return;
+	}
+
+	vertexAllocator.free(mesh.baseVertex);
+	if (mesh.indexCount > 0) {
+		indexAllocator.free(mesh.firstIndex);
+	}
+	mesh.alive = false;
+	freeIds.push_back(id);
+}
+
+void GeometryHeap::bind() {
+	glBindVertexArray(VAO);
+	++vaoBinds;
+}
+
+void GeometryHeap::draw(unsigned int id, GLenum mode) {
+	const Mesh& mesh = meshes[id];
+	if (mesh.indexCount > 0) {
+		glDrawElementsBaseVertex(mode, mesh.indexCount, GL_UNSIGNED_INT,
+			(void*)((size_t)mesh.firstIndex * sizeof(unsigned int)), mesh.baseVertex);
+	}
+	else {
+		glDrawArrays(mode, mesh.baseVertex, mesh.vertexCount);
+	}
+	++drawCalls;
+}
+
+void GeometryHeap::drawInstanced(unsigned int id, unsigned int instances, GLenum mode) {
+	const Mesh& mesh = meshes[id];
+	if (mesh.indexCount > 0) {
+		glDrawElementsInstancedBaseVertex(mode, mesh.indexCount, GL_UNSIGNED_INT,
+			(void*)((size_t)mesh.firstIndex * sizeof(unsigned int)), instances, mesh.baseVertex);
+	}
+	else {
+		glDrawArraysInstanced(mode, mesh.baseVertex, mesh.vertexCount, instances);
+	}
+	++drawCalls;
+}
+
+void GeometryHeap::defragment() {
+	reallocate(vertexAllocator.getSize(), indexAllocator.getSize(), true);
+	++defragmentations;
+}
+
+void GeometryHeap::printStats() const {
+	double perFrame = frames > 0 ? 1.0 / frames : 0.0;
+	std::cout << "GEOMETRYHEAP::meshes " << (meshes.size() - freeIds.size())
+		<< " | vertices " << vertexAllocator.getUsed() << "/" << vertexAllocator.getSize()
+		<< " fragmentation " << vertexAllocator.fragmentation()
+		<< " (" << vertexAllocator.getFreeBlockCount() << " free blocks)"
+		<< " | indices " << indexAllocator.getUsed() << "/" << indexAllocator.getSize()
+		<< " fragmentation " << indexAllocator.fragmentation()
+		<< " | VAO binds/frame " << vaoBinds * perFrame
+		<< " draws/frame " << drawCalls * perFrame
+		<< " | defragmentations " << defragmentations << std::endl;
+}
+
+void GeometryHeap::setupVertexArray() {
+	glBindVertexArray(VAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+	// position attribute
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_SIZE, (void*)0);
+	glEnableVertexAttribArray(0);
+	// texture attribute
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, VERTEX_SIZE, (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GeometryHeap::reallocate(unsigned int vertexCapacity, unsigned int indexCapacity, bool compact) {
+	unsigned int newVBO, newEBO;
+	glGenBuffers(1, &newVBO);
+	glGenBuffers(1, &newEBO);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newVBO);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)vertexCapacity * VERTEX_SIZE, NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newEBO);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)indexCapacity * sizeof(unsigned int), NULL, GL_STATIC_DRAW);
+
+	if (compact) {
+		vertexAllocator.reset(vertexCapacity);
+		indexAllocator.reset(indexCapacity);
+	}
+	else {
+		vertexAllocator.grow(vertexCapacity);
+		indexAllocator.grow(indexCapacity);
+	}
+
+	// copy every live mesh on the GPU, no round trip through client memory
+	for (Mesh& mesh : meshes) {
+		if (!mesh.alive) {
+			continue;
+		}
+
+		Mesh moved = mesh;
+		if (compact) {
+			allocateRanges(moved);
+		}
+
+		glBindBuffer(GL_COPY_READ_BUFFER, VBO);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, newVBO);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+			(GLintptr)mesh.baseVertex * VERTEX_SIZE, (GLintptr)moved.baseVertex * VERTEX_SIZE,
+			(GLsizeiptr)mesh.vertexCount * VERTEX_SIZE);
+
+		if (mesh.indexCount > 0) {
+			glBindBuffer(GL_COPY_READ_BUFFER, EBO);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, newEBO);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+				(GLintptr)mesh.firstIndex * sizeof(unsigned int), (GLintptr)moved.firstIndex * sizeof(unsigned int),
+				(GLsizeiptr)mesh.indexCount * sizeof(unsigned int));
+		}
+
+		mesh = moved;
+	}
+
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	VBO = newVBO;
+	EBO = newEBO;
+
+	setupVertexArray();
+}
+
+bool GeometryHeap::allocateRanges(Mesh& mesh) {
+	unsigned int baseVertex = vertexAllocator.allocate(mesh.vertexCount);
+	if (baseVertex == OffsetAllocator::INVALID_OFFSET) {
+		return false;
+	}
+
+	unsigned int firstIndex = 0;
+	if (mesh.indexCount > 0) {
+		firstIndex = indexAllocator.allocate(mesh.indexCount);
+		if (firstIndex == OffsetAllocator::INVALID_OFFSET) {
+			vertexAllocator.free(baseVertex);
+			return false;
+		}
+	}
+
+	mesh.baseVertex = baseVertex;
+	mesh.firstIndex = firstIndex;
+	return true;
+}
\ No newline at end of file
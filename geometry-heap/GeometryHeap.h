@@ -0,0 +1,69 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <vector>
+
+#include "OffsetAllocator.h"
+
+// range of the shared buffers a mesh lives in
+struct Mesh {
+	unsigned int baseVertex;
+	unsigned int vertexCount;
+	unsigned int firstIndex;
+	unsigned int indexCount; // 0 = not indexed, drawn with glDrawArrays
+	bool alive;
+};
+
+// Every mesh lives in one big vertex buffer and one big index buffer behind a
+// single VAO, so switching meshes is just a different baseVertex/firstIndex.
+// vertex format: position (3 floats) + texture coords (2 floats)
+class GeometryHeap {
+public:
+	static const unsigned int VERTEX_FLOATS = 5;
+	static const unsigned int INVALID_MESH = 0xffffffff;
+
+	GeometryHeap(unsigned int vertexCapacity, unsigned int indexCapacity);
+	~GeometryHeap();
+
+	// indices are local to the mesh, returns the mesh id or INVALID_MESH when the buffers cannot grow
+	unsigned int addMesh(const float* vertices, unsigned int vertexCount,
+		const unsigned int* indices = NULL, unsigned int indexCount = 0);
+	void removeMesh(unsigned int id);
+	const Mesh& getMesh(unsigned int id) const { return meshes[id]; }
+
+	// bind the shared VAO, once per pass instead of once per mesh
+	void bind();
+	void draw(unsigned int id, GLenum mode = GL_TRIANGLES);
+	void drawInstanced(unsigned int id, unsigned int instances, GLenum mode = GL_TRIANGLES);
+
+	// move every live mesh to the front of the buffers
+	void defragment();
+
+	unsigned int getVAO() const { return VAO; }
+	unsigned int getVBO() const { return VBO; }
+	unsigned int getEBO() const { return EBO; }
+	const OffsetAllocator& getVertexAllocator() const { return vertexAllocator; }
+	const OffsetAllocator& getIndexAllocator() const { return indexAllocator; }
+
+	// frame counter for the per frame bind/draw averages
+	void endFrame() { ++frames; }
+	void printStats() const;
+
+private:
+	unsigned int VAO, VBO, EBO;
+	OffsetAllocator vertexAllocator;
+	OffsetAllocator indexAllocator;
+	std::vector<Mesh> meshes;
+	std::vector<unsigned int> freeIds;
+
+	unsigned long long vaoBinds;
+	unsigned long long drawCalls;
+	unsigned long long frames;
+	unsigned int defragmentations;
+
+	void setupVertexArray();
+	// move the data into new buffers, either at the same offsets or packed
+	void reallocate(unsigned int vertexCapacity, unsigned int indexCapacity, bool compact);
+	bool allocateRanges(Mesh& mesh);
+};
\ No newline at end of file
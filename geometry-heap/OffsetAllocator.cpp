@@ -0,0 +1,123 @@
+#include "OffsetAllocator.h"
+
+#include <iterator>
+
+OffsetAllocator::OffsetAllocator(unsigned int size) : size(0), used(0) {
+	reset(size);
+}
+
+unsigned int OffsetAllocator::allocate(unsigned int count) {
+	if (count == 0) {
+		return INVALID_OFFSET;
+	}
+
+	// smallest free range that still fits
+	auto fit = freeBySize.lower_bound(count);
+	if (fit == freeBySize.end()) {
+		return INVALID_OFFSET;
+	}
+
+	unsigned int offset = fit->second;
+	unsigned int blockSize = fit->first;
+	eraseFree(freeByOffset.find(offset));
+
+	// give the tail back
+	if (blockSize > count) {
+		insertFree(offset + count, blockSize - count);
+	}
+
+	allocated[offset] = count;
+	used += count;
+	return offset;
+}
+
+void OffsetAllocator::free(unsigned int offset) {
+	auto it = allocated.find(offset);
+	if (it == allocated.end()) {
+		return;
+	}
+
+	unsigned int count = it->second;
+	allocated.erase(it);
+	used -= count;
+
+	// merge with the free neighbour after this range
+	auto next = freeByOffset.find(offset + count);
+	if (next != freeByOffset.end()) {
+		count += next->second;
+		eraseFree(next);
+	}
+
+	// and with the one before it
+	auto prev = freeByOffset.lower_bound(offset);
+	if (prev != freeByOffset.begin()) {
+		--prev;
+		if (prev->first + prev->second == offset) {
+			offset = prev->first;
+			count += prev->second;
+			eraseFree(prev);
+		}
+	}
+
+	insertFree(offset, count);
+}
+
+void OffsetAllocator::reset(unsigned int newSize) {
+	freeByOffset.clear();
+	freeBySize.clear();
+	allocated.clear();
+	size = newSize;
+	used = 0;
+	if (size > 0) {
+		insertFree(0, size);
+	}
+}
+
+void OffsetAllocator::grow(unsigned int newSize) {
+	if (newSize <= size) {
+		return;
+	}
+
+	unsigned int offset = size;
+	unsigned int count = newSize - size;
+	size = newSize;
+
+	// extend the last free range if it touches the old end
+	if (!freeByOffset.empty()) {
+		auto last = std::prev(freeByOffset.end());
+		if (last->first + last->second == offset) {
+			offset = last->first;
+			count += last->second;
+			eraseFree(last);
+		}
+	}
+	insertFree(offset, count);
+}
+
+unsigned int OffsetAllocator::largestFreeBlock() const {
+	return freeBySize.empty() ? 0 : std::prev(freeBySize.end())->first;
+}
+
+float OffsetAllocator::fragmentation() const {
+	unsigned int freeSpace = getFree();
+	if (freeSpace == 0) {
+		return 0.0f;
+	}
+	return 1.0f - (float)largestFreeBlock() / (float)freeSpace;
+}
+
+void OffsetAllocator::insertFree(unsigned int offset, unsigned int count) {
+	freeByOffset[offset] = count;
+	freeBySize.insert(std::make_pair(count, offset));
+}
+
+void OffsetAllocator::eraseFree(std::map<unsigned int, unsigned int>::iterator it) {
+	auto range = freeBySize.equal_range(it->second);
+	for (auto bySize = range.first; bySize != range.second; ++bySize) {
+		if (bySize->second == it->first) {
+			freeBySize.erase(bySize);
+			break;
+		}
+	}
+	freeByOffset.erase(it);
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <map>
+#include <unordered_map>
+
+// Best-fit range allocator over [0, size). It only hands out offsets, the memory
+// itself lives somewhere else (a GL buffer). Free ranges are coalesced on free.
+class OffsetAllocator {
+public:
+	static const unsigned int INVALID_OFFSET = 0xffffffff;
+
+	OffsetAllocator(unsigned int size = 0);
+
+	// returns INVALID_OFFSET when no free range is big enough
+	unsigned int allocate(unsigned int size);
+	void free(unsigned int offset);
+
+	// drop every allocation and start over with a new size
+	void reset(unsigned int size);
+	// append free space at the end
+	void grow(unsigned int newSize);
+
+	unsigned int getSize() const { return size; }
+	unsigned int getUsed() const { return used; }
+	unsigned int getFree() const { return size - used; }
+	unsigned int getAllocationCount() const { return (unsigned int)allocated.size(); }
+	unsigned int getFreeBlockCount() const { return (unsigned int)freeByOffset.size(); }
+	unsigned int largestFreeBlock() const;
+	// 0 = all free space is one block, close to 1 = free space is scattered
+	float fragmentation() const;
+
+private:
+	unsigned int size;
+	unsigned int used;
+
+	std::map<unsigned int, unsigned int> freeByOffset;     // offset -> size
+	std::multimap<unsigned int, unsigned int> freeBySize;  // size -> offset
+	std::unordered_map<unsigned int, unsigned int> allocated; // offset -> size
+
+	void insertFree(unsigned int offset, unsigned int size);
+	void eraseFree(std::map<unsigned int, unsigned int>::iterator it);
+};
\ No newline at end of file
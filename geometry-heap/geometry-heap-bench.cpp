@@ -0,0 +1,83 @@
+// allocator churn benchmark for the geometry heap, runs without a GL context
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "OffsetAllocator.h"
+
+int main() {
+	// 16M vertices, meshes between 24 and 64k vertices, keep ~70% occupancy
+	const unsigned int CAPACITY = 16 * 1024 * 1024;
+	const unsigned int OPERATIONS = 1000000;
+	const float TARGET_OCCUPANCY = 0.7f;
+
+	OffsetAllocator allocator(CAPACITY);
+	std::vector<unsigned int> live;
+	std::vector<unsigned int> liveSizes;
+
+	std::mt19937 rng(1234);
+	// mostly small meshes, a few big ones
+	std::lognormal_distribution<float> meshSize(7.0f, 1.5f);
+
+	unsigned int failed = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (unsigned int op = 1; op <= OPERATIONS; ++op) {
+		float occupancy = (float)allocator.getUsed() / CAPACITY;
+		// lean towards allocating below the target so occupancy settles around it
+		bool doAllocate = live.empty() || (occupancy < TARGET_OCCUPANCY && rng() % 4 != 0);
+
+		if (doAllocate) {
+			unsigned int size = std::min(65536u, 24u + (unsigned int)meshSize(rng));
+			unsigned int offset = allocator.allocate(size);
+			if (offset == OffsetAllocator::INVALID_OFFSET) {
+				++failed;
+			}
+			else {
+				live.push_back(offset);
+				liveSizes.push_back(size);
+			}
+		}
+		else {
+			// free a random live mesh
+			unsigned int i = rng() % live.size();
+			allocator.free(live[i]);
+			live[i] = live.back();
+			live.pop_back();
+			liveSizes[i] = liveSizes.back();
+			liveSizes.pop_back();
+		}
+
+		if (op % 100000 == 0) {
+			std::cout << "ops " << op
+				<< " | live meshes " << allocator.getAllocationCount()
+				<< " | occupancy " << (float)allocator.getUsed() / CAPACITY
+				<< " | free blocks " << allocator.getFreeBlockCount()
+				<< " | largest free " << allocator.largestFreeBlock()
+				<< " | fragmentation " << allocator.fragmentation()
+				<< " | failed allocations " << failed << std::endl;
+		}
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+	std::cout << "churn: " << OPERATIONS / seconds / 1e6 << " M ops/s" << std::endl;
+
+	// what GeometryHeap::defragment does to the allocator
+	start = std::chrono::high_resolution_clock::now();
+	allocator.reset(CAPACITY);
+	for (unsigned int size : liveSizes) {
+		allocator.allocate(size);
+	}
+	end = std::chrono::high_resolution_clock::now();
+
+	std::cout << "after defragment: free blocks " << allocator.getFreeBlockCount()
+		<< " | fragmentation " << allocator.fragmentation()
+		<< " | repack " << std::chrono::duration<double, std::milli>(end - start).count()
+		<< " ms for " << liveSizes.size() << " meshes" << std::endl;
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,836 @@
+#include "GLTrace.h"
+#include "TraceFormat.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+	const unsigned int MAX_TEXTURE_UNITS = 32;
+	// per ring slot, a lesson frame is a few KB
+	const size_t FRAME_RESERVE = 16 * 1024;
+
+	// texture and buffer targets the shadow state follows
+	enum TextureSlot { SLOT_2D, SLOT_2D_ARRAY, SLOT_3D, SLOT_CUBE, SLOT_BUFFER, TEXTURE_SLOTS };
+	enum BufferSlot {
+		SLOT_ARRAY, SLOT_ELEMENT, SLOT_COPY_READ, SLOT_COPY_WRITE, SLOT_UNIFORM, SLOT_TEXTURE,
+		SLOT_PIXEL_PACK, SLOT_PIXEL_UNPACK, SLOT_OTHER, BUFFER_SLOTS
+	};
+
+	// what has to be bound before a setup call recorded mid frame replays correctly
+	enum PreludeKind { PRELUDE_NONE, PRELUDE_TEXTURE, PRELUDE_BUFFER, PRELUDE_COPY, PRELUDE_VAO,
+		PRELUDE_VAO_ARRAY, PRELUDE_FRAMEBUFFER, PRELUDE_RENDERBUFFER };
+
+	struct Prelude {
+		PreludeKind kind;
+		GLenum target;
+		GLenum target2;
+	};
+
+	const Prelude NO_PRELUDE = { PRELUDE_NONE, 0, 0 };
+
+	// client memory a pointer argument refers to
+	struct Blob {
+		const void* data;
+		uint32_t size;
+	};
+
+	struct TraceState {
+		bool installed = false;
+		bool started = false;
+		bool capturing = true;
+
+		std::vector<unsigned char> setup;
+		std::vector<std::vector<unsigned char>> ring;
+		unsigned int head = 0;   // frame being recorded
+		unsigned int filled = 0; // finished frames in the ring
+		std::vector<unsigned char> record; // call being recorded
+
+		// bindings as the application sees them
+		unsigned int activeUnit = 0;
+		GLuint textures[MAX_TEXTURE_UNITS][TEXTURE_SLOTS] = {};
+		GLuint buffers[BUFFER_SLOTS] = {};
+		GLuint vertexArray = 0;
+		GLuint drawFramebuffer = 0;
+		GLuint readFramebuffer = 0;
+		GLuint renderbuffer = 0;
+		GLint unpackAlignment = 4;
+		// storage size per buffer, to tell orphaning from a new allocation
+		std::unordered_map<GLuint, int64_t> bufferSizes;
+		// (program << 32) | location already in the setup log, lookups repeat every frame
+		std::unordered_set<uint64_t> knownLocations;
+		std::unordered_set<uint64_t> knownBlocks;
+
+		unsigned long long ringCalls = 0;
+		unsigned long long ringBytes = 0;
+		unsigned long long capturedFrames = 0;
+
+		std::chrono::high_resolution_clock::time_point frameStart;
+		double frameTime[2] = { 0.0, 0.0 }; // ms, [capture off, capture on]
+		unsigned long long timedFrames[2] = { 0, 0 };
+	};
+
+	TraceState trace;
+
+	TextureSlot textureSlot(GLenum target) {
+		switch (target) {
+		case GL_TEXTURE_2D_ARRAY: return SLOT_2D_ARRAY;
+		case GL_TEXTURE_3D: return SLOT_3D;
+		case GL_TEXTURE_CUBE_MAP: return SLOT_CUBE;
+		case GL_TEXTURE_BUFFER: return SLOT_BUFFER;
+		default: return SLOT_2D;
+		}
+	}
+
+	BufferSlot bufferSlot(GLenum target) {
+		switch (target) {
+		case GL_ARRAY_BUFFER: return SLOT_ARRAY;
+		case GL_ELEMENT_ARRAY_BUFFER: return SLOT_ELEMENT;
+		case GL_COPY_READ_BUFFER: return SLOT_COPY_READ;
+		case GL_COPY_WRITE_BUFFER: return SLOT_COPY_WRITE;
+		case GL_UNIFORM_BUFFER: return SLOT_UNIFORM;
+		case GL_TEXTURE_BUFFER: return SLOT_TEXTURE;
+		case GL_PIXEL_PACK_BUFFER: return SLOT_PIXEL_PACK;
+		case GL_PIXEL_UNPACK_BUFFER: return SLOT_PIXEL_UNPACK;
+		default: return SLOT_OTHER;
+		}
+	}
+
+	// bytes glTexImage2D reads from client memory
+	uint32_t imageSize(GLsizei width, GLsizei height, GLenum format, GLenum type) {
+		unsigned int channels;
+		switch (format) {
+		case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX: channels = 1; break;
+		case GL_RG: case GL_RG_INTEGER: case GL_DEPTH_STENCIL: channels = 2; break;
+		case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: channels = 3; break;
+		default: channels = 4; break;
+		}
+
+		unsigned int pixel;
+		switch (type) {
+		case GL_UNSIGNED_BYTE: case GL_BYTE: pixel = channels; break;
+		case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: pixel = channels * 2; break;
+		case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: pixel = channels * 4; break;
+		case GL_FLOAT_32_UNSIGNED_INT_24_8_REV: pixel = 8; break;
+		case GL_UNSIGNED_SHORT_5_6_5: case GL_UNSIGNED_SHORT_4_4_4_4: case GL_UNSIGNED_SHORT_5_5_5_1: pixel = 2; break;
+		default: pixel = 4; break; // packed 32 bit formats
+		}
+
+		if (width <= 0 || height <= 0) {
+			return 0;
+		}
+		uint32_t alignment = (uint32_t)trace.unpackAlignment;
+		uint32_t row = width * pixel;
+		uint32_t stride = (row + alignment - 1) / alignment * alignment;
+		return stride * (height - 1) + row;
+	}
+
+	template <typename T>
+	void putArg(TraceWriter& writer, const T& value) {
+		writer.put(value);
+	}
+
+	void putArg(TraceWriter& writer, const Blob& blob) {
+		writer.putBlob(blob.data, blob.data ? blob.size : 0);
+	}
+
+	template <typename... Args>
+	void write(std::vector<unsigned char>& out, TraceOp op, const Args&... args) {
+		TraceWriter writer(out);
+		writer.put((uint16_t)op);
+		(putArg(writer, args), ...);
+	}
+
+	void writePrelude(const Prelude& prelude) {
+		std::vector<unsigned char>& out = trace.setup;
+		switch (prelude.kind) {
+		case PRELUDE_TEXTURE:
+			write(out, OP_ActiveTexture, (GLenum)(GL_TEXTURE0 + trace.activeUnit));
+			write(out, OP_PixelStorei, (GLenum)GL_UNPACK_ALIGNMENT, trace.unpackAlignment);
+			write(out, OP_BindBuffer, (GLenum)GL_PIXEL_UNPACK_BUFFER, trace.buffers[SLOT_PIXEL_UNPACK]);
+			write(out, OP_BindTexture, prelude.target, trace.textures[trace.activeUnit][textureSlot(prelude.target)]);
+			break;
+		case PRELUDE_BUFFER:
+			if (prelude.target == GL_ELEMENT_ARRAY_BUFFER) {
+				write(out, OP_BindVertexArray, trace.vertexArray);
+			}
+			write(out, OP_BindBuffer, prelude.target, trace.buffers[bufferSlot(prelude.target)]);
+			break;
+		case PRELUDE_COPY:
+			write(out, OP_BindBuffer, prelude.target, trace.buffers[bufferSlot(prelude.target)]);
+			write(out, OP_BindBuffer, prelude.target2, trace.buffers[bufferSlot(prelude.target2)]);
+			break;
+		case PRELUDE_VAO_ARRAY:
+			write(out, OP_BindVertexArray, trace.vertexArray);
+			write(out, OP_BindBuffer, (GLenum)GL_ARRAY_BUFFER, trace.buffers[SLOT_ARRAY]);
+			break;
+		case PRELUDE_VAO:
+			write(out, OP_BindVertexArray, trace.vertexArray);
+			break;
+		case PRELUDE_FRAMEBUFFER:
+			write(out, OP_BindFramebuffer, prelude.target,
+				prelude.target == GL_READ_FRAMEBUFFER ? trace.readFramebuffer : trace.drawFramebuffer);
+			break;
+		case PRELUDE_RENDERBUFFER:
+			write(out, OP_BindRenderbuffer, (GLenum)GL_RENDERBUFFER, trace.renderbuffer);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// the call in trace.record goes to the setup log and/or the open ring frame
+	void commit(bool setupCall, const Prelude& prelude) {
+		if (!trace.started) {
+			trace.setup.insert(trace.setup.end(), trace.record.begin(), trace.record.end());
+			return;
+		}
+		if (setupCall) {
+			writePrelude(prelude);
+			trace.setup.insert(trace.setup.end(), trace.record.begin(), trace.record.end());
+		}
+		if (trace.capturing) {
+			std::vector<unsigned char>& frame = trace.ring[trace.head];
+			frame.insert(frame.end(), trace.record.begin(), trace.record.end());
+			++trace.ringCalls;
+		}
+	}
+
+	template <typename... Args>
+	void recordFrame(TraceOp op, const Args&... args) {
+		trace.record.clear();
+		write(trace.record, op, args...);
+		commit(false, NO_PRELUDE);
+	}
+
+	// creates or fills an object: kept in the setup log for the whole run
+	template <typename... Args>
+	void recordSetup(const Prelude& prelude, TraceOp op, const Args&... args) {
+		trace.record.clear();
+		write(trace.record, op, args...);
+		commit(true, prelude);
+	}
+
+	// pixel data or an offset into the bound unpack buffer
+	void writePixels(TraceWriter& writer, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels) {
+		if (trace.buffers[SLOT_PIXEL_UNPACK] != 0) {
+			writer.put((uint8_t)1).put((uint64_t)(uintptr_t)pixels);
+		}
+		else {
+			writer.put((uint8_t)0).putBlob(pixels, pixels ? imageSize(width, height, format, type) : 0);
+		}
+	}
+}
+
+// driver entry points the wrappers forward to
+#define GLTRACE_REAL(name) static decltype(glad_gl##name) real_gl##name = NULL;
+GLTRACE_OPS(GLTRACE_REAL)
+#undef GLTRACE_REAL
+
+// objects
+
+#define GLTRACE_GEN(name) \
+	static void APIENTRY trace_gl##name(GLsizei n, GLuint* names) { \
+		real_gl##name(n, names); \
+		recordSetup(NO_PRELUDE, OP_##name, n, Blob{ names, (uint32_t)(n * sizeof(GLuint)) }); \
+	}
+#define GLTRACE_DELETE(name) \
+	static void APIENTRY trace_gl##name(GLsizei n, const GLuint* names) { \
+		real_gl##name(n, names); \
+		recordFrame(OP_##name, n, Blob{ names, (uint32_t)(n * sizeof(GLuint)) }); \
+	}
+GLTRACE_GEN(GenTextures) GLTRACE_GEN(GenVertexArrays)
+GLTRACE_GEN(GenFramebuffers) GLTRACE_GEN(GenRenderbuffers) GLTRACE_GEN(GenQueries)
+GLTRACE_DELETE(DeleteBuffers) GLTRACE_DELETE(DeleteTextures) GLTRACE_DELETE(DeleteVertexArrays)
+GLTRACE_DELETE(DeleteFramebuffers) GLTRACE_DELETE(DeleteRenderbuffers) GLTRACE_DELETE(DeleteQueries)
+#undef GLTRACE_GEN
+#undef GLTRACE_DELETE
+
+static void APIENTRY trace_glGenBuffers(GLsizei n, GLuint* names) {
+	real_glGenBuffers(n, names);
+	// a reused name starts without storage
+	for (GLsizei i = 0; i < n; ++i) {
+		trace.bufferSizes.erase(names[i]);
+	}
+	recordSetup(NO_PRELUDE, OP_GenBuffers, n, Blob{ names, (uint32_t)(n * sizeof(GLuint)) });
+}
+
+// shaders
+
+static GLuint APIENTRY trace_glCreateShader(GLenum type) {
+	GLuint shader = real_glCreateShader(type);
+	recordSetup(NO_PRELUDE, OP_CreateShader, type, shader);
+	return shader;
+}
+
+static void APIENTRY trace_glShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths) {
+	real_glShaderSource(shader, count, strings, lengths);
+	trace.record.clear();
+	TraceWriter writer(trace.record);
+	writer.put((uint16_t)OP_ShaderSource).put(shader).put(count);
+	for (GLsizei i = 0; i < count; ++i) {
+		uint32_t length = lengths && lengths[i] >= 0 ? (uint32_t)lengths[i] : (uint32_t)std::strlen(strings[i]);
+		writer.putBlob(strings[i], length);
+	}
+	commit(true, NO_PRELUDE);
+}
+
+static void APIENTRY trace_glCompileShader(GLuint shader) {
+	real_glCompileShader(shader);
+	recordSetup(NO_PRELUDE, OP_CompileShader, shader);
+}
+
+static void APIENTRY trace_glDeleteShader(GLuint shader) {
+	real_glDeleteShader(shader);
+	recordFrame(OP_DeleteShader, shader);
+}
+
+static GLuint APIENTRY trace_glCreateProgram() {
+	GLuint program = real_glCreateProgram();
+	// a reused name has none of the old program's locations
+	for (std::unordered_set<uint64_t>* known : { &trace.knownLocations, &trace.knownBlocks }) {
+		for (auto it = known->begin(); it != known->end();) {
+			it = (*it >> 32) == program ? known->erase(it) : std::next(it);
+		}
+	}
+	recordSetup(NO_PRELUDE, OP_CreateProgram, program);
+	return program;
+}
+
+static void APIENTRY trace_glAttachShader(GLuint program, GLuint shader) {
+	real_glAttachShader(program, shader);
+	recordSetup(NO_PRELUDE, OP_AttachShader, program, shader);
+}
+
+static void APIENTRY trace_glLinkProgram(GLuint program) {
+	real_glLinkProgram(program);
+	recordSetup(NO_PRELUDE, OP_LinkProgram, program);
+}
+
+static void APIENTRY trace_glDeleteProgram(GLuint program) {
+	real_glDeleteProgram(program);
+	recordFrame(OP_DeleteProgram, program);
+}
+
+static GLint APIENTRY trace_glGetUniformLocation(GLuint program, const GLchar* name) {
+	GLint location = real_glGetUniformLocation(program, name);
+	Blob uniform = { name, (uint32_t)std::strlen(name) + 1 };
+	if (location >= 0 && trace.knownLocations.insert(((uint64_t)program << 32) | (uint32_t)location).second) {
+		recordSetup(NO_PRELUDE, OP_GetUniformLocation, program, uniform, location);
+	}
+	else {
+		recordFrame(OP_GetUniformLocation, program, uniform, location);
+	}
+	return location;
+}
+
+static GLuint APIENTRY trace_glGetUniformBlockIndex(GLuint program, const GLchar* name) {
+	GLuint index = real_glGetUniformBlockIndex(program, name);
+	Blob block = { name, (uint32_t)std::strlen(name) + 1 };
+	if (index != GL_INVALID_INDEX && trace.knownBlocks.insert(((uint64_t)program << 32) | index).second) {
+		recordSetup(NO_PRELUDE, OP_GetUniformBlockIndex, program, block, index);
+	}
+	else {
+		recordFrame(OP_GetUniformBlockIndex, program, block, index);
+	}
+	return index;
+}
+
+static void APIENTRY trace_glUniformBlockBinding(GLuint program, GLuint index, GLuint binding) {
+	real_glUniformBlockBinding(program, index, binding);
+	recordSetup(NO_PRELUDE, OP_UniformBlockBinding, program, index, binding);
+}
+
+// buffers and textures
+
+static void APIENTRY trace_glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+	real_glBufferData(target, size, data, usage);
+	// orphaning a buffer every frame would grow the setup log forever, the replay
+	// already has storage of that size
+	GLuint buffer = trace.buffers[bufferSlot(target)];
+	auto it = trace.bufferSizes.find(buffer);
+	if (trace.started && data == NULL && it != trace.bufferSizes.end() && it->second == (int64_t)size) {
+		recordFrame(OP_BufferData, target, (int64_t)size, Blob{ data, (uint32_t)size }, usage);
+		return;
+	}
+	trace.bufferSizes[buffer] = (int64_t)size;
+	recordSetup(Prelude{ PRELUDE_BUFFER, target, 0 }, OP_BufferData, target, (int64_t)size,
+		Blob{ data, (uint32_t)size }, usage);
+}
+
+static void APIENTRY trace_glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+	real_glBufferSubData(target, offset, size, data);
+	recordFrame(OP_BufferSubData, target, (int64_t)offset, (int64_t)size, Blob{ data, (uint32_t)size });
+}
+
+static void APIENTRY trace_glCopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset,
+	GLintptr writeOffset, GLsizeiptr size) {
+	real_glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+	recordSetup(Prelude{ PRELUDE_COPY, readTarget, writeTarget }, OP_CopyBufferSubData, readTarget, writeTarget,
+		(int64_t)readOffset, (int64_t)writeOffset, (int64_t)size);
+}
+
+static void APIENTRY trace_glTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+	GLint border, GLenum format, GLenum type, const void* pixels) {
+	real_glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+	trace.record.clear();
+	TraceWriter writer(trace.record);
+	writer.put((uint16_t)OP_TexImage2D).put(target).put(level).put(internalFormat).put(width).put(height)
+		.put(border).put(format).put(type);
+	writePixels(writer, width, height, format, type, pixels);
+	commit(true, Prelude{ PRELUDE_TEXTURE, target, 0 });
+}
+
+static void APIENTRY trace_glTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+	GLenum format, GLenum type, const void* pixels) {
+	real_glTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+	trace.record.clear();
+	TraceWriter writer(trace.record);
+	writer.put((uint16_t)OP_TexSubImage2D).put(target).put(level).put(x).put(y).put(width).put(height)
+		.put(format).put(type);
+	writePixels(writer, width, height, format, type, pixels);
+	commit(false, NO_PRELUDE);
+}
+
+static void APIENTRY trace_glTexParameteri(GLenum target, GLenum pname, GLint param) {
+	real_glTexParameteri(target, pname, param);
+	recordSetup(Prelude{ PRELUDE_TEXTURE, target, 0 }, OP_TexParameteri, target, pname, param);
+}
+
+static void APIENTRY trace_glTexParameterf(GLenum target, GLenum pname, GLfloat param) {
+	real_glTexParameterf(target, pname, param);
+	recordSetup(Prelude{ PRELUDE_TEXTURE, target, 0 }, OP_TexParameterf, target, pname, param);
+}
+
+static void APIENTRY trace_glGenerateMipmap(GLenum target) {
+	real_glGenerateMipmap(target);
+	recordSetup(Prelude{ PRELUDE_TEXTURE, target, 0 }, OP_GenerateMipmap, target);
+}
+
+static void APIENTRY trace_glTexBuffer(GLenum target, GLenum internalFormat, GLuint buffer) {
+	real_glTexBuffer(target, internalFormat, buffer);
+	recordSetup(Prelude{ PRELUDE_TEXTURE, target, 0 }, OP_TexBuffer, target, internalFormat, buffer);
+}
+
+static void APIENTRY trace_glPixelStorei(GLenum pname, GLint param) {
+	real_glPixelStorei(pname, param);
+	if (pname == GL_UNPACK_ALIGNMENT) {
+		trace.unpackAlignment = param;
+	}
+	recordFrame(OP_PixelStorei, pname, param);
+}
+
+// vertex arrays
+
+static void APIENTRY trace_glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized,
+	GLsizei stride, const void* pointer) {
+	real_glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+	recordSetup(Prelude{ PRELUDE_VAO_ARRAY, 0, 0 }, OP_VertexAttribPointer, index, size, type, normalized, stride,
+		(uint64_t)(uintptr_t)pointer);
+}
+
+static void APIENTRY trace_glVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) {
+	real_glVertexAttribIPointer(index, size, type, stride, pointer);
+	recordSetup(Prelude{ PRELUDE_VAO_ARRAY, 0, 0 }, OP_VertexAttribIPointer, index, size, type, stride,
+		(uint64_t)(uintptr_t)pointer);
+}
+
+static void APIENTRY trace_glEnableVertexAttribArray(GLuint index) {
+	real_glEnableVertexAttribArray(index);
+	recordSetup(Prelude{ PRELUDE_VAO, 0, 0 }, OP_EnableVertexAttribArray, index);
+}
+
+static void APIENTRY trace_glDisableVertexAttribArray(GLuint index) {
+	real_glDisableVertexAttribArray(index);
+	recordSetup(Prelude{ PRELUDE_VAO, 0, 0 }, OP_DisableVertexAttribArray, index);
+}
+
+static void APIENTRY trace_glVertexAttribDivisor(GLuint index, GLuint divisor) {
+	real_glVertexAttribDivisor(index, divisor);
+	recordSetup(Prelude{ PRELUDE_VAO, 0, 0 }, OP_VertexAttribDivisor, index, divisor);
+}
+
+// framebuffers
+
+static void APIENTRY trace_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget,
+	GLuint texture, GLint level) {
+	real_glFramebufferTexture2D(target, attachment, textureTarget, texture, level);
+	recordSetup(Prelude{ PRELUDE_FRAMEBUFFER, target, 0 }, OP_FramebufferTexture2D, target, attachment,
+		textureTarget, texture, level);
+}
+
+static void APIENTRY trace_glFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget,
+	GLuint renderbuffer) {
+	real_glFramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer);
+	recordSetup(Prelude{ PRELUDE_FRAMEBUFFER, target, 0 }, OP_FramebufferRenderbuffer, target, attachment,
+		renderbufferTarget, renderbuffer);
+}
+
+static void APIENTRY trace_glRenderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height) {
+	real_glRenderbufferStorage(target, internalFormat, width, height);
+	recordSetup(Prelude{ PRELUDE_RENDERBUFFER, target, 0 }, OP_RenderbufferStorage, target, internalFormat,
+		width, height);
+}
+
+// state
+
+static void APIENTRY trace_glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+	real_glViewport(x, y, width, height);
+	recordFrame(OP_Viewport, x, y, width, height);
+}
+
+static void APIENTRY trace_glClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+	real_glClearColor(r, g, b, a);
+	recordFrame(OP_ClearColor, r, g, b, a);
+}
+
+static void APIENTRY trace_glClear(GLbitfield mask) {
+	real_glClear(mask);
+	recordFrame(OP_Clear, mask);
+}
+
+static void APIENTRY trace_glEnable(GLenum cap) {
+	real_glEnable(cap);
+	recordFrame(OP_Enable, cap);
+}
+
+static void APIENTRY trace_glDisable(GLenum cap) {
+	real_glDisable(cap);
+	recordFrame(OP_Disable, cap);
+}
+
+static void APIENTRY trace_glPolygonMode(GLenum face, GLenum mode) {
+	real_glPolygonMode(face, mode);
+	recordFrame(OP_PolygonMode, face, mode);
+}
+
+static void APIENTRY trace_glBlendFunc(GLenum source, GLenum destination) {
+	real_glBlendFunc(source, destination);
+	recordFrame(OP_BlendFunc, source, destination);
+}
+
+static void APIENTRY trace_glDepthMask(GLboolean flag) {
+	real_glDepthMask(flag);
+	recordFrame(OP_DepthMask, flag);
+}
+
+static void APIENTRY trace_glDepthFunc(GLenum func) {
+	real_glDepthFunc(func);
+	recordFrame(OP_DepthFunc, func);
+}
+
+static void APIENTRY trace_glCullFace(GLenum mode) {
+	real_glCullFace(mode);
+	recordFrame(OP_CullFace, mode);
+}
+
+// bindings, mirrored in the shadow state
+
+static void APIENTRY trace_glActiveTexture(GLenum unit) {
+	real_glActiveTexture(unit);
+	unsigned int index = unit - GL_TEXTURE0;
+	trace.activeUnit = index < MAX_TEXTURE_UNITS ? index : 0;
+	recordFrame(OP_ActiveTexture, unit);
+}
+
+static void APIENTRY trace_glBindTexture(GLenum target, GLuint texture) {
+	real_glBindTexture(target, texture);
+	trace.textures[trace.activeUnit][textureSlot(target)] = texture;
+	recordFrame(OP_BindTexture, target, texture);
+}
+
+static void APIENTRY trace_glBindBuffer(GLenum target, GLuint buffer) {
+	real_glBindBuffer(target, buffer);
+	trace.buffers[bufferSlot(target)] = buffer;
+	if (target == GL_ELEMENT_ARRAY_BUFFER && trace.vertexArray != 0) {
+		// part of the vertex array state
+		recordSetup(Prelude{ PRELUDE_VAO, 0, 0 }, OP_BindBuffer, target, buffer);
+	}
+	else {
+		recordFrame(OP_BindBuffer, target, buffer);
+	}
+}
+
+static void APIENTRY trace_glBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+	real_glBindBufferBase(target, index, buffer);
+	trace.buffers[bufferSlot(target)] = buffer;
+	recordFrame(OP_BindBufferBase, target, index, buffer);
+}
+
+static void APIENTRY trace_glBindVertexArray(GLuint vertexArray) {
+	real_glBindVertexArray(vertexArray);
+	trace.vertexArray = vertexArray;
+	recordFrame(OP_BindVertexArray, vertexArray);
+}
+
+static void APIENTRY trace_glBindFramebuffer(GLenum target, GLuint framebuffer) {
+	real_glBindFramebuffer(target, framebuffer);
+	if (target != GL_READ_FRAMEBUFFER) {
+		trace.drawFramebuffer = framebuffer;
+	}
+	if (target != GL_DRAW_FRAMEBUFFER) {
+		trace.readFramebuffer = framebuffer;
+	}
+	recordFrame(OP_BindFramebuffer, target, framebuffer);
+}
+
+static void APIENTRY trace_glBindRenderbuffer(GLenum target, GLuint renderbuffer) {
+	real_glBindRenderbuffer(target, renderbuffer);
+	trace.renderbuffer = renderbuffer;
+	recordFrame(OP_BindRenderbuffer, target, renderbuffer);
+}
+
+static void APIENTRY trace_glUseProgram(GLuint program) {
+	real_glUseProgram(program);
+	recordFrame(OP_UseProgram, program);
+}
+
+// uniforms
+
+static void APIENTRY trace_glUniform1i(GLint location, GLint v0) {
+	real_glUniform1i(location, v0);
+	recordFrame(OP_Uniform1i, location, v0);
+}
+
+static void APIENTRY trace_glUniform1f(GLint location, GLfloat v0) {
+	real_glUniform1f(location, v0);
+	recordFrame(OP_Uniform1f, location, v0);
+}
+
+static void APIENTRY trace_glUniform2f(GLint location, GLfloat v0, GLfloat v1) {
+	real_glUniform2f(location, v0, v1);
+	recordFrame(OP_Uniform2f, location, v0, v1);
+}
+
+static void APIENTRY trace_glUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
+	real_glUniform3f(location, v0, v1, v2);
+	recordFrame(OP_Uniform3f, location, v0, v1, v2);
+}
+
+static void APIENTRY trace_glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) {
+	real_glUniform4f(location, v0, v1, v2, v3);
+	recordFrame(OP_Uniform4f, location, v0, v1, v2, v3);
+}
+
+static void APIENTRY trace_glUniform3fv(GLint location, GLsizei count, const GLfloat* value) {
+	real_glUniform3fv(location, count, value);
+	recordFrame(OP_Uniform3fv, location, count, Blob{ value, (uint32_t)(count * 3 * sizeof(GLfloat)) });
+}
+
+static void APIENTRY trace_glUniform4fv(GLint location, GLsizei count, const GLfloat* value) {
+	real_glUniform4fv(location, count, value);
+	recordFrame(OP_Uniform4fv, location, count, Blob{ value, (uint32_t)(count * 4 * sizeof(GLfloat)) });
+}
+
+static void APIENTRY trace_glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+	real_glUniformMatrix4fv(location, count, transpose, value);
+	recordFrame(OP_UniformMatrix4fv, location, count, transpose, Blob{ value, (uint32_t)(count * 16 * sizeof(GLfloat)) });
+}
+
+// draws
+
+static void APIENTRY trace_glDrawArrays(GLenum mode, GLint first, GLsizei count) {
+	real_glDrawArrays(mode, first, count);
+	recordFrame(OP_DrawArrays, mode, first, count);
+}
+
+static void APIENTRY trace_glDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+	real_glDrawElements(mode, count, type, indices);
+	recordFrame(OP_DrawElements, mode, count, type, (uint64_t)(uintptr_t)indices);
+}
+
+static void APIENTRY trace_glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) {
+	real_glDrawArraysInstanced(mode, first, count, instances);
+	recordFrame(OP_DrawArraysInstanced, mode, first, count, instances);
+}
+
+static void APIENTRY trace_glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices,
+	GLsizei instances) {
+	real_glDrawElementsInstanced(mode, count, type, indices, instances);
+	recordFrame(OP_DrawElementsInstanced, mode, count, type, (uint64_t)(uintptr_t)indices, instances);
+}
+
+static void APIENTRY trace_glDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices,
+	GLint baseVertex) {
+	real_glDrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+	recordFrame(OP_DrawElementsBaseVertex, mode, count, type, (uint64_t)(uintptr_t)indices, baseVertex);
+}
+
+static void APIENTRY trace_glDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type,
+	const void* indices, GLsizei instances, GLint baseVertex) {
+	real_glDrawElementsInstancedBaseVertex(mode, count, type, indices, instances, baseVertex);
+	recordFrame(OP_DrawElementsInstancedBaseVertex, mode, count, type, (uint64_t)(uintptr_t)indices, instances, baseVertex);
+}
+
+// synchronization
+
+static void APIENTRY trace_glFlush() {
+	real_glFlush();
+	recordFrame(OP_Flush);
+}
+
+static void APIENTRY trace_glFinish() {
+	real_glFinish();
+	recordFrame(OP_Finish);
+}
+
+static GLsync APIENTRY trace_glFenceSync(GLenum condition, GLbitfield flags) {
+	GLsync sync = real_glFenceSync(condition, flags);
+	recordFrame(OP_FenceSync, condition, flags, (uint64_t)(uintptr_t)sync);
+	return sync;
+}
+
+static GLenum APIENTRY trace_glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
+	GLenum result = real_glClientWaitSync(sync, flags, timeout);
+	recordFrame(OP_ClientWaitSync, (uint64_t)(uintptr_t)sync, flags, timeout);
+	return result;
+}
+
+static void APIENTRY trace_glDeleteSync(GLsync sync) {
+	real_glDeleteSync(sync);
+	recordFrame(OP_DeleteSync, (uint64_t)(uintptr_t)sync);
+}
+
+static void APIENTRY trace_glQueryCounter(GLuint query, GLenum target) {
+	real_glQueryCounter(query, target);
+	recordFrame(OP_QueryCounter, query, target);
+}
+
+static void APIENTRY trace_glBeginQuery(GLenum target, GLuint query) {
+	real_glBeginQuery(target, query);
+	recordFrame(OP_BeginQuery, target, query);
+}
+
+static void APIENTRY trace_glEndQuery(GLenum target) {
+	real_glEndQuery(target);
+	recordFrame(OP_EndQuery, target);
+}
+
+void GLTrace::install(unsigned int ringFrames) {
+	if (trace.installed) {
+		return;
+	}
+	trace.installed = true;
+	// one extra slot for the frame being recorded
+	trace.ring.resize(ringFrames + 1);
+	// reserved up front so recording a frame does not allocate
+	for (std::vector<unsigned char>& frame : trace.ring) {
+		frame.reserve(FRAME_RESERVE);
+	}
+
+#define GLTRACE_HOOK(name) real_gl##name = glad_gl##name; glad_gl##name = trace_gl##name;
+	GLTRACE_OPS(GLTRACE_HOOK)
+#undef GLTRACE_HOOK
+}
+
+bool GLTrace::isInstalled() {
+	return trace.installed;
+}
+
+void GLTrace::setCapturing(bool capturing) {
+	if (capturing == trace.capturing) {
+		return;
+	}
+	trace.capturing = capturing;
+	if (capturing) {
+		// frames before the pause are no longer contiguous with the new ones
+		trace.filled = 0;
+		trace.ring[trace.head].clear();
+	}
+	std::cout << "GLTRACE::CAPTURE " << (capturing ? "on" : "off") << std::endl;
+}
+
+bool GLTrace::isCapturing() {
+	return trace.capturing;
+}
+
+void GLTrace::beginFrame() {
+	trace.started = true;
+	trace.frameStart = std::chrono::high_resolution_clock::now();
+}
+
+void GLTrace::endFrame() {
+	int bucket = trace.capturing ? 1 : 0;
+	trace.frameTime[bucket] += std::chrono::duration<double, std::milli>(
+		std::chrono::high_resolution_clock::now() - trace.frameStart).count();
+	++trace.timedFrames[bucket];
+
+	if (!trace.capturing || !trace.installed) {
+		return;
+	}
+	trace.ringBytes += trace.ring[trace.head].size();
+	++trace.capturedFrames;
+
+	unsigned int count = (unsigned int)trace.ring.size();
+	size_t lastBytes = trace.ring[trace.head].size();
+	trace.head = (trace.head + 1) % count;
+	trace.ring[trace.head].clear();
+	// grow in one step when frames got bigger than the reserve
+	trace.ring[trace.head].reserve(lastBytes);
+	if (trace.filled < count - 1) {
+		++trace.filled;
+	}
+}
+
+bool GLTrace::save(const char* path) {
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		std::cout << "ERROR::GLTRACE::SAVE_FAILED " << path << std::endl;
+		return false;
+	}
+
+	uint64_t setupSize = trace.setup.size();
+	uint32_t frameCount = trace.filled;
+	file.write("GLTR", 4);
+	file.write((const char*)&TRACE_VERSION, sizeof(TRACE_VERSION));
+	file.write((const char*)&setupSize, sizeof(setupSize));
+	file.write((const char*)trace.setup.data(), setupSize);
+	file.write((const char*)&frameCount, sizeof(frameCount));
+
+	// finished frames only, oldest first
+	unsigned int count = (unsigned int)trace.ring.size();
+	for (unsigned int i = frameCount; i > 0; --i) {
+		const std::vector<unsigned char>& frame = trace.ring[(trace.head + count - i) % count];
+		uint64_t size = frame.size();
+		file.write((const char*)&size, sizeof(size));
+		file.write((const char*)frame.data(), size);
+	}
+
+	std::cout << "GLTRACE::SAVED " << path << " (" << frameCount << " frames, "
+		<< (file.tellp() / (1024.0 * 1024.0)) << " MB)" << std::endl;
+	return (bool)file;
+}
+
+size_t GLTrace::getSetupBytes() {
+	return trace.setup.size();
+}
+
+size_t GLTrace::getRingBytes() {
+	size_t bytes = 0;
+	for (const std::vector<unsigned char>& frame : trace.ring) {
+		bytes += frame.size();
+	}
+	return bytes;
+}
+
+void GLTrace::printStats() {
+	double perFrame = trace.capturedFrames > 0 ? 1.0 / trace.capturedFrames : 0.0;
+	std::cout << "GLTRACE::setup " << trace.setup.size() / (1024.0 * 1024.0) << " MB"
+		<< " | ring " << trace.filled << "/" << trace.ring.size() << " frames, "
+		<< getRingBytes() / 1024.0 << " KB"
+		<< " | calls/frame " << trace.ringCalls * perFrame
+		<< " | bytes/frame " << trace.ringBytes * perFrame << std::endl;
+
+	for (int bucket = 1; bucket >= 0; --bucket) {
+		if (trace.timedFrames[bucket] > 0) {
+			std::cout << "GLTRACE::cpu frame time capture " << (bucket ? "on " : "off ")
+				<< trace.frameTime[bucket] / trace.timedFrames[bucket] << " ms"
+				<< " (" << trace.timedFrames[bucket] << " frames)" << std::endl;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+// Records the GL calls made through glad into a compact binary trace.
+// install() swaps the glad function pointers for recording wrappers, so no call
+// site changes. Everything before the first beginFrame() goes to the setup log,
+// and so does every later call that creates or fills an object, together with
+// the binds it depends on; the setup log is kept for the whole run. Frames go
+// into a ring holding the last N frames, which can stay on all the time.
+// save() writes setup + ring, trace-replay runs it again headless.
+// Not recorded: calls without a wrapper (getters, buffer mapping), and sub data
+// updates made during a frame are only in that frame, so they are gone once it
+// leaves the ring.
+class GLTrace {
+public:
+	// call once, right after gladLoadGLLoader
+	static void install(unsigned int ringFrames = 120);
+	static bool isInstalled();
+
+	// pause/resume the frame ring, the setup log always records
+	static void setCapturing(bool capturing);
+	static bool isCapturing();
+
+	// frame boundaries, the first beginFrame() ends the setup phase
+	static void beginFrame();
+	static void endFrame();
+
+	// setup log + the frames in the ring, oldest first
+	static bool save(const char* path);
+
+	static size_t getSetupBytes();
+	static size_t getRingBytes();
+	// calls, bytes and CPU frame time with and without capture
+	static void printStats();
+};
\ No newline at end of file
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Binary layout shared by the capture side (GLTrace) and trace-replay.
+//   file:   "GLTR" | u32 version | u64 setup size | setup records
+//           | u32 frame count | per frame: u64 size | records
+//   record: u16 opcode | arguments in call order, raw little endian
+//           | pointers to client data as u32 size + bytes
+const uint32_t TRACE_VERSION = 1;
+
+#define GLTRACE_OPS(X) \
+	X(GenBuffers) X(GenTextures) X(GenVertexArrays) X(GenFramebuffers) X(GenRenderbuffers) X(GenQueries) \
+	X(DeleteBuffers) X(DeleteTextures) X(DeleteVertexArrays) X(DeleteFramebuffers) X(DeleteRenderbuffers) \
+	X(DeleteQueries) X(CreateShader) X(ShaderSource) X(CompileShader) X(DeleteShader) X(CreateProgram) \
+	X(AttachShader) X(LinkProgram) X(DeleteProgram) X(GetUniformLocation) X(GetUniformBlockIndex) \
+	X(UniformBlockBinding) X(BufferData) X(BufferSubData) X(CopyBufferSubData) X(TexImage2D) \
+	X(TexSubImage2D) X(TexParameteri) X(TexParameterf) X(GenerateMipmap) X(TexBuffer) X(PixelStorei) \
+	X(VertexAttribPointer) X(VertexAttribIPointer) X(EnableVertexAttribArray) X(DisableVertexAttribArray) \
+	X(VertexAttribDivisor) X(FramebufferTexture2D) X(FramebufferRenderbuffer) X(RenderbufferStorage) \
+	X(Viewport) X(ClearColor) X(Clear) X(Enable) X(Disable) X(PolygonMode) X(BlendFunc) X(DepthMask) \
+	X(DepthFunc) X(CullFace) X(ActiveTexture) X(BindTexture) X(BindBuffer) X(BindBufferBase) \
+	X(BindVertexArray) X(BindFramebuffer) X(BindRenderbuffer) X(UseProgram) X(Uniform1i) X(Uniform1f) \
+	X(Uniform2f) X(Uniform3f) X(Uniform4f) X(Uniform3fv) X(Uniform4fv) X(UniformMatrix4fv) \
+	X(DrawArrays) X(DrawElements) X(DrawArraysInstanced) X(DrawElementsInstanced) X(DrawElementsBaseVertex) \
+	X(DrawElementsInstancedBaseVertex) X(Flush) X(Finish) X(FenceSync) X(ClientWaitSync) X(DeleteSync) \
+	X(QueryCounter) X(BeginQuery) X(EndQuery)
+
+enum TraceOp : uint16_t {
+#define GLTRACE_ENUM(name) OP_##name,
+	GLTRACE_OPS(GLTRACE_ENUM)
+#undef GLTRACE_ENUM
+	OP_COUNT
+};
+
+inline const char* traceOpName(uint16_t op) {
+	static const char* names[] = {
+#define GLTRACE_NAME(name) "gl" #name,
+		GLTRACE_OPS(GLTRACE_NAME)
+#undef GLTRACE_NAME
+	};
+	return op < OP_COUNT ? names[op] : "unknown";
+}
+
+// kinds of GL object names, each gets its own capture -> replay name table
+enum TraceNameKind {
+	NAME_BUFFER,
+	NAME_TEXTURE,
+	NAME_VERTEX_ARRAY,
+	NAME_FRAMEBUFFER,
+	NAME_RENDERBUFFER,
+	NAME_QUERY,
+	NAME_SHADER,
+	NAME_PROGRAM,
+	NAME_SYNC,
+	NAME_UNIFORM,       // (program << 32) | location
+	NAME_UNIFORM_BLOCK, // (program << 32) | block index
+	NAME_KIND_COUNT
+};
+
+// appends to a byte vector, reusing its capacity
+class TraceWriter {
+public:
+	TraceWriter(std::vector<unsigned char>& out) : out(out) {}
+
+	template <typename T>
+	TraceWriter& put(const T& value) {
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+		out.insert(out.end(), bytes, bytes + sizeof(T));
+		return *this;
+	}
+
+	TraceWriter& putBlob(const void* data, uint32_t size) {
+		put(size);
+		if (size > 0) {
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			out.insert(out.end(), bytes, bytes + size);
+		}
+		return *this;
+	}
+
+	TraceWriter& putString(const char* text) {
+		return putBlob(text, text ? (uint32_t)std::strlen(text) + 1 : 0);
+	}
+
+private:
+	std::vector<unsigned char>& out;
+};
+
+// reads records back, failed() turns true on a truncated or corrupt stream
+class TraceReader {
+public:
+	TraceReader(const unsigned char* data, size_t size) : at(data), end(data + size), error(false) {}
+
+	bool atEnd() const { return at >= end || error; }
+	bool failed() const { return error; }
+	// a record that does not make sense, stops the reading like a truncation
+	void fail() { error = true; }
+
+	template <typename T>
+	T get() {
+		T value = T();
+		if (at + sizeof(T) > end) {
+			error = true;
+			return value;
+		}
+		std::memcpy(&value, at, sizeof(T));
+		at += sizeof(T);
+		return value;
+	}
+
+	// NULL for an empty blob
+	const void* getBlob(uint32_t& size) {
+		size = get<uint32_t>();
+		if (at + size > end) {
+			error = true;
+			size = 0;
+		}
+		const void* data = size > 0 ? at : NULL;
+		at += size;
+		return data;
+	}
+
+	const char* getString() {
+		uint32_t size;
+		return static_cast<const char*>(getBlob(size));
+	}
+
+private:
+	const unsigned char* at;
+	const unsigned char* end;
+	bool error;
+};
\ No newline at end of file
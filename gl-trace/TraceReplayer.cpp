@@ -0,0 +1,642 @@
+#include "TraceReplayer.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+TraceReplayer::TraceReplayer() : currentProgram(0), unmappedNames(0) {
+	resetCallStats();
+}
+
+bool TraceReplayer::load(const char* path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		std::cout << "ERROR::TRACEREPLAYER::FILE_NOT_SUCCESSFULLY_READ " << path << std::endl;
+		return false;
+	}
+
+	char magic[4];
+	uint32_t version = 0;
+	uint64_t setupSize = 0;
+	file.read(magic, 4);
+	file.read((char*)&version, sizeof(version));
+	if (!file || std::memcmp(magic, "GLTR", 4) != 0 || version != TRACE_VERSION) {
+		std::cout << "ERROR::TRACEREPLAYER::NOT_A_TRACE " << path << std::endl;
+		return false;
+	}
+
+	file.read((char*)&setupSize, sizeof(setupSize));
+	setup.resize(setupSize);
+	file.read((char*)setup.data(), setupSize);
+
+	uint32_t frameCount = 0;
+	file.read((char*)&frameCount, sizeof(frameCount));
+	frames.resize(frameCount);
+	for (std::vector<unsigned char>& frame : frames) {
+		uint64_t size = 0;
+		file.read((char*)&size, sizeof(size));
+		frame.resize(size);
+		file.read((char*)frame.data(), size);
+	}
+
+	if (!file) {
+		std::cout << "ERROR::TRACEREPLAYER::TRUNCATED " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool TraceReplayer::replaySetup() {
+	return execute(setup, false, false);
+}
+
+bool TraceReplayer::replayFrame(unsigned int index, bool finishEachCall) {
+	return execute(frames[index], true, finishEachCall);
+}
+
+void TraceReplayer::resetCallStats() {
+	for (CallStats& call : stats) {
+		call.calls = 0;
+		call.cpuMs = 0.0;
+	}
+}
+
+bool TraceReplayer::execute(const std::vector<unsigned char>& records, bool timed, bool finishEachCall) {
+	TraceReader reader(records.data(), records.size());
+	while (!reader.atEnd()) {
+		uint16_t op = reader.get<uint16_t>();
+		if (op >= OP_COUNT) {
+			std::cout << "ERROR::TRACEREPLAYER::UNKNOWN_OPCODE " << op << std::endl;
+			return false;
+		}
+
+		if (!timed) {
+			executeCall(op, reader);
+			continue;
+		}
+
+		auto start = std::chrono::high_resolution_clock::now();
+		executeCall(op, reader);
+		if (finishEachCall) {
+			glFinish();
+		}
+		stats[op].cpuMs += std::chrono::duration<double, std::milli>(
+			std::chrono::high_resolution_clock::now() - start).count();
+		++stats[op].calls;
+	}
+
+	if (reader.failed()) {
+		std::cout << "ERROR::TRACEREPLAYER::BAD_RECORD" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void TraceReplayer::mapNames(TraceNameKind kind, GLsizei n, const GLuint* captured, const GLuint* replayed) {
+	for (GLsizei i = 0; i < n; ++i) {
+		names[kind][captured[i]] = replayed[i];
+	}
+}
+
+uint64_t TraceReplayer::lookup(TraceNameKind kind, uint64_t captured) {
+	if (captured == 0) {
+		return 0;
+	}
+	auto it = names[kind].find(captured);
+	if (it == names[kind].end()) {
+		++unmappedNames;
+		return 0;
+	}
+	return it->second;
+}
+
+GLint TraceReplayer::location(GLint captured) {
+	if (captured < 0) {
+		return -1;
+	}
+	auto it = names[NAME_UNIFORM].find(((uint64_t)currentProgram << 32) | (uint32_t)captured);
+	return it != names[NAME_UNIFORM].end() ? (GLint)it->second : -1;
+}
+
+// a name list blob holds exactly n names, anything else is a corrupt trace
+static bool namesMatch(GLsizei n, uint32_t size) {
+	if (n < 0 || size != (uint64_t)n * sizeof(GLuint)) {
+		std::cout << "ERROR::TRACEREPLAYER::BAD_NAME_LIST " << n << " names in " << size << " bytes" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void TraceReplayer::executeCall(uint16_t op, TraceReader& r) {
+	// arguments are read one statement at a time, the order has to match the capture
+	switch (op) {
+	case OP_GenBuffers: case OP_GenTextures: case OP_GenVertexArrays:
+	case OP_GenFramebuffers: case OP_GenRenderbuffers: case OP_GenQueries: {
+		GLsizei n = r.get<GLsizei>();
+		uint32_t size;
+		const void* data = r.getBlob(size);
+		if (!namesMatch(n, size)) {
+			r.fail();
+			break;
+		}
+		std::vector<GLuint> captured(n), replayed(n);
+		if (data) {
+			std::memcpy(captured.data(), data, n * sizeof(GLuint));
+		}
+		TraceNameKind kind;
+		switch (op) {
+		case OP_GenBuffers: glGenBuffers(n, replayed.data()); kind = NAME_BUFFER; break;
+		case OP_GenTextures: glGenTextures(n, replayed.data()); kind = NAME_TEXTURE; break;
+		case OP_GenVertexArrays: glGenVertexArrays(n, replayed.data()); kind = NAME_VERTEX_ARRAY; break;
+		case OP_GenFramebuffers: glGenFramebuffers(n, replayed.data()); kind = NAME_FRAMEBUFFER; break;
+		case OP_GenRenderbuffers: glGenRenderbuffers(n, replayed.data()); kind = NAME_RENDERBUFFER; break;
+		default: glGenQueries(n, replayed.data()); kind = NAME_QUERY; break;
+		}
+		mapNames(kind, n, captured.data(), replayed.data());
+		break;
+	}
+	case OP_DeleteBuffers: case OP_DeleteTextures: case OP_DeleteVertexArrays:
+	case OP_DeleteFramebuffers: case OP_DeleteRenderbuffers: case OP_DeleteQueries: {
+		GLsizei n = r.get<GLsizei>();
+		uint32_t size;
+		const void* data = r.getBlob(size);
+		if (!namesMatch(n, size)) {
+			r.fail();
+			break;
+		}
+		std::vector<GLuint> captured(n), replayed(n);
+		if (data) {
+			std::memcpy(captured.data(), data, n * sizeof(GLuint));
+		}
+		TraceNameKind kind = op == OP_DeleteBuffers ? NAME_BUFFER
+			: op == OP_DeleteTextures ? NAME_TEXTURE
+			: op == OP_DeleteVertexArrays ? NAME_VERTEX_ARRAY
+			: op == OP_DeleteFramebuffers ? NAME_FRAMEBUFFER
+			: op == OP_DeleteRenderbuffers ? NAME_RENDERBUFFER : NAME_QUERY;
+		for (GLsizei i = 0; i < n; ++i) {
+			replayed[i] = name(kind, captured[i]);
+			names[kind].erase(captured[i]);
+		}
+		switch (op) {
+		case OP_DeleteBuffers: glDeleteBuffers(n, replayed.data()); break;
+		case OP_DeleteTextures: glDeleteTextures(n, replayed.data()); break;
+		case OP_DeleteVertexArrays: glDeleteVertexArrays(n, replayed.data()); break;
+		case OP_DeleteFramebuffers: glDeleteFramebuffers(n, replayed.data()); break;
+		case OP_DeleteRenderbuffers: glDeleteRenderbuffers(n, replayed.data()); break;
+		default: glDeleteQueries(n, replayed.data()); break;
+		}
+		break;
+	}
+
+	case OP_CreateShader: {
+		GLenum type = r.get<GLenum>();
+		GLuint captured = r.get<GLuint>();
+		names[NAME_SHADER][captured] = glCreateShader(type);
+		break;
+	}
+	case OP_ShaderSource: {
+		GLuint shader = name(NAME_SHADER, r.get<GLuint>());
+		GLsizei count = r.get<GLsizei>();
+		std::vector<const GLchar*> strings(count);
+		std::vector<GLint> lengths(count);
+		for (GLsizei i = 0; i < count; ++i) {
+			uint32_t size;
+			strings[i] = static_cast<const GLchar*>(r.getBlob(size));
+			lengths[i] = (GLint)size;
+		}
+		glShaderSource(shader, count, strings.data(), lengths.data());
+		break;
+	}
+	case OP_CompileShader: glCompileShader(name(NAME_SHADER, r.get<GLuint>())); break;
+	case OP_DeleteShader: {
+		GLuint captured = r.get<GLuint>();
+		glDeleteShader(name(NAME_SHADER, captured));
+		names[NAME_SHADER].erase(captured);
+		break;
+	}
+	case OP_CreateProgram: {
+		GLuint captured = r.get<GLuint>();
+		names[NAME_PROGRAM][captured] = glCreateProgram();
+		break;
+	}
+	case OP_AttachShader: {
+		GLuint program = name(NAME_PROGRAM, r.get<GLuint>());
+		GLuint shader = name(NAME_SHADER, r.get<GLuint>());
+		glAttachShader(program, shader);
+		break;
+	}
+	case OP_LinkProgram: glLinkProgram(name(NAME_PROGRAM, r.get<GLuint>())); break;
+	case OP_DeleteProgram: {
+		GLuint captured = r.get<GLuint>();
+		glDeleteProgram(name(NAME_PROGRAM, captured));
+		names[NAME_PROGRAM].erase(captured);
+		break;
+	}
+	case OP_GetUniformLocation: {
+		GLuint program = r.get<GLuint>();
+		const char* uniform = r.getString();
+		GLint captured = r.get<GLint>();
+		if (uniform && captured >= 0) {
+			GLint replayed = glGetUniformLocation(name(NAME_PROGRAM, program), uniform);
+			names[NAME_UNIFORM][((uint64_t)program << 32) | (uint32_t)captured] = (uint64_t)(uint32_t)replayed;
+		}
+		break;
+	}
+	case OP_GetUniformBlockIndex: {
+		GLuint program = r.get<GLuint>();
+		const char* block = r.getString();
+		GLuint captured = r.get<GLuint>();
+		if (block && captured != GL_INVALID_INDEX) {
+			GLuint replayed = glGetUniformBlockIndex(name(NAME_PROGRAM, program), block);
+			names[NAME_UNIFORM_BLOCK][((uint64_t)program << 32) | captured] = replayed;
+		}
+		break;
+	}
+	case OP_UniformBlockBinding: {
+		GLuint program = r.get<GLuint>();
+		GLuint index = r.get<GLuint>();
+		GLuint binding = r.get<GLuint>();
+		auto it = names[NAME_UNIFORM_BLOCK].find(((uint64_t)program << 32) | index);
+		if (it != names[NAME_UNIFORM_BLOCK].end()) {
+			glUniformBlockBinding(name(NAME_PROGRAM, program), (GLuint)it->second, binding);
+		}
+		break;
+	}
+
+	case OP_BufferData: {
+		GLenum target = r.get<GLenum>();
+		int64_t size = r.get<int64_t>();
+		uint32_t dataSize;
+		const void* data = r.getBlob(dataSize);
+		GLenum usage = r.get<GLenum>();
+		glBufferData(target, (GLsizeiptr)size, data, usage);
+		break;
+	}
+	case OP_BufferSubData: {
+		GLenum target = r.get<GLenum>();
+		int64_t offset = r.get<int64_t>();
+		int64_t size = r.get<int64_t>();
+		uint32_t dataSize;
+		const void* data = r.getBlob(dataSize);
+		if (data) {
+			glBufferSubData(target, (GLintptr)offset, (GLsizeiptr)size, data);
+		}
+		break;
+	}
+	case OP_CopyBufferSubData: {
+		GLenum readTarget = r.get<GLenum>();
+		GLenum writeTarget = r.get<GLenum>();
+		int64_t readOffset = r.get<int64_t>();
+		int64_t writeOffset = r.get<int64_t>();
+		int64_t size = r.get<int64_t>();
+		glCopyBufferSubData(readTarget, writeTarget, (GLintptr)readOffset, (GLintptr)writeOffset, (GLsizeiptr)size);
+		break;
+	}
+	case OP_TexImage2D: case OP_TexSubImage2D: {
+		GLenum target = r.get<GLenum>();
+		GLint level = r.get<GLint>();
+		GLint internalFormat = 0, x = 0, y = 0, border = 0;
+		if (op == OP_TexImage2D) {
+			internalFormat = r.get<GLint>();
+		}
+		else {
+			x = r.get<GLint>();
+			y = r.get<GLint>();
+		}
+		GLsizei width = r.get<GLsizei>();
+		GLsizei height = r.get<GLsizei>();
+		if (op == OP_TexImage2D) {
+			border = r.get<GLint>();
+		}
+		GLenum format = r.get<GLenum>();
+		GLenum type = r.get<GLenum>();
+
+		// client memory or an offset into the bound unpack buffer
+		const void* pixels;
+		if (r.get<uint8_t>() != 0) {
+			pixels = (const void*)(uintptr_t)r.get<uint64_t>();
+		}
+		else {
+			uint32_t size;
+			pixels = r.getBlob(size);
+		}
+
+		if (op == OP_TexImage2D) {
+			glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+		}
+		else {
+			glTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+		}
+		break;
+	}
+	case OP_TexParameteri: {
+		GLenum target = r.get<GLenum>();
+		GLenum pname = r.get<GLenum>();
+		GLint param = r.get<GLint>();
+		glTexParameteri(target, pname, param);
+		break;
+	}
+	case OP_TexParameterf: {
+		GLenum target = r.get<GLenum>();
+		GLenum pname = r.get<GLenum>();
+		GLfloat param = r.get<GLfloat>();
+		glTexParameterf(target, pname, param);
+		break;
+	}
+	case OP_GenerateMipmap: glGenerateMipmap(r.get<GLenum>()); break;
+	case OP_TexBuffer: {
+		GLenum target = r.get<GLenum>();
+		GLenum internalFormat = r.get<GLenum>();
+		GLuint buffer = name(NAME_BUFFER, r.get<GLuint>());
+		glTexBuffer(target, internalFormat, buffer);
+		break;
+	}
+	case OP_PixelStorei: {
+		GLenum pname = r.get<GLenum>();
+		GLint param = r.get<GLint>();
+		glPixelStorei(pname, param);
+		break;
+	}
+
+	case OP_VertexAttribPointer: {
+		GLuint index = r.get<GLuint>();
+		GLint size = r.get<GLint>();
+		GLenum type = r.get<GLenum>();
+		GLboolean normalized = r.get<GLboolean>();
+		GLsizei stride = r.get<GLsizei>();
+		uint64_t offset = r.get<uint64_t>();
+		glVertexAttribPointer(index, size, type, normalized, stride, (const void*)(uintptr_t)offset);
+		break;
+	}
+	case OP_VertexAttribIPointer: {
+		GLuint index = r.get<GLuint>();
+		GLint size = r.get<GLint>();
+		GLenum type = r.get<GLenum>();
+		GLsizei stride = r.get<GLsizei>();
+		uint64_t offset = r.get<uint64_t>();
+		glVertexAttribIPointer(index, size, type, stride, (const void*)(uintptr_t)offset);
+		break;
+	}
+	case OP_EnableVertexAttribArray: glEnableVertexAttribArray(r.get<GLuint>()); break;
+	case OP_DisableVertexAttribArray: glDisableVertexAttribArray(r.get<GLuint>()); break;
+	case OP_VertexAttribDivisor: {
+		GLuint index = r.get<GLuint>();
+		GLuint divisor = r.get<GLuint>();
+		glVertexAttribDivisor(index, divisor);
+		break;
+	}
+
+	case OP_FramebufferTexture2D: {
+		GLenum target = r.get<GLenum>();
+		GLenum attachment = r.get<GLenum>();
+		GLenum textureTarget = r.get<GLenum>();
+		GLuint texture = name(NAME_TEXTURE, r.get<GLuint>());
+		GLint level = r.get<GLint>();
+		glFramebufferTexture2D(target, attachment, textureTarget, texture, level);
+		break;
+	}
+	case OP_FramebufferRenderbuffer: {
+		GLenum target = r.get<GLenum>();
+		GLenum attachment = r.get<GLenum>();
+		GLenum renderbufferTarget = r.get<GLenum>();
+		GLuint renderbuffer = name(NAME_RENDERBUFFER, r.get<GLuint>());
+		glFramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer);
+		break;
+	}
+	case OP_RenderbufferStorage: {
+		GLenum target = r.get<GLenum>();
+		GLenum internalFormat = r.get<GLenum>();
+		GLsizei width = r.get<GLsizei>();
+		GLsizei height = r.get<GLsizei>();
+		glRenderbufferStorage(target, internalFormat, width, height);
+		break;
+	}
+
+	case OP_Viewport: {
+		GLint x = r.get<GLint>();
+		GLint y = r.get<GLint>();
+		GLsizei width = r.get<GLsizei>();
+		GLsizei height = r.get<GLsizei>();
+		glViewport(x, y, width, height);
+		break;
+	}
+	case OP_ClearColor: {
+		GLfloat red = r.get<GLfloat>();
+		GLfloat green = r.get<GLfloat>();
+		GLfloat blue = r.get<GLfloat>();
+		GLfloat alpha = r.get<GLfloat>();
+		glClearColor(red, green, blue, alpha);
+		break;
+	}
+	case OP_Clear: glClear(r.get<GLbitfield>()); break;
+	case OP_Enable: glEnable(r.get<GLenum>()); break;
+	case OP_Disable: glDisable(r.get<GLenum>()); break;
+	case OP_PolygonMode: {
+		GLenum face = r.get<GLenum>();
+		GLenum mode = r.get<GLenum>();
+		glPolygonMode(face, mode);
+		break;
+	}
+	case OP_BlendFunc: {
+		GLenum source = r.get<GLenum>();
+		GLenum destination = r.get<GLenum>();
+		glBlendFunc(source, destination);
+		break;
+	}
+	case OP_DepthMask: glDepthMask(r.get<GLboolean>()); break;
+	case OP_DepthFunc: glDepthFunc(r.get<GLenum>()); break;
+	case OP_CullFace: glCullFace(r.get<GLenum>()); break;
+
+	case OP_ActiveTexture: glActiveTexture(r.get<GLenum>()); break;
+	case OP_BindTexture: {
+		GLenum target = r.get<GLenum>();
+		GLuint texture = name(NAME_TEXTURE, r.get<GLuint>());
+		glBindTexture(target, texture);
+		break;
+	}
+	case OP_BindBuffer: {
+		GLenum target = r.get<GLenum>();
+		GLuint buffer = name(NAME_BUFFER, r.get<GLuint>());
+		glBindBuffer(target, buffer);
+		break;
+	}
+	case OP_BindBufferBase: {
+		GLenum target = r.get<GLenum>();
+		GLuint index = r.get<GLuint>();
+		GLuint buffer = name(NAME_BUFFER, r.get<GLuint>());
+		glBindBufferBase(target, index, buffer);
+		break;
+	}
+	case OP_BindVertexArray: glBindVertexArray(name(NAME_VERTEX_ARRAY, r.get<GLuint>())); break;
+	case OP_BindFramebuffer: {
+		GLenum target = r.get<GLenum>();
+		GLuint framebuffer = name(NAME_FRAMEBUFFER, r.get<GLuint>());
+		glBindFramebuffer(target, framebuffer);
+		break;
+	}
+	case OP_BindRenderbuffer: {
+		GLenum target = r.get<GLenum>();
+		GLuint renderbuffer = name(NAME_RENDERBUFFER, r.get<GLuint>());
+		glBindRenderbuffer(target, renderbuffer);
+		break;
+	}
+	case OP_UseProgram:
+		currentProgram = r.get<GLuint>();
+		glUseProgram(name(NAME_PROGRAM, currentProgram));
+		break;
+
+	case OP_Uniform1i: {
+		GLint at = location(r.get<GLint>());
+		glUniform1i(at, r.get<GLint>());
+		break;
+	}
+	case OP_Uniform1f: {
+		GLint at = location(r.get<GLint>());
+		glUniform1f(at, r.get<GLfloat>());
+		break;
+	}
+	case OP_Uniform2f: {
+		GLint at = location(r.get<GLint>());
+		GLfloat v0 = r.get<GLfloat>();
+		GLfloat v1 = r.get<GLfloat>();
+		glUniform2f(at, v0, v1);
+		break;
+	}
+	case OP_Uniform3f: {
+		GLint at = location(r.get<GLint>());
+		GLfloat v0 = r.get<GLfloat>();
+		GLfloat v1 = r.get<GLfloat>();
+		GLfloat v2 = r.get<GLfloat>();
+		glUniform3f(at, v0, v1, v2);
+		break;
+	}
+	case OP_Uniform4f: {
+		GLint at = location(r.get<GLint>());
+		GLfloat v0 = r.get<GLfloat>();
+		GLfloat v1 = r.get<GLfloat>();
+		GLfloat v2 = r.get<GLfloat>();
+		GLfloat v3 = r.get<GLfloat>();
+		glUniform4f(at, v0, v1, v2, v3);
+		break;
+	}
+	case OP_Uniform3fv: case OP_Uniform4fv: {
+		GLint at = location(r.get<GLint>());
+		GLsizei count = r.get<GLsizei>();
+		uint32_t size;
+		const GLfloat* value = static_cast<const GLfloat*>(r.getBlob(size));
+		if (value && op == OP_Uniform3fv) {
+			glUniform3fv(at, count, value);
+		}
+		else if (value) {
+			glUniform4fv(at, count, value);
+		}
+		break;
+	}
+	case OP_UniformMatrix4fv: {
+		GLint at = location(r.get<GLint>());
+		GLsizei count = r.get<GLsizei>();
+		GLboolean transpose = r.get<GLboolean>();
+		uint32_t size;
+		const GLfloat* value = static_cast<const GLfloat*>(r.getBlob(size));
+		if (value) {
+			glUniformMatrix4fv(at, count, transpose, value);
+		}
+		break;
+	}
+
+	case OP_DrawArrays: {
+		GLenum mode = r.get<GLenum>();
+		GLint first = r.get<GLint>();
+		GLsizei count = r.get<GLsizei>();
+		glDrawArrays(mode, first, count);
+		break;
+	}
+	case OP_DrawElements: {
+		GLenum mode = r.get<GLenum>();
+		GLsizei count = r.get<GLsizei>();
+		GLenum type = r.get<GLenum>();
+		uint64_t offset = r.get<uint64_t>();
+		glDrawElements(mode, count, type, (const void*)(uintptr_t)offset);
+		break;
+	}
+	case OP_DrawArraysInstanced: {
+		GLenum mode = r.get<GLenum>();
+		GLint first = r.get<GLint>();
+		GLsizei count = r.get<GLsizei>();
+		GLsizei instances = r.get<GLsizei>();
+		glDrawArraysInstanced(mode, first, count, instances);
+		break;
+	}
+	case OP_DrawElementsInstanced: {
+		GLenum mode = r.get<GLenum>();
+		GLsizei count = r.get<GLsizei>();
+		GLenum type = r.get<GLenum>();
+		uint64_t offset = r.get<uint64_t>();
+		GLsizei instances = r.get<GLsizei>();
+		glDrawElementsInstanced(mode, count, type, (const void*)(uintptr_t)offset, instances);
+		break;
+	}
+	case OP_DrawElementsBaseVertex: {
+		GLenum mode = r.get<GLenum>();
+		GLsizei count = r.get<GLsizei>();
+		GLenum type = r.get<GLenum>();
+		uint64_t offset = r.get<uint64_t>();
+		GLint baseVertex = r.get<GLint>();
+		glDrawElementsBaseVertex(mode, count, type, (void*)(uintptr_t)offset, baseVertex);
+		break;
+	}
+	case OP_DrawElementsInstancedBaseVertex: {
+		GLenum mode = r.get<GLenum>();
+		GLsizei count = r.get<GLsizei>();
+		GLenum type = r.get<GLenum>();
+		uint64_t offset = r.get<uint64_t>();
+		GLsizei instances = r.get<GLsizei>();
+		GLint baseVertex = r.get<GLint>();
+		glDrawElementsInstancedBaseVertex(mode, count, type, (const void*)(uintptr_t)offset, instances, baseVertex);
+		break;
+	}
+
+	case OP_Flush: glFlush(); break;
+	case OP_Finish: glFinish(); break;
+	case OP_FenceSync: {
+		GLenum condition = r.get<GLenum>();
+		GLbitfield flags = r.get<GLbitfield>();
+		uint64_t captured = r.get<uint64_t>();
+		names[NAME_SYNC][captured] = (uint64_t)(uintptr_t)glFenceSync(condition, flags);
+		break;
+	}
+	case OP_ClientWaitSync: {
+		uint64_t captured = r.get<uint64_t>();
+		GLbitfield flags = r.get<GLbitfield>();
+		GLuint64 timeout = r.get<GLuint64>();
+		GLsync sync = (GLsync)(uintptr_t)lookup(NAME_SYNC, captured);
+		if (sync) {
+			glClientWaitSync(sync, flags, timeout);
+		}
+		break;
+	}
+	case OP_DeleteSync: {
+		uint64_t captured = r.get<uint64_t>();
+		GLsync sync = (GLsync)(uintptr_t)lookup(NAME_SYNC, captured);
+		if (sync) {
+			glDeleteSync(sync);
+			names[NAME_SYNC].erase(captured);
+		}
+		break;
+	}
+	case OP_QueryCounter: {
+		GLuint query = name(NAME_QUERY, r.get<GLuint>());
+		GLenum target = r.get<GLenum>();
+		glQueryCounter(query, target);
+		break;
+	}
+	case OP_BeginQuery: {
+		GLenum target = r.get<GLenum>();
+		GLuint query = name(NAME_QUERY, r.get<GLuint>());
+		glBeginQuery(target, query);
+		break;
+	}
+	case OP_EndQuery: glEndQuery(r.get<GLenum>()); break;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "TraceFormat.h"
+
+// Runs a trace written by GLTrace::save() against the current context.
+// Object names and uniform locations from the capture are mapped onto the
+// ones this context hands out, so the setup log has to run before any frame.
+class TraceReplayer {
+public:
+	struct CallStats {
+		unsigned long long calls;
+		double cpuMs; // submit time, includes the GPU when finishing every call
+	};
+
+	TraceReplayer();
+
+	bool load(const char* path);
+	unsigned int getFrameCount() const { return (unsigned int)frames.size(); }
+	size_t getSetupBytes() const { return setup.size(); }
+	size_t getFrameBytes(unsigned int index) const { return frames[index].size(); }
+
+	// rebuild every object, untimed
+	bool replaySetup();
+	// one captured frame, call times add up in the per opcode stats.
+	// finishEachCall puts a glFinish after every call so GPU work lands on the call that caused it
+	bool replayFrame(unsigned int index, bool finishEachCall = false);
+
+	const CallStats& getCallStats(uint16_t op) const { return stats[op]; }
+	void resetCallStats();
+	// references to objects the trace never created, e.g. from frames that left the ring
+	unsigned long long getUnmappedNames() const { return unmappedNames; }
+
+private:
+	std::vector<unsigned char> setup;
+	std::vector<std::vector<unsigned char>> frames;
+
+	std::unordered_map<uint64_t, uint64_t> names[NAME_KIND_COUNT];
+	GLuint currentProgram; // captured name, uniform locations are per program
+	CallStats stats[OP_COUNT];
+	unsigned long long unmappedNames;
+
+	bool execute(const std::vector<unsigned char>& records, bool timed, bool finishEachCall);
+	void executeCall(uint16_t op, TraceReader& reader);
+
+	void mapNames(TraceNameKind kind, GLsizei n, const GLuint* captured, const GLuint* replayed);
+	uint64_t lookup(TraceNameKind kind, uint64_t captured);
+	GLuint name(TraceNameKind kind, GLuint captured) { return (GLuint)lookup(kind, captured); }
+	GLint location(GLint captured);
+};
\ No newline at end of file
@@ -0,0 +1,128 @@
+// offline replay of a GL trace: rebuilds the captured objects in a hidden window,
+// plays every captured frame and reports per frame CPU/GPU time and the most expensive calls
+// usage: trace-replay <file.gltrace> [loops] [--finish]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "TraceReplayer.h"
+
+const int TOP_CALLS = 12;
+
+double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::cout << "usage: trace-replay <file.gltrace> [loops] [--finish]" << std::endl;
+		return -1;
+	}
+	int loops = 1;
+	bool finishEachCall = false;
+	for (int i = 2; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--finish") == 0) {
+			finishEachCall = true;
+		}
+		else {
+			loops = std::max(1, std::atoi(argv[i]));
+		}
+	}
+
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	// same size as the lessons, the captured viewport calls assume it
+	GLFWwindow* window = glfwCreateWindow(800, 600, "trace-replay", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	TraceReplayer replayer;
+	if (!replayer.load(argv[1])) {
+		glfwTerminate();
+		return -1;
+	}
+	std::cout << "TRACEREPLAY::setup " << replayer.getSetupBytes() / (1024.0 * 1024.0) << " MB"
+		<< " | frames " << replayer.getFrameCount() << std::endl;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	bool ok = replayer.replaySetup();
+	glFinish();
+	std::cout << "TRACEREPLAY::setup replayed in " << elapsedMs(start) << " ms" << std::endl;
+
+	unsigned int queries[2];
+	glGenQueries(2, queries);
+
+	double cpuTotal = 0.0, cpuMax = 0.0, gpuTotal = 0.0, gpuMax = 0.0;
+	unsigned int replayed = 0;
+	for (int loop = 0; loop < loops && ok; ++loop) {
+		for (unsigned int frame = 0; frame < replayer.getFrameCount() && ok; ++frame) {
+			glQueryCounter(queries[0], GL_TIMESTAMP);
+			start = std::chrono::high_resolution_clock::now();
+			ok = replayer.replayFrame(frame, finishEachCall);
+			double cpu = elapsedMs(start);
+			glQueryCounter(queries[1], GL_TIMESTAMP);
+			glFinish();
+
+			GLuint64 begin = 0, end = 0;
+			glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &end);
+			double gpu = (end - begin) / 1000000.0;
+
+			cpuTotal += cpu;
+			cpuMax = std::max(cpuMax, cpu);
+			gpuTotal += gpu;
+			gpuMax = std::max(gpuMax, gpu);
+			++replayed;
+		}
+	}
+
+	if (replayed > 0) {
+		std::cout << "TRACEREPLAY::frames " << replayed
+			<< " | CPU avg " << cpuTotal / replayed << " ms max " << cpuMax << " ms"
+			<< " | GPU avg " << gpuTotal / replayed << " ms max " << gpuMax << " ms"
+			<< (finishEachCall ? " | finish after every call" : "") << std::endl;
+	}
+	if (replayer.getUnmappedNames() > 0) {
+		std::cout << "TRACEREPLAY::unmapped object references " << replayer.getUnmappedNames() << std::endl;
+	}
+
+	// most expensive calls first
+	std::vector<uint16_t> ops;
+	for (uint16_t op = 0; op < OP_COUNT; ++op) {
+		if (replayer.getCallStats(op).calls > 0) {
+			ops.push_back(op);
+		}
+	}
+	std::sort(ops.begin(), ops.end(), [&replayer](uint16_t a, uint16_t b) {
+		return replayer.getCallStats(a).cpuMs > replayer.getCallStats(b).cpuMs;
+	});
+	for (size_t i = 0; i < ops.size() && i < (size_t)TOP_CALLS; ++i) {
+		const TraceReplayer::CallStats& call = replayer.getCallStats(ops[i]);
+		std::cout << "  " << traceOpName(ops[i])
+			<< " | calls " << call.calls
+			<< " | total " << call.cpuMs << " ms"
+			<< " | avg " << call.cpuMs * 1000.0 / call.calls << " us" << std::endl;
+	}
+
+	glDeleteQueries(2, queries);
+	glfwTerminate();
+	return ok ? 0 : -1;
+}
\ No newline at end of file
@@ -0,0 +1,700 @@
+#include "GpuMemory.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// driver entry points the wrappers replace
+#define GPUMEMORY_HOOKS(X) \
+	X(GenBuffers) X(DeleteBuffers) X(BindBuffer) X(BindBufferBase) X(BindBufferRange) X(BufferData) \
+	X(BindVertexArray) X(DeleteVertexArrays) X(GenTextures) X(DeleteTextures) X(ActiveTexture) \
+	X(BindTexture) X(TexImage2D) X(TexImage3D) X(GenerateMipmap) X(GenRenderbuffers) \
+	X(DeleteRenderbuffers) X(BindRenderbuffer) X(RenderbufferStorage) X(CreateProgram) \
+	X(DeleteProgram) X(UseProgram)
+
+namespace {
+	const unsigned int MAX_LEVELS = 16;
+	const unsigned int MAX_UNITS = 32;
+	const unsigned int MAX_FACES = 6;
+
+	enum TextureSlot { SLOT_2D, SLOT_2D_ARRAY, SLOT_3D, SLOT_CUBE, TEXTURE_SLOTS };
+	enum BufferSlot { SLOT_ARRAY, SLOT_COPY_READ, SLOT_COPY_WRITE, SLOT_UNIFORM, SLOT_PIXEL_PACK,
+		SLOT_PIXEL_UNPACK, SLOT_OTHER, BUFFER_SLOTS };
+
+	struct Object {
+		GpuMemory::Kind kind;
+		unsigned int category;
+		int asset; // -1 = not part of an asset
+		size_t bytes;
+		unsigned long long lastUsedFrame;
+	};
+
+	// storage of every face and level, redefining one replaces its old size
+	struct TextureLevels {
+		int width, height, depth;
+		unsigned int texelBytes;
+		size_t bytes[MAX_FACES][MAX_LEVELS];
+	};
+
+	struct Category {
+		const char* name;
+		size_t budget;
+		size_t bytes, peakBytes;
+		unsigned int objects;
+		unsigned int evictions, loads;
+		unsigned int overBudgetLoads; // loads that found nothing left to evict
+		double loadMilliseconds, evictMilliseconds;
+	};
+
+	struct Asset {
+		std::string name;
+		unsigned int category;
+		std::function<void()> load, unload;
+		bool resident;
+		size_t bytes;       // of its live objects
+		size_t loadedBytes; // after the last load, what loading it again will take
+		unsigned long long lastUsedFrame;
+	};
+
+	struct State {
+		bool installed = false;
+		unsigned long long frame = 0;
+
+		std::unordered_map<uint64_t, Object> objects; // by kind << 32 | name
+		std::unordered_map<GLuint, TextureLevels> textureLevels;
+		size_t kindBytes[GpuMemory::KIND_COUNT] = {};
+		unsigned int kindCount[GpuMemory::KIND_COUNT] = {};
+
+		Category categories[GpuMemory::MAX_CATEGORIES] = {};
+		unsigned int categoryCount = 1;
+		std::vector<Asset> assets;
+		unsigned int currentCategory = 0;
+		int currentAsset = -1;
+
+		// bindings, the element buffer belongs to the vertex array
+		GLuint buffers[BUFFER_SLOTS] = {};
+		std::unordered_map<GLuint, GLuint> elementBuffers;
+		GLuint vertexArray = 0;
+		GLuint boundTextures[MAX_UNITS][TEXTURE_SLOTS] = {};
+		unsigned int activeUnit = 0;
+		GLuint renderbuffer = 0;
+
+		State() {
+			// category 0 takes whatever is created outside of a scope
+			categories[0].name = "other";
+		}
+	};
+	State memory;
+
+	uint64_t key(GpuMemory::Kind kind, GLuint name) {
+		return ((uint64_t)kind << 32) | name;
+	}
+
+	double millisecondsSince(std::chrono::high_resolution_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	BufferSlot bufferSlot(GLenum target) {
+		switch (target) {
+		case GL_ARRAY_BUFFER: return SLOT_ARRAY;
+		case GL_COPY_READ_BUFFER: return SLOT_COPY_READ;
+		case GL_COPY_WRITE_BUFFER: return SLOT_COPY_WRITE;
+		case GL_UNIFORM_BUFFER: return SLOT_UNIFORM;
+		case GL_PIXEL_PACK_BUFFER: return SLOT_PIXEL_PACK;
+		case GL_PIXEL_UNPACK_BUFFER: return SLOT_PIXEL_UNPACK;
+		default: return SLOT_OTHER;
+		}
+	}
+
+	GLuint& boundBuffer(GLenum target) {
+		if (target == GL_ELEMENT_ARRAY_BUFFER) {
+			return memory.elementBuffers[memory.vertexArray];
+		}
+		return memory.buffers[bufferSlot(target)];
+	}
+
+	// face is the cube map face for GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, else 0
+	TextureSlot textureSlot(GLenum target, unsigned int& face) {
+		face = 0;
+		if (target >= GL_TEXTURE_CUBE_MAP_POSITIVE_X && target <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z) {
+			face = target - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
+			return SLOT_CUBE;
+		}
+		switch (target) {
+		case GL_TEXTURE_2D_ARRAY: return SLOT_2D_ARRAY;
+		case GL_TEXTURE_3D: return SLOT_3D;
+		case GL_TEXTURE_CUBE_MAP: return SLOT_CUBE;
+		default: return SLOT_2D;
+		}
+	}
+
+	GLuint boundTexture(GLenum target, unsigned int& face) {
+		return memory.boundTextures[memory.activeUnit][textureSlot(target, face)];
+	}
+
+	// what the driver most likely stores, three component formats are padded to four
+	unsigned int texelBytes(GLint internalFormat) {
+		switch (internalFormat) {
+		case GL_R8: case GL_RED: case GL_R8UI: case GL_R8I: case GL_STENCIL_INDEX8:
+			return 1;
+		case GL_RG8: case GL_RG: case GL_R16F: case GL_R16: case GL_R16UI: case GL_R16I: case GL_DEPTH_COMPONENT16:
+			return 2;
+		case GL_RGBA16F: case GL_RGB16F: case GL_RG32F: case GL_RGBA16: case GL_RGBA16UI: case GL_RG32UI:
+			return 8;
+		case GL_RGB32F: case GL_RGBA32F: case GL_RGBA32UI: case GL_RGBA32I:
+			return 16;
+		case GL_DEPTH32F_STENCIL8:
+			return 8;
+		default:
+			// GL_RGBA8, GL_RGB8, GL_SRGB8_ALPHA8, GL_R32F, GL_RG16F, GL_R11F_G11F_B10F, depth 24/32 ...
+			return 4;
+		}
+	}
+
+	Object* find(GpuMemory::Kind kind, GLuint name) {
+		auto found = memory.objects.find(key(kind, name));
+		return found != memory.objects.end() ? &found->second : NULL;
+	}
+
+	void stamp(GpuMemory::Kind kind, GLuint name) {
+		if (name == 0) {
+			return;
+		}
+		Object* object = find(kind, name);
+		if (object) {
+			object->lastUsedFrame = memory.frame;
+			if (object->asset >= 0) {
+				memory.assets[object->asset].lastUsedFrame = memory.frame;
+			}
+		}
+	}
+
+	void resize(Object& object, size_t bytes) {
+		Category& category = memory.categories[object.category];
+		category.bytes = category.bytes - object.bytes + bytes;
+		category.peakBytes = std::max(category.peakBytes, category.bytes);
+		memory.kindBytes[object.kind] = memory.kindBytes[object.kind] - object.bytes + bytes;
+		if (object.asset >= 0) {
+			Asset& asset = memory.assets[object.asset];
+			asset.bytes = asset.bytes - object.bytes + bytes;
+		}
+		object.bytes = bytes;
+		object.lastUsedFrame = memory.frame;
+	}
+
+	void destroy(GpuMemory::Kind kind, GLuint name) {
+		auto found = memory.objects.find(key(kind, name));
+		if (found == memory.objects.end()) {
+			return;
+		}
+		resize(found->second, 0);
+		--memory.kindCount[kind];
+		--memory.categories[found->second.category].objects;
+		memory.objects.erase(found);
+	}
+
+	void create(GpuMemory::Kind kind, GLuint name) {
+		// a name the driver hands out again is a new object, whatever we missed about the old one
+		destroy(kind, name);
+		Object object;
+		object.kind = kind;
+		object.category = memory.currentCategory;
+		object.asset = memory.currentAsset;
+		object.bytes = 0;
+		object.lastUsedFrame = memory.frame;
+		memory.objects[key(kind, name)] = object;
+		++memory.kindCount[kind];
+		++memory.categories[object.category].objects;
+	}
+
+	void textureResized(GLuint texture, const TextureLevels& levels) {
+		Object* object = find(GpuMemory::KIND_TEXTURE, texture);
+		if (!object) {
+			return;
+		}
+		size_t bytes = 0;
+		for (unsigned int face = 0; face < MAX_FACES; ++face) {
+			for (unsigned int level = 0; level < MAX_LEVELS; ++level) {
+				bytes += levels.bytes[face][level];
+			}
+		}
+		resize(*object, bytes);
+	}
+
+	void textureImage(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLsizei depth) {
+		unsigned int face;
+		GLuint texture = boundTexture(target, face);
+		if (texture == 0 || level < 0 || level >= (GLint)MAX_LEVELS) {
+			return;
+		}
+		TextureLevels& levels = memory.textureLevels[texture];
+		unsigned int bytesPerTexel = texelBytes(internalFormat);
+		if (level == 0) {
+			levels.width = width;
+			levels.height = height;
+			levels.depth = depth;
+			levels.texelBytes = bytesPerTexel;
+		}
+		levels.bytes[face][level] = (size_t)width * height * depth * bytesPerTexel;
+		textureResized(texture, levels);
+	}
+
+	// a reloadable asset of the category used least recently, but not this frame
+	int leastRecentlyUsed(unsigned int category) {
+		int oldest = -1;
+		for (unsigned int i = 0; i < memory.assets.size(); ++i) {
+			const Asset& asset = memory.assets[i];
+			if (asset.category == category && asset.resident && asset.lastUsedFrame < memory.frame
+				&& (oldest < 0 || asset.lastUsedFrame < memory.assets[oldest].lastUsedFrame)) {
+				oldest = (int)i;
+			}
+		}
+		return oldest;
+	}
+
+	// evict until bytes more fit into the budget, false when it cannot be done
+	bool makeRoom(unsigned int category, size_t bytes) {
+		const Category& stats = memory.categories[category];
+		while (stats.budget > 0 && stats.bytes + bytes > stats.budget) {
+			int oldest = leastRecentlyUsed(category);
+			if (oldest < 0) {
+				return false;
+			}
+			GpuMemory::evict((unsigned int)oldest);
+		}
+		return true;
+	}
+}
+
+#define GPUMEMORY_REAL(name) static decltype(glad_gl##name) real_gl##name = NULL;
+GPUMEMORY_HOOKS(GPUMEMORY_REAL)
+#undef GPUMEMORY_REAL
+
+// buffers
+
+static void APIENTRY memory_glGenBuffers(GLsizei n, GLuint* names) {
+	real_glGenBuffers(n, names);
+	for (GLsizei i = 0; i < n; ++i) {
+		create(GpuMemory::KIND_BUFFER, names[i]);
+	}
+}
+
+static void APIENTRY memory_glDeleteBuffers(GLsizei n, const GLuint* names) {
+	real_glDeleteBuffers(n, names);
+	for (GLsizei i = 0; i < n; ++i) {
+		destroy(GpuMemory::KIND_BUFFER, names[i]);
+		// deleting a bound buffer unbinds it
+		for (GLuint& bound : memory.buffers) {
+			bound = bound == names[i] ? 0 : bound;
+		}
+		GLuint& element = memory.elementBuffers[memory.vertexArray];
+		element = element == names[i] ? 0 : element;
+	}
+}
+
+static void APIENTRY memory_glBindBuffer(GLenum target, GLuint buffer) {
+	real_glBindBuffer(target, buffer);
+	boundBuffer(target) = buffer;
+	stamp(GpuMemory::KIND_BUFFER, buffer);
+}
+
+static void APIENTRY memory_glBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+	real_glBindBufferBase(target, index, buffer);
+	// also binds the generic binding point
+	boundBuffer(target) = buffer;
+	stamp(GpuMemory::KIND_BUFFER, buffer);
+}
+
+static void APIENTRY memory_glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+	real_glBindBufferRange(target, index, buffer, offset, size);
+	boundBuffer(target) = buffer;
+	stamp(GpuMemory::KIND_BUFFER, buffer);
+}
+
+static void APIENTRY memory_glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+	real_glBufferData(target, size, data, usage);
+	Object* object = find(GpuMemory::KIND_BUFFER, boundBuffer(target));
+	if (object) {
+		resize(*object, (size_t)size);
+	}
+}
+
+static void APIENTRY memory_glBindVertexArray(GLuint vertexArray) {
+	real_glBindVertexArray(vertexArray);
+	memory.vertexArray = vertexArray;
+}
+
+static void APIENTRY memory_glDeleteVertexArrays(GLsizei n, const GLuint* names) {
+	real_glDeleteVertexArrays(n, names);
+	for (GLsizei i = 0; i < n; ++i) {
+		memory.elementBuffers.erase(names[i]);
+		memory.vertexArray = memory.vertexArray == names[i] ? 0 : memory.vertexArray;
+	}
+}
+
+// textures
+
+static void APIENTRY memory_glGenTextures(GLsizei n, GLuint* names) {
+	real_glGenTextures(n, names);
+	for (GLsizei i = 0; i < n; ++i) {
+		create(GpuMemory::KIND_TEXTURE, names[i]);
+		memory.textureLevels.erase(names[i]);
+	}
+}
+
+static void APIENTRY memory_glDeleteTextures(GLsizei n, const GLuint* names) {
+	real_glDeleteTextures(n, names);
+	for (GLsizei i = 0; i < n; ++i) {
+		destroy(GpuMemory::KIND_TEXTURE, names[i]);
+		memory.textureLevels.erase(names[i]);
+		for (auto& unit : memory.boundTextures) {
+			for (GLuint& bound : unit) {
+				bound = bound == names[i] ? 0 : bound;
+			}
+		}
+	}
+}
+
+static void APIENTRY memory_glActiveTexture(GLenum unit) {
+	real_glActiveTexture(unit);
+	memory.activeUnit = std::min(unit - GL_TEXTURE0, MAX_UNITS - 1);
+}
+
+static void APIENTRY memory_glBindTexture(GLenum target, GLuint texture) {
+	real_glBindTexture(target, texture);
+	unsigned int face;
+	memory.boundTextures[memory.activeUnit][textureSlot(target, face)] = texture;
+	stamp(GpuMemory::KIND_TEXTURE, texture);
+}
+
+static void APIENTRY memory_glTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+	GLint border, GLenum format, GLenum type, const void* pixels) {
+	real_glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+	textureImage(target, level, internalFormat, width, height, 1);
+}
+
+static void APIENTRY memory_glTexImage3D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+	GLsizei depth, GLint border, GLenum format, GLenum type, const void* pixels) {
+	real_glTexImage3D(target, level, internalFormat, width, height, depth, border, format, type, pixels);
+	textureImage(target, level, internalFormat, width, height, depth);
+}
+
+static void APIENTRY memory_glGenerateMipmap(GLenum target) {
+	real_glGenerateMipmap(target);
+	unsigned int face;
+	GLuint texture = boundTexture(target, face);
+	auto found = memory.textureLevels.find(texture);
+	if (found == memory.textureLevels.end()) {
+		return;
+	}
+	// every face with a base level gets the whole chain, arrays keep their layer count
+	TextureLevels& levels = found->second;
+	bool layered = target == GL_TEXTURE_2D_ARRAY;
+	for (unsigned int f = 0; f < MAX_FACES; ++f) {
+		if (levels.bytes[f][0] == 0) {
+			continue;
+		}
+		int width = levels.width, height = levels.height, depth = levels.depth;
+		for (unsigned int level = 1; level < MAX_LEVELS; ++level) {
+			width = std::max(1, width / 2);
+			height = std::max(1, height / 2);
+			depth = layered ? depth : std::max(1, depth / 2);
+			levels.bytes[f][level] = (size_t)width * height * depth * levels.texelBytes;
+			if (width == 1 && height == 1 && (layered || depth == 1)) {
+				break;
+			}
+		}
+	}
+	textureResized(texture, levels);
+}
+
+// renderbuffers
+
+static void APIENTRY memory_glGenRenderbuffers(GLsizei n, GLuint* names) {
+	real_glGenRenderbuffers(n, names);
+	for (GLsizei i = 0; i < n; ++i) {
+		create(GpuMemory::KIND_RENDERBUFFER, names[i]);
+	}
+}
+
+static void APIENTRY memory_glDeleteRenderbuffers(GLsizei n, const GLuint* names) {
+	real_glDeleteRenderbuffers(n, names);
+	for (GLsizei i = 0; i < n; ++i) {
+		destroy(GpuMemory::KIND_RENDERBUFFER, names[i]);
+		memory.renderbuffer = memory.renderbuffer == names[i] ? 0 : memory.renderbuffer;
+	}
+}
+
+static void APIENTRY memory_glBindRenderbuffer(GLenum target, GLuint renderbuffer) {
+	real_glBindRenderbuffer(target, renderbuffer);
+	memory.renderbuffer = renderbuffer;
+	stamp(GpuMemory::KIND_RENDERBUFFER, renderbuffer);
+}
+
+static void APIENTRY memory_glRenderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height) {
+	real_glRenderbufferStorage(target, internalFormat, width, height);
+	Object* object = find(GpuMemory::KIND_RENDERBUFFER, memory.renderbuffer);
+	if (object) {
+		resize(*object, (size_t)width * height * texelBytes(internalFormat));
+	}
+}
+
+// programs
+
+static GLuint APIENTRY memory_glCreateProgram() {
+	GLuint program = real_glCreateProgram();
+	create(GpuMemory::KIND_PROGRAM, program);
+	return program;
+}
+
+static void APIENTRY memory_glDeleteProgram(GLuint program) {
+	real_glDeleteProgram(program);
+	destroy(GpuMemory::KIND_PROGRAM, program);
+}
+
+static void APIENTRY memory_glUseProgram(GLuint program) {
+	real_glUseProgram(program);
+	stamp(GpuMemory::KIND_PROGRAM, program);
+}
+
+void GpuMemory::install() {
+	if (memory.installed) {
+		return;
+	}
+	memory.installed = true;
+	// whatever is installed already (GLTrace) stays in the chain
+#define GPUMEMORY_HOOK(name) real_gl##name = glad_gl##name; glad_gl##name = memory_gl##name;
+	GPUMEMORY_HOOKS(GPUMEMORY_HOOK)
+#undef GPUMEMORY_HOOK
+}
+
+bool GpuMemory::isInstalled() {
+	return memory.installed;
+}
+
+unsigned int GpuMemory::category(const char* name) {
+	for (unsigned int i = 0; i < memory.categoryCount; ++i) {
+		if (std::strcmp(memory.categories[i].name, name) == 0) {
+			return i;
+		}
+	}
+	if (memory.categoryCount == MAX_CATEGORIES) {
+		std::cout << "ERROR::GPUMEMORY::TOO_MANY_CATEGORIES " << name << std::endl;
+		return 0;
+	}
+	Category& category = memory.categories[memory.categoryCount];
+	category = Category();
+	category.name = name;
+	return memory.categoryCount++;
+}
+
+void GpuMemory::setBudget(unsigned int category, size_t bytes) {
+	memory.categories[category].budget = bytes;
+}
+
+size_t GpuMemory::getBudget(unsigned int category) {
+	return memory.categories[category].budget;
+}
+
+unsigned int GpuMemory::addAsset(const char* name, unsigned int category,
+	std::function<void()> load, std::function<void()> unload) {
+	Asset asset;
+	asset.name = name;
+	asset.category = category;
+	asset.load = std::move(load);
+	asset.unload = std::move(unload);
+	asset.resident = false;
+	asset.bytes = 0;
+	asset.loadedBytes = 0;
+	asset.lastUsedFrame = 0;
+	memory.assets.push_back(std::move(asset));
+	return (unsigned int)memory.assets.size() - 1;
+}
+
+bool GpuMemory::use(unsigned int id) {
+	Asset& asset = memory.assets[id];
+	asset.lastUsedFrame = memory.frame;
+	if (asset.resident) {
+		return false;
+	}
+
+	// room for what it took last time, only assets not used this frame can go
+	// (the working set itself can be over budget, that is counted, not fixed)
+	if (!makeRoom(asset.category, asset.loadedBytes)) {
+		++memory.categories[asset.category].overBudgetLoads;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	unsigned int previousCategory = memory.currentCategory;
+	int previousAsset = memory.currentAsset;
+	memory.currentCategory = asset.category;
+	memory.currentAsset = (int)id;
+	asset.load();
+	memory.currentCategory = previousCategory;
+	memory.currentAsset = previousAsset;
+
+	Category& category = memory.categories[asset.category];
+	category.loadMilliseconds += millisecondsSince(start);
+	++category.loads;
+	asset.resident = true;
+	asset.loadedBytes = asset.bytes;
+	return true;
+}
+
+bool GpuMemory::isResident(unsigned int asset) {
+	return memory.assets[asset].resident;
+}
+
+void GpuMemory::evict(unsigned int id) {
+	Asset& asset = memory.assets[id];
+	if (!asset.resident) {
+		return;
+	}
+	auto start = std::chrono::high_resolution_clock::now();
+	asset.unload();
+	Category& category = memory.categories[asset.category];
+	category.evictMilliseconds += millisecondsSince(start);
+	++category.evictions;
+	asset.resident = false;
+	if (asset.bytes > 0) {
+		std::cout << "ERROR::GPUMEMORY::ASSET_NOT_FREED " << asset.name << " still holds " << asset.bytes
+			<< " bytes after unload" << std::endl;
+	}
+}
+
+void GpuMemory::endFrame() {
+	for (unsigned int i = 0; i < memory.categoryCount; ++i) {
+		makeRoom(i, 0);
+	}
+	++memory.frame;
+}
+
+unsigned long long GpuMemory::getFrame() {
+	return memory.frame;
+}
+
+size_t GpuMemory::getBytes(unsigned int category) {
+	return memory.categories[category].bytes;
+}
+
+size_t GpuMemory::getPeakBytes(unsigned int category) {
+	return memory.categories[category].peakBytes;
+}
+
+size_t GpuMemory::getKindBytes(Kind kind) {
+	return memory.kindBytes[kind];
+}
+
+unsigned int GpuMemory::getKindCount(Kind kind) {
+	return memory.kindCount[kind];
+}
+
+size_t GpuMemory::getTotalBytes() {
+	size_t total = 0;
+	for (size_t bytes : memory.kindBytes) {
+		total += bytes;
+	}
+	return total;
+}
+
+unsigned int GpuMemory::getEvictions(unsigned int category) {
+	return memory.categories[category].evictions;
+}
+
+unsigned int GpuMemory::getLoads(unsigned int category) {
+	return memory.categories[category].loads;
+}
+
+unsigned int GpuMemory::getOverBudgetLoads(unsigned int category) {
+	return memory.categories[category].overBudgetLoads;
+}
+
+double GpuMemory::getLoadMilliseconds(unsigned int category) {
+	return memory.categories[category].loadMilliseconds;
+}
+
+double GpuMemory::getEvictMilliseconds(unsigned int category) {
+	return memory.categories[category].evictMilliseconds;
+}
+
+const char* GpuMemory::kindName(Kind kind) {
+	switch (kind) {
+	case KIND_BUFFER: return "buffers";
+	case KIND_TEXTURE: return "textures";
+	case KIND_RENDERBUFFER: return "renderbuffers";
+	case KIND_PROGRAM: return "programs";
+	default: return "unknown";
+	}
+}
+
+void GpuMemory::printStats(const char* label) {
+	const double MB = 1.0 / (1024.0 * 1024.0);
+	std::cout << "GPUMEMORY::" << label << " total " << getTotalBytes() * MB << " MB";
+	for (unsigned int kind = 0; kind < KIND_COUNT; ++kind) {
+		std::cout << " | " << kindName((Kind)kind) << " " << memory.kindCount[kind];
+		if (kind != KIND_PROGRAM) {
+			std::cout << " (" << memory.kindBytes[kind] * MB << " MB)";
+		}
+	}
+	std::cout << std::endl;
+
+	for (unsigned int i = 0; i < memory.categoryCount; ++i) {
+		const Category& category = memory.categories[i];
+		std::cout << "GPUMEMORY::" << label << "::" << category.name
+			<< " objects " << category.objects
+			<< " | " << category.bytes * MB << " MB (peak " << category.peakBytes * MB << " MB";
+		if (category.budget > 0) {
+			std::cout << ", budget " << category.budget * MB << " MB";
+		}
+		std::cout << ")";
+		if (category.loads > 0) {
+			std::cout << " | loads " << category.loads
+				<< " (" << category.loadMilliseconds / category.loads << " ms each)"
+				<< " | evictions " << category.evictions;
+			if (category.evictions > 0) {
+				std::cout << " (" << category.evictMilliseconds / category.evictions << " ms each)";
+			}
+			if (category.overBudgetLoads > 0) {
+				std::cout << " | loaded over budget " << category.overBudgetLoads;
+			}
+		}
+		std::cout << std::endl;
+	}
+}
+
+void GpuMemory::printLive(const char* label) {
+	// sorted so the output is the same from run to run
+	std::vector<std::pair<uint64_t, const Object*>> live;
+	for (const auto& entry : memory.objects) {
+		live.push_back({ entry.first, &entry.second });
+	}
+	std::sort(live.begin(), live.end(),
+		[](const std::pair<uint64_t, const Object*>& a, const std::pair<uint64_t, const Object*>& b) { return a.first < b.first; });
+
+	std::cout << "GPUMEMORY::" << label << " live objects " << live.size() << std::endl;
+	for (const auto& entry : live) {
+		const Object& object = *entry.second;
+		std::cout << "GPUMEMORY::" << label << "::" << memory.categories[object.category].name
+			<< " " << kindName(object.kind) << " " << (GLuint)entry.first
+			<< " | " << object.bytes << " bytes"
+			<< " | last used frame " << object.lastUsedFrame;
+		if (object.asset >= 0) {
+			std::cout << " | asset " << memory.assets[object.asset].name;
+		}
+		std::cout << std::endl;
+	}
+}
+
+GpuMemoryScope::GpuMemoryScope(unsigned int category)
+	: previous(memory.currentCategory) {
+	memory.currentCategory = category;
+}
+
+GpuMemoryScope::~GpuMemoryScope() {
+	memory.currentCategory = previous;
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <functional>
+
+// Keeps a registry of every GL buffer, texture, renderbuffer and program with
+// its size, category and the frame it was last bound in.
+// install() swaps the glad function pointers for accounting wrappers, the same
+// way GLTrace does (the two can be installed in either order), so no call site
+// changes. Sizes come from the storage calls: glBufferData, glTexImage2D/3D,
+// glGenerateMipmap, glRenderbufferStorage. Programs are counted but have no
+// size, GL 3.3 has no way to ask for it.
+// Objects belong to the category whose GpuMemoryScope was active when they were
+// created. A category can have a budget; when it is over budget, reloadable
+// assets in it are evicted least recently used first. An asset is a load
+// function that creates GL objects (everything created inside it belongs to the
+// asset) and an unload function that deletes them; use() loads it back when it
+// was evicted. Everything here is main thread only, like the GL calls it wraps.
+class GpuMemory {
+public:
+	enum Kind { KIND_BUFFER, KIND_TEXTURE, KIND_RENDERBUFFER, KIND_PROGRAM, KIND_COUNT };
+	static const unsigned int MAX_CATEGORIES = 16;
+
+	// call once, right after gladLoadGLLoader
+	static void install();
+	static bool isInstalled();
+
+	// id for a category name, the same name always gives the same id.
+	// 0 is "other", anything created outside a scope
+	static unsigned int category(const char* name);
+	// 0 = no budget
+	static void setBudget(unsigned int category, size_t bytes);
+	static size_t getBudget(unsigned int category);
+
+	// a reloadable asset in a category, nothing is loaded until the first use()
+	static unsigned int addAsset(const char* name, unsigned int category,
+		std::function<void()> load, std::function<void()> unload);
+	// mark the asset used this frame and load it if it is not resident,
+	// true when it had to be loaded
+	static bool use(unsigned int asset);
+	static bool isResident(unsigned int asset);
+	static void evict(unsigned int asset);
+
+	// frame stamps for the bind wrappers, the end of a frame evicts over budget
+	static void endFrame();
+	static unsigned long long getFrame();
+
+	// stats
+	static size_t getBytes(unsigned int category);
+	static size_t getPeakBytes(unsigned int category);
+	static size_t getKindBytes(Kind kind);
+	static unsigned int getKindCount(Kind kind);
+	static size_t getTotalBytes();
+	static unsigned int getEvictions(unsigned int category);
+	static unsigned int getLoads(unsigned int category);
+	// loads that went over budget because everything resident was used this frame
+	static unsigned int getOverBudgetLoads(unsigned int category);
+	static double getLoadMilliseconds(unsigned int category);
+	static double getEvictMilliseconds(unsigned int category);
+
+	static const char* kindName(Kind kind);
+	// one line per category and per kind, label is printed in front
+	static void printStats(const char* label);
+	// every object still alive, call before the context goes away
+	static void printLive(const char* label);
+};
+
+// objects created on this thread count towards category until the scope ends
+class GpuMemoryScope {
+public:
+	GpuMemoryScope(unsigned int category);
+	~GpuMemoryScope();
+
+private:
+	unsigned int previous;
+};
\ No newline at end of file
@@ -0,0 +1,254 @@
+// GPU memory stress test: cycles a window of textures through more reloadable assets than the
+// texture budget holds, so the LRU has to evict and reload all the time. Sweeps working sets
+// below, near and above the budget and prints the frame time plus the eviction and reload cost,
+// then keeps the last one running; W cycles the working set.
+// usage: gpu-memory-stress [budget MB] [texture size]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "../shader-lesson-1.4/Shader.h"
+#include "GpuMemory.h"
+
+const unsigned int WIDTH = 800;
+const unsigned int HEIGHT = 600;
+const unsigned int ASSET_COUNT = 64;
+const unsigned int SWEEP_FRAMES = 240;
+
+// working set as a share of what fits into the budget, and how many new assets enter it per frame
+struct Phase {
+	const char* name;
+	float workingSet;
+	unsigned int step;
+	bool budget;
+};
+const Phase PHASES[] = {
+	{ "no budget", 0.9f, 1, false },
+	{ "half budget", 0.5f, 1, true },
+	{ "near budget", 0.9f, 1, true },
+	{ "near budget, fast", 0.9f, 4, true },
+	{ "over budget", 1.5f, 1, true },
+};
+const unsigned int PHASE_COUNT = sizeof(PHASES) / sizeof(PHASES[0]);
+
+unsigned int phase = 0;
+bool phaseChanged = true;
+
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void fillPattern(std::vector<unsigned char>& pixels, int size, unsigned int seed);
+
+int main(int argc, char** argv) {
+	size_t budget = (size_t)(argc > 1 ? std::atof(argv[1]) : 64.0) * 1024 * 1024;
+	int textureSize = argc > 2 ? std::atoi(argv[2]) : 1024;
+
+	// initialize GLFW
+	glfwInit();
+	// set version and core profile
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// create a window
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glfwSetKeyCallback(window, keyCallback);
+
+	// initialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+	GpuMemory::install();
+
+	// no vsync, we want to see the frame time
+	glfwSwapInterval(0);
+
+	unsigned int textureCategory = GpuMemory::category("textures");
+	Shader* shader = new Shader("tile.vert", "tile.frag");
+	unsigned int emptyVAO;
+	glGenVertexArrays(1, &emptyVAO);
+
+	// every asset is a mipmapped RGBA8 texture made from a pattern, loading it again
+	// is the same work as the first time
+	std::vector<unsigned int> textures(ASSET_COUNT, 0);
+	std::vector<unsigned int> assets(ASSET_COUNT);
+	std::vector<unsigned char> pixels;
+	for (unsigned int i = 0; i < ASSET_COUNT; ++i) {
+		std::string name = "pattern " + std::to_string(i);
+		assets[i] = GpuMemory::addAsset(name.c_str(), textureCategory,
+			[i, textureSize, &textures, &pixels]() {
+				fillPattern(pixels, textureSize, i);
+				glGenTextures(1, &textures[i]);
+				glBindTexture(GL_TEXTURE_2D, textures[i]);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, textureSize, textureSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+				glGenerateMipmap(GL_TEXTURE_2D);
+			},
+			[i, &textures]() {
+				glDeleteTextures(1, &textures[i]);
+				textures[i] = 0;
+			});
+	}
+	// RGBA8 plus a third for the mips
+	size_t assetBytes = (size_t)textureSize * textureSize * 4 * 4 / 3;
+	unsigned int capacity = std::max(1u, (unsigned int)(budget / assetBytes));
+	std::cout << "GPUMEMORY::" << ASSET_COUNT << " assets of " << assetBytes / (1024.0 * 1024.0) << " MB"
+		<< " | budget " << budget / (1024.0 * 1024.0) << " MB holds " << capacity << std::endl;
+
+	bool sweeping = true;
+	unsigned int sweepFrame = 0;
+	unsigned int offset = 0;
+	unsigned int workingSet = 1;
+	double lastReport = glfwGetTime();
+	double frameSum = 0.0, frameMax = 0.0;
+	unsigned int frames = 0;
+	unsigned int startLoads = 0, startEvictions = 0, startOverBudget = 0;
+	double startLoadTime = 0.0, startEvictTime = 0.0;
+
+	// render loop
+	while (!glfwWindowShouldClose(window)) {
+		if (phaseChanged) {
+			const Phase& settings = PHASES[phase];
+			workingSet = std::min(ASSET_COUNT, std::max(1u, (unsigned int)(capacity * settings.workingSet)));
+			GpuMemory::setBudget(textureCategory, settings.budget ? budget : 0);
+			frameSum = frameMax = 0.0;
+			frames = 0;
+			startLoads = GpuMemory::getLoads(textureCategory);
+			startEvictions = GpuMemory::getEvictions(textureCategory);
+			startOverBudget = GpuMemory::getOverBudgetLoads(textureCategory);
+			startLoadTime = GpuMemory::getLoadMilliseconds(textureCategory);
+			startEvictTime = GpuMemory::getEvictMilliseconds(textureCategory);
+			lastReport = glfwGetTime();
+			phaseChanged = false;
+		}
+
+		auto start = std::chrono::high_resolution_clock::now();
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		// the working set as a grid of tiles, sliding through the assets
+		shader->use();
+		shader->setInt("texture1", 0);
+		glBindVertexArray(emptyVAO);
+		glActiveTexture(GL_TEXTURE0);
+		unsigned int columns = (unsigned int)std::ceil(std::sqrt((float)workingSet));
+		float tile = 2.0f / columns;
+		for (unsigned int i = 0; i < workingSet; ++i) {
+			unsigned int asset = (offset + i) % ASSET_COUNT;
+			GpuMemory::use(assets[asset]);
+			glBindTexture(GL_TEXTURE_2D, textures[asset]);
+			glUniform4f(glGetUniformLocation(shader->ID, "rect"),
+				-1.0f + (i % columns) * tile, 1.0f - (i / columns + 1) * tile, tile * 0.95f, tile * 0.95f);
+			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+		}
+		glBindVertexArray(0);
+		offset = (offset + PHASES[phase].step) % ASSET_COUNT;
+
+		// evicts whatever the frame pushed over budget
+		GpuMemory::endFrame();
+		double frameTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		frameSum += frameTime;
+		frameMax = std::max(frameMax, frameTime);
+		++frames;
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		// the sweep steps through every phase, then hands over to the keys
+		bool report = sweeping ? ++sweepFrame % SWEEP_FRAMES == 0 : glfwGetTime() - lastReport > 1.0;
+		if (report) {
+			unsigned int loads = GpuMemory::getLoads(textureCategory) - startLoads;
+			unsigned int evictions = GpuMemory::getEvictions(textureCategory) - startEvictions;
+			double loadTime = GpuMemory::getLoadMilliseconds(textureCategory) - startLoadTime;
+			double evictTime = GpuMemory::getEvictMilliseconds(textureCategory) - startEvictTime;
+			std::cout << "GPUMEMORY::" << PHASES[phase].name << " | working set " << workingSet
+				<< " | CPU " << frameSum / frames << " ms (max " << frameMax << ")"
+				<< " | loads/frame " << (double)loads / frames
+				<< " (" << (loads > 0 ? loadTime / loads : 0.0) << " ms each)"
+				<< " | evictions/frame " << (double)evictions / frames
+				<< " (" << (evictions > 0 ? evictTime / evictions : 0.0) << " ms each)"
+				<< " | over budget loads " << GpuMemory::getOverBudgetLoads(textureCategory) - startOverBudget
+				<< " | resident " << GpuMemory::getBytes(textureCategory) / (1024.0 * 1024.0) << " MB" << std::endl;
+			frameSum = frameMax = 0.0;
+			frames = 0;
+			startLoads += loads;
+			startEvictions += evictions;
+			startOverBudget = GpuMemory::getOverBudgetLoads(textureCategory);
+			startLoadTime += loadTime;
+			startEvictTime += evictTime;
+			lastReport = glfwGetTime();
+		}
+		if (sweeping && report) {
+			if (phase + 1 == PHASE_COUNT) {
+				sweeping = false;
+			}
+			else {
+				++phase;
+				phaseChanged = true;
+			}
+		}
+	}
+
+	GpuMemory::printStats("gpu-memory-stress");
+
+	// deallocate objects
+	for (unsigned int asset : assets) {
+		GpuMemory::evict(asset);
+	}
+	glDeleteVertexArrays(1, &emptyVAO);
+	glDeleteProgram(shader->ID);
+	delete shader;
+	// should be empty, anything left here leaked
+	GpuMemory::printLive("gpu-memory-stress");
+
+	glfwTerminate();
+	return 0;
+}
+
+// react to key presses
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	if (action != GLFW_PRESS) {
+		return;
+	}
+	if (key == GLFW_KEY_ESCAPE) {
+		glfwSetWindowShouldClose(window, true);
+	}
+	if (key == GLFW_KEY_W) {
+		phase = (phase + 1) % PHASE_COUNT;
+		phaseChanged = true;
+	}
+}
+
+// RGBA8 checker pattern with a color of its own per seed
+void fillPattern(std::vector<unsigned char>& pixels, int size, unsigned int seed) {
+	pixels.resize((size_t)size * size * 4);
+	unsigned char r = (unsigned char)(seed * 67), g = (unsigned char)(seed * 151), b = (unsigned char)(seed * 37);
+	for (int y = 0; y < size; ++y) {
+		for (int x = 0; x < size; ++x) {
+			unsigned char* pixel = &pixels[((size_t)y * size + x) * 4];
+			bool dark = ((x >> 5) ^ (y >> 5)) & 1;
+			pixel[0] = dark ? r / 2 : r;
+			pixel[1] = dark ? g / 2 : g;
+			pixel[2] = dark ? b / 2 : b;
+			pixel[3] = 255;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#version 330 core
+// one screen rectangle from a triangle strip, no vertex buffer needed
+out vec2 TexCoord;
+
+uniform vec4 rect; // x, y, width, height in clip space
+
+void main()
+{
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+	TexCoord = corner;
+	gl_Position = vec4(rect.xy + corner * rect.zw, 0.0f, 1.0f);
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include "../frame-memory/AllocationTracker.h"
 
 void framebufferResizeCallback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
@@ -238,6 +239,8 @@ int main() {
 
 	// render loop
 	while (!glfwWindowShouldClose(window)) {
+		AllocationTracker::beginFrame();
+
 		processInput(window);
 
 		// clear screen
@@ -256,7 +259,12 @@ int main() {
 
 		glfwSwapBuffers(window);
 		glfwPollEvents();
+
+		AllocationTracker::endFrame();
 	}
+	// heap allocations per frame, should be 0 in steady state
+	AllocationTracker::report("hello-triangle-1.3");
+
 	// deallocate objects
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteBuffers(1, &VBO);
@@ -0,0 +1,154 @@
+#include "InitGraph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+static const std::chrono::high_resolution_clock::time_point processStart = std::chrono::high_resolution_clock::now();
+
+InitGraph::InitGraph(ThreadPool& pool)
+	: pool(pool), runStart(0.0), runEnd(0.0), completed(0) {
+}
+
+unsigned int InitGraph::add(const char* name, Affinity affinity, std::function<void()> task,
+	const std::vector<unsigned int>& dependencies) {
+	unsigned int id = (unsigned int)tasks.size();
+	Task entry;
+	entry.name = name;
+	entry.affinity = affinity;
+	entry.function = std::move(task);
+	entry.dependencies = dependencies;
+	entry.remaining = (unsigned int)dependencies.size();
+	entry.start = entry.end = 0.0;
+	entry.onMainThread = false;
+	tasks.push_back(entry);
+	for (unsigned int dependency : dependencies) {
+		tasks[dependency].dependents.push_back(id);
+	}
+	return id;
+}
+
+void InitGraph::run(bool serial) {
+	mainThread = std::this_thread::get_id();
+	runStart = sinceProcessStart();
+
+	if (serial) {
+		for (unsigned int id = 0; id < tasks.size(); ++id) {
+			execute(id);
+		}
+		runEnd = sinceProcessStart();
+		return;
+	}
+
+	completed = 0;
+	for (unsigned int id = 0; id < tasks.size(); ++id) {
+		if (tasks[id].remaining == 0) {
+			std::lock_guard<std::mutex> lock(mutex);
+			dispatch(id);
+		}
+	}
+
+	// the main thread only runs its own tasks and sleeps in between
+	std::unique_lock<std::mutex> lock(mutex);
+	while (completed < tasks.size()) {
+		condition.wait(lock, [this] { return !mainReady.empty() || completed == tasks.size(); });
+		if (mainReady.empty()) {
+			break;
+		}
+		unsigned int id = mainReady.front();
+		mainReady.pop_front();
+		lock.unlock();
+		execute(id);
+		finish(id);
+		lock.lock();
+	}
+	runEnd = sinceProcessStart();
+}
+
+void InitGraph::printTimeline() const {
+	std::vector<unsigned int> order(tasks.size());
+	for (unsigned int id = 0; id < tasks.size(); ++id) {
+		order[id] = id;
+	}
+	std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b) {
+		return tasks[a].start < tasks[b].start;
+	});
+
+	// walk back from the task that finished last through the dependency that finished last
+	std::vector<bool> critical(tasks.size(), false);
+	std::vector<unsigned int> path;
+	int current = -1;
+	for (unsigned int id = 0; id < tasks.size(); ++id) {
+		if (current < 0 || tasks[id].end > tasks[current].end) {
+			current = (int)id;
+		}
+	}
+	while (current >= 0) {
+		critical[current] = true;
+		path.push_back((unsigned int)current);
+		int latest = -1;
+		for (unsigned int dependency : tasks[current].dependencies) {
+			if (latest < 0 || tasks[dependency].end > tasks[latest].end) {
+				latest = (int)dependency;
+			}
+		}
+		current = latest;
+	}
+
+	double busy = 0.0;
+	std::cout << std::fixed << std::setprecision(2);
+	for (unsigned int id : order) {
+		const Task& task = tasks[id];
+		busy += task.end - task.start;
+		std::cout << "INITGRAPH::" << std::setw(8) << task.start << " - " << std::setw(8) << task.end << " ms | "
+			<< (task.onMainThread ? "main  " : "worker") << " | " << (critical[id] ? "* " : "  ")
+			<< task.name << " (" << task.end - task.start << " ms)" << std::endl;
+	}
+
+	std::cout << "INITGRAPH::critical path";
+	for (unsigned int i = (unsigned int)path.size(); i > 0; --i) {
+		std::cout << (i == path.size() ? " " : " > ") << tasks[path[i - 1]].name;
+	}
+	std::cout << std::endl;
+	std::cout << "INITGRAPH::wall " << getRunTime() << " ms | task time " << busy << " ms"
+		<< " | overlap " << busy / std::max(getRunTime(), 0.001) << "x" << std::endl;
+	std::cout << std::defaultfloat << std::setprecision(6);
+}
+
+double InitGraph::sinceProcessStart() {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - processStart).count();
+}
+
+void InitGraph::dispatch(unsigned int id) {
+	// called with the mutex held
+	if (tasks[id].affinity == MAIN_THREAD) {
+		mainReady.push_back(id);
+		condition.notify_all();
+	}
+	else {
+		pool.submit([this, id] {
+			execute(id);
+			finish(id);
+		});
+	}
+}
+
+void InitGraph::execute(unsigned int id) {
+	Task& task = tasks[id];
+	task.onMainThread = std::this_thread::get_id() == mainThread;
+	task.start = sinceProcessStart();
+	task.function();
+	task.end = sinceProcessStart();
+}
+
+void InitGraph::finish(unsigned int id) {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (unsigned int dependent : tasks[id].dependents) {
+		if (--tasks[dependent].remaining == 0) {
+			dispatch(dependent);
+		}
+	}
+	++completed;
+	condition.notify_all();
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../thread-pool/ThreadPool.h"
+
+// Startup work as a graph of tasks. A task runs as soon as everything it depends
+// on is done: file reads, image decodes and other CPU work go to the thread pool,
+// anything touching GLFW or GL stays on the thread that calls run() (the one that
+// owns the context). Every task is timed, so the timeline shows what ran where
+// and which chain of tasks the startup had to wait for.
+class InitGraph {
+public:
+	enum Affinity { ANY_THREAD, MAIN_THREAD };
+
+	InitGraph(ThreadPool& pool = ThreadPool::global());
+
+	// dependencies must have been added before, so ids are always in a valid order
+	unsigned int add(const char* name, Affinity affinity, std::function<void()> task,
+		const std::vector<unsigned int>& dependencies = std::vector<unsigned int>());
+
+	// returns once every task has run. serial runs them one by one on this thread
+	// in the order they were added, for comparison
+	void run(bool serial = false);
+
+	// start/end of every task and the critical path, times since process start
+	void printTimeline() const;
+	double getRunTime() const { return runEnd - runStart; }
+
+	// ms since the process started (static initialisation, close enough)
+	static double sinceProcessStart();
+
+private:
+	struct Task {
+		std::string name;
+		Affinity affinity;
+		std::function<void()> function;
+		std::vector<unsigned int> dependencies;
+		std::vector<unsigned int> dependents;
+		unsigned int remaining; // unfinished dependencies
+		double start, end;
+		bool onMainThread;
+	};
+
+	ThreadPool& pool;
+	std::vector<Task> tasks;
+	std::thread::id mainThread;
+	double runStart, runEnd;
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<unsigned int> mainReady;
+	unsigned int completed;
+
+	void dispatch(unsigned int id);
+	void execute(unsigned int id);
+	void finish(unsigned int id);
+};
\ No newline at end of file
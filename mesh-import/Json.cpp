@@ -0,0 +1,256 @@
+#include "Json.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+const JsonValue JsonValue::null;
+
+struct JsonValue::Parser {
+	const char* p;
+	const char* end;
+	unsigned int depth;
+
+	void skipSpace() {
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+			++p;
+		}
+	}
+
+	bool literal(const char* word) {
+		size_t length = std::strlen(word);
+		if ((size_t)(end - p) < length || std::strncmp(p, word, length) != 0) {
+			return false;
+		}
+		p += length;
+		return true;
+	}
+
+	static void appendUtf8(std::string& out, unsigned int code) {
+		if (code < 0x80) {
+			out += (char)code;
+		}
+		else if (code < 0x800) {
+			out += (char)(0xC0 | (code >> 6));
+			out += (char)(0x80 | (code & 0x3F));
+		}
+		else if (code < 0x10000) {
+			out += (char)(0xE0 | (code >> 12));
+			out += (char)(0x80 | ((code >> 6) & 0x3F));
+			out += (char)(0x80 | (code & 0x3F));
+		}
+		else {
+			out += (char)(0xF0 | (code >> 18));
+			out += (char)(0x80 | ((code >> 12) & 0x3F));
+			out += (char)(0x80 | ((code >> 6) & 0x3F));
+			out += (char)(0x80 | (code & 0x3F));
+		}
+	}
+
+	bool hex4(unsigned int& code) {
+		if (end - p < 4) {
+			return false;
+		}
+		code = 0;
+		for (int i = 0; i < 4; ++i) {
+			char c = *p++;
+			code <<= 4;
+			if (c >= '0' && c <= '9') code |= c - '0';
+			else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+			else return false;
+		}
+		return true;
+	}
+
+	bool string(std::string& out) {
+		// opening quote already checked
+		++p;
+		while (p < end && *p != '"') {
+			if (*p != '\\') {
+				out += *p++;
+				continue;
+			}
+			if (++p == end) {
+				return false;
+			}
+			char c = *p++;
+			switch (c) {
+			case '"': case '\\': case '/': out += c; break;
+			case 'b': out += '\b'; break;
+			case 'f': out += '\f'; break;
+			case 'n': out += '\n'; break;
+			case 'r': out += '\r'; break;
+			case 't': out += '\t'; break;
+			case 'u': {
+				unsigned int code;
+				if (!hex4(code)) {
+					return false;
+				}
+				// surrogate pair
+				if (code >= 0xD800 && code < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+					p += 2;
+					unsigned int low;
+					if (!hex4(low)) {
+						return false;
+					}
+					code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+				}
+				appendUtf8(out, code);
+				break;
+			}
+			default:
+				return false;
+			}
+		}
+		if (p == end) {
+			return false;
+		}
+		++p;
+		return true;
+	}
+
+	bool value(JsonValue& out) {
+		skipSpace();
+		if (p == end || ++depth > 256) {
+			return false;
+		}
+		bool ok = true;
+		switch (*p) {
+		case '{':
+			out.type = TYPE_OBJECT;
+			++p;
+			skipSpace();
+			if (p < end && *p == '}') {
+				++p;
+				break;
+			}
+			while (ok) {
+				skipSpace();
+				if (p == end || *p != '"') {
+					ok = false;
+					break;
+				}
+				out.keys.emplace_back();
+				out.items.emplace_back();
+				ok = string(out.keys.back());
+				skipSpace();
+				if (!ok || p == end || *p++ != ':') {
+					ok = false;
+					break;
+				}
+				ok = value(out.items.back());
+				skipSpace();
+				if (!ok || p == end) {
+					ok = false;
+				}
+				else if (*p == ',') {
+					++p;
+				}
+				else if (*p == '}') {
+					++p;
+					break;
+				}
+				else {
+					ok = false;
+				}
+			}
+			break;
+		case '[':
+			out.type = TYPE_ARRAY;
+			++p;
+			skipSpace();
+			if (p < end && *p == ']') {
+				++p;
+				break;
+			}
+			while (ok) {
+				out.items.emplace_back();
+				ok = value(out.items.back());
+				skipSpace();
+				if (!ok || p == end) {
+					ok = false;
+				}
+				else if (*p == ',') {
+					++p;
+				}
+				else if (*p == ']') {
+					++p;
+					break;
+				}
+				else {
+					ok = false;
+				}
+			}
+			break;
+		case '"':
+			out.type = TYPE_STRING;
+			ok = string(out.string);
+			break;
+		case 't':
+			out.type = TYPE_BOOL;
+			out.boolean = true;
+			ok = literal("true");
+			break;
+		case 'f':
+			out.type = TYPE_BOOL;
+			out.boolean = false;
+			ok = literal("false");
+			break;
+		case 'n':
+			ok = literal("null");
+			break;
+		default: {
+			// strtod stops at the first character that is not part of the number,
+			// the header is small and parsed once, so it does not need the fast parser
+			std::string digits;
+			while (p < end && (std::strchr("+-.eE", *p) || (*p >= '0' && *p <= '9'))) {
+				digits += *p++;
+			}
+			char* stop;
+			out.type = TYPE_NUMBER;
+			out.number = std::strtod(digits.c_str(), &stop);
+			ok = !digits.empty() && *stop == '\0';
+			break;
+		}
+		}
+		--depth;
+		return ok;
+	}
+};
+
+JsonValue::JsonValue()
+	: type(TYPE_NULL), number(0.0), boolean(false) {
+}
+
+bool JsonValue::parse(const char* begin, const char* end, JsonValue& out) {
+	out = JsonValue();
+	Parser parser = { begin, end, 0 };
+	bool ok = parser.value(out);
+	parser.skipSpace();
+	if (!ok || parser.p != end) {
+		std::cout << "ERROR::JSON::PARSE_FAILED at byte " << parser.p - begin << std::endl;
+		out = JsonValue();
+		return false;
+	}
+	return true;
+}
+
+const JsonValue& JsonValue::operator[](const char* key) const {
+	if (type == TYPE_OBJECT) {
+		for (size_t i = 0; i < keys.size(); ++i) {
+			if (keys[i] == key) {
+				return items[i];
+			}
+		}
+	}
+	return null;
+}
+
+const JsonValue& JsonValue::at(size_t index) const {
+	return type == TYPE_ARRAY && index < items.size() ? items[index] : null;
+}
+
+bool JsonValue::has(const char* key) const {
+	return !(*this)[key].isNull();
+}
\ No newline at end of file
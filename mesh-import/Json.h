@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Just enough JSON for glTF headers: a tree of values, objects keep their
+// members in file order. Lookups of missing keys or indices give a null value,
+// so chains like gltf["meshes"].at(0)["primitives"] never need checks in between.
+class JsonValue {
+public:
+	enum Type { TYPE_NULL, TYPE_BOOL, TYPE_NUMBER, TYPE_STRING, TYPE_ARRAY, TYPE_OBJECT };
+
+	JsonValue();
+
+	// false (and an error printed) for malformed input
+	static bool parse(const char* begin, const char* end, JsonValue& out);
+
+	Type getType() const { return type; }
+	bool isNull() const { return type == TYPE_NULL; }
+
+	// members of an object, items of an array
+	const JsonValue& operator[](const char* key) const;
+	const JsonValue& at(size_t index) const;
+	bool has(const char* key) const;
+	size_t size() const { return items.size(); }
+
+	double asNumber(double fallback = 0.0) const { return type == TYPE_NUMBER ? number : fallback; }
+	int asInt(int fallback = 0) const { return type == TYPE_NUMBER ? (int)number : fallback; }
+	bool asBool(bool fallback = false) const { return type == TYPE_BOOL ? boolean : fallback; }
+	const std::string& asString() const { return string; }
+
+private:
+	Type type;
+	double number;
+	bool boolean;
+	std::string string;
+	std::vector<JsonValue> items;
+	std::vector<std::string> keys; // objects only, one per item
+
+	static const JsonValue null;
+
+	struct Parser;
+};
\ No newline at end of file
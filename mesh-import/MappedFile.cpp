@@ -0,0 +1,107 @@
+#include "MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+	: memory(NULL), length(0), file(INVALID_HANDLE_VALUE), mapping(NULL) {
+}
+
+bool MappedFile::open(const char* path) {
+	close();
+	file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	LARGE_INTEGER size;
+	if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size)) {
+		std::cout << "ERROR::MAPPEDFILE::OPEN_FAILED " << path << std::endl;
+		close();
+		return false;
+	}
+	length = (size_t)size.QuadPart;
+	if (length == 0) {
+		return true;
+	}
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	memory = mapping ? (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+	if (!memory) {
+		std::cout << "ERROR::MAPPEDFILE::MAP_FAILED " << path << std::endl;
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close() {
+	if (memory) {
+		UnmapViewOfFile(memory);
+	}
+	if (mapping) {
+		CloseHandle(mapping);
+	}
+	if (file != INVALID_HANDLE_VALUE) {
+		CloseHandle(file);
+	}
+	memory = NULL;
+	length = 0;
+	file = INVALID_HANDLE_VALUE;
+	mapping = NULL;
+}
+
+#else
+
+MappedFile::MappedFile()
+	: memory(NULL), length(0), descriptor(-1) {
+}
+
+bool MappedFile::open(const char* path) {
+	close();
+	descriptor = ::open(path, O_RDONLY);
+	struct stat info;
+	if (descriptor < 0 || fstat(descriptor, &info) != 0) {
+		std::cout << "ERROR::MAPPEDFILE::OPEN_FAILED " << path << std::endl;
+		close();
+		return false;
+	}
+	length = (size_t)info.st_size;
+	if (length == 0) {
+		return true;
+	}
+	void* view = mmap(NULL, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	if (view == MAP_FAILED) {
+		std::cout << "ERROR::MAPPEDFILE::MAP_FAILED " << path << std::endl;
+		close();
+		return false;
+	}
+	// every parser thread reads its own range front to back
+	madvise(view, length, MADV_SEQUENTIAL);
+	memory = (const char*)view;
+	return true;
+}
+
+void MappedFile::close() {
+	if (memory) {
+		munmap((void*)memory, length);
+	}
+	if (descriptor >= 0) {
+		::close(descriptor);
+	}
+	memory = NULL;
+	length = 0;
+	descriptor = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
\ No newline at end of file
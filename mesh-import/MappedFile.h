@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+// Read only view of a whole file. The file is mapped into memory instead of
+// read into a buffer, so nothing is copied and pages come in as they are
+// touched, by whichever thread touches them first.
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const char* path);
+	void close();
+
+	const char* data() const { return memory; }
+	size_t size() const { return length; }
+
+private:
+	const char* memory;
+	size_t length;
+#ifdef _WIN32
+	void* file;
+	void* mapping;
+#else
+	int descriptor;
+#endif
+};
\ No newline at end of file
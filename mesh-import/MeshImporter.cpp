@@ -0,0 +1,785 @@
+#include "MeshImporter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "Json.h"
+#include "MappedFile.h"
+
+namespace {
+	const unsigned int CHUNKS_PER_THREAD = 4;
+	// below this a chunk costs more to hand out than to parse
+	const size_t MIN_CHUNK_BYTES = 256 * 1024;
+	const size_t MIN_CHUNK_ITEMS = 64 * 1024;
+
+	const uint32_t NO_TEXCOORD = 0xFFFFFFFE;
+	const uint32_t UNREFERENCED = 0xFFFFFFFF;
+	const uint32_t SEAM = 0xFFFFFFFF;
+
+	// one triangle corner of an OBJ face, indices already resolved to 0 based
+	struct Corner {
+		uint32_t position;
+		uint32_t texcoord;
+	};
+
+	// a range of the file, whole lines only
+	struct ObjChunk {
+		const char* begin;
+		const char* end;
+		uint32_t positions, texcoords, triangles;
+		uint32_t positionBase, texcoordBase, triangleBase;
+		bool error;
+	};
+
+	double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	bool isSpace(char c) {
+		return c == ' ' || c == '\t';
+	}
+
+	bool isLineEnd(char c) {
+		return c == '\n' || c == '\r' || c == '#';
+	}
+
+	const char* skipSpace(const char* p, const char* end) {
+		while (p < end && isSpace(*p)) {
+			++p;
+		}
+		return p;
+	}
+
+	const char* nextLine(const char* p, const char* end) {
+		const char* newline = (const char*)std::memchr(p, '\n', end - p);
+		return newline ? newline + 1 : end;
+	}
+
+	// signed OBJ index, returns start when there is none
+	const char* parseIndex(const char* start, const char* end, int64_t& value) {
+		const char* p = start;
+		bool negative = p < end && *p == '-';
+		if (negative) {
+			++p;
+		}
+		const char* digits = p;
+		value = 0;
+		while (p < end && *p >= '0' && *p <= '9') {
+			value = value * 10 + (*p - '0');
+			++p;
+		}
+		if (p == digits) {
+			return start;
+		}
+		value = negative ? -value : value;
+		return p;
+	}
+
+	// 1 based or negative (relative to the count so far) to 0 based
+	// (0 is not a valid index, out of range becomes UNREFERENCED and fails the range check later)
+	uint32_t resolveIndex(int64_t index, uint32_t countSoFar) {
+		int64_t resolved = index > 0 ? index - 1 : index < 0 ? (int64_t)countSoFar + index : -1;
+		return resolved >= 0 && resolved < (int64_t)NO_TEXCOORD ? (uint32_t)resolved : UNREFERENCED;
+	}
+
+	// faces count their corners on the first pass, a polygon of n corners is n - 2 triangles
+	unsigned int faceTriangles(const char* p, const char* end) {
+		unsigned int corners = 0;
+		bool inToken = false;
+		while (p < end && !isLineEnd(*p)) {
+			bool space = isSpace(*p);
+			corners += !space && !inToken;
+			inToken = !space;
+			++p;
+		}
+		return corners >= 3 ? corners - 2 : 0;
+	}
+
+	void countObjChunk(ObjChunk& chunk) {
+		chunk.positions = chunk.texcoords = chunk.triangles = 0;
+		for (const char* p = chunk.begin; p < chunk.end; p = nextLine(p, chunk.end)) {
+			p = skipSpace(p, chunk.end);
+			if (chunk.end - p < 2) {
+				continue;
+			}
+			if (p[0] == 'v' && isSpace(p[1])) {
+				++chunk.positions;
+			}
+			else if (p[0] == 'v' && p[1] == 't' && chunk.end - p > 2 && isSpace(p[2])) {
+				++chunk.texcoords;
+			}
+			else if (p[0] == 'f' && isSpace(p[1])) {
+				chunk.triangles += faceTriangles(p + 2, chunk.end);
+			}
+		}
+	}
+
+	// the second pass writes to the ranges the first pass counted
+	void parseObjChunk(ObjChunk& chunk, float* positions, float* texcoords, Corner* corners) {
+		float* position = positions + (size_t)chunk.positionBase * 3;
+		float* texcoord = texcoords + (size_t)chunk.texcoordBase * 2;
+		Corner* corner = corners + (size_t)chunk.triangleBase * 3;
+		uint32_t positionCount = chunk.positionBase, texcoordCount = chunk.texcoordBase;
+		const char* end = chunk.end;
+		chunk.error = false;
+
+		for (const char* p = chunk.begin; p < end; p = nextLine(p, end)) {
+			p = skipSpace(p, end);
+			if (end - p < 2) {
+				continue;
+			}
+			if (p[0] == 'v' && isSpace(p[1])) {
+				p += 2;
+				for (int i = 0; i < 3; ++i) {
+					const char* number = skipSpace(p, end);
+					p = MeshImporter::parseFloat(number, end, position[i]);
+					chunk.error |= p == number;
+				}
+				position += 3;
+				++positionCount;
+			}
+			else if (p[0] == 'v' && p[1] == 't' && end - p > 2 && isSpace(p[2])) {
+				p += 3;
+				const char* number = skipSpace(p, end);
+				p = MeshImporter::parseFloat(number, end, texcoord[0]);
+				chunk.error |= p == number;
+				// v is optional
+				number = skipSpace(p, end);
+				if (MeshImporter::parseFloat(number, end, texcoord[1]) == number) {
+					texcoord[1] = 0.0f;
+				}
+				texcoord += 2;
+				++texcoordCount;
+			}
+			else if (p[0] == 'f' && isSpace(p[1])) {
+				unsigned int triangles = faceTriangles(p + 2, end);
+				p += 2;
+				// fan around the first corner: 0 1 2, 0 2 3, ...
+				Corner first = Corner(), previous = Corner();
+				for (unsigned int i = 0; i < triangles + 2; ++i) {
+					Corner current;
+					int64_t index;
+					p = skipSpace(p, end);
+					const char* token = p;
+					p = parseIndex(p, end, index);
+					chunk.error |= p == token;
+					current.position = resolveIndex(index, positionCount);
+					current.texcoord = NO_TEXCOORD;
+					if (p < end && *p == '/') {
+						++p;
+						const char* texcoordIndex = p;
+						p = parseIndex(p, end, index);
+						if (p != texcoordIndex) {
+							current.texcoord = resolveIndex(index, texcoordCount);
+						}
+					}
+					// the normal index, not used
+					while (p < end && !isSpace(*p) && !isLineEnd(*p)) {
+						++p;
+					}
+
+					if (i == 0) {
+						first = current;
+					}
+					else if (i >= 2) {
+						corner[0] = first;
+						corner[1] = previous;
+						corner[2] = current;
+						corner += 3;
+					}
+					previous = current;
+				}
+			}
+		}
+	}
+
+	// GL component types glTF uses
+	size_t componentBytes(int componentType) {
+		switch (componentType) {
+		case GL_BYTE: case GL_UNSIGNED_BYTE: return 1;
+		case GL_SHORT: case GL_UNSIGNED_SHORT: return 2;
+		case GL_UNSIGNED_INT: case GL_FLOAT: return 4;
+		default: return 0;
+		}
+	}
+
+	float readComponent(const unsigned char* p, int componentType, bool normalized) {
+		switch (componentType) {
+		case GL_FLOAT: { float value; std::memcpy(&value, p, 4); return value; }
+		case GL_UNSIGNED_BYTE: return normalized ? *p / 255.0f : *p;
+		case GL_UNSIGNED_SHORT: { uint16_t value; std::memcpy(&value, p, 2); return normalized ? value / 65535.0f : value; }
+		case GL_BYTE: { int8_t value = (int8_t)*p; return normalized ? std::max(value / 127.0f, -1.0f) : value; }
+		case GL_SHORT: { int16_t value; std::memcpy(&value, p, 2); return normalized ? std::max(value / 32767.0f, -1.0f) : value; }
+		default: return 0.0f;
+		}
+	}
+
+	uint32_t readIndex(const unsigned char* p, int componentType) {
+		switch (componentType) {
+		case GL_UNSIGNED_BYTE: return *p;
+		case GL_UNSIGNED_SHORT: { uint16_t value; std::memcpy(&value, p, 2); return value; }
+		default: { uint32_t value; std::memcpy(&value, p, 4); return value; }
+		}
+	}
+
+	// a glTF accessor resolved to memory
+	struct Accessor {
+		const unsigned char* data;
+		size_t stride;
+		uint32_t count;
+		int componentType;
+		unsigned int components;
+		bool normalized;
+	};
+
+	struct GltfBuffer {
+		const unsigned char* data;
+		size_t size;
+	};
+
+	bool resolveAccessor(const JsonValue& gltf, int index, const std::vector<GltfBuffer>& buffers, Accessor& out) {
+		const JsonValue& accessor = gltf["accessors"].at(index);
+		const std::string& type = accessor["type"].asString();
+		out.components = type == "SCALAR" ? 1 : type == "VEC2" ? 2 : type == "VEC3" ? 3 : type == "VEC4" ? 4 : 0;
+		out.componentType = accessor["componentType"].asInt();
+		out.count = (uint32_t)accessor["count"].asNumber();
+		out.normalized = accessor["normalized"].asBool();
+		size_t elementBytes = componentBytes(out.componentType) * out.components;
+		if (accessor.isNull() || elementBytes == 0 || accessor.has("sparse") || !accessor.has("bufferView")) {
+			std::cout << "ERROR::MESHIMPORTER::GLTF_ACCESSOR_UNSUPPORTED " << index << std::endl;
+			return false;
+		}
+
+		const JsonValue& view = gltf["bufferViews"].at(accessor["bufferView"].asInt());
+		int buffer = view["buffer"].asInt(-1);
+		size_t viewOffset = (size_t)view["byteOffset"].asNumber();
+		size_t viewLength = (size_t)view["byteLength"].asNumber();
+		size_t offset = (size_t)accessor["byteOffset"].asNumber();
+		out.stride = view.has("byteStride") ? (size_t)view["byteStride"].asNumber() : elementBytes;
+		size_t needed = out.count == 0 ? 0 : offset + out.stride * (out.count - 1) + elementBytes;
+		if (buffer < 0 || buffer >= (int)buffers.size() || viewOffset + viewLength > buffers[buffer].size || needed > viewLength) {
+			std::cout << "ERROR::MESHIMPORTER::GLTF_ACCESSOR_OUT_OF_RANGE " << index << std::endl;
+			return false;
+		}
+		out.data = buffers[buffer].data + viewOffset + offset;
+		return true;
+	}
+}
+
+MeshImporter::MeshImporter(ThreadPool& pool)
+	: pool(pool), threadCount(0), mapTime(0.0), countTime(0.0), parseTime(0.0), dedupTime(0.0), writeTime(0.0),
+	fileBytes(0), vertexCount(0), indexCount(0), seamCount(0) {
+}
+
+bool MeshImporter::load(const std::string& path, ImportedMesh& mesh) {
+	mapTime = countTime = parseTime = dedupTime = writeTime = 0.0;
+	fileBytes = 0;
+	vertexCount = indexCount = seamCount = 0;
+	mesh = ImportedMesh();
+
+	auto start = std::chrono::high_resolution_clock::now();
+	MappedFile file;
+	if (!file.open(path.c_str())) {
+		return false;
+	}
+	fileBytes = file.size();
+	mapTime = elapsedMs(start);
+
+	std::string extension = path.substr(path.find_last_of('.') + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	bool loaded;
+	if (extension == "obj") {
+		loaded = loadObj(file.data(), file.size(), mesh);
+	}
+	else if (extension == "gltf" || extension == "glb") {
+		loaded = loadGltf(path, file.data(), file.size(), extension == "glb", mesh);
+	}
+	else {
+		std::cout << "ERROR::MESHIMPORTER::UNKNOWN_FORMAT " << path << std::endl;
+		return false;
+	}
+	if (!loaded) {
+		std::cout << "ERROR::MESHIMPORTER::LOAD_FAILED " << path << std::endl;
+		mesh = ImportedMesh();
+		return false;
+	}
+	vertexCount = mesh.vertexCount;
+	indexCount = mesh.indexCount;
+	return true;
+}
+
+double MeshImporter::getThroughput() const {
+	double total = getTotalTime();
+	return total > 0.0 ? fileBytes / (1024.0 * 1024.0) / (total / 1000.0) : 0.0;
+}
+
+void MeshImporter::printStats() const {
+	std::cout << "MESHIMPORTER::" << fileBytes / (1024.0 * 1024.0) << " MB on " << threads() << " thread(s)"
+		<< " | map " << mapTime << " ms | count " << countTime << " ms | parse " << parseTime
+		<< " ms | dedup " << dedupTime << " ms | write " << writeTime << " ms"
+		<< " | " << getThroughput() << " MB/s"
+		<< " | " << vertexCount << " vertices (" << seamCount << " seams), " << indexCount / 3 << " triangles" << std::endl;
+}
+
+const char* MeshImporter::parseFloat(const char* start, const char* end, float& value) {
+	// exact in a double, so one multiply or divide rounds correctly
+	static const double POWERS[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	const char* p = start;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		++p;
+	}
+
+	// up to 19 significant digits in an integer, the rest only moves the exponent
+	uint64_t mantissa = 0;
+	int exponent = 0;
+	int digits = 0;
+	bool any = false;
+	while (p < end && *p >= '0' && *p <= '9') {
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (*p - '0');
+			digits += mantissa != 0;
+		}
+		else {
+			++exponent;
+		}
+		any = true;
+		++p;
+	}
+	if (p < end && *p == '.') {
+		++p;
+		while (p < end && *p >= '0' && *p <= '9') {
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				digits += mantissa != 0;
+				--exponent;
+			}
+			any = true;
+			++p;
+		}
+	}
+	if (!any) {
+		return start;
+	}
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		const char* q = p + 1;
+		bool negativeExponent = false;
+		if (q < end && (*q == '-' || *q == '+')) {
+			negativeExponent = *q == '-';
+			++q;
+		}
+		if (q < end && *q >= '0' && *q <= '9') {
+			int written = 0;
+			while (q < end && *q >= '0' && *q <= '9') {
+				written = std::min(written * 10 + (*q - '0'), 10000);
+				++q;
+			}
+			exponent += negativeExponent ? -written : written;
+			p = q;
+		}
+	}
+
+	double result = (double)mantissa;
+	if (mantissa < (1ull << 53) && exponent >= -22 && exponent <= 22) {
+		result = exponent < 0 ? result / POWERS[-exponent] : result * POWERS[exponent];
+	}
+	else if (mantissa != 0) {
+		result *= std::pow(10.0, exponent);
+	}
+	value = (float)(negative ? -result : result);
+	return p;
+}
+
+unsigned int MeshImporter::threads() const {
+	unsigned int available = pool.getConcurrency();
+	return threadCount == 0 ? available : std::max(1u, std::min(threadCount, available));
+}
+
+unsigned int MeshImporter::chunkCount(size_t items, size_t minimumItems) const {
+	unsigned int count = threads() == 1 ? 1 : threads() * CHUNKS_PER_THREAD;
+	return (unsigned int)std::max<size_t>(1, std::min<size_t>(count, items / minimumItems));
+}
+
+void MeshImporter::forEachChunk(unsigned int chunks, const std::function<void(unsigned int)>& fn) {
+	// one pool job per thread, each takes the next chunk until none are left,
+	// so a slow chunk does not hold up the others and no more threads than asked join in
+	std::atomic<unsigned int> next(0);
+	unsigned int workers = std::min(threads(), chunks);
+	pool.parallelFor(workers, 1, [&](unsigned int, unsigned int) {
+		unsigned int chunk;
+		while ((chunk = next.fetch_add(1)) < chunks) {
+			fn(chunk);
+		}
+	});
+}
+
+bool MeshImporter::loadObj(const char* data, size_t size, ImportedMesh& mesh) {
+	// split at line breaks
+	auto start = std::chrono::high_resolution_clock::now();
+	const char* end = data + size;
+	unsigned int chunkTotal = chunkCount(size, MIN_CHUNK_BYTES);
+	std::vector<ObjChunk> chunks(chunkTotal);
+	const char* begin = data;
+	for (unsigned int i = 0; i < chunkTotal; ++i) {
+		const char* split = i + 1 == chunkTotal ? end : std::max(begin, data + size / chunkTotal * (i + 1));
+		chunks[i].begin = begin;
+		chunks[i].end = split == end ? end : nextLine(split, end);
+		begin = chunks[i].end;
+	}
+
+	// first pass: how much each chunk holds, then where its output goes
+	forEachChunk(chunkTotal, [&](unsigned int i) {
+		countObjChunk(chunks[i]);
+	});
+	uint64_t positionCount = 0, texcoordCount = 0, triangleCount = 0;
+	for (ObjChunk& chunk : chunks) {
+		chunk.positionBase = (uint32_t)positionCount;
+		chunk.texcoordBase = (uint32_t)texcoordCount;
+		chunk.triangleBase = (uint32_t)triangleCount;
+		positionCount += chunk.positions;
+		texcoordCount += chunk.texcoords;
+		triangleCount += chunk.triangles;
+	}
+	if (positionCount >= UNREFERENCED - 1 || texcoordCount >= NO_TEXCOORD || triangleCount * 3 >= UNREFERENCED) {
+		std::cout << "ERROR::MESHIMPORTER::OBJ_TOO_LARGE " << triangleCount << " triangles" << std::endl;
+		return false;
+	}
+	countTime = elapsedMs(start);
+
+	// second pass: parse straight into arrays of the final size
+	start = std::chrono::high_resolution_clock::now();
+	std::unique_ptr<float[]> positions(new float[positionCount * 3]);
+	std::unique_ptr<float[]> texcoords(new float[texcoordCount * 2]);
+	size_t cornerCount = (size_t)triangleCount * 3;
+	std::unique_ptr<Corner[]> corners(new Corner[cornerCount]);
+	forEachChunk(chunkTotal, [&](unsigned int i) {
+		parseObjChunk(chunks[i], positions.get(), texcoords.get(), corners.get());
+	});
+	for (const ObjChunk& chunk : chunks) {
+		if (chunk.error) {
+			std::cout << "ERROR::MESHIMPORTER::OBJ_PARSE_FAILED in bytes " << chunk.begin - data
+				<< " to " << chunk.end - data << std::endl;
+			return false;
+		}
+	}
+	parseTime = elapsedMs(start);
+
+	// dedup: every position becomes one vertex with the smallest texcoord index it is used
+	// with, the min is the same whatever order the threads run in
+	start = std::chrono::high_resolution_clock::now();
+	std::unique_ptr<std::atomic<uint32_t>[]> firstTexcoord(new std::atomic<uint32_t>[positionCount]);
+	std::unique_ptr<uint32_t[]> vertexOf(new uint32_t[positionCount]);
+	unsigned int positionChunks = chunkCount(positionCount, MIN_CHUNK_ITEMS);
+	unsigned int cornerChunks = chunkCount(cornerCount, MIN_CHUNK_ITEMS);
+	auto chunkRange = [](size_t count, unsigned int chunkCount, unsigned int i, size_t& first, size_t& last) {
+		first = count * i / chunkCount;
+		last = count * (i + 1) / chunkCount;
+	};
+
+	forEachChunk(positionChunks, [&](unsigned int i) {
+		size_t first, last;
+		chunkRange(positionCount, positionChunks, i, first, last);
+		for (size_t p = first; p < last; ++p) {
+			firstTexcoord[p].store(UNREFERENCED, std::memory_order_relaxed);
+		}
+	});
+	std::atomic<bool> outOfRange(false);
+	forEachChunk(cornerChunks, [&](unsigned int i) {
+		size_t first, last;
+		chunkRange(cornerCount, cornerChunks, i, first, last);
+		for (size_t c = first; c < last; ++c) {
+			const Corner& corner = corners[c];
+			if (corner.position >= positionCount || (corner.texcoord != NO_TEXCOORD && corner.texcoord >= texcoordCount)) {
+				outOfRange.store(true, std::memory_order_relaxed);
+				continue;
+			}
+			std::atomic<uint32_t>& slot = firstTexcoord[corner.position];
+			uint32_t current = slot.load(std::memory_order_relaxed);
+			while (corner.texcoord < current && !slot.compare_exchange_weak(current, corner.texcoord, std::memory_order_relaxed)) {
+			}
+		}
+	});
+	if (outOfRange.load()) {
+		std::cout << "ERROR::MESHIMPORTER::OBJ_INDEX_OUT_OF_RANGE" << std::endl;
+		return false;
+	}
+
+	// vertex ids of the positions in file order, unused positions get none
+	std::vector<uint32_t> referencedBase(positionChunks + 1, 0);
+	forEachChunk(positionChunks, [&](unsigned int i) {
+		size_t first, last;
+		chunkRange(positionCount, positionChunks, i, first, last);
+		uint32_t referenced = 0;
+		for (size_t p = first; p < last; ++p) {
+			referenced += firstTexcoord[p].load(std::memory_order_relaxed) != UNREFERENCED;
+		}
+		referencedBase[i + 1] = referenced;
+	});
+	for (unsigned int i = 0; i < positionChunks; ++i) {
+		referencedBase[i + 1] += referencedBase[i];
+	}
+	uint32_t primaryCount = referencedBase[positionChunks];
+	forEachChunk(positionChunks, [&](unsigned int i) {
+		size_t first, last;
+		chunkRange(positionCount, positionChunks, i, first, last);
+		uint32_t id = referencedBase[i];
+		for (size_t p = first; p < last; ++p) {
+			vertexOf[p] = firstTexcoord[p].load(std::memory_order_relaxed) != UNREFERENCED ? id++ : UNREFERENCED;
+		}
+	});
+
+	// indices go straight into the mesh, corners with a second texcoord are left for the seam pass
+	mesh.indexCount = (unsigned int)cornerCount;
+	mesh.indices.reset(new unsigned int[cornerCount]);
+	std::vector<std::vector<uint32_t>> seamCorners(cornerChunks);
+	forEachChunk(cornerChunks, [&](unsigned int i) {
+		size_t first, last;
+		chunkRange(cornerCount, cornerChunks, i, first, last);
+		for (size_t c = first; c < last; ++c) {
+			const Corner& corner = corners[c];
+			if (corner.texcoord == firstTexcoord[corner.position].load(std::memory_order_relaxed)) {
+				mesh.indices[c] = vertexOf[corner.position];
+			}
+			else {
+				mesh.indices[c] = SEAM;
+				seamCorners[i].push_back((uint32_t)c);
+			}
+		}
+	});
+
+	// seams are few, one hash map in chunk order keeps the ids deterministic
+	size_t seamCornerCount = 0;
+	for (const std::vector<uint32_t>& list : seamCorners) {
+		seamCornerCount += list.size();
+	}
+	std::vector<Corner> seamVertices;
+	std::unordered_map<uint64_t, uint32_t> seamIds;
+	seamIds.reserve(seamCornerCount);
+	for (const std::vector<uint32_t>& list : seamCorners) {
+		for (uint32_t c : list) {
+			const Corner& corner = corners[c];
+			uint64_t key = ((uint64_t)corner.position << 32) | corner.texcoord;
+			auto inserted = seamIds.insert({ key, primaryCount + (uint32_t)seamVertices.size() });
+			if (inserted.second) {
+				seamVertices.push_back(corner);
+			}
+			mesh.indices[c] = inserted.first->second;
+		}
+	}
+	seamCount = (unsigned int)seamVertices.size();
+	dedupTime = elapsedMs(start);
+
+	// write the vertices in the engine format
+	start = std::chrono::high_resolution_clock::now();
+	mesh.vertexCount = primaryCount + seamCount;
+	mesh.vertices.reset(new float[(size_t)mesh.vertexCount * GeometryHeap::VERTEX_FLOATS]);
+	auto writeVertex = [&](uint32_t id, uint32_t position, uint32_t texcoord) {
+		float* vertex = &mesh.vertices[(size_t)id * GeometryHeap::VERTEX_FLOATS];
+		const float* source = &positions[(size_t)position * 3];
+		vertex[0] = source[0];
+		vertex[1] = source[1];
+		vertex[2] = source[2];
+		vertex[3] = texcoord == NO_TEXCOORD ? 0.0f : texcoords[(size_t)texcoord * 2];
+		vertex[4] = texcoord == NO_TEXCOORD ? 0.0f : texcoords[(size_t)texcoord * 2 + 1];
+	};
+	forEachChunk(positionChunks, [&](unsigned int i) {
+		size_t first, last;
+		chunkRange(positionCount, positionChunks, i, first, last);
+		for (size_t p = first; p < last; ++p) {
+			if (vertexOf[p] != UNREFERENCED) {
+				writeVertex(vertexOf[p], (uint32_t)p, firstTexcoord[p].load(std::memory_order_relaxed));
+			}
+		}
+	});
+	unsigned int seamChunks = chunkCount(seamCount, MIN_CHUNK_ITEMS);
+	forEachChunk(seamChunks, [&](unsigned int i) {
+		size_t first, last;
+		chunkRange(seamCount, seamChunks, i, first, last);
+		for (size_t s = first; s < last; ++s) {
+			writeVertex(primaryCount + (uint32_t)s, seamVertices[s].position, seamVertices[s].texcoord);
+		}
+	});
+	writeTime = elapsedMs(start);
+	return true;
+}
+
+bool MeshImporter::loadGltf(const std::string& path, const char* data, size_t size, bool binary, ImportedMesh& mesh) {
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// .glb: 12 byte header, then a JSON chunk and an optional binary chunk
+	const char* json = data;
+	size_t jsonSize = size;
+	GltfBuffer embedded = { NULL, 0 };
+	if (binary) {
+		uint32_t header[3], chunkHeader[2];
+		if (size < 20) {
+			std::cout << "ERROR::MESHIMPORTER::GLB_TRUNCATED" << std::endl;
+			return false;
+		}
+		std::memcpy(header, data, 12);
+		std::memcpy(chunkHeader, data + 12, 8);
+		if (header[0] != 0x46546C67 || header[1] != 2 || chunkHeader[1] != 0x4E4F534A || 20 + (size_t)chunkHeader[0] > size) {
+			std::cout << "ERROR::MESHIMPORTER::GLB_BAD_HEADER" << std::endl;
+			return false;
+		}
+		json = data + 20;
+		jsonSize = chunkHeader[0];
+		size_t binOffset = 20 + (size_t)chunkHeader[0];
+		if (binOffset + 8 <= size) {
+			std::memcpy(chunkHeader, data + binOffset, 8);
+			if (chunkHeader[1] == 0x004E4942 && binOffset + 8 + chunkHeader[0] <= size) {
+				embedded.data = (const unsigned char*)data + binOffset + 8;
+				embedded.size = chunkHeader[0];
+			}
+		}
+	}
+
+	JsonValue gltf;
+	if (!JsonValue::parse(json, json + jsonSize, gltf)) {
+		return false;
+	}
+
+	// buffers: the .glb binary chunk or files next to the .gltf, mapped like the file itself
+	std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+	const JsonValue& bufferList = gltf["buffers"];
+	std::vector<std::unique_ptr<MappedFile>> files;
+	std::vector<GltfBuffer> buffers;
+	for (size_t i = 0; i < bufferList.size(); ++i) {
+		const JsonValue& buffer = bufferList.at(i);
+		if (!buffer.has("uri")) {
+			buffers.push_back(embedded);
+			continue;
+		}
+		const std::string& uri = buffer["uri"].asString();
+		if (uri.compare(0, 5, "data:") == 0) {
+			std::cout << "ERROR::MESHIMPORTER::GLTF_DATA_URI_UNSUPPORTED buffer " << i << std::endl;
+			return false;
+		}
+		files.emplace_back(new MappedFile());
+		if (!files.back()->open((directory + uri).c_str())) {
+			return false;
+		}
+		buffers.push_back({ (const unsigned char*)files.back()->data(), files.back()->size() });
+		fileBytes += files.back()->size();
+	}
+
+	// every triangle primitive of every mesh, appended one after the other
+	struct Primitive {
+		Accessor positions, texcoords, indices;
+		bool hasTexcoords, hasIndices;
+		uint32_t baseVertex, firstIndex;
+	};
+	std::vector<Primitive> primitives;
+	uint64_t totalVertices = 0, totalIndices = 0;
+	const JsonValue& meshes = gltf["meshes"];
+	for (size_t m = 0; m < meshes.size(); ++m) {
+		const JsonValue& primitiveList = meshes.at(m)["primitives"];
+		for (size_t p = 0; p < primitiveList.size(); ++p) {
+			const JsonValue& source = primitiveList.at(p);
+			const JsonValue& attributes = source["attributes"];
+			if (source["mode"].asInt(GL_TRIANGLES) != GL_TRIANGLES || !attributes.has("POSITION")) {
+				continue;
+			}
+			Primitive primitive;
+			if (!resolveAccessor(gltf, attributes["POSITION"].asInt(), buffers, primitive.positions)) {
+				return false;
+			}
+			primitive.hasTexcoords = attributes.has("TEXCOORD_0");
+			if (primitive.hasTexcoords && !resolveAccessor(gltf, attributes["TEXCOORD_0"].asInt(), buffers, primitive.texcoords)) {
+				return false;
+			}
+			primitive.hasIndices = source.has("indices");
+			if (primitive.hasIndices && !resolveAccessor(gltf, source["indices"].asInt(), buffers, primitive.indices)) {
+				return false;
+			}
+			if (primitive.positions.components != 3 || (primitive.hasTexcoords && primitive.texcoords.components != 2)
+				|| (primitive.hasTexcoords && primitive.texcoords.count < primitive.positions.count)) {
+				std::cout << "ERROR::MESHIMPORTER::GLTF_BAD_ATTRIBUTES mesh " << m << std::endl;
+				return false;
+			}
+			primitive.baseVertex = (uint32_t)totalVertices;
+			primitive.firstIndex = (uint32_t)totalIndices;
+			totalVertices += primitive.positions.count;
+			totalIndices += primitive.hasIndices ? primitive.indices.count : primitive.positions.count;
+			primitives.push_back(primitive);
+		}
+	}
+	if (totalVertices >= UNREFERENCED || totalIndices >= UNREFERENCED) {
+		std::cout << "ERROR::MESHIMPORTER::GLTF_TOO_LARGE " << totalIndices << " indices" << std::endl;
+		return false;
+	}
+	countTime = elapsedMs(start);
+
+	// convert to the engine format, every primitive split into chunks
+	start = std::chrono::high_resolution_clock::now();
+	mesh.vertexCount = (unsigned int)totalVertices;
+	mesh.vertices.reset(new float[(size_t)mesh.vertexCount * GeometryHeap::VERTEX_FLOATS]);
+	mesh.indexCount = (unsigned int)totalIndices;
+	mesh.indices.reset(new unsigned int[mesh.indexCount]);
+	for (const Primitive& primitive : primitives) {
+		unsigned int chunks = chunkCount(primitive.positions.count, MIN_CHUNK_ITEMS);
+		forEachChunk(chunks, [&](unsigned int i) {
+			size_t first = (size_t)primitive.positions.count * i / chunks;
+			size_t last = (size_t)primitive.positions.count * (i + 1) / chunks;
+			const Accessor& positions = primitive.positions;
+			const Accessor& texcoords = primitive.texcoords;
+			size_t positionBytes = componentBytes(positions.componentType);
+			size_t texcoordBytes = primitive.hasTexcoords ? componentBytes(texcoords.componentType) : 0;
+			for (size_t v = first; v < last; ++v) {
+				float* vertex = &mesh.vertices[((size_t)primitive.baseVertex + v) * GeometryHeap::VERTEX_FLOATS];
+				const unsigned char* position = positions.data + v * positions.stride;
+				for (int c = 0; c < 3; ++c) {
+					vertex[c] = readComponent(position + c * positionBytes, positions.componentType, positions.normalized);
+				}
+				if (primitive.hasTexcoords) {
+					// glTF puts the texture origin top left
+					const unsigned char* texcoord = texcoords.data + v * texcoords.stride;
+					vertex[3] = readComponent(texcoord, texcoords.componentType, texcoords.normalized);
+					vertex[4] = 1.0f - readComponent(texcoord + texcoordBytes, texcoords.componentType, texcoords.normalized);
+				}
+				else {
+					vertex[3] = vertex[4] = 0.0f;
+				}
+			}
+		});
+	}
+	parseTime = elapsedMs(start);
+
+	start = std::chrono::high_resolution_clock::now();
+	std::atomic<bool> outOfRange(false);
+	for (const Primitive& primitive : primitives) {
+		uint32_t count = primitive.hasIndices ? primitive.indices.count : primitive.positions.count;
+		unsigned int chunks = chunkCount(count, MIN_CHUNK_ITEMS);
+		forEachChunk(chunks, [&](unsigned int i) {
+			size_t first = (size_t)count * i / chunks;
+			size_t last = (size_t)count * (i + 1) / chunks;
+			unsigned int* out = &mesh.indices[primitive.firstIndex];
+			const Accessor& indices = primitive.indices;
+			for (size_t n = first; n < last; ++n) {
+				uint32_t index = primitive.hasIndices ? readIndex(indices.data + n * indices.stride, indices.componentType) : (uint32_t)n;
+				if (index >= primitive.positions.count) {
+					outOfRange.store(true, std::memory_order_relaxed);
+					index = 0;
+				}
+				out[n] = primitive.baseVertex + index;
+			}
+		});
+	}
+	if (outOfRange.load()) {
+		std::cout << "ERROR::MESHIMPORTER::GLTF_INDEX_OUT_OF_RANGE" << std::endl;
+		return false;
+	}
+	writeTime = elapsedMs(start);
+	return true;
+}
\ No newline at end of file
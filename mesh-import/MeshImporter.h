@@ -0,0 +1,74 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "../geometry-heap/GeometryHeap.h"
+#include "../thread-pool/ThreadPool.h"
+
+// triangles in the GeometryHeap vertex format, ready for addMesh()
+struct ImportedMesh {
+	// GeometryHeap::VERTEX_FLOATS per vertex: position, texture coords.
+	// plain arrays, so allocating a few GB does not also mean zero filling them
+	std::unique_ptr<float[]> vertices;
+	unsigned int vertexCount;
+	std::unique_ptr<unsigned int[]> indices;
+	unsigned int indexCount;
+
+	ImportedMesh() : vertexCount(0), indexCount(0) {}
+};
+
+// Loads OBJ and glTF 2.0 (.gltf + .bin, .glb) files into one indexed mesh.
+// The file is memory mapped, never read into a buffer.
+// OBJ is split into chunks at line breaks and parsed in two parallel passes:
+// the first counts the v/vt/f lines of every chunk, so every array gets its
+// final size once and the second pass writes each chunk straight to its own
+// range. Vertices are then deduplicated by their position/texcoord pair: the
+// smallest texcoord index seen with a position wins, and only corners with
+// another texcoord (UV seams) go through a hash map. Normals, materials and
+// groups are skipped, the vertex format has no place for them.
+// glTF is already indexed, accessors are converted in parallel; node
+// transforms and non triangle primitives are ignored, texture coords are
+// flipped to the bottom left origin the rest of the code uses.
+class MeshImporter {
+public:
+	MeshImporter(ThreadPool& pool = ThreadPool::global());
+
+	// .obj, .gltf or .glb by extension
+	bool load(const std::string& path, ImportedMesh& mesh);
+
+	// threads one import uses at most, 0 = the whole pool
+	void setThreadCount(unsigned int threads) { threadCount = threads; }
+
+	// last import
+	size_t getFileBytes() const { return fileBytes; }
+	double getTotalTime() const { return mapTime + countTime + parseTime + dedupTime + writeTime; }
+	// file MB per second of the whole import
+	double getThroughput() const;
+	unsigned int getVertexCount() const { return vertexCount; }
+	unsigned int getTriangleCount() const { return indexCount / 3; }
+	void printStats() const;
+
+	// decimal number as written by exporters; returns where the number ended, start on failure
+	static const char* parseFloat(const char* start, const char* end, float& value);
+
+private:
+	ThreadPool& pool;
+	unsigned int threadCount;
+
+	// stages of the last import, ms
+	double mapTime, countTime, parseTime, dedupTime, writeTime;
+	size_t fileBytes;
+	unsigned int vertexCount, indexCount;
+	unsigned int seamCount; // OBJ vertices that share their position with another texcoord
+
+	// run fn(chunk) for every chunk on at most threadCount threads, chunks are handed out one by one
+	void forEachChunk(unsigned int chunks, const std::function<void(unsigned int)>& fn);
+
+	bool loadObj(const char* data, size_t size, ImportedMesh& mesh);
+	bool loadGltf(const std::string& path, const char* data, size_t size, bool binary, ImportedMesh& mesh);
+	// chunks to split items into, a few per thread but none smaller than minimumItems
+	unsigned int chunkCount(size_t items, size_t minimumItems) const;
+	unsigned int threads() const;
+};
\ No newline at end of file
@@ -0,0 +1,210 @@
+// mesh import benchmark, runs without a GL context
+// imports an OBJ file on 1, 2, 4 ... threads and prints the parse throughput, then writes the
+// result as .glb and imports that the same way. without a path a torus of the given size is
+// generated first (kept next to the program for the next run).
+// usage: mesh-import-bench [model.obj|.gltf|.glb] [generated MB]
+//        mesh-import-bench [generated MB]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MeshImporter.h"
+
+const unsigned int RUNS = 3;
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// torus grid of quads: positions wrap around, texture coords do not, so the wrap is a UV seam
+static bool writeTorus(const std::string& path, size_t targetBytes) {
+	// about 110 bytes of text per grid cell
+	unsigned int side = std::max(4u, (unsigned int)std::sqrt(targetBytes / 110.0));
+	std::FILE* file = std::fopen(path.c_str(), "wb");
+	if (!file) {
+		std::cout << "ERROR::MESHIMPORTBENCH::CANNOT_WRITE " << path << std::endl;
+		return false;
+	}
+	std::vector<char> buffer(1 << 20);
+	std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+	std::fprintf(file, "# generated torus, %u x %u quads\n", side, side);
+	for (unsigned int j = 0; j < side; ++j) {
+		for (unsigned int i = 0; i < side; ++i) {
+			float u = 6.2831853f * i / side, v = 6.2831853f * j / side;
+			std::fprintf(file, "v %.6f %.6f %.6f\n", (1.0f + 0.4f * std::cos(v)) * std::cos(u),
+				0.4f * std::sin(v), (1.0f + 0.4f * std::cos(v)) * std::sin(u));
+		}
+	}
+	for (unsigned int j = 0; j <= side; ++j) {
+		for (unsigned int i = 0; i <= side; ++i) {
+			std::fprintf(file, "vt %.6f %.6f\n", (float)i / side, (float)j / side);
+		}
+	}
+	for (unsigned int j = 0; j < side; ++j) {
+		for (unsigned int i = 0; i < side; ++i) {
+			unsigned int p0 = j * side + i + 1, p1 = j * side + (i + 1) % side + 1;
+			unsigned int p2 = ((j + 1) % side) * side + (i + 1) % side + 1, p3 = ((j + 1) % side) * side + i + 1;
+			unsigned int t0 = j * (side + 1) + i + 1;
+			std::fprintf(file, "f %u/%u %u/%u %u/%u %u/%u\n", p0, t0, p1, t0 + 1, p2, t0 + side + 2, p3, t0 + side + 1);
+		}
+	}
+	std::fclose(file);
+	return true;
+}
+
+// the mesh as a .glb: one interleaved vertex view, one index view
+static bool writeGlb(const std::string& path, const ImportedMesh& mesh) {
+	size_t vertexBytes = (size_t)mesh.vertexCount * GeometryHeap::VERTEX_FLOATS * sizeof(float);
+	size_t indexBytes = (size_t)mesh.indexCount * sizeof(unsigned int);
+	float low[3] = { 1e30f, 1e30f, 1e30f }, high[3] = { -1e30f, -1e30f, -1e30f };
+	for (unsigned int v = 0; v < mesh.vertexCount; ++v) {
+		for (int c = 0; c < 3; ++c) {
+			low[c] = std::min(low[c], mesh.vertices[(size_t)v * GeometryHeap::VERTEX_FLOATS + c]);
+			high[c] = std::max(high[c], mesh.vertices[(size_t)v * GeometryHeap::VERTEX_FLOATS + c]);
+		}
+	}
+	// the importer flips v on the way in, so flip it on the way out
+	std::vector<float> vertices(mesh.vertices.get(), mesh.vertices.get() + mesh.vertexCount * GeometryHeap::VERTEX_FLOATS);
+	for (unsigned int v = 0; v < mesh.vertexCount; ++v) {
+		vertices[(size_t)v * GeometryHeap::VERTEX_FLOATS + 4] = 1.0f - vertices[(size_t)v * GeometryHeap::VERTEX_FLOATS + 4];
+	}
+
+	char json[2048];
+	std::snprintf(json, sizeof(json),
+		"{\"asset\":{\"version\":\"2.0\"},"
+		"\"buffers\":[{\"byteLength\":%zu}],"
+		"\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":%zu,\"byteStride\":20},"
+		"{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu}],"
+		"\"accessors\":[{\"bufferView\":0,\"byteOffset\":0,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\","
+		"\"min\":[%g,%g,%g],\"max\":[%g,%g,%g]},"
+		"{\"bufferView\":0,\"byteOffset\":12,\"componentType\":5126,\"count\":%u,\"type\":\"VEC2\"},"
+		"{\"bufferView\":1,\"componentType\":5125,\"count\":%u,\"type\":\"SCALAR\"}],"
+		"\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"TEXCOORD_0\":1},\"indices\":2}]}]}",
+		vertexBytes + indexBytes, vertexBytes, vertexBytes, indexBytes, mesh.vertexCount,
+		low[0], low[1], low[2], high[0], high[1], high[2], mesh.vertexCount, mesh.indexCount);
+	// chunks are 4 byte aligned, JSON is padded with spaces
+	std::string header = json;
+	header.append((4 - header.size() % 4) % 4, ' ');
+
+	std::FILE* file = std::fopen(path.c_str(), "wb");
+	if (!file) {
+		std::cout << "ERROR::MESHIMPORTBENCH::CANNOT_WRITE " << path << std::endl;
+		return false;
+	}
+	uint32_t binLength = (uint32_t)(vertexBytes + indexBytes);
+	uint32_t words[5] = { 0x46546C67, 2, (uint32_t)(12 + 8 + header.size() + 8 + binLength),
+		(uint32_t)header.size(), 0x4E4F534A };
+	std::fwrite(words, 4, 5, file);
+	std::fwrite(header.data(), 1, header.size(), file);
+	uint32_t binHeader[2] = { binLength, 0x004E4942 };
+	std::fwrite(binHeader, 4, 2, file);
+	std::fwrite(vertices.data(), 1, vertexBytes, file);
+	std::fwrite(mesh.indices.get(), 1, indexBytes, file);
+	std::fclose(file);
+	return true;
+}
+
+// tolerance for the glb round trip, flipping v twice can move it by a bit
+static bool sameMesh(const ImportedMesh& a, const ImportedMesh& b, float tolerance = 0.0f) {
+	if (a.vertexCount != b.vertexCount || a.indexCount != b.indexCount
+		|| std::memcmp(a.indices.get(), b.indices.get(), (size_t)a.indexCount * sizeof(unsigned int)) != 0) {
+		return false;
+	}
+	for (size_t i = 0; i < (size_t)a.vertexCount * GeometryHeap::VERTEX_FLOATS; ++i) {
+		if (std::fabs(a.vertices[i] - b.vertices[i]) > tolerance) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// best of RUNS on every thread count, the first run also warms the page cache.
+// the 1 thread mesh is kept to check that the others come out the same
+static void benchmark(const std::string& path, ImportedMesh& reference) {
+	std::vector<unsigned int> threadCounts;
+	unsigned int hardware = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned int threads = 1; threads < hardware; threads *= 2) {
+		threadCounts.push_back(threads);
+	}
+	threadCounts.push_back(hardware);
+
+	for (unsigned int threads : threadCounts) {
+		// a pool of exactly this size, the calling thread is one of them
+		ThreadPool* pool = threads > 1 ? new ThreadPool(threads - 1) : NULL;
+		MeshImporter importer(pool ? *pool : ThreadPool::global());
+		importer.setThreadCount(threads);
+
+		double best = 0.0;
+		ImportedMesh mesh;
+		for (unsigned int run = 0; run < RUNS; ++run) {
+			if (!importer.load(path, mesh)) {
+				delete pool;
+				return;
+			}
+			best = std::max(best, importer.getThroughput());
+		}
+		std::cout << path << ", " << threads << " thread(s): " << best << " MB/s (best of " << RUNS << ")";
+		if (threads == 1) {
+			std::cout << std::endl;
+			reference = std::move(mesh);
+		}
+		else {
+			std::cout << " | same mesh as 1 thread: " << (sameMesh(mesh, reference) ? "yes" : "NO") << std::endl;
+		}
+		importer.printStats();
+		delete pool;
+	}
+}
+
+int main(int argc, char** argv) {
+	std::string path = argc > 1 ? argv[1] : "";
+	double megabytes = argc > 2 ? std::atof(argv[2]) : 256.0;
+	// a number instead of a path is the size of the torus to generate
+	char* end = NULL;
+	double number = std::strtod(path.c_str(), &end);
+	if (!path.empty() && *end == '\0' && number > 0.0) {
+		megabytes = number;
+		path.clear();
+	}
+	if (path.empty()) {
+		path = "mesh-import-bench-" + std::to_string((int)megabytes) + "mb.obj";
+		std::FILE* existing = std::fopen(path.c_str(), "rb");
+		if (existing) {
+			std::fclose(existing);
+		}
+		else {
+			auto start = std::chrono::high_resolution_clock::now();
+			if (!writeTorus(path, (size_t)(megabytes * 1024 * 1024))) {
+				return -1;
+			}
+			std::cout << "generated " << path << " in " << elapsedMs(start) << " ms" << std::endl;
+		}
+	}
+	std::cout << "threads available: " << std::thread::hardware_concurrency() << std::endl;
+
+	ImportedMesh mesh;
+	benchmark(path, mesh);
+	if (mesh.vertexCount == 0) {
+		return -1;
+	}
+
+	// the same mesh through the glTF path, binary data needs no parsing so this is mostly memory bandwidth
+	if (path.substr(path.find_last_of('.') + 1) == "obj") {
+		std::string glb = path.substr(0, path.find_last_of('.')) + ".glb";
+		if (!writeGlb(glb, mesh)) {
+			return -1;
+		}
+		ImportedMesh fromGlb;
+		benchmark(glb, fromGlb);
+		std::cout << "glb round trip matches the obj import: " << (sameMesh(mesh, fromGlb, 1e-6f) ? "yes" : "NO") << std::endl;
+		std::remove(glb.c_str());
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,363 @@
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MIP_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIP_SSE
+#endif
+
+// taps of the Kaiser filter, centred between the two source texels
+const int KAISER_TAPS = 8;
+
+// conversion tables, built once on first use
+struct ColorTables {
+	float toLinear[256];      // sRGB byte -> linear
+	float unorm[256];         // byte -> [0, 1]
+	unsigned char toSrgb[4096]; // 12 bit linear -> sRGB byte
+	float kaiser[KAISER_TAPS];
+
+	ColorTables() {
+		for (int i = 0; i < 256; ++i) {
+			float c = i / 255.0f;
+			toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			unorm[i] = c;
+		}
+		for (int i = 0; i < 4096; ++i) {
+			float l = i / 4095.0f;
+			float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+			toSrgb[i] = (unsigned char)std::min(255.0f, c * 255.0f + 0.5f);
+		}
+
+		// sinc with cutoff at half the source rate, Kaiser window alpha = 4
+		const float alpha = 4.0f;
+		const float halfWidth = KAISER_TAPS * 0.5f;
+		float sum = 0.0f;
+		for (int k = 0; k < KAISER_TAPS; ++k) {
+			float t = k - (KAISER_TAPS - 1) * 0.5f;
+			float x = t * 0.5f;
+			float sinc = x == 0.0f ? 1.0f : std::sin(3.14159265f * x) / (3.14159265f * x);
+			float ratio = t / halfWidth;
+			float window = bessel0(alpha * std::sqrt(std::max(0.0f, 1.0f - ratio * ratio))) / bessel0(alpha);
+			kaiser[k] = sinc * window;
+			sum += kaiser[k];
+		}
+		for (int k = 0; k < KAISER_TAPS; ++k) {
+			kaiser[k] /= sum;
+		}
+	}
+
+	// modified Bessel function of the first kind, order 0
+	static float bessel0(float x) {
+		float sum = 1.0f, term = 1.0f;
+		for (int k = 1; k < 16; ++k) {
+			term *= (x * 0.5f / k) * (x * 0.5f / k);
+			sum += term;
+		}
+		return sum;
+	}
+};
+
+static const ColorTables& tables() {
+	static ColorTables instance;
+	return instance;
+}
+
+// bytes -> linear float RGBA, optionally premultiplied
+static void decodeRow(const unsigned char* src, int width, int channels, const MipOptions& options, float* dst) {
+	const ColorTables& t = tables();
+	const float* toFloat = options.srgb ? t.toLinear : t.unorm;
+	for (int x = 0; x < width; ++x) {
+		const unsigned char* p = src + (size_t)x * channels;
+		float a = channels == 4 ? t.unorm[p[3]] : 1.0f;
+		float scale = options.premultiplyAlpha ? a : 1.0f;
+		// fewer than 3 channels are spread the same way as level 0
+		dst[x * 4 + 0] = toFloat[p[0]] * scale;
+		dst[x * 4 + 1] = toFloat[p[channels > 1 ? 1 : 0]] * scale;
+		dst[x * 4 + 2] = toFloat[p[channels > 2 ? 2 : 0]] * scale;
+		dst[x * 4 + 3] = a;
+	}
+}
+
+// linear float RGBA -> bytes, undoing the premultiply
+static void encodeRow(const float* src, int width, const MipOptions& options, unsigned char* dst) {
+	const ColorTables& t = tables();
+	int x = 0;
+
+#ifdef MIP_SSE
+	if (options.simd) {
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		// rgb goes through the 12 bit table when encoding sRGB, alpha is always linear
+		const __m128 scale = options.srgb ? _mm_setr_ps(4095.0f, 4095.0f, 4095.0f, 255.0f) : _mm_set1_ps(255.0f);
+		const __m128 alphaLane = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+		for (; x < width; ++x) {
+			__m128 v = _mm_loadu_ps(src + x * 4);
+			if (options.premultiplyAlpha) {
+				__m128 a = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+				__m128 inv = _mm_and_ps(_mm_div_ps(one, a), _mm_cmpgt_ps(a, zero));
+				// keep alpha itself, divide the color
+				v = _mm_mul_ps(v, _mm_or_ps(_mm_and_ps(alphaLane, one), _mm_andnot_ps(alphaLane, inv)));
+			}
+			v = _mm_min_ps(_mm_max_ps(v, zero), one);
+			__m128i q = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half));
+
+			alignas(16) int c[4];
+			_mm_store_si128((__m128i*)c, q);
+			unsigned char* p = dst + x * 4;
+			if (options.srgb) {
+				p[0] = t.toSrgb[c[0]];
+				p[1] = t.toSrgb[c[1]];
+				p[2] = t.toSrgb[c[2]];
+			}
+			else {
+				p[0] = (unsigned char)c[0];
+				p[1] = (unsigned char)c[1];
+				p[2] = (unsigned char)c[2];
+			}
+			p[3] = (unsigned char)c[3];
+		}
+	}
+#endif
+
+	for (; x < width; ++x) {
+		const float* v = src + x * 4;
+		float a = std::min(1.0f, std::max(0.0f, v[3]));
+		float inv = options.premultiplyAlpha ? (a > 0.0f ? 1.0f / v[3] : 0.0f) : 1.0f;
+		for (int c = 0; c < 3; ++c) {
+			float l = std::min(1.0f, std::max(0.0f, v[c] * inv));
+			dst[x * 4 + c] = options.srgb ? t.toSrgb[(int)(l * 4095.0f + 0.5f)] : (unsigned char)(l * 255.0f + 0.5f);
+		}
+		dst[x * 4 + 3] = (unsigned char)(a * 255.0f + 0.5f);
+	}
+}
+
+// 2x2 average of two source rows into one output row
+static void boxRow(const float* r0, const float* r1, int inWidth, float* out, int outWidth, bool simd) {
+	int x = 0;
+
+#ifdef MIP_AVX2
+	if (simd) {
+		// both source texels of the pair in one register
+		const __m128 quarter = _mm_set1_ps(0.25f);
+		for (; x < outWidth && x * 2 + 1 < inWidth; ++x) {
+			__m256 sum = _mm256_add_ps(_mm256_loadu_ps(r0 + x * 8), _mm256_loadu_ps(r1 + x * 8));
+			__m128 pair = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+			_mm_storeu_ps(out + x * 4, _mm_mul_ps(pair, quarter));
+		}
+	}
+#endif
+
+#ifdef MIP_SSE
+	if (simd) {
+		const __m128 quarter = _mm_set1_ps(0.25f);
+		for (; x < outWidth; ++x) {
+			int x0 = x * 2;
+			int x1 = std::min(x0 + 1, inWidth - 1);
+			__m128 sum = _mm_add_ps(
+				_mm_add_ps(_mm_loadu_ps(r0 + x0 * 4), _mm_loadu_ps(r0 + x1 * 4)),
+				_mm_add_ps(_mm_loadu_ps(r1 + x0 * 4), _mm_loadu_ps(r1 + x1 * 4)));
+			_mm_storeu_ps(out + x * 4, _mm_mul_ps(sum, quarter));
+		}
+	}
+#endif
+
+	for (; x < outWidth; ++x) {
+		int x0 = x * 2;
+		int x1 = std::min(x0 + 1, inWidth - 1);
+		for (int c = 0; c < 4; ++c) {
+			out[x * 4 + c] = (r0[x0 * 4 + c] + r0[x1 * 4 + c] + r1[x0 * 4 + c] + r1[x1 * 4 + c]) * 0.25f;
+		}
+	}
+}
+
+// weighted sum of KAISER_TAPS source pixels, one pointer per tap
+static void kaiserAccumulate(const float* const* taps, int tapStride, int count, float* out, bool simd) {
+	const float* w = tables().kaiser;
+	int x = 0;
+
+#ifdef MIP_SSE
+	if (simd) {
+		for (; x < count; ++x) {
+			__m128 acc = _mm_setzero_ps();
+			for (int k = 0; k < KAISER_TAPS; ++k) {
+				acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]), _mm_loadu_ps(taps[k] + (size_t)x * tapStride)));
+			}
+			_mm_storeu_ps(out + x * 4, acc);
+		}
+	}
+#endif
+
+	for (; x < count; ++x) {
+		for (int c = 0; c < 4; ++c) {
+			float acc = 0.0f;
+			for (int k = 0; k < KAISER_TAPS; ++k) {
+				acc += w[k] * taps[k][(size_t)x * tapStride + c];
+			}
+			out[x * 4 + c] = acc;
+		}
+	}
+}
+
+// rows per parallelFor chunk: enough pixels to be worth a job, no more chunks than threads allowed
+static unsigned int rowGrain(int rows, int width, const MipOptions& options) {
+	unsigned int grain = std::max(1, 65536 / width);
+	if (options.threads > 0) {
+		grain = std::max(grain, (rows + options.threads - 1) / options.threads);
+	}
+	return grain;
+}
+
+MipGenerator::MipGenerator(ThreadPool& pool) : pool(pool) {
+	// build the tables before any worker needs them
+	tables();
+}
+
+std::vector<MipLevel> MipGenerator::generate(const unsigned char* pixels, int width, int height, int channels,
+	const MipOptions& options) {
+	std::vector<MipLevel> levels;
+
+	// level 0 is the source itself, expanded to RGBA
+	MipLevel base;
+	base.width = width;
+	base.height = height;
+	base.data.resize((size_t)width * height * 4);
+	if (channels == 4) {
+		std::memcpy(base.data.data(), pixels, base.data.size());
+	}
+	else {
+		for (size_t i = 0; i < (size_t)width * height; ++i) {
+			base.data[i * 4 + 0] = pixels[i * channels + 0];
+			base.data[i * 4 + 1] = pixels[i * channels + (channels > 1 ? 1 : 0)];
+			base.data[i * 4 + 2] = pixels[i * channels + (channels > 2 ? 2 : 0)];
+			base.data[i * 4 + 3] = 255;
+		}
+	}
+	levels.push_back(std::move(base));
+
+	std::vector<float> current, next, horizontal;
+	bool fromBytes = options.filter == MipOptions::FILTER_BOX;
+
+	if (!fromBytes) {
+		// the Kaiser taps reach across many rows, decode the whole source once
+		current.resize((size_t)width * height * 4);
+		pool.parallelFor(height, rowGrain(height, width, options), [&](unsigned int begin, unsigned int end) {
+			for (unsigned int y = begin; y < end; ++y) {
+				decodeRow(pixels + (size_t)y * width * channels, width, channels, options, &current[(size_t)y * width * 4]);
+			}
+		});
+	}
+
+	int w = width, h = height;
+	while (w > 1 || h > 1) {
+		int nw = std::max(1, w / 2);
+		int nh = std::max(1, h / 2);
+		next.resize((size_t)nw * nh * 4);
+
+		MipLevel level;
+		level.width = nw;
+		level.height = nh;
+		level.data.resize((size_t)nw * nh * 4);
+
+		if (options.filter == MipOptions::FILTER_KAISER) {
+			// horizontal pass over every source row first
+			horizontal.resize((size_t)nw * h * 4);
+			pool.parallelFor(h, rowGrain(h, nw, options), [&](unsigned int begin, unsigned int end) {
+				const float* taps[KAISER_TAPS];
+				for (unsigned int y = begin; y < end; ++y) {
+					const float* row = &current[(size_t)y * w * 4];
+					for (int x = 0; x < nw; ++x) {
+						for (int k = 0; k < KAISER_TAPS; ++k) {
+							int sx = std::min(w - 1, std::max(0, x * 2 - KAISER_TAPS / 2 + 1 + k));
+							taps[k] = row + sx * 4;
+						}
+						kaiserAccumulate(taps, 0, 1, &horizontal[((size_t)y * nw + x) * 4], options.simd);
+					}
+				}
+			});
+		}
+
+		const int rowWidth = w;
+		pool.parallelFor(nh, rowGrain(nh, nw, options), [&](unsigned int begin, unsigned int end) {
+			std::vector<float> scratch;
+			if (fromBytes) {
+				scratch.resize((size_t)rowWidth * 8);
+			}
+
+			for (unsigned int y = begin; y < end; ++y) {
+				int y0 = y * 2;
+				int y1 = std::min(y0 + 1, h - 1);
+				float* out = &next[(size_t)y * nw * 4];
+
+				if (options.filter == MipOptions::FILTER_KAISER) {
+					const float* taps[KAISER_TAPS];
+					for (int k = 0; k < KAISER_TAPS; ++k) {
+						int sy = std::min(h - 1, std::max(0, y0 - KAISER_TAPS / 2 + 1 + k));
+						taps[k] = &horizontal[(size_t)sy * nw * 4];
+					}
+					kaiserAccumulate(taps, 4, nw, out, options.simd);
+				}
+				else if (fromBytes) {
+					// first level reads the source bytes directly, two rows at a time
+					float* r0 = scratch.data();
+					float* r1 = scratch.data() + (size_t)rowWidth * 4;
+					decodeRow(pixels + (size_t)y0 * rowWidth * channels, rowWidth, channels, options, r0);
+					decodeRow(pixels + (size_t)y1 * rowWidth * channels, rowWidth, channels, options, r1);
+					boxRow(r0, r1, rowWidth, out, nw, options.simd);
+				}
+				else {
+					boxRow(&current[(size_t)y0 * rowWidth * 4], &current[(size_t)y1 * rowWidth * 4], rowWidth, out, nw, options.simd);
+				}
+
+				encodeRow(out, nw, options, &level.data[(size_t)y * nw * 4]);
+			}
+		});
+
+		levels.push_back(std::move(level));
+		current.swap(next);
+		fromBytes = false;
+		w = nw;
+		h = nh;
+	}
+
+	return levels;
+}
+
+std::vector<std::vector<MipLevel>> MipGenerator::generate(const std::vector<Source>& sources,
+	const MipOptions& options) {
+	std::vector<std::vector<MipLevel>> chains(sources.size());
+	pool.parallelFor((unsigned int)sources.size(), 1, [&](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; ++i) {
+			const Source& source = sources[i];
+			chains[i] = generate(source.pixels, source.width, source.height, source.channels, options);
+		}
+	});
+	return chains;
+}
+
+void MipGenerator::upload(const std::vector<MipLevel>& levels, GLenum internalFormat) {
+	for (size_t i = 0; i < levels.size(); ++i) {
+		glTexImage2D(GL_TEXTURE_2D, (GLint)i, internalFormat, levels[i].width, levels[i].height, 0,
+			GL_RGBA, GL_UNSIGNED_BYTE, levels[i].data.data());
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+}
+
+const char* MipGenerator::simdName() {
+#if defined(MIP_AVX2)
+	return "AVX2";
+#elif defined(MIP_SSE)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
\ No newline at end of file
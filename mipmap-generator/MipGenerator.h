@@ -0,0 +1,60 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <vector>
+
+#include "../thread-pool/ThreadPool.h"
+
+// one level of a mip chain, always RGBA8
+struct MipLevel {
+	int width, height;
+	std::vector<unsigned char> data;
+};
+
+struct MipOptions {
+	enum Filter {
+		FILTER_BOX,   // 2x2 average, cheapest
+		FILTER_KAISER // 8 tap Kaiser windowed sinc, sharper, slight ringing
+	};
+
+	Filter filter = FILTER_BOX;
+	// decode to linear light before filtering and encode back afterwards
+	bool srgb = true;
+	// filter premultiplied so transparent texels do not bleed their color,
+	// the output is stored straight again like the lessons expect
+	bool premultiplyAlpha = true;
+	// false forces the scalar path, for comparisons
+	bool simd = true;
+	// upper bound on threads working on one image, 0 = the whole pool
+	unsigned int threads = 0;
+};
+
+// Builds full mip chains on the CPU instead of glGenerateMipmap: filtering
+// happens in linear light with premultiplied alpha, each pixel is one SSE
+// register (two per AVX2 register) and rows are split across the thread pool.
+class MipGenerator {
+public:
+	MipGenerator(ThreadPool& pool = ThreadPool::global());
+
+	// channels is 1 to 4, level 0 of the result is the source as RGBA
+	std::vector<MipLevel> generate(const unsigned char* pixels, int width, int height, int channels,
+		const MipOptions& options = MipOptions());
+
+	// several images at once, images and rows are spread over the pool
+	struct Source {
+		const unsigned char* pixels;
+		int width, height, channels;
+	};
+	std::vector<std::vector<MipLevel>> generate(const std::vector<Source>& sources,
+		const MipOptions& options = MipOptions());
+
+	// glTexImage2D every level into the texture bound to GL_TEXTURE_2D
+	static void upload(const std::vector<MipLevel>& levels, GLenum internalFormat = GL_RGBA);
+
+	// name of the SIMD path compiled in
+	static const char* simdName();
+
+private:
+	ThreadPool& pool;
+};
\ No newline at end of file
@@ -0,0 +1,120 @@
+// mip generation benchmark: glGenerateMipmap against the CPU generator on a 4096x4096 image,
+// then CPU only timings for scalar/SIMD, 1/N threads and box/Kaiser
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "MipGenerator.h"
+
+const int SIZE = 4096;
+const int ITERATIONS = 5;
+
+double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int main() {
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	GLFWwindow* window = glfwCreateWindow(64, 64, "mipmap-bench", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// noise with soft alpha edges, the worst case for color bleeding
+	std::vector<unsigned char> pixels((size_t)SIZE * SIZE * 4);
+	std::mt19937 rng(7);
+	for (size_t i = 0; i < (size_t)SIZE * SIZE; ++i) {
+		unsigned int bits = rng();
+		pixels[i * 4 + 0] = bits & 0xff;
+		pixels[i * 4 + 1] = (bits >> 8) & 0xff;
+		pixels[i * 4 + 2] = (bits >> 16) & 0xff;
+		pixels[i * 4 + 3] = (i / 64) % 2 ? 255 : (bits >> 24) & 0xff;
+	}
+
+	ThreadPool& pool = ThreadPool::global();
+	MipGenerator generator(pool);
+	std::cout << "SIMD path: " << MipGenerator::simdName() << " | threads available: " << pool.getConcurrency() << std::endl;
+
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	// driver path: upload level 0 and let the GPU build the rest
+	double driver = 0.0;
+	for (int i = 0; i < ITERATIONS; ++i) {
+		auto start = std::chrono::high_resolution_clock::now();
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, SIZE, SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glFinish();
+		driver += elapsedMs(start);
+	}
+
+	// CPU path: generate every level, upload them all
+	double cpu = 0.0, upload = 0.0;
+	for (int i = 0; i < ITERATIONS; ++i) {
+		auto start = std::chrono::high_resolution_clock::now();
+		std::vector<MipLevel> levels = generator.generate(pixels.data(), SIZE, SIZE, 4);
+		cpu += elapsedMs(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		MipGenerator::upload(levels);
+		glFinish();
+		upload += elapsedMs(start);
+	}
+
+	std::cout << "glTexImage2D + glGenerateMipmap: " << driver / ITERATIONS << " ms" << std::endl;
+	std::cout << "MipGenerator + upload: " << (cpu + upload) / ITERATIONS << " ms"
+		<< " (generate " << cpu / ITERATIONS << " ms, upload " << upload / ITERATIONS << " ms)" << std::endl;
+
+	glDeleteTextures(1, &texture);
+	glfwTerminate();
+
+	struct Config { const char* name; MipOptions::Filter filter; bool simd; unsigned int threads; };
+	const Config configs[] = {
+		{ "box scalar 1 thread", MipOptions::FILTER_BOX, false, 1 },
+		{ "box simd 1 thread", MipOptions::FILTER_BOX, true, 1 },
+		{ "box simd all threads", MipOptions::FILTER_BOX, true, 0 },
+		{ "kaiser scalar 1 thread", MipOptions::FILTER_KAISER, false, 1 },
+		{ "kaiser simd 1 thread", MipOptions::FILTER_KAISER, true, 1 },
+		{ "kaiser simd all threads", MipOptions::FILTER_KAISER, true, 0 }
+	};
+
+	for (const Config& config : configs) {
+		MipOptions options;
+		options.filter = config.filter;
+		options.simd = config.simd;
+		options.threads = config.threads;
+
+		double total = 0.0;
+		for (int i = 0; i < ITERATIONS; ++i) {
+			auto start = std::chrono::high_resolution_clock::now();
+			std::vector<MipLevel> levels = generator.generate(pixels.data(), SIZE, SIZE, 4, options);
+			total += elapsedMs(start);
+		}
+		std::cout << config.name << ": " << total / ITERATIONS << " ms" << std::endl;
+	}
+
+	// a batch of smaller textures, spread over the pool image by image
+	std::vector<MipGenerator::Source> sources(16, MipGenerator::Source{ pixels.data(), 1024, 1024, 4 });
+	auto start = std::chrono::high_resolution_clock::now();
+	std::vector<std::vector<MipLevel>> chains = generator.generate(sources);
+	std::cout << "16 x 1024x1024 batch: " << elapsedMs(start) << " ms" << std::endl;
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include "MultiViewRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "../frustum/Frustum.h"
+
+// std140: mat4 viewProjection[16] then int viewCount
+const GLsizeiptr VIEWS_UBO_SIZE = MultiViewRenderer::MAX_VIEWS * sizeof(glm::mat4) + 4 * sizeof(int);
+
+MultiViewRenderer::MultiViewRenderer(int width, int height, const char* vertexPath, const char* fragmentPath,
+	const char* geometryPath, GLADloadproc loader)
+	: width(width), height(height), multiviewViews(0), viewCount(0),
+	framebufferTextureMultiview(NULL), vertexPath(vertexPath), fragmentPath(fragmentPath),
+	geometryPath(geometryPath), layeredShader(NULL) {
+	std::fill(multiviewShaders, multiviewShaders + MAX_VIEWS + 1, (Shader*)NULL);
+
+	glGenTextures(1, &colorTexture);
+	glGenTextures(1, &depthTexture);
+	glGenFramebuffers(1, &layeredFBO);
+	glGenFramebuffers(MAX_VIEWS, layerFBOs);
+	glGenFramebuffers(1, &multiviewFBO);
+
+	for (unsigned int texture : { colorTexture, depthTexture }) {
+		glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	allocateLayers(1);
+
+	glGenBuffers(1, &UBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferData(GL_UNIFORM_BUFFER, VIEWS_UBO_SIZE, NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, VIEWS_UBO_BINDING, UBO);
+
+	// gl_Layer in the vertex shader saves the geometry stage, it needs one of these
+	layerFromVertex = hasExtension("GL_ARB_shader_viewport_layer_array") || hasExtension("GL_AMD_vertex_shader_layer");
+	if (loader && hasExtension("GL_OVR_multiview")) {
+		framebufferTextureMultiview = (FramebufferTextureMultiviewProc)loader("glFramebufferTextureMultiviewOVR");
+	}
+
+	passShader = createShader(false, NULL);
+	layeredShader = layerFromVertex
+		? createShader(false, "#define LAYER_FROM_VERTEX\n")
+		: createShader(true, "#define LAYER_FROM_GEOMETRY\n");
+}
+
+MultiViewRenderer::~MultiViewRenderer() {
+	glDeleteProgram(passShader->ID);
+	delete passShader;
+	glDeleteProgram(layeredShader->ID);
+	delete layeredShader;
+	for (Shader* shader : multiviewShaders) {
+		if (shader) {
+			glDeleteProgram(shader->ID);
+			delete shader;
+		}
+	}
+
+	glDeleteFramebuffers(1, &layeredFBO);
+	glDeleteFramebuffers(MAX_VIEWS, layerFBOs);
+	glDeleteFramebuffers(1, &multiviewFBO);
+	glDeleteTextures(1, &colorTexture);
+	glDeleteTextures(1, &depthTexture);
+	glDeleteBuffers(1, &UBO);
+}
+
+bool MultiViewRenderer::isSupported(Mode mode) const {
+	return mode != MODE_OVR_MULTIVIEW || framebufferTextureMultiview != NULL;
+}
+
+const char* MultiViewRenderer::modeName(Mode mode) {
+	switch (mode) {
+	case MODE_SEPARATE_PASSES: return "separate passes";
+	case MODE_LAYERED: return "layered instancing";
+	case MODE_OVR_MULTIVIEW: return "OVR_multiview";
+	default: return "unknown";
+	}
+}
+
+void MultiViewRenderer::setViews(const glm::mat4* viewProjections, unsigned int count) {
+	count = std::max(1u, std::min(count, (unsigned int)MAX_VIEWS));
+	if (count != viewCount) {
+		allocateLayers(count);
+	}
+
+	// orphan and refill, the previous frame may still read the old contents
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferData(GL_UNIFORM_BUFFER, VIEWS_UBO_SIZE, NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, count * sizeof(glm::mat4), viewProjections);
+	int countValue = (int)count;
+	glBufferSubData(GL_UNIFORM_BUFFER, MAX_VIEWS * sizeof(glm::mat4), sizeof(int), &countValue);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	for (unsigned int view = 0; view < count; ++view) {
+		frustumPlanes(viewProjections[view], planes[view]);
+	}
+}
+
+Shader& MultiViewRenderer::begin(Mode mode, unsigned int view) {
+	Shader* shader;
+	switch (mode) {
+	case MODE_LAYERED:
+		glBindFramebuffer(GL_FRAMEBUFFER, layeredFBO);
+		shader = layeredShader;
+		break;
+	case MODE_OVR_MULTIVIEW:
+		if (multiviewViews != viewCount) {
+			glBindFramebuffer(GL_FRAMEBUFFER, multiviewFBO);
+			framebufferTextureMultiview(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, colorTexture, 0, 0, viewCount);
+			framebufferTextureMultiview(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0, 0, viewCount);
+			multiviewViews = viewCount;
+		}
+		if (!multiviewShaders[viewCount]) {
+			std::string defines = "#define OVR_MULTIVIEW\n#define VIEW_COUNT " + std::to_string(viewCount) + "\n";
+			multiviewShaders[viewCount] = createShader(false, defines.c_str());
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, multiviewFBO);
+		shader = multiviewShaders[viewCount];
+		break;
+	default:
+		glBindFramebuffer(GL_FRAMEBUFFER, layerFBOs[view]);
+		shader = passShader;
+		break;
+	}
+
+	// a layered framebuffer clears every layer at once
+	glViewport(0, 0, width, height);
+	glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	shader->use();
+	if (mode == MODE_SEPARATE_PASSES) {
+		shader->setInt("viewIndex", (int)view);
+	}
+	return *shader;
+}
+
+void MultiViewRenderer::end() {
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+bool MultiViewRenderer::isVisible(unsigned int view, const glm::vec3& center, float radius) const {
+	return sphereVisible(planes[view], center, radius);
+}
+
+bool MultiViewRenderer::isVisibleInAny(const glm::vec3& center, float radius) const {
+	for (unsigned int view = 0; view < viewCount; ++view) {
+		if (isVisible(view, center, radius)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void MultiViewRenderer::present(int windowWidth, int windowHeight) {
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glViewport(0, 0, windowWidth, windowHeight);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	// as square a grid as the view count allows, tiles keep the target aspect
+	unsigned int columns = (unsigned int)std::ceil(std::sqrt((float)viewCount));
+	unsigned int rows = (viewCount + columns - 1) / columns;
+	int tileWidth = windowWidth / columns;
+	int tileHeight = windowHeight / rows;
+	for (unsigned int view = 0; view < viewCount; ++view) {
+		int x = (view % columns) * tileWidth;
+		int y = windowHeight - (view / columns + 1) * tileHeight;
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, layerFBOs[view]);
+		glBlitFramebuffer(0, 0, width, height, x, y, x + tileWidth, y + tileHeight,
+			GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	}
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+void MultiViewRenderer::allocateLayers(unsigned int count) {
+	glBindTexture(GL_TEXTURE_2D_ARRAY, colorTexture);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, count, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, depthTexture);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, width, height, count, 0,
+		GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	// only as many layers as views, so the layered clear touches nothing extra
+	glBindFramebuffer(GL_FRAMEBUFFER, layeredFBO);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, colorTexture, 0);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cout << "ERROR::MULTIVIEW::LAYERED_FRAMEBUFFER_INCOMPLETE" << std::endl;
+	}
+	for (unsigned int view = 0; view < count; ++view) {
+		glBindFramebuffer(GL_FRAMEBUFFER, layerFBOs[view]);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, colorTexture, 0, view);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0, view);
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	viewCount = count;
+	multiviewViews = 0;
+}
+
+Shader* MultiViewRenderer::createShader(bool geometry, const char* defines) {
+	Shader* shader = new Shader(vertexPath.c_str(), fragmentPath.c_str(),
+		geometry ? geometryPath.c_str() : NULL, defines);
+	shader->bindUniformBlock("Views", VIEWS_UBO_BINDING);
+	return shader;
+}
+
+bool MultiViewRenderer::hasExtension(const char* name) {
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; ++i) {
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (extension && std::strcmp(extension, name) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <string>
+
+#include "../shader-lesson-1.4/Shader.h"
+
+// uniform block binding of the Views block in multiview.vert
+const unsigned int VIEWS_UBO_BINDING = 1;
+
+// Renders one scene from up to MAX_VIEWS cameras into the layers of a texture
+// array. The view-projection matrices of every view sit in one uniform block,
+// so the scene is walked and culled once and each draw is broadcast to all
+// views: as instances that pick their layer (gl_Layer from the vertex shader
+// when the driver allows it, from a geometry shader otherwise) or through
+// GL_OVR_multiview. Separate passes, one per view, are kept for comparison.
+class MultiViewRenderer {
+public:
+	static const unsigned int MAX_VIEWS = 16;
+
+	enum Mode { MODE_SEPARATE_PASSES, MODE_LAYERED, MODE_OVR_MULTIVIEW, MODE_COUNT };
+
+	// the shaders are compiled once per mode, the fragment shader gets TexCoord;
+	// the loader is only used to find glFramebufferTextureMultiviewOVR
+	MultiViewRenderer(int width, int height, const char* vertexPath, const char* fragmentPath,
+		const char* geometryPath, GLADloadproc loader = NULL);
+	~MultiViewRenderer();
+
+	bool isSupported(Mode mode) const;
+	static const char* modeName(Mode mode);
+	// where gl_Layer comes from in MODE_LAYERED
+	bool layerFromVertexShader() const { return layerFromVertex; }
+
+	// matrices for this frame, count <= MAX_VIEWS
+	void setViews(const glm::mat4* viewProjections, unsigned int count);
+	unsigned int getViewCount() const { return viewCount; }
+
+	// bind target and program and clear, returns the program for per draw uniforms.
+	// MODE_SEPARATE_PASSES renders one view per call, pass the view index
+	Shader& begin(Mode mode, unsigned int view = 0);
+	// instance count for one object: every view in MODE_LAYERED, the driver handles OVR
+	unsigned int getInstances(Mode mode) const { return mode == MODE_LAYERED ? viewCount : 1; }
+	void end();
+
+	// bounding sphere against the frustum of one view, or of any view
+	bool isVisible(unsigned int view, const glm::vec3& center, float radius) const;
+	bool isVisibleInAny(const glm::vec3& center, float radius) const;
+
+	// blit every layer into a grid on the default framebuffer
+	void present(int windowWidth, int windowHeight);
+
+	unsigned int getColorTexture() const { return colorTexture; }
+
+private:
+	typedef void (APIENTRYP FramebufferTextureMultiviewProc)(GLenum target, GLenum attachment,
+		GLuint texture, GLint level, GLint baseViewIndex, GLsizei numViews);
+
+	int width, height;
+	unsigned int colorTexture, depthTexture;
+	unsigned int layeredFBO;              // whole arrays, layered attachment
+	unsigned int layerFBOs[MAX_VIEWS];    // one layer each, separate passes and present
+	unsigned int multiviewFBO;            // OVR attachment for the current view count
+	unsigned int multiviewViews;          // view count multiviewFBO is set up for
+	unsigned int UBO;
+
+	unsigned int viewCount;
+	glm::vec4 planes[MAX_VIEWS][6];
+
+	bool layerFromVertex;
+	FramebufferTextureMultiviewProc framebufferTextureMultiview;
+
+	std::string vertexPath, fragmentPath, geometryPath;
+	Shader* passShader;
+	Shader* layeredShader;
+	Shader* multiviewShaders[MAX_VIEWS + 1]; // num_views is fixed at compile time, built on first use
+
+	// size the arrays to the view count, only when it changes
+	void allocateLayers(unsigned int count);
+	Shader* createShader(bool geometry, const char* defines);
+	static bool hasExtension(const char* name);
+};
\ No newline at end of file
@@ -0,0 +1,350 @@
+// multi-view demo: a field of cubes seen by 1, 2 (stereo), 6 (cubemap probe) and 16 (split screen)
+// cameras, rendered in separate passes and broadcast to texture array layers in one pass.
+// sweeps every view count and mode first and prints the frame times, then V cycles the view
+// count and M the mode
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "../shader-lesson-1.4/Shader.h"
+#include "../geometry-heap/GeometryHeap.h"
+#include "MultiViewRenderer.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <std_image/stb_image.h>
+
+const unsigned int WIDTH = 800;
+const unsigned int HEIGHT = 600;
+// every view renders at this size, square so cube faces fit
+const int VIEW_SIZE = 512;
+const int FIELD_SIZE = 40;
+const float CUBE_RADIUS = 0.87f; // bounding sphere of a unit cube
+
+const unsigned int VIEW_COUNTS[] = { 1, 2, 6, 16 };
+const unsigned int VIEW_COUNT_OPTIONS = sizeof(VIEW_COUNTS) / sizeof(VIEW_COUNTS[0]);
+const unsigned int SWEEP_FRAMES = 120;
+
+unsigned int viewOption = 0;
+MultiViewRenderer::Mode mode = MultiViewRenderer::MODE_SEPARATE_PASSES;
+bool settingsChanged = true;
+int windowWidth = WIDTH;
+int windowHeight = HEIGHT;
+
+void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+unsigned int loadTexture(const char* path);
+void buildViews(unsigned int count, float time, glm::mat4* viewProjections);
+
+int main() {
+	// initialize GLFW
+	glfwInit();
+	// set version and core profile
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// create a window
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	// set callback to handle when window is resized
+	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+	glfwSetKeyCallback(window, keyCallback);
+
+	// initialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// no vsync, we want to see the frame time
+	glfwSwapInterval(0);
+
+	MultiViewRenderer* renderer = new MultiViewRenderer(VIEW_SIZE, VIEW_SIZE, "multiview.vert",
+		"../coordinate-systems-1.6/les1.6-fShader.frag", "multiview.geom", (GLADloadproc)glfwGetProcAddress);
+	std::cout << "MULTIVIEW::layer written by the " << (renderer->layerFromVertexShader() ? "vertex" : "geometry")
+		<< " shader | OVR_multiview " << (renderer->isSupported(MultiViewRenderer::MODE_OVR_MULTIVIEW) ? "yes" : "no")
+		<< std::endl;
+
+	// positions and texture coords
+	float vertices[] = {
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+	};
+
+	GeometryHeap* geometry = new GeometryHeap(1024, 0);
+	unsigned int cubeMesh = geometry->addMesh(vertices, 36);
+
+	stbi_set_flip_vertically_on_load(true);
+	unsigned int texture = loadTexture("../textures-lesson-1.5/container.jpg");
+	unsigned int texture2 = loadTexture("../textures-lesson-1.5/awesomeface.png");
+
+	glEnable(GL_DEPTH_TEST);
+
+	unsigned int query;
+	glGenQueries(1, &query);
+
+	glm::mat4 viewProjections[MultiViewRenderer::MAX_VIEWS];
+	bool sweeping = true;
+	unsigned int sweepFrame = 0;
+	double lastReport = glfwGetTime();
+	double cpuSum = 0.0, gpuSum = 0.0;
+	unsigned long long drawSum = 0;
+	unsigned int frames = 0;
+
+	// render loop
+	while (!glfwWindowShouldClose(window)) {
+		float time = (float)glfwGetTime();
+		unsigned int viewCount = VIEW_COUNTS[viewOption];
+		if (settingsChanged) {
+			if (!renderer->isSupported(mode)) {
+				mode = MultiViewRenderer::MODE_SEPARATE_PASSES;
+			}
+			cpuSum = gpuSum = 0.0;
+			drawSum = 0;
+			frames = 0;
+			lastReport = glfwGetTime();
+			settingsChanged = false;
+		}
+
+		buildViews(viewCount, time, viewProjections);
+
+		// scene traversal and GPU time of everything that renders the views
+		auto start = std::chrono::high_resolution_clock::now();
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		renderer->setViews(viewProjections, viewCount);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, texture2);
+		geometry->bind();
+
+		// separate passes walk and cull the scene once per view, the others once in total
+		unsigned int passes = mode == MultiViewRenderer::MODE_SEPARATE_PASSES ? viewCount : 1;
+		unsigned int instances = renderer->getInstances(mode);
+		for (unsigned int pass = 0; pass < passes; ++pass) {
+			Shader& shader = renderer->begin(mode, pass);
+			shader.setInt("texture1", 0);
+			shader.setInt("texture2", 1);
+			shader.setFloat("percentage", 0.2f);
+
+			for (int z = -FIELD_SIZE / 2; z < FIELD_SIZE / 2; ++z) {
+				for (int x = -FIELD_SIZE / 2; x < FIELD_SIZE / 2; ++x) {
+					glm::vec3 position = glm::vec3(x * 2.0f, -1.5f, z * 2.0f);
+					bool visible = passes > 1 ? renderer->isVisible(pass, position, CUBE_RADIUS)
+						: renderer->isVisibleInAny(position, CUBE_RADIUS);
+					if (!visible) {
+						continue;
+					}
+
+					glm::mat4 model = glm::mat4(1.0f);
+					model = glm::translate(model, position);
+					shader.setMat4("model", model);
+					if (mode == MultiViewRenderer::MODE_LAYERED) {
+						geometry->drawInstanced(cubeMesh, instances);
+					}
+					else {
+						geometry->draw(cubeMesh);
+					}
+					++drawSum;
+				}
+			}
+		}
+		renderer->end();
+		glEndQuery(GL_TIME_ELAPSED);
+		cpuSum += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		geometry->endFrame();
+
+		renderer->present(windowWidth, windowHeight);
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		GLuint64 gpuTime = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &gpuTime);
+		gpuSum += gpuTime / 1000000.0;
+		++frames;
+
+		// the sweep steps through every view count and mode, then hands over to the keys
+		bool report = sweeping ? ++sweepFrame % SWEEP_FRAMES == 0 : glfwGetTime() - lastReport > 1.0;
+		if (report) {
+			std::cout << "MULTIVIEW::views " << viewCount << " | " << MultiViewRenderer::modeName(mode)
+				<< " | CPU " << cpuSum / frames << " ms"
+				<< " | GPU " << gpuSum / frames << " ms"
+				<< " | draws/frame " << (double)drawSum / frames << std::endl;
+			cpuSum = gpuSum = 0.0;
+			drawSum = 0;
+			frames = 0;
+			lastReport = glfwGetTime();
+		}
+		if (sweeping && report) {
+			do {
+				mode = (MultiViewRenderer::Mode)(mode + 1);
+			} while (mode != MultiViewRenderer::MODE_COUNT && !renderer->isSupported(mode));
+			if (mode == MultiViewRenderer::MODE_COUNT) {
+				mode = MultiViewRenderer::MODE_SEPARATE_PASSES;
+				++viewOption;
+			}
+			if (viewOption == VIEW_COUNT_OPTIONS) {
+				viewOption = 0;
+				mode = MultiViewRenderer::MODE_LAYERED;
+				sweeping = false;
+			}
+			settingsChanged = true;
+		}
+	}
+
+	// deallocate objects
+	glDeleteQueries(1, &query);
+	delete renderer;
+	delete geometry;
+	glDeleteTextures(1, &texture);
+	glDeleteTextures(1, &texture2);
+
+	glfwTerminate();
+	return 0;
+}
+
+// stereo pair, cube map faces or cameras spread around the field
+void buildViews(unsigned int count, float time, glm::mat4* viewProjections) {
+	glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+	if (count == 6) {
+		// probe in the middle of the field
+		const glm::vec3 directions[6] = {
+			glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+			glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+		};
+		const glm::vec3 ups[6] = {
+			glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f),
+			glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)
+		};
+		glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+		glm::vec3 probe = glm::vec3(0.0f, 1.0f, 0.0f);
+		for (unsigned int face = 0; face < 6; ++face) {
+			viewProjections[face] = projection * glm::lookAt(probe, probe + directions[face], ups[face]);
+		}
+		return;
+	}
+
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+	for (unsigned int view = 0; view < count; ++view) {
+		float angle = time * 0.1f + 6.2831853f * view / count;
+		glm::vec3 cameraPos = glm::vec3(sin(angle) * 30.0f, 8.0f, cos(angle) * 30.0f);
+		glm::vec3 target = glm::vec3(0.0f);
+		if (count == 2) {
+			// one camera, eyes 6.4 cm apart
+			angle = time * 0.1f;
+			glm::vec3 center = glm::vec3(sin(angle) * 30.0f, 8.0f, cos(angle) * 30.0f);
+			glm::vec3 right = glm::normalize(glm::cross(target - center, up));
+			cameraPos = center + right * (view == 0 ? -0.032f : 0.032f);
+			target += right * (view == 0 ? -0.032f : 0.032f);
+		}
+		viewProjections[view] = projection * glm::lookAt(cameraPos, target, up);
+	}
+}
+
+// whenever the window is resized this function gets called
+void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+	windowWidth = width;
+	windowHeight = height;
+}
+
+// react to key presses
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	if (action != GLFW_PRESS) {
+		return;
+	}
+	if (key == GLFW_KEY_ESCAPE) {
+		glfwSetWindowShouldClose(window, true);
+	}
+	if (key == GLFW_KEY_V) {
+		viewOption = (viewOption + 1) % VIEW_COUNT_OPTIONS;
+		settingsChanged = true;
+	}
+	if (key == GLFW_KEY_M) {
+		mode = (MultiViewRenderer::Mode)((mode + 1) % MultiViewRenderer::MODE_COUNT);
+		settingsChanged = true;
+	}
+}
+
+// load an image into a mipmapped texture
+unsigned int loadTexture(const char* path) {
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width, height, nrChannels;
+	unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 4);
+	if (data) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else {
+		std::cout << "Failed to load texture" << std::endl;
+	}
+
+	stbi_image_free(data);
+	return texture;
+}
\ No newline at end of file
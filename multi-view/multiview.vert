@@ -0,0 +1,55 @@
+#version 330 core
+// one of these is defined by MultiViewRenderer:
+// LAYER_FROM_VERTEX   instanced, view = instance % viewCount, gl_Layer written here
+// LAYER_FROM_GEOMETRY instanced, view = instance % viewCount, multiview.geom writes gl_Layer
+// OVR_MULTIVIEW       the driver runs the shader once per view, VIEW_COUNT views
+// neither             one view per pass, picked by viewIndex
+#if defined(LAYER_FROM_VERTEX)
+#extension GL_ARB_shader_viewport_layer_array : enable
+#extension GL_AMD_vertex_shader_layer : enable
+#elif defined(OVR_MULTIVIEW)
+#extension GL_OVR_multiview : require
+layout (num_views = VIEW_COUNT) in;
+#endif
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+#if defined(LAYER_FROM_GEOMETRY)
+out vec2 vTexCoord;
+flat out int vView;
+#else
+out vec2 TexCoord;
+#endif
+
+// written by MultiViewRenderer::setViews
+layout (std140) uniform Views
+{
+	mat4 viewProjection[16];
+	int viewCount;
+};
+
+uniform mat4 model;
+uniform int viewIndex;
+
+void main()
+{
+#if defined(LAYER_FROM_VERTEX) || defined(LAYER_FROM_GEOMETRY)
+	int view = gl_InstanceID % viewCount;
+#elif defined(OVR_MULTIVIEW)
+	int view = int(gl_ViewID_OVR);
+#else
+	int view = viewIndex;
+#endif
+
+	gl_Position = viewProjection[view] * model * vec4(aPos, 1.0f);
+#if defined(LAYER_FROM_GEOMETRY)
+	vTexCoord = aTexCoord;
+	vView = view;
+#else
+	TexCoord = aTexCoord;
+#endif
+#if defined(LAYER_FROM_VERTEX)
+	gl_Layer = view;
+#endif
+}
\ No newline at end of file
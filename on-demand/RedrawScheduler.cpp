@@ -0,0 +1,216 @@
+#include "RedrawScheduler.h"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+static const double NEVER = 1e30;
+
+RedrawScheduler::RedrawScheduler(Mode mode, double maxWait)
+	: mode(mode), maxWait(maxWait), fullInvalid(true), hasDamage(false), damage(0), animationEnd(0.0), nextWake(NEVER),
+	canvasFBO(0), canvasColor(0), canvasDepth(0), canvasWidth(0), canvasHeight(0) {
+	resetStats();
+}
+
+RedrawScheduler::~RedrawScheduler() {
+	deleteCanvas();
+}
+
+void RedrawScheduler::setMode(Mode newMode) {
+	mode = newMode;
+	if (mode != MODE_ON_DEMAND_PARTIAL) {
+		deleteCanvas();
+	}
+	// the window has to show the new mode's frame
+	fullInvalid = true;
+}
+
+const char* RedrawScheduler::modeName(Mode mode) {
+	switch (mode) {
+	case MODE_CONTINUOUS: return "continuous";
+	case MODE_ON_DEMAND: return "on demand";
+	case MODE_ON_DEMAND_PARTIAL: return "on demand, partial";
+	default: return "unknown";
+	}
+}
+
+void RedrawScheduler::invalidate() {
+	fullInvalid = true;
+}
+
+void RedrawScheduler::invalidateRegion(int x, int y, int width, int height) {
+	if (width <= 0 || height <= 0) {
+		return;
+	}
+	// one rectangle around all of it, overlays are few and small
+	if (!hasDamage) {
+		damage = glm::ivec4(x, y, width, height);
+		hasDamage = true;
+		return;
+	}
+	int x1 = std::max(damage.x + damage.z, x + width), y1 = std::max(damage.y + damage.w, y + height);
+	damage.x = std::min(damage.x, x);
+	damage.y = std::min(damage.y, y);
+	damage.z = x1 - damage.x;
+	damage.w = y1 - damage.y;
+}
+
+void RedrawScheduler::animateUntil(double time) {
+	animationEnd = std::max(animationEnd, time);
+}
+
+void RedrawScheduler::wakeAt(double time) {
+	nextWake = std::min(nextWake, time);
+}
+
+void RedrawScheduler::waitForEvents() {
+	double now = glfwGetTime();
+	if (mode == MODE_CONTINUOUS || fullInvalid || hasDamage || now < animationEnd || now >= nextWake) {
+		glfwPollEvents();
+	}
+	else {
+		glfwWaitEventsTimeout(std::min(nextWake - now, maxWait));
+	}
+	if (glfwGetTime() >= nextWake) {
+		nextWake = NEVER;
+	}
+}
+
+bool RedrawScheduler::beginFrame(GLFWwindow* window) {
+	int width, height;
+	glfwGetFramebufferSize(window, &width, &height);
+	if (width <= 0 || height <= 0) {
+		// minimized
+		return false;
+	}
+
+	if (mode == MODE_ON_DEMAND_PARTIAL && (width != canvasWidth || height != canvasHeight)) {
+		createCanvas(width, height);
+		fullInvalid = true;
+	}
+	bool animating = glfwGetTime() < animationEnd;
+	if (mode != MODE_CONTINUOUS && !fullInvalid && !hasDamage && !animating) {
+		++emptyWakeups;
+		return false;
+	}
+	// without the canvas there is nothing to keep, any change redraws everything
+	bool full = mode != MODE_ON_DEMAND_PARTIAL || fullInvalid || animating;
+
+	if (full) {
+		damage = glm::ivec4(0, 0, width, height);
+	}
+	else {
+		int x0 = std::max(damage.x, 0), y0 = std::max(damage.y, 0);
+		int x1 = std::min(damage.x + damage.z, width), y1 = std::min(damage.y + damage.w, height);
+		damage = glm::ivec4(x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0));
+		++partialFrames;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, mode == MODE_ON_DEMAND_PARTIAL ? canvasFBO : 0);
+	glViewport(0, 0, width, height);
+	if (!full) {
+		// glClear respects the scissor too, everything outside keeps the last frame
+		glEnable(GL_SCISSOR_TEST);
+		glScissor(damage.x, damage.y, damage.z, damage.w);
+	}
+
+	++frames;
+	drawnPixels += (double)damage.z * damage.w;
+	framePixels += (double)width * height;
+	return true;
+}
+
+void RedrawScheduler::endFrame(GLFWwindow* window) {
+	if (mode == MODE_ON_DEMAND_PARTIAL) {
+		glDisable(GL_SCISSOR_TEST);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, canvasFBO);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		glBlitFramebuffer(0, 0, canvasWidth, canvasHeight, 0, 0, canvasWidth, canvasHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+	glfwSwapBuffers(window);
+	fullInvalid = false;
+	hasDamage = false;
+}
+
+double RedrawScheduler::processCpuTime() {
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+		return 0.0;
+	}
+	// 100 ns units
+	ULARGE_INTEGER k, u;
+	k.LowPart = kernel.dwLowDateTime;
+	k.HighPart = kernel.dwHighDateTime;
+	u.LowPart = user.dwLowDateTime;
+	u.HighPart = user.dwHighDateTime;
+	return (k.QuadPart + u.QuadPart) * 1e-7;
+#else
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+#endif
+}
+
+void RedrawScheduler::resetStats() {
+	statsStart = glfwGetTime();
+	cpuStart = processCpuTime();
+	frames = partialFrames = emptyWakeups = 0;
+	drawnPixels = framePixels = 0.0;
+}
+
+void RedrawScheduler::printStats() const {
+	double seconds = std::max(glfwGetTime() - statsStart, 1e-6);
+	double cpu = processCpuTime() - cpuStart;
+	// CPU seconds per wall minute is the power proxy: 60 s means one core kept busy
+	std::cout << "ONDEMAND::" << modeName(mode)
+		<< " | frames/s " << frames / seconds
+		<< " | partial " << (frames > 0 ? 100.0 * partialFrames / frames : 0.0) << "%"
+		<< " | wakeups without a frame/s " << emptyWakeups / seconds
+		<< " | pixels redrawn " << (framePixels > 0.0 ? 100.0 * drawnPixels / framePixels : 0.0) << "%"
+		<< " | CPU " << cpu * 60.0 / seconds << " s per minute (" << 100.0 * cpu / seconds << "% of a core)" << std::endl;
+}
+
+void RedrawScheduler::createCanvas(int width, int height) {
+	deleteCanvas();
+	canvasWidth = width;
+	canvasHeight = height;
+
+	glGenTextures(1, &canvasColor);
+	glBindTexture(GL_TEXTURE_2D, canvasColor);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glGenRenderbuffers(1, &canvasDepth);
+	glBindRenderbuffer(GL_RENDERBUFFER, canvasDepth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &canvasFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, canvasFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, canvasColor, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, canvasDepth);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cout << "ERROR::ONDEMAND::CANVAS_INCOMPLETE" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void RedrawScheduler::deleteCanvas() {
+	if (canvasFBO) {
+		glDeleteFramebuffers(1, &canvasFBO);
+		glDeleteTextures(1, &canvasColor);
+		glDeleteRenderbuffers(1, &canvasDepth);
+	}
+	canvasFBO = canvasColor = canvasDepth = 0;
+	canvasWidth = canvasHeight = 0;
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+// Draws a frame only when something changed. Input callbacks, timers and
+// resource updates invalidate the whole frame or a damage rectangle; running
+// animations keep it invalid until they end. With nothing to draw the loop
+// blocks in glfwWaitEventsTimeout until the next event or the next timer
+// instead of spinning on glfwPollEvents.
+//
+// In the partial mode frames are drawn into a retained canvas with the
+// scissor set to the damage, so a small 2D overlay change only redraws its
+// own pixels. The back buffer is undefined after a swap, so the whole
+// canvas is blitted to the window every drawn frame.
+//
+//   while (!glfwWindowShouldClose(window)) {
+//       scheduler.waitForEvents();
+//       ...update, invalidate what changed...
+//       if (scheduler.beginFrame(window)) { ...draw...; scheduler.endFrame(window); }
+//   }
+class RedrawScheduler {
+public:
+	enum Mode {
+		MODE_CONTINUOUS,        // poll and draw every iteration, as the lessons do
+		MODE_ON_DEMAND,         // wait for events, draw the whole frame when anything changed
+		MODE_ON_DEMAND_PARTIAL, // same, redraw only the damage into a retained canvas
+		MODE_COUNT
+	};
+
+	// maxWait: longest the loop sleeps without an event or timer, in seconds
+	RedrawScheduler(Mode mode = MODE_ON_DEMAND, double maxWait = 0.5);
+	~RedrawScheduler();
+
+	void setMode(Mode mode);
+	void nextMode() { setMode((Mode)((mode + 1) % MODE_COUNT)); }
+	Mode getMode() const { return mode; }
+	static const char* modeName(Mode mode);
+
+	void invalidate();
+	// framebuffer pixels, origin bottom left like glScissor
+	void invalidateRegion(int x, int y, int width, int height);
+	// draw every frame until time (glfwGetTime seconds)
+	void animateUntil(double time);
+	// wake up at time even without events, e.g. a clock that ticks every second
+	void wakeAt(double time);
+
+	// poll when a frame is due, otherwise block until an event or the next wake up
+	void waitForEvents();
+	// true when a frame has to be drawn: the target is bound and, when partial, the scissor set
+	bool beginFrame(GLFWwindow* window);
+	// show the frame and forget the damage
+	void endFrame(GLFWwindow* window);
+	// x, y, width, height of what the current frame redraws
+	glm::ivec4 getDamage() const { return damage; }
+
+	// user + system CPU time of the process in seconds
+	static double processCpuTime();
+	// stats since the last reset
+	void resetStats();
+	void printStats() const;
+
+private:
+	Mode mode;
+	double maxWait;
+	bool fullInvalid;
+	bool hasDamage;
+	glm::ivec4 damage; // x, y, width, height
+	double animationEnd;
+	double nextWake;
+
+	// retained canvas of the partial mode
+	unsigned int canvasFBO, canvasColor, canvasDepth;
+	int canvasWidth, canvasHeight;
+
+	double statsStart;
+	double cpuStart;
+	unsigned long long frames, partialFrames, emptyWakeups;
+	double drawnPixels, framePixels;
+
+	void createCanvas(int width, int height);
+	void deleteCanvas();
+};
\ No newline at end of file
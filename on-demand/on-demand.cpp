@@ -0,0 +1,247 @@
+// on demand rendering demo: the shader-lesson-1.4 triangle under a 2D overlay with a clock bar
+// that ticks once a second and a marker that follows the cursor. SPACE slides the triangle for
+// a second. sweeps continuous, on demand and on demand with partial redraw while idle first and
+// prints frames and CPU time per minute of each, then M cycles the mode.
+
+#include <cmath>
+#include <iostream>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include "../shader-lesson-1.4/Shader.h"
+#include "../sprite-batch/SpriteBatch.h"
+#include "RedrawScheduler.h"
+
+const unsigned int WIDTH = 800;
+const unsigned int HEIGHT = 600;
+
+const double SWEEP_SECONDS = 10.0;
+const double ANIMATION_SECONDS = 1.0;
+// clock bar in the top left corner, pixels from the top
+const int BAR_X = 16, BAR_Y = 16, BAR_WIDTH = 200, BAR_HEIGHT = 12;
+const unsigned int BAR_STEPS = 10;
+const int MARKER_SIZE = 16;
+
+RedrawScheduler* scheduler = NULL;
+bool sweeping = true;
+bool modeChanged = false;
+double animationStart = -1.0;
+int framebufferWidth = WIDTH;
+int framebufferHeight = HEIGHT;
+// top left corner of the marker in framebuffer pixels, origin top left
+glm::ivec2 marker(-MARKER_SIZE, -MARKER_SIZE);
+
+void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+void windowRefreshCallback(GLFWwindow* window);
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void cursorCallback(GLFWwindow* window, double xpos, double ypos);
+void invalidateTopLeftRect(int x, int y, int width, int height);
+
+int main() {
+	// initialize GLFW
+	glfwInit();
+	// set version and core profile
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// create a window
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	// set callback to handle when window is resized
+	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+	// uncovered or restored, the back buffer contents are gone
+	glfwSetWindowRefreshCallback(window, windowRefreshCallback);
+	glfwSetKeyCallback(window, keyCallback);
+	glfwSetCursorPosCallback(window, cursorCallback);
+
+	// initialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// present on vblank, continuous mode runs at the refresh rate like the lessons
+	glfwSwapInterval(1);
+	glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+
+	Shader shader("../shader-lesson-1.4/les1.4-vShader.vert", "../shader-lesson-1.4/les1.4-fShader.frag");
+
+	float vertices[] = {
+		// positions         // colors
+		-0.5f, -0.5f, 0.0f,  1.0f, 0.0f, 0.0f, // bottom left
+		 0.0f,  0.5f, 0.0f,  0.0f, 1.0f, 0.0f, // top
+		 0.5f, -0.5f, 0.0f,  0.0f, 0.0f, 1.0f  // bottom right
+	};
+
+	unsigned int VBO, VAO;
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	// the overlay is untextured, sprites sample one white texel
+	SpriteBatch* overlay = new SpriteBatch();
+	unsigned char white[] = { 255, 255, 255, 255 };
+	unsigned int whiteTexture;
+	glGenTextures(1, &whiteTexture);
+	glBindTexture(GL_TEXTURE_2D, whiteTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	scheduler = new RedrawScheduler(RedrawScheduler::MODE_CONTINUOUS);
+	double lastReport = glfwGetTime();
+	unsigned int clockStep = 0;
+
+	// render loop
+	while (!glfwWindowShouldClose(window)) {
+		scheduler->waitForEvents();
+		double now = glfwGetTime();
+
+		// the sweep measures every mode idle, then hands over to the keys
+		if (sweeping && now - lastReport >= SWEEP_SECONDS) {
+			scheduler->printStats();
+			if (scheduler->getMode() + 1 == RedrawScheduler::MODE_COUNT) {
+				sweeping = false;
+			}
+			else {
+				scheduler->nextMode();
+			}
+			modeChanged = true;
+		}
+		if (modeChanged) {
+			scheduler->resetStats();
+			lastReport = now;
+			modeChanged = false;
+		}
+		if (sweeping) {
+			scheduler->wakeAt(lastReport + SWEEP_SECONDS);
+		}
+
+		// the clock bar grows one step a second, only its own pixels change
+		unsigned int step = (unsigned int)now % BAR_STEPS;
+		if (step != clockStep) {
+			clockStep = step;
+			invalidateTopLeftRect(BAR_X, BAR_Y, BAR_WIDTH, BAR_HEIGHT);
+		}
+		scheduler->wakeAt(std::floor(now) + 1.0);
+
+		if (!scheduler->beginFrame(window)) {
+			continue;
+		}
+
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		float slide = 0.0f;
+		if (animationStart >= 0.0 && now - animationStart < ANIMATION_SECONDS) {
+			slide = (float)sin((now - animationStart) / ANIMATION_SECONDS * 6.2831853) * 0.3f;
+		}
+		shader.use();
+		shader.setFloat("xOffset", slide);
+		shader.setFloat("yOffset", 0.0f);
+		glBindVertexArray(VAO);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glBindVertexArray(0);
+
+		overlay->begin(framebufferWidth, framebufferHeight);
+		float filled = (float)(clockStep + 1) / BAR_STEPS;
+		overlay->draw(whiteTexture, glm::vec4(BAR_X, BAR_Y, BAR_WIDTH, BAR_HEIGHT), glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),
+			SpriteBatch::rgba(0, 0, 0, 128));
+		overlay->draw(whiteTexture, glm::vec4(BAR_X, BAR_Y, BAR_WIDTH * filled, BAR_HEIGHT), glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),
+			SpriteBatch::rgba(255, 200, 60));
+		overlay->draw(whiteTexture, glm::vec4(marker.x, marker.y, MARKER_SIZE, MARKER_SIZE), glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),
+			SpriteBatch::rgba(255, 255, 255, 200));
+		overlay->end();
+
+		scheduler->endFrame(window);
+	}
+
+	if (!sweeping) {
+		scheduler->printStats();
+	}
+
+	// deallocate objects
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteTextures(1, &whiteTexture);
+	glDeleteProgram(shader.ID);
+	delete overlay;
+	delete scheduler;
+
+	glfwTerminate();
+	return 0;
+}
+
+// whenever the window is resized this function gets called
+void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+	framebufferWidth = width;
+	framebufferHeight = height;
+	scheduler->invalidate();
+}
+
+// the system asks for the window contents again
+void windowRefreshCallback(GLFWwindow* window) {
+	scheduler->invalidate();
+}
+
+// react to key presses
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	if (action != GLFW_PRESS) {
+		return;
+	}
+	if (key == GLFW_KEY_ESCAPE) {
+		glfwSetWindowShouldClose(window, true);
+	}
+	if (key == GLFW_KEY_SPACE) {
+		animationStart = glfwGetTime();
+		scheduler->animateUntil(animationStart + ANIMATION_SECONDS);
+	}
+	if (key == GLFW_KEY_M) {
+		if (!sweeping) {
+			scheduler->printStats();
+		}
+		scheduler->nextMode();
+		sweeping = false;
+		modeChanged = true;
+	}
+}
+
+// the marker moves: its old and its new place have to be redrawn
+void cursorCallback(GLFWwindow* window, double xpos, double ypos) {
+	int windowWidth, windowHeight;
+	glfwGetWindowSize(window, &windowWidth, &windowHeight);
+	// window coordinates differ from pixels on high DPI screens
+	double scaleX = windowWidth > 0 ? (double)framebufferWidth / windowWidth : 1.0;
+	double scaleY = windowHeight > 0 ? (double)framebufferHeight / windowHeight : 1.0;
+	invalidateTopLeftRect(marker.x, marker.y, MARKER_SIZE, MARKER_SIZE);
+	marker = glm::ivec2((int)(xpos * scaleX) - MARKER_SIZE / 2, (int)(ypos * scaleY) - MARKER_SIZE / 2);
+	invalidateTopLeftRect(marker.x, marker.y, MARKER_SIZE, MARKER_SIZE);
+}
+
+// overlay rectangles are placed from the top left, damage is counted from the bottom left
+void invalidateTopLeftRect(int x, int y, int width, int height) {
+	scheduler->invalidateRegion(x, framebufferHeight - y - height, width, height);
+}
\ No newline at end of file
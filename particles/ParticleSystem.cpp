@@ -0,0 +1,473 @@
+#include "ParticleSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARTICLES_SSE
+#endif
+
+// 4.3 names missing from headers generated for 3.3
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_SHADER_STORAGE_BARRIER_BIT
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#endif
+#ifndef GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT
+#define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT 0x00000001
+#endif
+#ifndef GL_COMMAND_BARRIER_BIT
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#endif
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+// threads per compute group, matches local_size_x in the shaders
+const unsigned int GROUP_SIZE = 256;
+// smallest chunk the CPU simulation hands to a thread, a multiple of 4
+const unsigned int MIN_GRAIN = 16384;
+
+// vertex count, instance count, first, base instance
+const unsigned int EMPTY_ARGS[4] = { 4, 0, 0, 0 };
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+ParticleSystem::ParticleSystem(unsigned int capacity, ThreadPool& pool, GLADloadproc loader,
+	bool uploadToGPU, const char* shaderDirectory)
+	: backend(BACKEND_CPU), capacity(capacity), pool(pool), uploadToGPU(uploadToGPU), useSIMD(true),
+	threadCount(pool.getConcurrency()), gravity(0.0f, -9.81f, 0.0f), drag(0.1f), emitRemainder(0.0f),
+	rng(7), count(0), current(0), quadBuffer(0), instanceBuffer(0), frame(0),
+	simulateShader(NULL), emitShader(NULL), renderShader(NULL),
+	dispatchCompute(NULL), memoryBarrier(NULL), drawArraysIndirect(NULL),
+	updateTime(0.0), renderTime(0.0) {
+	emitter.position = glm::vec3(0.0f);
+	emitter.rate = 10000.0f;
+	emitter.speed = 6.0f;
+	emitter.spread = 0.35f;
+	emitter.minLife = 2.0f;
+	emitter.maxLife = 4.0f;
+
+	if (uploadToGPU && loader && computeSupported()) {
+		dispatchCompute = (DispatchComputeProc)loader("glDispatchCompute");
+		memoryBarrier = (MemoryBarrierProc)loader("glMemoryBarrier");
+		drawArraysIndirect = (DrawArraysIndirectProc)loader("glDrawArraysIndirect");
+		if (dispatchCompute && memoryBarrier && drawArraysIndirect) {
+			backend = BACKEND_GPU;
+		}
+	}
+
+	if (backend == BACKEND_CPU) {
+		for (std::vector<float>* stream : { &positionX, &positionY, &positionZ,
+			&velocityX, &velocityY, &velocityZ, &life, &lifeRate }) {
+			stream->resize(capacity);
+		}
+		instanceData.resize((size_t)capacity * 4);
+	}
+
+	std::fill(&queryPending[0][0], &queryPending[0][0] + 4, false);
+	if (!uploadToGPU) {
+		return;
+	}
+
+	std::string directory = shaderDirectory;
+	renderShader = new Shader((directory + "particle.vert").c_str(), (directory + "particle.frag").c_str());
+	glGenQueries(4, &queries[0][0]);
+
+	// one camera facing quad, drawn as a triangle strip
+	const float corners[] = { -1.0f, -1.0f,  1.0f, -1.0f,  -1.0f, 1.0f,  1.0f, 1.0f };
+	glGenBuffers(1, &quadBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glGenVertexArrays(2, VAOs);
+
+	if (backend == BACKEND_GPU) {
+		simulateShader = new Shader((directory + "simulate.comp").c_str());
+		emitShader = new Shader((directory + "emit.comp").c_str());
+
+		glGenBuffers(2, positionBuffers);
+		glGenBuffers(2, velocityBuffers);
+		glGenBuffers(2, argsBuffers);
+		for (int set = 0; set < 2; ++set) {
+			glBindBuffer(GL_COPY_WRITE_BUFFER, positionBuffers[set]);
+			glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity * sizeof(glm::vec4), NULL, GL_DYNAMIC_COPY);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, velocityBuffers[set]);
+			glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity * sizeof(glm::vec4), NULL, GL_DYNAMIC_COPY);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, argsBuffers[set]);
+			glBufferData(GL_COPY_WRITE_BUFFER, sizeof(EMPTY_ARGS), EMPTY_ARGS, GL_DYNAMIC_COPY);
+			setupVertexArray(VAOs[set], positionBuffers[set]);
+		}
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+	else {
+		glGenBuffers(1, &instanceBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)capacity * sizeof(glm::vec4), NULL, GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		setupVertexArray(VAOs[0], instanceBuffer);
+		setupVertexArray(VAOs[1], instanceBuffer);
+	}
+}
+
+ParticleSystem::~ParticleSystem() {
+	Shader* shaders[] = { simulateShader, emitShader, renderShader };
+	for (Shader* shader : shaders) {
+		if (shader) {
+			glDeleteProgram(shader->ID);
+			delete shader;
+		}
+	}
+	if (!uploadToGPU) {
+		return;
+	}
+
+	if (backend == BACKEND_GPU) {
+		glDeleteBuffers(2, positionBuffers);
+		glDeleteBuffers(2, velocityBuffers);
+		glDeleteBuffers(2, argsBuffers);
+	}
+	else {
+		glDeleteBuffers(1, &instanceBuffer);
+	}
+	glDeleteBuffers(1, &quadBuffer);
+	glDeleteVertexArrays(2, VAOs);
+	glDeleteQueries(4, &queries[0][0]);
+}
+
+bool ParticleSystem::computeSupported() {
+	// the shaders are #version 430
+	GLint major = 0, minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	return major > 4 || (major == 4 && minor >= 3);
+}
+
+const char* ParticleSystem::backendName(Backend backend) {
+	return backend == BACKEND_GPU ? "GPU compute" : "CPU";
+}
+
+void ParticleSystem::update(float deltaTime) {
+	emitRemainder += emitter.rate * deltaTime;
+	unsigned int emitCount = (unsigned int)std::min(emitRemainder, (float)capacity);
+	emitRemainder -= (float)emitCount;
+	emitRemainder = std::min(emitRemainder, 1.0f);
+
+	if (backend == BACKEND_GPU) {
+		updateGPU(deltaTime, emitCount);
+	}
+	else {
+		updateCPU(deltaTime, emitCount);
+	}
+}
+
+void ParticleSystem::render(const glm::mat4& view, const glm::mat4& projection, unsigned int texture, float size) {
+	unsigned int slot = frame % 2;
+	readQuery(slot, 1, renderTime);
+	glBeginQuery(GL_TIME_ELAPSED, queries[slot][1]);
+
+	// additive blending, order does not matter and nothing needs sorting
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE);
+	glDepthMask(GL_FALSE);
+
+	renderShader->use();
+	renderShader->setMat4("view", view);
+	renderShader->setMat4("projection", projection);
+	renderShader->setFloat("size", size);
+	renderShader->setInt("particleTexture", 0);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	glBindVertexArray(VAOs[current]);
+	if (backend == BACKEND_GPU) {
+		// instance count straight from the compute pass
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, argsBuffers[current]);
+		drawArraysIndirect(GL_TRIANGLE_STRIP, NULL);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+	else if (count > 0) {
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+	}
+	glBindVertexArray(0);
+
+	glDepthMask(GL_TRUE);
+	glDisable(GL_BLEND);
+
+	glEndQuery(GL_TIME_ELAPSED);
+	queryPending[slot][1] = true;
+	++frame;
+}
+
+unsigned int ParticleSystem::getAliveCount() {
+	if (backend == BACKEND_CPU) {
+		return count;
+	}
+	unsigned int args[4] = { 0, 0, 0, 0 };
+	glBindBuffer(GL_COPY_READ_BUFFER, argsBuffers[current]);
+	glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(args), args);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	return std::min(args[1], capacity);
+}
+
+void ParticleSystem::updateGPU(float deltaTime, unsigned int emitCount) {
+	unsigned int slot = frame % 2;
+	readQuery(slot, 0, updateTime);
+	glBeginQuery(GL_TIME_ELAPSED, queries[slot][0]);
+
+	unsigned int source = current;
+	unsigned int destination = 1 - current;
+
+	// the destination count starts at zero, simulate and emit add to it
+	glBindBuffer(GL_COPY_WRITE_BUFFER, argsBuffers[destination]);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, 0, sizeof(EMPTY_ARGS), EMPTY_ARGS);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, positionBuffers[source]);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, velocityBuffers[source]);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, positionBuffers[destination]);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, velocityBuffers[destination]);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, argsBuffers[source]);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, argsBuffers[destination]);
+
+	// the CPU does not know the count, every slot gets a thread and the extra ones exit
+	simulateShader->use();
+	simulateShader->setFloat("deltaTime", deltaTime);
+	simulateShader->setVec3("gravity", gravity);
+	simulateShader->setFloat("drag", std::exp(-drag * deltaTime));
+	dispatchCompute((capacity + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+	memoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	if (emitCount > 0) {
+		emitShader->use();
+		emitShader->setInt("emitCount", (int)emitCount);
+		emitShader->setInt("capacity", (int)capacity);
+		emitShader->setInt("seed", (int)rng());
+		emitShader->setVec3("origin", emitter.position);
+		emitShader->setFloat("speed", emitter.speed);
+		emitShader->setFloat("spread", emitter.spread);
+		emitShader->setFloat("minLife", emitter.minLife);
+		emitShader->setFloat("maxLife", emitter.maxLife);
+		dispatchCompute((emitCount + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+	}
+	// the draw reads the arrays as vertex attributes and the count as indirect arguments
+	memoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+	glEndQuery(GL_TIME_ELAPSED);
+	queryPending[slot][0] = true;
+	current = destination;
+}
+
+void ParticleSystem::updateCPU(float deltaTime, unsigned int emitCount) {
+	auto start = std::chrono::high_resolution_clock::now();
+	float dragFactor = std::exp(-drag * deltaTime);
+
+	// integrate and pack survivors per chunk, in parallel
+	unsigned int threads = std::max(1u, std::min(threadCount, pool.getConcurrency()));
+	unsigned int grain = std::max(MIN_GRAIN, ((count + threads - 1) / threads + 3) & ~3u);
+	unsigned int chunks = (count + grain - 1) / grain;
+	chunkAlive.resize(chunks);
+	if (threads > 1 && chunks > 1) {
+		pool.parallelFor(count, grain, [this, deltaTime, dragFactor, grain](unsigned int begin, unsigned int end) {
+			chunkAlive[begin / grain] = simulate(deltaTime, dragFactor, begin, end);
+		});
+	}
+	else if (chunks > 0) {
+		for (unsigned int chunk = 0; chunk < chunks; ++chunk) {
+			unsigned int begin = chunk * grain;
+			chunkAlive[chunk] = simulate(deltaTime, dragFactor, begin, std::min(begin + grain, count));
+		}
+	}
+
+	// close the gaps between chunks
+	unsigned int alive = chunks > 0 ? chunkAlive[0] : 0;
+	for (unsigned int chunk = 1; chunk < chunks; ++chunk) {
+		unsigned int begin = chunk * grain;
+		unsigned int survivors = chunkAlive[chunk];
+		for (std::vector<float>* stream : { &positionX, &positionY, &positionZ,
+			&velocityX, &velocityY, &velocityZ, &life, &lifeRate }) {
+			float* data = stream->data();
+			std::memmove(data + alive, data + begin, survivors * sizeof(float));
+		}
+		alive += survivors;
+	}
+	count = alive;
+
+	// new particles go behind the survivors
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	emitCount = std::min(emitCount, capacity - count);
+	for (unsigned int i = 0; i < emitCount; ++i) {
+		float angle = unit(rng) * 6.2831853f;
+		float radius = emitter.spread * std::sqrt(unit(rng));
+		glm::vec3 direction = glm::normalize(glm::vec3(std::cos(angle) * radius, 1.0f, std::sin(angle) * radius));
+		glm::vec3 velocity = direction * emitter.speed * (0.75f + 0.5f * unit(rng));
+		float lifetime = emitter.minLife + (emitter.maxLife - emitter.minLife) * unit(rng);
+
+		unsigned int index = count++;
+		positionX[index] = emitter.position.x;
+		positionY[index] = emitter.position.y;
+		positionZ[index] = emitter.position.z;
+		velocityX[index] = velocity.x;
+		velocityY[index] = velocity.y;
+		velocityZ[index] = velocity.z;
+		life[index] = 1.0f;
+		lifeRate[index] = 1.0f / lifetime;
+	}
+
+	if (uploadToGPU && count > 0) {
+		// interleave for the draw and upload into a fresh buffer
+		if (threads > 1 && count > MIN_GRAIN) {
+			pool.parallelFor(count, MIN_GRAIN, [this](unsigned int begin, unsigned int end) {
+				packInstances(begin, end);
+			});
+		}
+		else {
+			packInstances(0, count);
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)capacity * sizeof(glm::vec4), NULL, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)count * sizeof(glm::vec4), instanceData.data());
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	updateTime = elapsedMs(start);
+}
+
+unsigned int ParticleSystem::simulate(float deltaTime, float dragFactor, unsigned int begin, unsigned int end) {
+	if (useSIMD) {
+		integrateSIMD(deltaTime, dragFactor, begin, end);
+	}
+	else {
+		integrateScalar(deltaTime, dragFactor, begin, end);
+	}
+
+	// particles die roughly in birth order, so the first dead one is usually near the front
+	unsigned int alive = begin;
+	for (unsigned int i = begin; i < end; ++i) {
+		if (life[i] > 0.0f) {
+			if (alive != i) {
+				moveParticle(i, alive);
+			}
+			++alive;
+		}
+	}
+	return alive - begin;
+}
+
+void ParticleSystem::integrateScalar(float deltaTime, float dragFactor, unsigned int begin, unsigned int end) {
+	for (unsigned int i = begin; i < end; ++i) {
+		velocityX[i] = (velocityX[i] + gravity.x * deltaTime) * dragFactor;
+		velocityY[i] = (velocityY[i] + gravity.y * deltaTime) * dragFactor;
+		velocityZ[i] = (velocityZ[i] + gravity.z * deltaTime) * dragFactor;
+		positionX[i] += velocityX[i] * deltaTime;
+		positionY[i] += velocityY[i] * deltaTime;
+		positionZ[i] += velocityZ[i] * deltaTime;
+		life[i] -= lifeRate[i] * deltaTime;
+	}
+}
+
+void ParticleSystem::integrateSIMD(float deltaTime, float dragFactor, unsigned int begin, unsigned int end) {
+	unsigned int i = begin;
+#ifdef PARTICLES_SSE
+	// 4 particles per step, one register per component
+	const __m128 dt = _mm_set1_ps(deltaTime);
+	const __m128 damping = _mm_set1_ps(dragFactor);
+	const __m128 gx = _mm_set1_ps(gravity.x * deltaTime);
+	const __m128 gy = _mm_set1_ps(gravity.y * deltaTime);
+	const __m128 gz = _mm_set1_ps(gravity.z * deltaTime);
+	float* px = positionX.data();
+	float* py = positionY.data();
+	float* pz = positionZ.data();
+	float* vx = velocityX.data();
+	float* vy = velocityY.data();
+	float* vz = velocityZ.data();
+	float* l = life.data();
+	const float* rate = lifeRate.data();
+	for (; i + 4 <= end; i += 4) {
+		__m128 x = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vx + i), gx), damping);
+		__m128 y = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vy + i), gy), damping);
+		__m128 z = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vz + i), gz), damping);
+		_mm_storeu_ps(vx + i, x);
+		_mm_storeu_ps(vy + i, y);
+		_mm_storeu_ps(vz + i, z);
+		_mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(x, dt)));
+		_mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(y, dt)));
+		_mm_storeu_ps(pz + i, _mm_add_ps(_mm_loadu_ps(pz + i), _mm_mul_ps(z, dt)));
+		_mm_storeu_ps(l + i, _mm_sub_ps(_mm_loadu_ps(l + i), _mm_mul_ps(_mm_loadu_ps(rate + i), dt)));
+	}
+#endif
+	integrateScalar(deltaTime, dragFactor, i, end);
+}
+
+void ParticleSystem::moveParticle(unsigned int from, unsigned int to) {
+	positionX[to] = positionX[from];
+	positionY[to] = positionY[from];
+	positionZ[to] = positionZ[from];
+	velocityX[to] = velocityX[from];
+	velocityY[to] = velocityY[from];
+	velocityZ[to] = velocityZ[from];
+	life[to] = life[from];
+	lifeRate[to] = lifeRate[from];
+}
+
+void ParticleSystem::packInstances(unsigned int begin, unsigned int end) {
+	float* out = instanceData.data();
+	unsigned int i = begin;
+#ifdef PARTICLES_SSE
+	// SoA to xyzw with a 4x4 transpose
+	if (useSIMD) {
+		for (; i + 4 <= end; i += 4) {
+			__m128 x = _mm_loadu_ps(&positionX[i]);
+			__m128 y = _mm_loadu_ps(&positionY[i]);
+			__m128 z = _mm_loadu_ps(&positionZ[i]);
+			__m128 w = _mm_loadu_ps(&life[i]);
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+			_mm_storeu_ps(out + (size_t)i * 4, x);
+			_mm_storeu_ps(out + (size_t)i * 4 + 4, y);
+			_mm_storeu_ps(out + (size_t)i * 4 + 8, z);
+			_mm_storeu_ps(out + (size_t)i * 4 + 12, w);
+		}
+	}
+#endif
+	for (; i < end; ++i) {
+		out[(size_t)i * 4] = positionX[i];
+		out[(size_t)i * 4 + 1] = positionY[i];
+		out[(size_t)i * 4 + 2] = positionZ[i];
+		out[(size_t)i * 4 + 3] = life[i];
+	}
+}
+
+void ParticleSystem::setupVertexArray(unsigned int VAO, unsigned int instances) {
+	glBindVertexArray(VAO);
+
+	// quad corner
+	glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	// particle position + life, once per instance
+	glBindBuffer(GL_ARRAY_BUFFER, instances);
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribDivisor(1, 1);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ParticleSystem::readQuery(unsigned int slot, unsigned int kind, double& result) {
+	// issued two frames ago, normally finished by now
+	if (!queryPending[slot][kind]) {
+		return;
+	}
+	GLuint64 nanoseconds = 0;
+	glGetQueryObjectui64v(queries[slot][kind], GL_QUERY_RESULT, &nanoseconds);
+	result = nanoseconds / 1000000.0;
+	queryPending[slot][kind] = false;
+}
\ No newline at end of file
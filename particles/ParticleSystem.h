@@ -0,0 +1,124 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../shader-lesson-1.4/Shader.h"
+#include "../thread-pool/ThreadPool.h"
+
+// a fountain: particles leave one point upwards, inside a cone
+struct ParticleEmitter {
+	glm::vec3 position;
+	float rate;     // particles per second
+	float speed;    // initial speed, +-25%
+	float spread;   // cone radius at unit height, 0 = straight up
+	float minLife, maxLife; // seconds
+};
+
+// Particle system with its state in structure of arrays form: positions and
+// velocities are separate arrays, every update writes the survivors packed
+// into a second set and new particles are appended behind them.
+//
+// GPU backend (4.3 or the compute + SSBO extensions): the arrays are shader
+// storage buffers, emit/simulate/compact run in compute shaders and the draw
+// takes its instance count from the buffer the compute pass filled, so the
+// particle count never comes back to the CPU.
+// CPU backend: one float array per component, simulated 4 particles at a time
+// with SSE on the thread pool, then uploaded as the same per instance stream.
+// Both render camera facing quads, one instance per particle.
+class ParticleSystem {
+public:
+	enum Backend { BACKEND_GPU, BACKEND_CPU };
+
+	// the GPU backend is picked when the context can run it and a loader is given
+	// (the compute entry points are not in a 3.3 glad). uploadToGPU = false keeps
+	// everything on the CPU without touching GL (benchmarks). shaderDirectory
+	// holds the particle shaders
+	ParticleSystem(unsigned int capacity, ThreadPool& pool, GLADloadproc loader = NULL,
+		bool uploadToGPU = true, const char* shaderDirectory = "../particles/");
+	~ParticleSystem();
+
+	static bool computeSupported();
+	Backend getBackend() const { return backend; }
+	static const char* backendName(Backend backend);
+
+	void setEmitter(const ParticleEmitter& emitter) { this->emitter = emitter; }
+	void setGravity(const glm::vec3& gravity) { this->gravity = gravity; }
+	void update(float deltaTime);
+	// additive, no depth writes; texture is a regular 2D texture
+	void render(const glm::mat4& view, const glm::mat4& projection, unsigned int texture, float size = 0.05f);
+
+	// CPU backend options
+	void setUseSIMD(bool enabled) { useSIMD = enabled; }
+	void setThreadCount(unsigned int threads) { threadCount = threads; }
+
+	unsigned int getCapacity() const { return capacity; }
+	// reads the count back from the GPU backend and waits for it, only for reports
+	unsigned int getAliveCount();
+	// milliseconds; CPU time on the CPU backend, GPU time on the GPU backend
+	// (timer queries, a frame behind). render is always GPU time
+	double getUpdateTime() const { return updateTime; }
+	double getRenderTime() const { return renderTime; }
+
+private:
+	typedef void (APIENTRYP DispatchComputeProc)(GLuint x, GLuint y, GLuint z);
+	typedef void (APIENTRYP MemoryBarrierProc)(GLbitfield barriers);
+	typedef void (APIENTRYP DrawArraysIndirectProc)(GLenum mode, const void* indirect);
+
+	Backend backend;
+	unsigned int capacity;
+	ThreadPool& pool;
+	bool uploadToGPU;
+	bool useSIMD;
+	unsigned int threadCount;
+
+	ParticleEmitter emitter;
+	glm::vec3 gravity;
+	float drag;
+	float emitRemainder; // fraction of a particle carried to the next frame
+	std::mt19937 rng;
+
+	// CPU state, life is 1 at birth and dead at 0, lifeRate = 1 / lifetime
+	std::vector<float> positionX, positionY, positionZ;
+	std::vector<float> velocityX, velocityY, velocityZ;
+	std::vector<float> life, lifeRate;
+	std::vector<float> instanceData; // xyz + life per particle, what the GPU draws
+	std::vector<unsigned int> chunkAlive; // survivors per simulated chunk
+	unsigned int count;
+
+	// GPU state, two sets swapped every update
+	unsigned int positionBuffers[2], velocityBuffers[2];
+	unsigned int argsBuffers[2]; // DrawArraysIndirectCommand, instance count = particles
+	unsigned int current;
+	unsigned int quadBuffer;
+	unsigned int instanceBuffer; // CPU backend upload target
+	unsigned int VAOs[2];
+	unsigned int frame;
+
+	Shader* simulateShader;
+	Shader* emitShader;
+	Shader* renderShader;
+	DispatchComputeProc dispatchCompute;
+	MemoryBarrierProc memoryBarrier;
+	DrawArraysIndirectProc drawArraysIndirect;
+
+	// [update, render] x 2 frames in flight
+	unsigned int queries[2][2];
+	bool queryPending[2][2];
+	double updateTime, renderTime;
+
+	void updateGPU(float deltaTime, unsigned int emitCount);
+	void updateCPU(float deltaTime, unsigned int emitCount);
+	// integrate [begin, end) and pack the survivors at begin, returns how many
+	unsigned int simulate(float deltaTime, float dragFactor, unsigned int begin, unsigned int end);
+	void integrateScalar(float deltaTime, float dragFactor, unsigned int begin, unsigned int end);
+	void integrateSIMD(float deltaTime, float dragFactor, unsigned int begin, unsigned int end);
+	void moveParticle(unsigned int from, unsigned int to);
+	void packInstances(unsigned int begin, unsigned int end);
+	void setupVertexArray(unsigned int VAO, unsigned int instances);
+	void readQuery(unsigned int slot, unsigned int kind, double& result);
+};
\ No newline at end of file
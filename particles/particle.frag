@@ -0,0 +1,14 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in float Life;
+
+uniform sampler2D particleTexture;
+
+void main()
+{
+	// additive, fades out over the particle's life
+	vec4 color = texture(particleTexture, TexCoord);
+	FragColor = vec4(color.rgb * color.a * Life, 1.0f);
+}
\ No newline at end of file
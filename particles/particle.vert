@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec2 aCorner;
+// per instance: position + life left
+layout (location = 1) in vec4 aParticle;
+
+out vec2 TexCoord;
+out float Life;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float size;
+
+void main()
+{
+	// camera facing quad, shrinks as the particle dies
+	vec4 center = view * vec4(aParticle.xyz, 1.0f);
+	vec2 offset = aCorner * size * (0.25f + 0.75f * aParticle.w);
+	gl_Position = projection * (center + vec4(offset, 0.0f, 0.0f));
+	TexCoord = aCorner * 0.5f + 0.5f;
+	Life = aParticle.w;
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+// CPU particle simulation benchmark, runs without a GL context
+// steady state fountain of 100k to 4M particles for scalar/SIMD and 1/N threads
+
+#include <iostream>
+#include "ParticleSystem.h"
+
+int main() {
+	const unsigned int capacities[] = { 100000, 1000000, 4000000 };
+	const float DELTA_TIME = 1.0f / 60.0f;
+	const int WARMUP_FRAMES = 240;
+	const int ITERATIONS = 100;
+
+	ThreadPool& pool = ThreadPool::global();
+
+	struct Config { const char* name; bool simd; unsigned int threads; };
+	const Config configs[] = {
+		{ "scalar 1 thread", false, 1 },
+		{ "simd 1 thread", true, 1 },
+		{ "simd all threads", true, pool.getConcurrency() }
+	};
+
+	std::cout << "threads available: " << pool.getConcurrency() << std::endl;
+	for (unsigned int capacity : capacities) {
+		for (const Config& config : configs) {
+			ParticleSystem particles(capacity, pool, NULL, false);
+			particles.setUseSIMD(config.simd);
+			particles.setThreadCount(config.threads);
+
+			// about 90% full once the first particles start dying
+			ParticleEmitter emitter;
+			emitter.position = glm::vec3(0.0f);
+			emitter.rate = capacity * 0.9f / 3.0f;
+			emitter.speed = 7.0f;
+			emitter.spread = 0.4f;
+			emitter.minLife = 2.0f;
+			emitter.maxLife = 4.0f;
+			particles.setEmitter(emitter);
+			for (int i = 0; i < WARMUP_FRAMES; ++i) {
+				particles.update(DELTA_TIME);
+			}
+
+			double update = 0.0;
+			unsigned long long simulated = 0;
+			for (int i = 0; i < ITERATIONS; ++i) {
+				simulated += particles.getAliveCount();
+				particles.update(DELTA_TIME);
+				update += particles.getUpdateTime();
+			}
+
+			std::cout << capacity << " capacity, " << config.name
+				<< ": alive " << particles.getAliveCount()
+				<< " | update " << update / ITERATIONS << " ms"
+				<< " | " << simulated / update / 1000.0 << " M particles/s" << std::endl;
+		}
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,177 @@
+// particle demo: a fountain of up to millions of textured billboards
+// usage: particles [capacity] [--cpu], --cpu forces the CPU simulation even when compute is available.
+// prints update and render throughput once per second
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../mipmap-generator/MipGenerator.h"
+#include "ParticleSystem.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <std_image/stb_image.h>
+
+const unsigned int WIDTH = 800;
+const unsigned int HEIGHT = 600;
+
+void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+int main(int argc, char** argv) {
+	unsigned int capacity = 1000000;
+	bool forceCPU = false;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--cpu") == 0) {
+			forceCPU = true;
+		}
+		else {
+			capacity = std::stoul(argv[i]);
+		}
+	}
+
+	// initialize GLFW
+	glfwInit();
+	// compute needs 4.3, fall back to the usual 3.3 core context
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// create a window
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL) {
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+	}
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	// set callback to handle when window is resized
+	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+	glfwSetKeyCallback(window, keyCallback);
+
+	// initialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// no vsync, we want to see the frame time
+	glfwSwapInterval(0);
+
+	ParticleSystem* particles = new ParticleSystem(capacity, ThreadPool::global(),
+		forceCPU ? NULL : (GLADloadproc)glfwGetProcAddress);
+	std::cout << "PARTICLES::renderer " << glGetString(GL_RENDERER)
+		<< " | backend " << ParticleSystem::backendName(particles->getBackend())
+		<< " | capacity " << capacity << std::endl;
+
+	// enough particles per second to keep the buffers about 90% full at 3 s average life
+	ParticleEmitter emitter;
+	emitter.position = glm::vec3(0.0f, -1.0f, 0.0f);
+	emitter.rate = capacity * 0.9f / 3.0f;
+	emitter.speed = 7.0f;
+	emitter.spread = 0.4f;
+	emitter.minLife = 2.0f;
+	emitter.maxLife = 4.0f;
+	particles->setEmitter(emitter);
+
+	// same texture path as the lessons: stb_image + CPU mip chain
+	MipGenerator mipGenerator;
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	int width, height, nrChannels;
+	unsigned char* data = stbi_load("../textures-lesson-1.5/awesomeface.png", &width, &height, &nrChannels, 0);
+	if (data) {
+		MipGenerator::upload(mipGenerator.generate(data, width, height, nrChannels));
+	}
+	else {
+		std::cout << "Failed to load texture" << std::endl;
+	}
+	stbi_image_free(data);
+
+	glEnable(GL_DEPTH_TEST);
+
+	double lastFrame = glfwGetTime();
+	double lastReport = lastFrame;
+	double updateSum = 0.0, renderSum = 0.0;
+	unsigned int frames = 0;
+
+	// render loop
+	while (!glfwWindowShouldClose(window)) {
+		double currentFrame = glfwGetTime();
+		float deltaTime = (float)std::min(currentFrame - lastFrame, 0.1);
+		lastFrame = currentFrame;
+
+		particles->update(deltaTime);
+
+		// clear screen
+		glClearColor(0.05f, 0.05f, 0.08f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// camera circles the fountain
+		float time = (float)currentFrame;
+		glm::vec3 cameraPos = glm::vec3(sin(time * 0.2f) * 12.0f, 4.0f, cos(time * 0.2f) * 12.0f);
+		glm::mat4 view = glm::lookAt(cameraPos, glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)WIDTH / (float)HEIGHT, 0.1f, 100.0f);
+		particles->render(view, projection, texture);
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		updateSum += particles->getUpdateTime();
+		renderSum += particles->getRenderTime();
+		++frames;
+		if (glfwGetTime() - lastReport > 1.0) {
+			// reading the count back stalls the GPU backend, once a second is fine
+			double alive = particles->getAliveCount();
+			double update = updateSum / frames;
+			double render = renderSum / frames;
+			std::cout << "PARTICLES::" << ParticleSystem::backendName(particles->getBackend())
+				<< " | alive " << alive
+				<< " | update " << update << " ms (" << (update > 0.0 ? alive / update / 1000.0 : 0.0) << " M/s)"
+				<< " | render " << render << " ms (" << (render > 0.0 ? alive / render / 1000.0 : 0.0) << " M/s)"
+				<< " | frame " << (glfwGetTime() - lastReport) * 1000.0 / frames << " ms" << std::endl;
+			updateSum = renderSum = 0.0;
+			frames = 0;
+			lastReport = glfwGetTime();
+		}
+	}
+
+	// deallocate objects
+	delete particles;
+	glDeleteTextures(1, &texture);
+
+	glfwTerminate();
+	return 0;
+}
+
+// whenever the window is resized this function gets called
+void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+	// tell OpenGL the size of the window
+	glViewport(0, 0, width, height);
+}
+
+// react to key presses
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
+		glfwSetWindowShouldClose(window, true);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "BVH.h"
+
+#include <algorithm>
+
+void BVH::build(const std::vector<AABB>& bounds, unsigned int maxLeafSize) {
+	unsigned int count = (unsigned int)bounds.size();
+	nodes.clear();
+	parents.clear();
+	indices.resize(count);
+	primitiveLeaf.assign(count, (unsigned int)INVALID_NODE);
+	centroids.resize(count);
+	leafCount = 0;
+	depth = 0;
+	for (unsigned int i = 0; i < count; ++i) {
+		indices[i] = i;
+		centroids[i] = bounds[i].center();
+	}
+
+	// at most 2n - 1 nodes, reserving keeps the references below stable
+	nodes.reserve(std::max(1u, 2 * count));
+	parents.reserve(std::max(1u, 2 * count));
+
+	Node root;
+	root.leftFirst = 0;
+	root.count = count;
+	updateBounds(root, bounds);
+	nodes.push_back(root);
+	parents.push_back((unsigned int)INVALID_NODE);
+
+	// explicit stack, a degenerate split sequence could get deep
+	std::vector<std::pair<unsigned int, unsigned int>> stack; // node, depth
+	stack.push_back(std::make_pair(0u, 1u));
+	while (!stack.empty()) {
+		unsigned int nodeIndex = stack.back().first;
+		unsigned int nodeDepth = stack.back().second;
+		stack.pop_back();
+		depth = std::max(depth, nodeDepth);
+
+		Node node = nodes[nodeIndex];
+		unsigned int split = node.leftFirst;
+		if (count > 0 && nodeDepth < MAX_DEPTH) {
+			split = findSplit(node, bounds, maxLeafSize);
+		}
+		if (split == node.leftFirst) {
+			for (unsigned int i = node.leftFirst; i < node.leftFirst + node.count; ++i) {
+				primitiveLeaf[indices[i]] = nodeIndex;
+			}
+			++leafCount;
+			continue;
+		}
+
+		Node left, right;
+		left.leftFirst = node.leftFirst;
+		left.count = split - node.leftFirst;
+		right.leftFirst = split;
+		right.count = node.count - left.count;
+		updateBounds(left, bounds);
+		updateBounds(right, bounds);
+
+		unsigned int leftIndex = (unsigned int)nodes.size();
+		nodes.push_back(left);
+		nodes.push_back(right);
+		parents.push_back(nodeIndex);
+		parents.push_back(nodeIndex);
+		nodes[nodeIndex].leftFirst = leftIndex;
+		nodes[nodeIndex].count = 0;
+
+		stack.push_back(std::make_pair(leftIndex + 1, nodeDepth + 1));
+		stack.push_back(std::make_pair(leftIndex, nodeDepth + 1));
+	}
+}
+
+void BVH::refit(const std::vector<AABB>& bounds, const unsigned int* changed, unsigned int changedCount) {
+	for (unsigned int i = 0; i < changedCount; ++i) {
+		unsigned int nodeIndex = primitiveLeaf[changed[i]];
+		if (nodeIndex == INVALID_NODE) {
+			continue;
+		}
+
+		// walk up until a node's bounds come out the same
+		Node& leaf = nodes[nodeIndex];
+		updateBounds(leaf, bounds);
+		nodeIndex = parents[nodeIndex];
+		while (nodeIndex != INVALID_NODE) {
+			Node& node = nodes[nodeIndex];
+			const Node& left = nodes[node.leftFirst];
+			const Node& right = nodes[node.leftFirst + 1];
+			glm::vec3 newMin = glm::min(left.min, right.min);
+			glm::vec3 newMax = glm::max(left.max, right.max);
+			if (newMin == node.min && newMax == node.max) {
+				break;
+			}
+			node.min = newMin;
+			node.max = newMax;
+			nodeIndex = parents[nodeIndex];
+		}
+	}
+}
+
+float BVH::cost() const {
+	if (nodes.empty()) {
+		return 0.0f;
+	}
+
+	// expected box tests + primitive tests per ray, relative to the root box
+	AABB root;
+	root.min = nodes[0].min;
+	root.max = nodes[0].max;
+	float rootArea = std::max(root.area(), FLT_MIN);
+	float total = 0.0f;
+	for (const Node& node : nodes) {
+		AABB box;
+		box.min = node.min;
+		box.max = node.max;
+		total += box.area() / rootArea * (node.isLeaf() ? (float)node.count : 1.0f);
+	}
+	return total;
+}
+
+float BVH::intersect(const Node& node, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance) {
+	glm::vec3 t0 = (node.min - origin) * inverseDirection;
+	glm::vec3 t1 = (node.max - origin) * inverseDirection;
+	glm::vec3 tNear = glm::min(t0, t1);
+	glm::vec3 tFar = glm::max(t0, t1);
+	float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+	float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+	return enter <= exit ? enter : FLT_MAX;
+}
+
+void BVH::updateBounds(Node& node, const std::vector<AABB>& bounds) const {
+	AABB box;
+	for (unsigned int i = node.leftFirst; i < node.leftFirst + node.count; ++i) {
+		box.grow(bounds[indices[i]]);
+	}
+	node.min = box.min;
+	node.max = box.max;
+}
+
+unsigned int BVH::findSplit(const Node& node, const std::vector<AABB>& bounds, unsigned int maxLeafSize) {
+	unsigned int first = node.leftFirst;
+	unsigned int last = node.leftFirst + node.count;
+	if (node.count <= 1) {
+		return first;
+	}
+
+	AABB centroidBounds;
+	for (unsigned int i = first; i < last; ++i) {
+		centroidBounds.grow(centroids[indices[i]]);
+	}
+
+	// bin the centroids along every axis and keep the cheapest plane
+	float bestCost = FLT_MAX;
+	int bestAxis = -1;
+	unsigned int bestBin = 0;
+	for (int axis = 0; axis < 3; ++axis) {
+		float lo = centroidBounds.min[axis];
+		float extent = centroidBounds.max[axis] - lo;
+		if (extent <= 0.0f) {
+			continue;
+		}
+
+		AABB binBounds[BINS];
+		unsigned int binCount[BINS] = {};
+		float scale = BINS / extent;
+		for (unsigned int i = first; i < last; ++i) {
+			unsigned int bin = std::min(BINS - 1, (unsigned int)((centroids[indices[i]][axis] - lo) * scale));
+			binBounds[bin].grow(bounds[indices[i]]);
+			++binCount[bin];
+		}
+
+		// sweep from the right for the area/count of everything past each plane
+		float rightArea[BINS];
+		unsigned int rightCount[BINS];
+		AABB box;
+		unsigned int sum = 0;
+		for (unsigned int bin = BINS - 1; bin > 0; --bin) {
+			box.grow(binBounds[bin]);
+			sum += binCount[bin];
+			rightArea[bin] = box.area();
+			rightCount[bin] = sum;
+		}
+		box = AABB();
+		sum = 0;
+		for (unsigned int bin = 0; bin < BINS - 1; ++bin) {
+			box.grow(binBounds[bin]);
+			sum += binCount[bin];
+			float planeCost = sum * box.area() + rightCount[bin + 1] * rightArea[bin + 1];
+			if (sum > 0 && rightCount[bin + 1] > 0 && planeCost < bestCost) {
+				bestCost = planeCost;
+				bestAxis = axis;
+				bestBin = bin;
+			}
+		}
+	}
+
+	AABB nodeBox;
+	nodeBox.min = node.min;
+	nodeBox.max = node.max;
+	float leafCost = node.count * nodeBox.area();
+	if (node.count <= maxLeafSize && bestCost >= leafCost) {
+		return first;
+	}
+
+	unsigned int* begin = indices.data();
+	if (bestAxis < 0) {
+		// every centroid in one spot, but too many for a leaf: split the list in half
+		return first + node.count / 2;
+	}
+
+	float lo = centroidBounds.min[bestAxis];
+	float scale = BINS / (centroidBounds.max[bestAxis] - lo);
+	unsigned int* middle = std::partition(begin + first, begin + last, [&](unsigned int index) {
+		return std::min(BINS - 1, (unsigned int)((centroids[index][bestAxis] - lo) * scale)) <= bestBin;
+	});
+	return (unsigned int)(middle - begin);
+}
\ No newline at end of file
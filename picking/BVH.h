@@ -0,0 +1,69 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cfloat>
+#include <vector>
+
+struct AABB {
+	glm::vec3 min = glm::vec3(FLT_MAX);
+	glm::vec3 max = glm::vec3(-FLT_MAX);
+
+	void grow(const glm::vec3& point) { min = glm::min(min, point); max = glm::max(max, point); }
+	void grow(const AABB& box) { min = glm::min(min, box.min); max = glm::max(max, box.max); }
+	glm::vec3 center() const { return (min + max) * 0.5f; }
+	float area() const {
+		glm::vec3 extent = max - min;
+		return extent.x < 0.0f ? 0.0f : 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+	}
+};
+
+// Bounding volume hierarchy over a list of boxes, built with binned SAH.
+// It only orders primitive indices, what a primitive is (a triangle, an
+// object) is up to the owner. Moving primitives can be refit in place: only
+// their leaves and the ancestors whose bounds actually change are touched.
+class BVH {
+public:
+	static const unsigned int BINS = 16;
+	static const unsigned int INVALID_NODE = 0xffffffff;
+	// deeper nodes become leaves whatever their size, traversal stacks can be fixed arrays
+	static const unsigned int MAX_DEPTH = 64;
+
+	// children of an inner node are always next to each other at leftFirst, leftFirst + 1
+	struct Node {
+		glm::vec3 min;
+		unsigned int leftFirst; // first child, or first index for a leaf
+		glm::vec3 max;
+		unsigned int count;     // 0 for inner nodes
+		bool isLeaf() const { return count > 0; }
+	};
+
+	void build(const std::vector<AABB>& bounds, unsigned int maxLeafSize);
+	// bounds holds the new boxes of every primitive, only the changed ones are read
+	void refit(const std::vector<AABB>& bounds, const unsigned int* changed, unsigned int changedCount);
+
+	const std::vector<Node>& getNodes() const { return nodes; }
+	// primitive indices in leaf order
+	const std::vector<unsigned int>& getIndices() const { return indices; }
+	unsigned int getLeafCount() const { return leafCount; }
+	unsigned int getDepth() const { return depth; }
+	// SAH cost of the tree, goes up when refits loosen it
+	float cost() const;
+
+	// slab test, returns the entry distance or FLT_MAX on a miss
+	static float intersect(const Node& node, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance);
+
+private:
+	std::vector<Node> nodes;
+	std::vector<unsigned int> indices;
+	std::vector<unsigned int> parents;
+	std::vector<unsigned int> primitiveLeaf; // primitive -> its leaf node
+	unsigned int leafCount;
+	unsigned int depth;
+
+	std::vector<glm::vec3> centroids;
+
+	void updateBounds(Node& node, const std::vector<AABB>& bounds) const;
+	// index of the first primitive that goes right, or first when splitting is not worth it
+	unsigned int findSplit(const Node& node, const std::vector<AABB>& bounds, unsigned int maxLeafSize);
+};
\ No newline at end of file
@@ -0,0 +1,418 @@
+#include "RayPicker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RAY_PICKER_SSE
+#endif
+
+// triangles with a smaller determinant are parallel to the ray (or padding)
+const float DETERMINANT_EPSILON = 1e-12f;
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// 1 / direction without infinities, keeps the slab test free of 0 * inf
+static glm::vec3 safeInverse(const glm::vec3& direction) {
+	glm::vec3 inverse;
+	for (int i = 0; i < 3; ++i) {
+		float d = direction[i];
+		inverse[i] = std::fabs(d) > 1e-20f ? 1.0f / d : std::copysign(1e20f, d);
+	}
+	return inverse;
+}
+
+RayPicker::RayPicker()
+	: rebuildNeeded(false), builtCost(0.0f), useSIMD(true), meshBuildTime(0.0), updateTime(0.0),
+	rebuilt(false), rebuilds(0), refits(0) {
+}
+
+unsigned int RayPicker::addMesh(const float* vertices, unsigned int vertexCount, unsigned int stride,
+	const unsigned int* indices, unsigned int indexCount) {
+	auto start = std::chrono::high_resolution_clock::now();
+
+	unsigned int triangleCount = (indices ? indexCount : vertexCount) / 3;
+	std::vector<glm::vec3> corners(triangleCount * 3);
+	for (unsigned int i = 0; i < triangleCount * 3; ++i) {
+		unsigned int vertex = indices ? indices[i] : i;
+		const float* position = vertices + (size_t)vertex * stride;
+		corners[i] = glm::vec3(position[0], position[1], position[2]);
+	}
+
+	MeshData mesh;
+	mesh.triangleCount = triangleCount;
+	std::vector<AABB> bounds(triangleCount);
+	for (unsigned int i = 0; i < triangleCount; ++i) {
+		for (int corner = 0; corner < 3; ++corner) {
+			bounds[i].grow(corners[i * 3 + corner]);
+		}
+		mesh.bounds.grow(bounds[i]);
+	}
+	mesh.bvh.build(bounds, LEAF_TRIANGLES);
+
+	// pack the triangles of every leaf into groups of 4, leaf order keeps them close in memory
+	const std::vector<BVH::Node>& nodes = mesh.bvh.getNodes();
+	const std::vector<unsigned int>& order = mesh.bvh.getIndices();
+	mesh.leafGroup.assign(nodes.size(), 0);
+	for (unsigned int nodeIndex = 0; nodeIndex < nodes.size(); ++nodeIndex) {
+		const BVH::Node& node = nodes[nodeIndex];
+		if (!node.isLeaf()) {
+			continue;
+		}
+
+		mesh.leafGroup[nodeIndex] = (unsigned int)mesh.groups.size();
+		for (unsigned int first = 0; first < node.count; first += 4) {
+			TriangleGroup group = {};
+			for (unsigned int lane = 0; lane < 4 && first + lane < node.count; ++lane) {
+				unsigned int triangle = order[node.leftFirst + first + lane];
+				glm::vec3 v0 = corners[triangle * 3];
+				glm::vec3 e1 = corners[triangle * 3 + 1] - v0;
+				glm::vec3 e2 = corners[triangle * 3 + 2] - v0;
+				group.v0x[lane] = v0.x; group.v0y[lane] = v0.y; group.v0z[lane] = v0.z;
+				group.e1x[lane] = e1.x; group.e1y[lane] = e1.y; group.e1z[lane] = e1.z;
+				group.e2x[lane] = e2.x; group.e2y[lane] = e2.y; group.e2z[lane] = e2.z;
+				group.triangle[lane] = triangle;
+			}
+			mesh.groups.push_back(group);
+		}
+	}
+
+	meshes.push_back(std::move(mesh));
+	meshBuildTime = elapsedMs(start);
+	return (unsigned int)meshes.size() - 1;
+}
+
+unsigned int RayPicker::addObject(unsigned int mesh, const glm::mat4& model) {
+	Object object;
+	object.mesh = mesh;
+	object.model = model;
+	object.inverse = glm::inverse(model);
+	objects.push_back(object);
+	objectBounds.push_back(AABB());
+
+	unsigned int id = (unsigned int)objects.size() - 1;
+	updateObjectBounds(id);
+	rebuildNeeded = true;
+	return id;
+}
+
+void RayPicker::setTransform(unsigned int object, const glm::mat4& model) {
+	objects[object].model = model;
+	objects[object].inverse = glm::inverse(model);
+	updateObjectBounds(object);
+	moved.push_back(object);
+}
+
+void RayPicker::update() {
+	rebuilt = false;
+	updateTime = 0.0;
+	if (!rebuildNeeded && moved.empty()) {
+		return;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	if (!rebuildNeeded) {
+		objectBVH.refit(objectBounds, moved.data(), (unsigned int)moved.size());
+		++refits;
+		// objects that moved far apart leave big overlapping boxes behind
+		rebuildNeeded = objectBVH.cost() > builtCost * 1.5f;
+	}
+	if (rebuildNeeded) {
+		objectBVH.build(objectBounds, 2);
+		builtCost = objectBVH.cost();
+		rebuildNeeded = false;
+		rebuilt = true;
+		++rebuilds;
+	}
+	moved.clear();
+	updateTime = elapsedMs(start);
+}
+
+PickHit RayPicker::pick(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const {
+	PickHit result;
+	result.hit = false;
+	result.object = 0;
+	result.triangle = 0;
+	result.distance = maxDistance;
+	result.position = origin;
+
+	const std::vector<BVH::Node>& nodes = objectBVH.getNodes();
+	if (nodes.empty() || objects.empty()) {
+		return result;
+	}
+
+	glm::vec3 rayDirection = glm::normalize(direction);
+	glm::vec3 inverseDirection = safeInverse(rayDirection);
+	const std::vector<unsigned int>& order = objectBVH.getIndices();
+
+	// near child first, far child on the stack with its entry distance
+	std::pair<unsigned int, float> stack[BVH::MAX_DEPTH];
+	unsigned int stackSize = 0;
+	unsigned int nodeIndex = 0;
+	float bestDistance = maxDistance;
+	if (BVH::intersect(nodes[0], origin, inverseDirection, bestDistance) == FLT_MAX) {
+		return result;
+	}
+
+	while (true) {
+		const BVH::Node& node = nodes[nodeIndex];
+		bool descend = false;
+		if (node.isLeaf()) {
+			for (unsigned int i = node.leftFirst; i < node.leftFirst + node.count; ++i) {
+				unsigned int id = order[i];
+				const Object& object = objects[id];
+				// mesh space ray, the direction keeps its scale so distances stay in world units
+				glm::vec3 localOrigin = glm::vec3(object.inverse * glm::vec4(origin, 1.0f));
+				glm::vec3 localDirection = glm::vec3(object.inverse * glm::vec4(rayDirection, 0.0f));
+				unsigned int triangle;
+				if (intersectMesh(meshes[object.mesh], localOrigin, localDirection, bestDistance, triangle)) {
+					result.hit = true;
+					result.object = id;
+					result.triangle = triangle;
+				}
+			}
+		}
+		else {
+			unsigned int nearChild = node.leftFirst;
+			unsigned int farChild = node.leftFirst + 1;
+			float nearDistance = BVH::intersect(nodes[nearChild], origin, inverseDirection, bestDistance);
+			float farDistance = BVH::intersect(nodes[farChild], origin, inverseDirection, bestDistance);
+			if (farDistance < nearDistance) {
+				std::swap(nearChild, farChild);
+				std::swap(nearDistance, farDistance);
+			}
+			if (nearDistance != FLT_MAX) {
+				if (farDistance != FLT_MAX) {
+					stack[stackSize++] = std::make_pair(farChild, farDistance);
+				}
+				nodeIndex = nearChild;
+				descend = true;
+			}
+		}
+
+		if (!descend) {
+			// skip whatever got further away than the best hit meanwhile
+			while (stackSize > 0 && stack[stackSize - 1].second >= bestDistance) {
+				--stackSize;
+			}
+			if (stackSize == 0) {
+				break;
+			}
+			nodeIndex = stack[--stackSize].first;
+		}
+	}
+
+	if (result.hit) {
+		result.distance = bestDistance;
+		result.position = origin + rayDirection * bestDistance;
+	}
+	return result;
+}
+
+void RayPicker::screenRay(float x, float y, float width, float height,
+	const glm::mat4& view, const glm::mat4& projection, glm::vec3& origin, glm::vec3& direction) {
+	// window pixels to normalized device coordinates, y points up in NDC
+	float ndcX = 2.0f * x / width - 1.0f;
+	float ndcY = 1.0f - 2.0f * y / height;
+
+	glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+	glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+	origin = glm::vec3(glm::inverse(view)[3]);
+	direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+}
+
+unsigned long long RayPicker::getTriangleCount() const {
+	unsigned long long count = 0;
+	for (const Object& object : objects) {
+		count += meshes[object.mesh].triangleCount;
+	}
+	return count;
+}
+
+void RayPicker::printStats() const {
+	std::cout << "RAYPICKER::objects " << objects.size()
+		<< " | meshes " << meshes.size()
+		<< " | triangles " << getTriangleCount()
+		<< " | object BVH depth " << objectBVH.getDepth()
+		<< " | rebuilds " << rebuilds << " refits " << refits << std::endl;
+}
+
+void RayPicker::updateObjectBounds(unsigned int object) {
+	const AABB& local = meshes[objects[object].mesh].bounds;
+	const glm::mat4& model = objects[object].model;
+	AABB world;
+	for (int corner = 0; corner < 8; ++corner) {
+		glm::vec3 point(corner & 1 ? local.max.x : local.min.x,
+			corner & 2 ? local.max.y : local.min.y,
+			corner & 4 ? local.max.z : local.min.z);
+		world.grow(glm::vec3(model * glm::vec4(point, 1.0f)));
+	}
+	objectBounds[object] = world;
+}
+
+bool RayPicker::intersectMesh(const MeshData& mesh, const glm::vec3& origin, const glm::vec3& direction,
+	float& bestDistance, unsigned int& triangle) const {
+	const std::vector<BVH::Node>& nodes = mesh.bvh.getNodes();
+	if (nodes.empty()) {
+		return false;
+	}
+
+	glm::vec3 inverseDirection = safeInverse(direction);
+	if (BVH::intersect(nodes[0], origin, inverseDirection, bestDistance) == FLT_MAX) {
+		return false;
+	}
+
+	std::pair<unsigned int, float> stack[BVH::MAX_DEPTH];
+	unsigned int stackSize = 0;
+	unsigned int nodeIndex = 0;
+	bool found = false;
+
+	while (true) {
+		const BVH::Node& node = nodes[nodeIndex];
+		bool descend = false;
+		if (node.isLeaf()) {
+			unsigned int firstGroup = mesh.leafGroup[nodeIndex];
+			unsigned int groupCount = (node.count + 3) / 4;
+			for (unsigned int i = firstGroup; i < firstGroup + groupCount; ++i) {
+				const TriangleGroup& group = mesh.groups[i];
+				int lane = -1;
+				if (useSIMD) {
+					intersectGroupSIMD(group, origin, direction, bestDistance, lane);
+				}
+				else {
+					intersectGroupScalar(group, origin, direction, bestDistance, lane);
+				}
+				if (lane >= 0) {
+					triangle = group.triangle[lane];
+					found = true;
+				}
+			}
+		}
+		else {
+			unsigned int nearChild = node.leftFirst;
+			unsigned int farChild = node.leftFirst + 1;
+			float nearDistance = BVH::intersect(nodes[nearChild], origin, inverseDirection, bestDistance);
+			float farDistance = BVH::intersect(nodes[farChild], origin, inverseDirection, bestDistance);
+			if (farDistance < nearDistance) {
+				std::swap(nearChild, farChild);
+				std::swap(nearDistance, farDistance);
+			}
+			if (nearDistance != FLT_MAX) {
+				if (farDistance != FLT_MAX) {
+					stack[stackSize++] = std::make_pair(farChild, farDistance);
+				}
+				nodeIndex = nearChild;
+				descend = true;
+			}
+		}
+
+		if (!descend) {
+			while (stackSize > 0 && stack[stackSize - 1].second >= bestDistance) {
+				--stackSize;
+			}
+			if (stackSize == 0) {
+				break;
+			}
+			nodeIndex = stack[--stackSize].first;
+		}
+	}
+	return found;
+}
+
+// Moller-Trumbore, one lane at a time
+void RayPicker::intersectGroupScalar(const TriangleGroup& group, const glm::vec3& origin, const glm::vec3& direction,
+	float& bestDistance, int& bestLane) {
+	for (int lane = 0; lane < 4; ++lane) {
+		glm::vec3 v0(group.v0x[lane], group.v0y[lane], group.v0z[lane]);
+		glm::vec3 e1(group.e1x[lane], group.e1y[lane], group.e1z[lane]);
+		glm::vec3 e2(group.e2x[lane], group.e2y[lane], group.e2z[lane]);
+
+		glm::vec3 p = glm::cross(direction, e2);
+		float determinant = glm::dot(e1, p);
+		if (std::fabs(determinant) <= DETERMINANT_EPSILON) {
+			continue;
+		}
+		float inverse = 1.0f / determinant;
+		glm::vec3 t = origin - v0;
+		float u = glm::dot(t, p) * inverse;
+		if (u < 0.0f || u > 1.0f) {
+			continue;
+		}
+		glm::vec3 q = glm::cross(t, e1);
+		float v = glm::dot(direction, q) * inverse;
+		if (v < 0.0f || u + v > 1.0f) {
+			continue;
+		}
+		float distance = glm::dot(e2, q) * inverse;
+		if (distance > 0.0f && distance < bestDistance) {
+			bestDistance = distance;
+			bestLane = lane;
+		}
+	}
+}
+
+// same test on all 4 lanes at once
+void RayPicker::intersectGroupSIMD(const TriangleGroup& group, const glm::vec3& origin, const glm::vec3& direction,
+	float& bestDistance, int& bestLane) {
+#ifdef RAY_PICKER_SSE
+	__m128 dx = _mm_set1_ps(direction.x), dy = _mm_set1_ps(direction.y), dz = _mm_set1_ps(direction.z);
+	__m128 e1x = _mm_loadu_ps(group.e1x), e1y = _mm_loadu_ps(group.e1y), e1z = _mm_loadu_ps(group.e1z);
+	__m128 e2x = _mm_loadu_ps(group.e2x), e2y = _mm_loadu_ps(group.e2y), e2z = _mm_loadu_ps(group.e2z);
+
+	// p = direction x e2
+	__m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+	__m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+	__m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+	__m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+
+	// t = origin - v0
+	__m128 tx = _mm_sub_ps(_mm_set1_ps(origin.x), _mm_loadu_ps(group.v0x));
+	__m128 ty = _mm_sub_ps(_mm_set1_ps(origin.y), _mm_loadu_ps(group.v0y));
+	__m128 tz = _mm_sub_ps(_mm_set1_ps(origin.z), _mm_loadu_ps(group.v0z));
+	__m128 u = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz));
+
+	// q = t x e1
+	__m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+	__m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+	__m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+	__m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz));
+	__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz));
+
+	// padding lanes have a zero determinant, the division result is masked away
+	__m128 absDeterminant = _mm_andnot_ps(_mm_set1_ps(-0.0f), determinant);
+	__m128 valid = _mm_cmpgt_ps(absDeterminant, _mm_set1_ps(DETERMINANT_EPSILON));
+	__m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), _mm_or_ps(_mm_andnot_ps(valid, _mm_set1_ps(1.0f)), _mm_and_ps(valid, determinant)));
+	u = _mm_mul_ps(u, inverse);
+	v = _mm_mul_ps(v, inverse);
+	distance = _mm_mul_ps(distance, inverse);
+
+	__m128 zero = _mm_setzero_ps();
+	valid = _mm_and_ps(valid, _mm_cmpge_ps(u, zero));
+	valid = _mm_and_ps(valid, _mm_cmpge_ps(v, zero));
+	valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+	valid = _mm_and_ps(valid, _mm_cmpgt_ps(distance, zero));
+	valid = _mm_and_ps(valid, _mm_cmplt_ps(distance, _mm_set1_ps(bestDistance)));
+
+	int mask = _mm_movemask_ps(valid);
+	if (mask == 0) {
+		return;
+	}
+	float distances[4];
+	_mm_storeu_ps(distances, distance);
+	for (int lane = 0; lane < 4; ++lane) {
+		if ((mask & (1 << lane)) && distances[lane] < bestDistance) {
+			bestDistance = distances[lane];
+			bestLane = lane;
+		}
+	}
+#else
+	intersectGroupScalar(group, origin, direction, bestDistance, bestLane);
+#endif
+}
\ No newline at end of file
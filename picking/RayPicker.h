@@ -0,0 +1,105 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cfloat>
+#include <vector>
+
+#include "BVH.h"
+
+struct PickHit {
+	bool hit;
+	unsigned int object;
+	unsigned int triangle; // index into the mesh's triangle list
+	float distance;        // along the normalized world ray
+	glm::vec3 position;
+};
+
+// Ray queries against meshes placed in the world, for selecting things with
+// the mouse. Two levels of BVH: one over the triangles of every mesh, built
+// once, and one over the world bounds of the objects, rebuilt when objects
+// are added and refit when they move.
+//
+// Mesh leaves hold up to 4 triangles stored as one SoA group, so the ray is
+// tested against all of them at once with SSE.
+class RayPicker {
+public:
+	static const unsigned int LEAF_TRIANGLES = 4;
+
+	RayPicker();
+
+	// positions are the first 3 floats of every vertex, stride in floats
+	// (GeometryHeap::VERTEX_FLOATS for heap meshes). no indices = triangle list
+	unsigned int addMesh(const float* vertices, unsigned int vertexCount, unsigned int stride,
+		const unsigned int* indices = NULL, unsigned int indexCount = 0);
+	unsigned int addObject(unsigned int mesh, const glm::mat4& model);
+	void setTransform(unsigned int object, const glm::mat4& model);
+
+	// rebuild the object BVH after adds, refit it after moves
+	void update();
+
+	// nearest hit along the ray, direction does not need to be normalized
+	PickHit pick(const glm::vec3& origin, const glm::vec3& direction, float maxDistance = FLT_MAX) const;
+
+	// world space ray from the camera through a window position (pixels, origin top left)
+	static void screenRay(float x, float y, float width, float height,
+		const glm::mat4& view, const glm::mat4& projection, glm::vec3& origin, glm::vec3& direction);
+
+	void setUseSIMD(bool enabled) { useSIMD = enabled; }
+
+	unsigned int getObjectCount() const { return (unsigned int)objects.size(); }
+	unsigned long long getTriangleCount() const;
+	// timings of the last build/refit in milliseconds
+	double getMeshBuildTime() const { return meshBuildTime; }
+	double getUpdateTime() const { return updateTime; }
+	bool lastUpdateRebuilt() const { return rebuilt; }
+	void printStats() const;
+
+private:
+	// 4 triangles as v0 + two edges, lanes past the end have zero edges and never hit
+	struct TriangleGroup {
+		float v0x[4], v0y[4], v0z[4];
+		float e1x[4], e1y[4], e1z[4];
+		float e2x[4], e2y[4], e2z[4];
+		unsigned int triangle[4];
+	};
+
+	struct MeshData {
+		BVH bvh;
+		std::vector<TriangleGroup> groups; // one per leaf
+		std::vector<unsigned int> leafGroup; // node -> group
+		AABB bounds;
+		unsigned int triangleCount;
+	};
+
+	struct Object {
+		unsigned int mesh;
+		glm::mat4 model;
+		glm::mat4 inverse;
+	};
+
+	std::vector<MeshData> meshes;
+	std::vector<Object> objects;
+	std::vector<AABB> objectBounds;
+	BVH objectBVH;
+	std::vector<unsigned int> moved;
+	bool rebuildNeeded;
+	// refits loosen the tree, rebuild once its cost grows past this factor
+	float builtCost;
+
+	bool useSIMD;
+	double meshBuildTime;
+	double updateTime;
+	bool rebuilt;
+	unsigned int rebuilds;
+	unsigned int refits;
+
+	void updateObjectBounds(unsigned int object);
+	// nearest hit in mesh space closer than bestDistance, updates it
+	bool intersectMesh(const MeshData& mesh, const glm::vec3& origin, const glm::vec3& direction,
+		float& bestDistance, unsigned int& triangle) const;
+	static void intersectGroupScalar(const TriangleGroup& group, const glm::vec3& origin, const glm::vec3& direction,
+		float& bestDistance, int& bestLane);
+	static void intersectGroupSIMD(const TriangleGroup& group, const glm::vec3& origin, const glm::vec3& direction,
+		float& bestDistance, int& bestLane);
+};
\ No newline at end of file
@@ -0,0 +1,151 @@
+// ray picking benchmark, runs without a GL context
+// query latency against 1M triangles as one mesh and as 1024 moving objects
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "RayPicker.h"
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// bumpy heightfield of size x size quads in [-1, 1], 2 triangles per quad
+static void makeTerrain(unsigned int size, std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+	for (unsigned int z = 0; z <= size; ++z) {
+		for (unsigned int x = 0; x <= size; ++x) {
+			float fx = 2.0f * x / size - 1.0f;
+			float fz = 2.0f * z / size - 1.0f;
+			vertices.push_back(fx);
+			vertices.push_back(0.05f * std::sin(fx * 40.0f) * std::cos(fz * 35.0f));
+			vertices.push_back(fz);
+		}
+	}
+	for (unsigned int z = 0; z < size; ++z) {
+		for (unsigned int x = 0; x < size; ++x) {
+			unsigned int i = z * (size + 1) + x;
+			unsigned int quad[6] = { i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2 };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+}
+
+// uv sphere of radius 0.5, slices * stacks * 2 triangles
+static void makeSphere(unsigned int slices, unsigned int stacks, std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+	for (unsigned int stack = 0; stack <= stacks; ++stack) {
+		float phi = 3.14159265f * stack / stacks;
+		for (unsigned int slice = 0; slice <= slices; ++slice) {
+			float theta = 2.0f * 3.14159265f * slice / slices;
+			vertices.push_back(0.5f * std::sin(phi) * std::cos(theta));
+			vertices.push_back(0.5f * std::cos(phi));
+			vertices.push_back(0.5f * std::sin(phi) * std::sin(theta));
+		}
+	}
+	for (unsigned int stack = 0; stack < stacks; ++stack) {
+		for (unsigned int slice = 0; slice < slices; ++slice) {
+			unsigned int i = stack * (slices + 1) + slice;
+			unsigned int quad[6] = { i, i + slices + 1, i + 1, i + 1, i + slices + 1, i + slices + 2 };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+}
+
+// average pick latency in microseconds and hit rate
+static void measure(RayPicker& picker, const std::vector<glm::vec3>& origins, const std::vector<glm::vec3>& targets,
+	const char* name) {
+	for (int simd = 0; simd < 2; ++simd) {
+		picker.setUseSIMD(simd == 1);
+		unsigned int hits = 0;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (unsigned int i = 0; i < origins.size(); ++i) {
+			if (picker.pick(origins[i], targets[i] - origins[i]).hit) {
+				++hits;
+			}
+		}
+		double ms = elapsedMs(start);
+		std::cout << name << (simd ? ", simd" : ", scalar")
+			<< ": " << ms * 1000.0 / origins.size() << " us/query"
+			<< " | hits " << 100.0 * hits / origins.size() << "%" << std::endl;
+	}
+}
+
+int main() {
+	const unsigned int QUERIES = 100000;
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	// one mesh with 1M triangles, rays from a camera above aimed anywhere on it
+	{
+		std::vector<float> vertices;
+		std::vector<unsigned int> indices;
+		makeTerrain(708, vertices, indices);
+
+		RayPicker picker;
+		unsigned int mesh = picker.addMesh(vertices.data(), (unsigned int)vertices.size() / 3, 3,
+			indices.data(), (unsigned int)indices.size());
+		picker.addObject(mesh, glm::scale(glm::mat4(1.0f), glm::vec3(50.0f)));
+		picker.update();
+		std::cout << "terrain: " << picker.getTriangleCount() << " triangles, BVH build "
+			<< picker.getMeshBuildTime() << " ms" << std::endl;
+
+		std::vector<glm::vec3> origins(QUERIES), targets(QUERIES);
+		for (unsigned int i = 0; i < QUERIES; ++i) {
+			origins[i] = glm::vec3(unit(rng) * 10.0f, 20.0f, 60.0f);
+			targets[i] = glm::vec3(unit(rng) * 50.0f, 0.0f, unit(rng) * 50.0f);
+		}
+		measure(picker, origins, targets, "terrain");
+	}
+
+	// 1024 spheres of 1024 triangles, a share of them moves before every query batch
+	{
+		std::vector<float> vertices;
+		std::vector<unsigned int> indices;
+		makeSphere(32, 16, vertices, indices);
+
+		RayPicker picker;
+		unsigned int mesh = picker.addMesh(vertices.data(), (unsigned int)vertices.size() / 3, 3,
+			indices.data(), (unsigned int)indices.size());
+		std::vector<glm::vec3> positions;
+		for (unsigned int i = 0; i < 1024; ++i) {
+			positions.push_back(glm::vec3(unit(rng), unit(rng), unit(rng)) * 20.0f);
+			picker.addObject(mesh, glm::translate(glm::mat4(1.0f), positions.back()));
+		}
+		picker.update();
+		std::cout << "objects: " << picker.getObjectCount() << " objects, " << picker.getTriangleCount()
+			<< " triangles, object BVH build " << picker.getUpdateTime() << " ms" << std::endl;
+
+		std::vector<glm::vec3> origins(QUERIES), targets(QUERIES);
+		for (unsigned int i = 0; i < QUERIES; ++i) {
+			origins[i] = glm::vec3(unit(rng), unit(rng), 1.0f) * 40.0f;
+			targets[i] = positions[i % positions.size()] + glm::vec3(unit(rng), unit(rng), unit(rng)) * 0.6f;
+		}
+		measure(picker, origins, targets, "objects");
+
+		// small moves are refits, the tree only gets rebuilt once it got too loose
+		const float movedShares[] = { 0.01f, 0.1f, 1.0f };
+		for (float share : movedShares) {
+			double update = 0.0;
+			unsigned int rebuilds = 0;
+			const int FRAMES = 100;
+			for (int frame = 0; frame < FRAMES; ++frame) {
+				for (unsigned int i = 0; i < (unsigned int)(positions.size() * share); ++i) {
+					unsigned int object = rng() % positions.size();
+					positions[object] += glm::vec3(unit(rng), unit(rng), unit(rng)) * 0.1f;
+					picker.setTransform(object, glm::translate(glm::mat4(1.0f), positions[object]));
+				}
+				picker.update();
+				update += picker.getUpdateTime();
+				rebuilds += picker.lastUpdateRebuilt() ? 1 : 0;
+			}
+			std::cout << share * 100.0f << "% moved per frame: update " << update / FRAMES * 1000.0 << " us"
+				<< " | rebuilds " << rebuilds << "/" << FRAMES << std::endl;
+		}
+		measure(picker, origins, targets, "objects after moves");
+	}
+
+	return 0;
+}
\ No newline at end of file
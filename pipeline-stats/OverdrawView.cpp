@@ -0,0 +1,215 @@
+#include "OverdrawView.h"
+
+#include <algorithm>
+#include <iostream>
+
+OverdrawView::OverdrawView(const char* vertexPath, const char* fragmentPath)
+	: count(COUNT_RASTERIZED), FBO(0), colorTexture(0), depthStencil(0), VAO(0), width(0), height(0),
+	querySet(0), frames(0) {
+	shader = new Shader(vertexPath, fragmentPath);
+	// the full screen triangle comes from gl_VertexID, the VAO only has to exist
+	glGenVertexArrays(1, &VAO);
+	glGenQueries(LEVELS, queries[0]);
+	glGenQueries(LEVELS, queries[1]);
+	queriesIssued[0] = queriesIssued[1] = false;
+	std::fill(histogram, histogram + LEVELS, 0ULL);
+	std::fill(levelSums, levelSums + LEVELS, 0ULL);
+}
+
+OverdrawView::~OverdrawView() {
+	deleteTarget();
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteQueries(LEVELS, queries[0]);
+	glDeleteQueries(LEVELS, queries[1]);
+	glDeleteProgram(shader->ID);
+	delete shader;
+}
+
+void OverdrawView::deleteTarget() {
+	if (FBO) {
+		glDeleteFramebuffers(1, &FBO);
+		glDeleteTextures(1, &colorTexture);
+		glDeleteRenderbuffers(1, &depthStencil);
+	}
+	FBO = colorTexture = depthStencil = 0;
+}
+
+void OverdrawView::resize(int newWidth, int newHeight) {
+	newWidth = std::max(newWidth, 1);
+	newHeight = std::max(newHeight, 1);
+	if (FBO && newWidth == width && newHeight == height) {
+		return;
+	}
+	deleteTarget();
+	width = newWidth;
+	height = newHeight;
+
+	glGenTextures(1, &colorTexture);
+	glBindTexture(GL_TEXTURE_2D, colorTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	// the counts live in the 8 stencil bits
+	glGenRenderbuffers(1, &depthStencil);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthStencil);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &FBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthStencil);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cout << "ERROR::OVERDRAW::FRAMEBUFFER_INCOMPLETE" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void OverdrawView::setCount(Count newCount) {
+	if (newCount == count) {
+		return;
+	}
+	count = newCount;
+	std::fill(histogram, histogram + LEVELS, 0ULL);
+	std::fill(levelSums, levelSums + LEVELS, 0ULL);
+	frames = 0;
+	// counted the other way
+	queriesIssued[0] = queriesIssued[1] = false;
+}
+
+void OverdrawView::begin() {
+	if (!FBO) {
+		resize(800, 600);
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glViewport(0, 0, width, height);
+	glDepthMask(GL_TRUE);
+	glStencilMask(0xFF);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClearStencil(0);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+	// only the stencil changes, the shaders still run as they would
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glEnable(GL_STENCIL_TEST);
+	glStencilFunc(GL_ALWAYS, 0, 0xFF);
+	if (count == COUNT_RASTERIZED) {
+		glStencilOp(GL_KEEP, GL_INCR, GL_INCR);
+	}
+	else {
+		glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+	}
+}
+
+void OverdrawView::end(unsigned int outputFBO) {
+	bool depthTestWasEnabled = glIsEnabled(GL_DEPTH_TEST) == GL_TRUE;
+	bool blendWasEnabled = glIsEnabled(GL_BLEND) == GL_TRUE;
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+	glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+	glStencilMask(0x00);
+
+	// last frame's counts are ready by now
+	unsigned int previous = querySet ^ 1;
+	if (queriesIssued[previous]) {
+		readQueries(previous);
+	}
+
+	shader->use();
+	glBindVertexArray(VAO);
+	for (unsigned int level = 0; level < LEVELS; ++level) {
+		// reference <= stencil for the last level
+		glStencilFunc(level + 1 == LEVELS ? GL_LEQUAL : GL_EQUAL, level, 0xFF);
+		shader->setVec3("levelColor", heatColor(level));
+		glBeginQuery(GL_SAMPLES_PASSED, queries[querySet][level]);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glEndQuery(GL_SAMPLES_PASSED);
+	}
+	glBindVertexArray(0);
+	queriesIssued[querySet] = true;
+	querySet = previous;
+
+	glStencilMask(0xFF);
+	glDisable(GL_STENCIL_TEST);
+	if (depthTestWasEnabled) {
+		glEnable(GL_DEPTH_TEST);
+	}
+	if (blendWasEnabled) {
+		glEnable(GL_BLEND);
+	}
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, outputFBO);
+	glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, outputFBO);
+}
+
+void OverdrawView::readQueries(unsigned int set) {
+	for (unsigned int level = 0; level < LEVELS; ++level) {
+		GLuint64 pixels = 0;
+		glGetQueryObjectui64v(queries[set][level], GL_QUERY_RESULT, &pixels);
+		histogram[level] = pixels;
+		levelSums[level] += pixels;
+	}
+	queriesIssued[set] = false;
+	++frames;
+}
+
+glm::vec3 OverdrawView::heatColor(unsigned int level) {
+	if (level == 0) {
+		return glm::vec3(0.0f);
+	}
+	// blue, cyan, green, yellow, red, then white for LEVELS - 1 and up
+	static const glm::vec3 ramp[] = {
+		glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+		glm::vec3(1.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f)
+	};
+	float t = (float)(level - 1) / (LEVELS - 2) * 5.0f;
+	unsigned int index = std::min((unsigned int)t, 4u);
+	return glm::mix(ramp[index], ramp[index + 1], t - index);
+}
+
+double OverdrawView::getAverageOverdraw() const {
+	unsigned long long covered = 0, fragments = 0;
+	for (unsigned int level = 1; level < LEVELS; ++level) {
+		covered += histogram[level];
+		fragments += histogram[level] * level;
+	}
+	return covered > 0 ? (double)fragments / covered : 0.0;
+}
+
+double OverdrawView::getCoverage() const {
+	unsigned long long total = 0;
+	for (unsigned int level = 0; level < LEVELS; ++level) {
+		total += histogram[level];
+	}
+	return total > 0 ? 1.0 - (double)histogram[0] / total : 0.0;
+}
+
+void OverdrawView::printStats() const {
+	unsigned long long total = 0, covered = 0, fragments = 0;
+	for (unsigned int level = 0; level < LEVELS; ++level) {
+		total += levelSums[level];
+		if (level > 0) {
+			covered += levelSums[level];
+			fragments += levelSums[level] * level;
+		}
+	}
+	if (total == 0) {
+		return;
+	}
+	// the last level counts as LEVELS - 1, the average is a lower bound when it is used
+	std::cout << "OVERDRAW::" << (count == COUNT_RASTERIZED ? "rasterized" : "depth passed") << " fragments"
+		<< " | frames " << frames
+		<< " | coverage " << 100.0 * covered / total << "%"
+		<< " | average per covered pixel " << (covered > 0 ? (double)fragments / covered : 0.0)
+		<< " | per screen pixel " << (double)fragments / total << std::endl;
+	std::cout << "OVERDRAW::histogram";
+	for (unsigned int level = 0; level < LEVELS; ++level) {
+		std::cout << " " << level << (level + 1 == LEVELS ? "+" : "") << ":" << 100.0 * levelSums[level] / total << "%";
+	}
+	std::cout << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "../shader-lesson-1.4/Shader.h"
+
+// Overdraw heat map. Between begin() and end() the scene is drawn with its own
+// shaders into a target of its own, with colour writes off and every fragment
+// incrementing the stencil; end() colours each stencil count, one full screen
+// pass per level with the stencil test picking the pixels, and blits the
+// heat map to the output. Every level pass also counts its pixels with an
+// occlusion query, read back a frame later, which gives the histogram and
+// the average overdraw without reading the stencil back.
+class OverdrawView {
+public:
+	enum Count {
+		COUNT_RASTERIZED,   // every fragment, also the ones the depth test rejects
+		COUNT_DEPTH_PASSED  // only fragments that passed the depth test
+	};
+
+	// the last level also holds every count above it
+	static const unsigned int LEVELS = 16;
+
+	OverdrawView(const char* vertexPath = "../post-processing/post.vert",
+		const char* fragmentPath = "../pipeline-stats/overdraw.frag");
+	~OverdrawView();
+
+	// size of the counting target, nothing happens when it already has that size
+	void resize(int width, int height);
+	// switching starts the stats over
+	void setCount(Count count);
+	Count getCount() const { return count; }
+
+	// bind the counting target with depth, stencil and colour cleared
+	void begin();
+	// colour the counts and blit them to outputFBO
+	void end(unsigned int outputFBO = 0);
+
+	// fragments per covered pixel and covered part of the screen, last frame read back
+	double getAverageOverdraw() const;
+	double getCoverage() const;
+	void printStats() const;
+
+private:
+	Shader* shader;
+	Count count;
+	unsigned int FBO, colorTexture, depthStencil;
+	unsigned int VAO;
+	int width, height;
+
+	// two sets of level queries, one is read while the other is written
+	unsigned int queries[2][LEVELS];
+	unsigned int querySet;
+	bool queriesIssued[2];
+	unsigned long long histogram[LEVELS];
+	unsigned long long frames;
+	unsigned long long levelSums[LEVELS];
+
+	static glm::vec3 heatColor(unsigned int level);
+	void readQueries(unsigned int set);
+	void deleteTarget();
+};
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include "PipelineStats.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// GL_ARB_pipeline_statistics_query names missing from headers generated for 3.3
+#ifndef GL_VERTICES_SUBMITTED_ARB
+#define GL_VERTICES_SUBMITTED_ARB 0x82EE
+#endif
+#ifndef GL_PRIMITIVES_SUBMITTED_ARB
+#define GL_PRIMITIVES_SUBMITTED_ARB 0x82EF
+#endif
+#ifndef GL_VERTEX_SHADER_INVOCATIONS_ARB
+#define GL_VERTEX_SHADER_INVOCATIONS_ARB 0x82F0
+#endif
+#ifndef GL_FRAGMENT_SHADER_INVOCATIONS_ARB
+#define GL_FRAGMENT_SHADER_INVOCATIONS_ARB 0x82F4
+#endif
+#ifndef GL_CLIPPING_INPUT_PRIMITIVES_ARB
+#define GL_CLIPPING_INPUT_PRIMITIVES_ARB 0x82F6
+#endif
+#ifndef GL_CLIPPING_OUTPUT_PRIMITIVES_ARB
+#define GL_CLIPPING_OUTPUT_PRIMITIVES_ARB 0x82F7
+#endif
+
+// query target of every counter, in Counter order
+static const GLenum COUNTER_TARGETS[PipelineStats::COUNTER_COUNT] = {
+	GL_TIME_ELAPSED,
+	GL_SAMPLES_PASSED,
+	GL_VERTICES_SUBMITTED_ARB,
+	GL_PRIMITIVES_SUBMITTED_ARB,
+	GL_VERTEX_SHADER_INVOCATIONS_ARB,
+	GL_CLIPPING_INPUT_PRIMITIVES_ARB,
+	GL_CLIPPING_OUTPUT_PRIMITIVES_ARB,
+	GL_FRAGMENT_SHADER_INVOCATIONS_ARB
+};
+
+PipelineStats::PipelineStats(unsigned int latency)
+	: enabled(false), frame(0), pixels(0), openGroup(-1), stalls(0) {
+	GLint major = 0, minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	pipelineStatistics = major > 4 || (major == 4 && minor >= 6) || hasExtension("GL_ARB_pipeline_statistics_query");
+	counterCount = pipelineStatistics ? (unsigned int)COUNTER_COUNT : 2;
+
+	slots.resize(std::max(latency, 1u) + 1);
+	// a handful of groups per frame, nothing is allocated once warm
+	groups.reserve(32);
+	for (std::vector<Issued>& slot : slots) {
+		slot.reserve(32);
+	}
+}
+
+PipelineStats::~PipelineStats() {
+	for (std::vector<Issued>& slot : slots) {
+		for (const Issued& issued : slot) {
+			glDeleteQueries(counterCount, issued.queries);
+		}
+	}
+	if (!freeQueries.empty()) {
+		glDeleteQueries((GLsizei)freeQueries.size(), freeQueries.data());
+	}
+}
+
+bool PipelineStats::hasExtension(const char* name) {
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; ++i) {
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (extension && std::strcmp(extension, name) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void PipelineStats::beginFrame(int width, int height) {
+	pixels = (unsigned int)(std::max(width, 0) * std::max(height, 0));
+	// the oldest slot is reused for this frame, its results are latency frames old
+	resolve(slots[frame % slots.size()]);
+}
+
+unsigned int PipelineStats::findGroup(const char* pass, const char* group) {
+	for (unsigned int i = 0; i < groups.size(); ++i) {
+		if (std::strcmp(groups[i].pass, pass) == 0 && std::strcmp(groups[i].group, group) == 0) {
+			return i;
+		}
+	}
+	Group added;
+	added.pass = pass;
+	added.group = group;
+	added.frames = 0;
+	added.pixels = 0;
+	std::fill(added.counters, added.counters + COUNTER_COUNT, 0ULL);
+	groups.push_back(added);
+	return (unsigned int)groups.size() - 1;
+}
+
+void PipelineStats::begin(const char* pass, const char* group) {
+	if (!enabled) {
+		return;
+	}
+	if (openGroup >= 0) {
+		std::cout << "ERROR::PIPELINESTATS::NESTED_GROUP " << pass << "/" << group << std::endl;
+		return;
+	}
+
+	Issued issued;
+	issued.group = findGroup(pass, group);
+	issued.pixels = pixels;
+	for (unsigned int i = 0; i < counterCount; ++i) {
+		if (freeQueries.empty()) {
+			glGenQueries(1, &issued.queries[i]);
+		}
+		else {
+			issued.queries[i] = freeQueries.back();
+			freeQueries.pop_back();
+		}
+		glBeginQuery(COUNTER_TARGETS[i], issued.queries[i]);
+	}
+	std::vector<Issued>& slot = slots[frame % slots.size()];
+	slot.push_back(issued);
+	openGroup = (int)issued.group;
+}
+
+void PipelineStats::end() {
+	if (openGroup < 0) {
+		return;
+	}
+	for (unsigned int i = 0; i < counterCount; ++i) {
+		glEndQuery(COUNTER_TARGETS[i]);
+	}
+	openGroup = -1;
+}
+
+void PipelineStats::endFrame() {
+	end();
+	++frame;
+}
+
+void PipelineStats::resolve(std::vector<Issued>& slot) {
+	if (slot.empty()) {
+		return;
+	}
+	// queries complete in order, if the last one is ready they all are
+	GLuint available = 0;
+	glGetQueryObjectuiv(slot.back().queries[counterCount - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available) {
+		++stalls;
+	}
+
+	// a group drawn twice in one frame still counts as one frame of it
+	unsigned int previousGroup = 0xffffffff;
+	for (const Issued& issued : slot) {
+		Group& group = groups[issued.group];
+		for (unsigned int i = 0; i < counterCount; ++i) {
+			GLuint64 value = 0;
+			glGetQueryObjectui64v(issued.queries[i], GL_QUERY_RESULT, &value);
+			group.counters[i] += value;
+			freeQueries.push_back(issued.queries[i]);
+		}
+		if (issued.group != previousGroup) {
+			++group.frames;
+			group.pixels += issued.pixels;
+		}
+		previousGroup = issued.group;
+	}
+	slot.clear();
+}
+
+void PipelineStats::report() const {
+	// passes in the order they first appeared
+	std::vector<const char*> passes;
+	for (const Group& group : groups) {
+		bool seen = false;
+		for (const char* pass : passes) {
+			seen = seen || std::strcmp(pass, group.pass) == 0;
+		}
+		if (!seen) {
+			passes.push_back(group.pass);
+		}
+	}
+	if (!pipelineStatistics) {
+		std::cout << "PIPELINESTATS::no GL_ARB_pipeline_statistics_query, time and samples passed only" << std::endl;
+	}
+	if (stalls > 0) {
+		std::cout << "PIPELINESTATS::" << stalls << " frames read before the GPU finished them, raise the latency" << std::endl;
+	}
+
+	for (const char* pass : passes) {
+		double passTime = 0.0, passSamples = 0.0, passFragments = 0.0, passPixels = 0.0;
+		for (const Group& group : groups) {
+			if (std::strcmp(group.pass, pass) != 0 || group.frames == 0) {
+				continue;
+			}
+			passTime += group.counters[COUNTER_TIME] / 1e6 / group.frames;
+			passSamples += (double)group.counters[COUNTER_SAMPLES_PASSED] / group.frames;
+			passFragments += (double)group.counters[COUNTER_FS_INVOCATIONS] / group.frames;
+			passPixels = std::max(passPixels, (double)group.pixels / group.frames);
+		}
+		std::cout << "PIPELINESTATS::" << pass << " | GPU " << passTime << " ms/frame"
+			<< " | samples passed " << passSamples << " (" << (passPixels > 0.0 ? passSamples / passPixels : 0.0) << "/pixel)";
+		if (pipelineStatistics) {
+			std::cout << " | FS invocations " << passFragments << " (" << (passPixels > 0.0 ? passFragments / passPixels : 0.0) << "/pixel)";
+		}
+		std::cout << std::endl;
+
+		for (const Group& group : groups) {
+			if (std::strcmp(group.pass, pass) != 0 || group.frames == 0) {
+				continue;
+			}
+			double perFrame = 1.0 / group.frames;
+			double samples = group.counters[COUNTER_SAMPLES_PASSED] * perFrame;
+			std::cout << "PIPELINESTATS::  " << group.group
+				<< " | GPU " << group.counters[COUNTER_TIME] / 1e6 * perFrame << " ms"
+				<< " | samples passed " << samples;
+			if (pipelineStatistics) {
+				double vertices = group.counters[COUNTER_VERTICES] * perFrame;
+				double fragments = group.counters[COUNTER_FS_INVOCATIONS] * perFrame;
+				// invocations per passed sample > 1: shaded and then hidden, or helper lanes on tiny triangles
+				std::cout << " | vertices " << vertices
+					<< " (VS invocations " << group.counters[COUNTER_VS_INVOCATIONS] * perFrame << ")"
+					<< " | primitives " << group.counters[COUNTER_PRIMITIVES] * perFrame
+					<< ", clipping in " << group.counters[COUNTER_CLIPPING_INPUT] * perFrame
+					<< " out " << group.counters[COUNTER_CLIPPING_OUTPUT] * perFrame
+					<< " | FS invocations " << fragments
+					<< " (" << (samples > 0.0 ? fragments / samples : 0.0) << " per sample passed)";
+			}
+			std::cout << " | frames " << group.frames << std::endl;
+		}
+	}
+}
+
+void PipelineStats::reset() {
+	for (Group& group : groups) {
+		group.frames = 0;
+		group.pixels = 0;
+		std::fill(group.counters, group.counters + COUNTER_COUNT, 0ULL);
+	}
+	stalls = 0;
+}
\ No newline at end of file
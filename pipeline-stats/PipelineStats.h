@@ -0,0 +1,82 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <vector>
+
+// GPU counters per draw group, grouped into passes. Every group is wrapped in
+// a set of queries: GL_TIME_ELAPSED and GL_SAMPLES_PASSED always, and with
+// GL_ARB_pipeline_statistics_query (core in 4.6) also the vertices and
+// primitives submitted, vertex shader invocations, primitives going in and
+// out of clipping and fragment shader invocations. Results are read a few
+// frames later so reading never waits for the GPU, and are averaged per frame
+// in report(), one line per pass followed by its groups.
+// Only one group can be open at a time, and no other GL_TIME_ELAPSED or
+// GL_SAMPLES_PASSED query may be active around it. Nothing is recorded while
+// disabled, so the instrumentation can stay in the frame and cost nothing.
+class PipelineStats {
+public:
+	enum Counter {
+		COUNTER_TIME,            // ns
+		COUNTER_SAMPLES_PASSED,
+		COUNTER_VERTICES,
+		COUNTER_PRIMITIVES,
+		COUNTER_VS_INVOCATIONS,
+		COUNTER_CLIPPING_INPUT,
+		COUNTER_CLIPPING_OUTPUT,
+		COUNTER_FS_INVOCATIONS,
+		COUNTER_COUNT
+	};
+
+	// latency: frames between issuing the queries and reading them
+	PipelineStats(unsigned int latency = 3);
+	~PipelineStats();
+
+	void setEnabled(bool enabled) { this->enabled = enabled; }
+	bool isEnabled() const { return enabled; }
+	// false: only time and samples passed are counted
+	bool hasPipelineStatistics() const { return pipelineStatistics; }
+
+	// size of the render target, samples per pixel are counted against it
+	void beginFrame(int width, int height);
+	// pass and group must stay valid, string literals usually
+	void begin(const char* pass, const char* group);
+	void end();
+	void endFrame();
+
+	// per frame averages of everything read so far
+	void report() const;
+	void reset();
+
+private:
+	struct Group {
+		const char* pass;
+		const char* group;
+		unsigned long long frames;
+		unsigned long long pixels;
+		unsigned long long counters[COUNTER_COUNT];
+	};
+
+	// one begin/end in flight
+	struct Issued {
+		unsigned int group;
+		unsigned int pixels;
+		unsigned int queries[COUNTER_COUNT];
+	};
+
+	bool enabled;
+	bool pipelineStatistics;
+	unsigned int counterCount;
+	unsigned int frame;
+	unsigned int pixels;
+	int openGroup;
+
+	std::vector<Group> groups;
+	std::vector<std::vector<Issued> > slots; // per frame in flight
+	std::vector<unsigned int> freeQueries;
+	unsigned long long stalls;
+
+	unsigned int findGroup(const char* pass, const char* group);
+	void resolve(std::vector<Issued>& slot);
+	static bool hasExtension(const char* name);
+};
\ No newline at end of file
@@ -0,0 +1,12 @@
+#version 330 core
+// flat colour of one overdraw level, the stencil test decides which pixels get it
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform vec3 levelColor;
+
+void main()
+{
+	FragColor = vec4(levelColor, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,331 @@
+#include "PostProcessChain.h"
+
+#include <algorithm>
+#include <iostream>
+
+PostProcessChain::PostProcessChain(int width, int height, const char* shaderDirectory)
+	: exposure(1.0f), bloomThreshold(1.0f), bloomIntensity(0.6f), contrast(1.05f), saturation(1.1f),
+	tint(1.0f, 0.98f, 0.95f), sharpness(0.5f), width(width), height(height), shaderDirectory(shaderDirectory),
+	fusion(true), bloomScale(0.5f), renderScale(1.0f), upscaling(false), dirty(true), sceneLastReader(-1), sceneTarget(0) {
+	// fullscreen triangles come from gl_VertexID, core profile still wants a VAO bound
+	glGenVertexArrays(1, &emptyVAO);
+}
+
+PostProcessChain::~PostProcessChain() {
+	for (auto& entry : programs) {
+		glDeleteProgram(entry.second->ID);
+		delete entry.second;
+	}
+	glDeleteVertexArrays(1, &emptyVAO);
+}
+
+void PostProcessChain::add(Effect effect) {
+	effects.push_back(effect);
+	dirty = true;
+}
+
+void PostProcessChain::clear() {
+	effects.clear();
+	dirty = true;
+}
+
+const char* PostProcessChain::effectName(Effect effect) {
+	switch (effect) {
+	case EFFECT_BLOOM: return "bloom";
+	case EFFECT_TONEMAP: return "tonemap";
+	case EFFECT_COLOR_GRADE: return "color grade";
+	case EFFECT_FXAA: return "FXAA";
+	default: return "unknown";
+	}
+}
+
+void PostProcessChain::setFusion(bool enabled) {
+	fusion = enabled;
+	dirty = true;
+}
+
+void PostProcessChain::setBloomScale(float scale) {
+	bloomScale = std::max(0.125f, std::min(1.0f, scale));
+	dirty = true;
+}
+
+void PostProcessChain::resize(int width, int height) {
+	// targets of the old size age out of the pool by themselves
+	this->width = std::max(1, width);
+	this->height = std::max(1, height);
+	setRenderScale(renderScale);
+}
+
+void PostProcessChain::setRenderScale(float scale) {
+	renderScale = std::max(0.25f, std::min(1.0f, scale));
+	bool belowOutput = getRenderWidth() < width || getRenderHeight() < height;
+	if (belowOutput != upscaling) {
+		dirty = true;
+	}
+}
+
+void PostProcessChain::beginScene() {
+	if (dirty) {
+		build();
+	}
+	sceneTarget = pool.acquire(width, height, GL_RGBA16F, true);
+	glBindFramebuffer(GL_FRAMEBUFFER, pool.get(sceneTarget).FBO);
+	glViewport(0, 0, getRenderWidth(), getRenderHeight());
+}
+
+void PostProcessChain::apply(unsigned int outputFBO) {
+	if (passes.empty()) {
+		// nothing to do but get the scene on screen
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, pool.get(sceneTarget).FBO);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, outputFBO);
+		glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, outputFBO);
+		pool.release(sceneTarget);
+		pool.endFrame();
+		return;
+	}
+
+	bool depthTest = glIsEnabled(GL_DEPTH_TEST) == GL_TRUE;
+	glDisable(GL_DEPTH_TEST);
+	glBindVertexArray(emptyVAO);
+
+	for (unsigned int i = 0; i < passes.size(); ++i) {
+		Pass& pass = passes[i];
+		int passWidth = std::max(1, (int)(width * pass.scale));
+		int passHeight = std::max(1, (int)(height * pass.scale));
+
+		if (i + 1 == passes.size()) {
+			glBindFramebuffer(GL_FRAMEBUFFER, outputFBO);
+			glViewport(0, 0, width, height);
+		}
+		else {
+			pass.target = pool.acquire(passWidth, passHeight, pass.format);
+			glBindFramebuffer(GL_FRAMEBUFFER, pool.get(pass.target).FBO);
+			glViewport(0, 0, passWidth, passHeight);
+		}
+
+		const RenderTarget& source = inputTarget(pass.input);
+		Shader& shader = *pass.shader;
+		shader.use();
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, source.texture);
+		shader.setInt("source", 0);
+		shader.setVec2("texelSize", glm::vec2(1.0f / source.width, 1.0f / source.height));
+
+		switch (pass.type) {
+		case PASS_UPSCALE:
+			// the scene only covers the bottom left corner of its target
+			shader.setVec2("uvScale", glm::vec2((float)getRenderWidth() / source.width,
+				(float)getRenderHeight() / source.height));
+			shader.setFloat("sharpness", sharpness);
+			break;
+		case PASS_BRIGHT:
+			shader.setFloat("threshold", bloomThreshold);
+			break;
+		case PASS_BLUR_H:
+			shader.setVec2("direction", glm::vec2(1.0f / passWidth, 0.0f));
+			break;
+		case PASS_BLUR_V:
+			shader.setVec2("direction", glm::vec2(0.0f, 1.0f / passHeight));
+			break;
+		case PASS_COLOR:
+			if (pass.bloomInput >= 0) {
+				glActiveTexture(GL_TEXTURE1);
+				glBindTexture(GL_TEXTURE_2D, inputTarget(pass.bloomInput).texture);
+				shader.setInt("bloomTexture", 1);
+				shader.setFloat("bloomIntensity", bloomIntensity);
+			}
+			shader.setFloat("exposure", exposure);
+			shader.setFloat("contrast", contrast);
+			shader.setFloat("saturation", saturation);
+			shader.setVec3("tint", tint);
+			break;
+		case PASS_FXAA:
+			break;
+		}
+
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+
+		// inputs whose last reader this was go back to the pool for the next passes
+		if (sceneLastReader == (int)i) {
+			pool.release(sceneTarget);
+		}
+		if (pass.input >= 0 && passes[pass.input].lastReader == (int)i) {
+			pool.release(passes[pass.input].target);
+		}
+		if (pass.bloomInput >= 0 && passes[pass.bloomInput].lastReader == (int)i) {
+			pool.release(passes[pass.bloomInput].target);
+		}
+	}
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindVertexArray(0);
+	if (depthTest) {
+		glEnable(GL_DEPTH_TEST);
+	}
+	pool.endFrame();
+}
+
+unsigned int PostProcessChain::getPassCount() {
+	if (dirty) {
+		build();
+	}
+	return (unsigned int)passes.size();
+}
+
+size_t PostProcessChain::getUnpooledBytes() {
+	if (dirty) {
+		build();
+	}
+	RenderTarget target;
+	target.width = width;
+	target.height = height;
+	target.format = GL_RGBA16F;
+	target.depth = 1;
+	size_t bytes = RenderTargetPool::targetBytes(target);
+	target.depth = 0;
+	for (unsigned int i = 0; i + 1 < passes.size(); ++i) {
+		target.width = std::max(1, (int)(width * passes[i].scale));
+		target.height = std::max(1, (int)(height * passes[i].scale));
+		target.format = passes[i].format;
+		bytes += RenderTargetPool::targetBytes(target);
+	}
+	return bytes;
+}
+
+void PostProcessChain::printStats() {
+	std::cout << "POSTPROCESS::";
+	for (unsigned int i = 0; i < effects.size(); ++i) {
+		std::cout << (i > 0 ? " > " : "") << effectName(effects[i]);
+	}
+	std::cout << " | " << (fusion ? "fused" : "unfused")
+		<< " | passes " << getPassCount()
+		<< " | bloom scale " << bloomScale
+		<< " | render scale " << renderScale
+		<< " | targets without reuse " << getUnpooledBytes() / (1024.0 * 1024.0) << " MB" << std::endl;
+	pool.printStats();
+}
+
+void PostProcessChain::build() {
+	passes.clear();
+	sceneLastReader = -1;
+
+	int current = -1;
+	upscaling = getRenderWidth() < width || getRenderHeight() < height;
+	if (upscaling) {
+		// everything after this runs at the output size
+		addPass(PASS_UPSCALE, program("upscale.frag", ""), -1, -1, 1.0f, GL_RGBA16F);
+		current = 0;
+	}
+	int bloom = -1;
+	bool hdr = true;
+	std::vector<ColorOp> ops;
+	for (Effect effect : effects) {
+		switch (effect) {
+		case EFFECT_BLOOM:
+			// the bright pass has to see everything queued before it
+			flushColorOps(ops, current, bloom, hdr);
+			addPass(PASS_BRIGHT, program("bright.frag", ""), current, -1, bloomScale, GL_RGBA16F);
+			addPass(PASS_BLUR_H, program("blur.frag", ""), (int)passes.size() - 1, -1, bloomScale, GL_RGBA16F);
+			addPass(PASS_BLUR_V, program("blur.frag", ""), (int)passes.size() - 1, -1, bloomScale, GL_RGBA16F);
+			bloom = (int)passes.size() - 1;
+			ops.push_back(OP_BLOOM);
+			break;
+		case EFFECT_TONEMAP:
+			ops.push_back(OP_TONEMAP);
+			break;
+		case EFFECT_COLOR_GRADE:
+			ops.push_back(OP_GRADE);
+			break;
+		case EFFECT_FXAA:
+			// reads its neighbours, the image has to be finished first
+			flushColorOps(ops, current, bloom, hdr);
+			addPass(PASS_FXAA, program("fxaa.frag", ""), current, -1, 1.0f, hdr ? GL_RGBA16F : GL_RGBA8);
+			current = (int)passes.size() - 1;
+			break;
+		default:
+			break;
+		}
+	}
+	flushColorOps(ops, current, bloom, hdr);
+
+	// who reads what last decides when targets go back to the pool
+	for (unsigned int i = 0; i < passes.size(); ++i) {
+		const Pass& pass = passes[i];
+		if (pass.input < 0) {
+			sceneLastReader = (int)i;
+		}
+		else {
+			passes[pass.input].lastReader = (int)i;
+		}
+		if (pass.bloomInput >= 0) {
+			passes[pass.bloomInput].lastReader = (int)i;
+		}
+	}
+
+	dirty = false;
+}
+
+void PostProcessChain::flushColorOps(std::vector<ColorOp>& ops, int& current, int bloom, bool& hdr) {
+	unsigned int groupSize = fusion ? (unsigned int)ops.size() : 1;
+	for (unsigned int first = 0; first < ops.size(); first += groupSize) {
+		// the group becomes one shader that applies its operations in order
+		std::string defines;
+		std::string body = "#define EFFECTS";
+		bool usesBloom = false;
+		for (unsigned int i = first; i < std::min(first + groupSize, (unsigned int)ops.size()); ++i) {
+			switch (ops[i]) {
+			case OP_BLOOM:
+				body += " color = bloom(color);";
+				usesBloom = true;
+				break;
+			case OP_TONEMAP:
+				body += " color = tonemap(color);";
+				hdr = false;
+				break;
+			case OP_GRADE:
+				body += " color = grade(color);";
+				break;
+			}
+		}
+		if (usesBloom) {
+			defines += "#define USE_BLOOM\n";
+		}
+		defines += body + "\n";
+
+		addPass(PASS_COLOR, program("color.frag", defines), current, usesBloom ? bloom : -1, 1.0f,
+			hdr ? GL_RGBA16F : GL_RGBA8);
+		current = (int)passes.size() - 1;
+	}
+	ops.clear();
+}
+
+void PostProcessChain::addPass(PassType type, Shader* shader, int input, int bloomInput, float scale, GLenum format) {
+	Pass pass;
+	pass.type = type;
+	pass.shader = shader;
+	pass.input = input;
+	pass.bloomInput = bloomInput;
+	pass.scale = scale;
+	pass.format = format;
+	pass.lastReader = -1;
+	pass.target = 0;
+	passes.push_back(pass);
+}
+
+Shader* PostProcessChain::program(const char* fragment, const std::string& defines) {
+	std::string key = std::string(fragment) + "\n" + defines;
+	auto found = programs.find(key);
+	if (found != programs.end()) {
+		return found->second;
+	}
+
+	Shader* shader = new Shader((shaderDirectory + "post.vert").c_str(), (shaderDirectory + fragment).c_str(),
+		NULL, defines.empty() ? NULL : defines.c_str());
+	programs[key] = shader;
+	return shader;
+}
+
+const RenderTarget& PostProcessChain::inputTarget(int input) const {
+	return pool.get(input < 0 ? sceneTarget : passes[input].target);
+}
\ No newline at end of file
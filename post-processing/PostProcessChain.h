@@ -0,0 +1,109 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../shader-lesson-1.4/Shader.h"
+#include "RenderTargetPool.h"
+
+// Runs screen space effects over an HDR scene target. The effects are turned
+// into a list of fullscreen passes once, whenever the chain changes. Effects
+// that only look at their own pixel (bloom composite, tonemap, color grading)
+// are fused into one pass with one shader; effects that read neighbours (the
+// bloom blur, FXAA) need the previous result in a texture and get their own.
+// Intermediate targets come from a RenderTargetPool and go back to it after
+// their last reader, so the chain only holds as much memory as the widest
+// point of the pass list. The scene can be rendered below the output size, it
+// is then upscaled and sharpened by the first pass.
+class PostProcessChain {
+public:
+	enum Effect { EFFECT_BLOOM, EFFECT_TONEMAP, EFFECT_COLOR_GRADE, EFFECT_FXAA, EFFECT_COUNT };
+
+	PostProcessChain(int width, int height, const char* shaderDirectory = "../post-processing/");
+	~PostProcessChain();
+
+	// effects run in the order they are added
+	void add(Effect effect);
+	void clear();
+	static const char* effectName(Effect effect);
+
+	// fold neighbouring per pixel effects into one pass, off = one pass per effect
+	void setFusion(bool enabled);
+	bool getFusion() const { return fusion; }
+	// resolution of the bloom passes relative to the screen, e.g. 0.5
+	void setBloomScale(float scale);
+	float getBloomScale() const { return bloomScale; }
+	void resize(int width, int height);
+	// scene resolution relative to the output, the scene target keeps the full size
+	// and only a corner of it is rendered, so changing this never reallocates
+	void setRenderScale(float scale);
+	float getRenderScale() const { return renderScale; }
+	int getRenderWidth() const { return std::max(1, (int)(width * renderScale)); }
+	int getRenderHeight() const { return std::max(1, (int)(height * renderScale)); }
+
+	// effect settings
+	float exposure;
+	float bloomThreshold;
+	float bloomIntensity;
+	float contrast;
+	float saturation;
+	glm::vec3 tint;
+	float sharpness; // of the upscale, 0 = plain bilinear
+
+	// bind the HDR scene target (with depth) and set the viewport to the render size,
+	// draw the scene after this
+	void beginScene();
+	// run every pass, the last one writes into outputFBO at the full size
+	void apply(unsigned int outputFBO = 0);
+
+	unsigned int getPassCount();
+	const RenderTargetPool& getPool() const { return pool; }
+	// bytes a pass list without any target reuse would hold
+	size_t getUnpooledBytes();
+	void printStats();
+
+private:
+	enum PassType { PASS_UPSCALE, PASS_BRIGHT, PASS_BLUR_H, PASS_BLUR_V, PASS_COLOR, PASS_FXAA };
+	// per pixel operations a color pass runs, in order
+	enum ColorOp { OP_BLOOM, OP_TONEMAP, OP_GRADE };
+
+	struct Pass {
+		PassType type;
+		Shader* shader;
+		int input;          // pass whose output is read, -1 = the scene
+		int bloomInput;     // pass with the blurred bloom, -1 = none
+		float scale;
+		GLenum format;
+		int lastReader;     // last pass reading the output, -1 = nobody (the final pass)
+		unsigned int target;
+	};
+
+	int width, height;
+	std::string shaderDirectory;
+	std::vector<Effect> effects;
+	bool fusion;
+	float bloomScale;
+	float renderScale;
+	bool upscaling; // render size below the output size, build() added the upscale pass
+	bool dirty;
+
+	std::vector<Pass> passes;
+	int sceneLastReader;
+	unsigned int sceneTarget;
+	std::map<std::string, Shader*> programs; // by defines
+	unsigned int emptyVAO;
+
+	RenderTargetPool pool;
+
+	// turn the effect list into passes
+	void build();
+	void flushColorOps(std::vector<ColorOp>& ops, int& current, int bloom, bool& hdr);
+	void addPass(PassType type, Shader* shader, int input, int bloomInput, float scale, GLenum format);
+	Shader* program(const char* fragment, const std::string& defines);
+	const RenderTarget& inputTarget(int input) const;
+};
\ No newline at end of file
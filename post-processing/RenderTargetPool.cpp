@@ -0,0 +1,122 @@
+#include "RenderTargetPool.h"
+
+#include <algorithm>
+#include <iostream>
+
+RenderTargetPool::RenderTargetPool()
+	: frame(0), allocatedBytes(0), peakBytes(0), created(0) {
+}
+
+RenderTargetPool::~RenderTargetPool() {
+	for (unsigned int id = 0; id < targets.size(); ++id) {
+		if (targets[id].texture) {
+			destroy(id);
+		}
+	}
+}
+
+unsigned int RenderTargetPool::acquire(int width, int height, GLenum format, bool depth) {
+	for (unsigned int id = 0; id < targets.size(); ++id) {
+		RenderTarget& target = targets[id];
+		if (target.texture && !target.inUse && target.width == width && target.height == height
+			&& target.format == format && (target.depth != 0) == depth) {
+			target.inUse = true;
+			target.lastUsedFrame = frame;
+			return id;
+		}
+	}
+
+	RenderTarget target;
+	target.width = width;
+	target.height = height;
+	target.format = format;
+	target.inUse = true;
+	target.lastUsedFrame = frame;
+
+	glGenTextures(1, &target.texture);
+	glBindTexture(GL_TEXTURE_2D, target.texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, GL_RGBA,
+		format == GL_RGBA8 ? GL_UNSIGNED_BYTE : GL_HALF_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	target.depth = 0;
+	if (depth) {
+		glGenRenderbuffers(1, &target.depth);
+		glBindRenderbuffer(GL_RENDERBUFFER, target.depth);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	}
+
+	glGenFramebuffers(1, &target.FBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, target.FBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.texture, 0);
+	if (depth) {
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target.depth);
+	}
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cout << "ERROR::RENDERTARGETPOOL::FRAMEBUFFER_INCOMPLETE " << width << "x" << height << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	allocatedBytes += targetBytes(target);
+	peakBytes = std::max(peakBytes, allocatedBytes);
+	++created;
+
+	unsigned int id;
+	if (freeIds.empty()) {
+		id = (unsigned int)targets.size();
+		targets.push_back(target);
+	}
+	else {
+		id = freeIds.back();
+		freeIds.pop_back();
+		targets[id] = target;
+	}
+	return id;
+}
+
+void RenderTargetPool::release(unsigned int id) {
+	targets[id].inUse = false;
+}
+
+void RenderTargetPool::endFrame() {
+	for (unsigned int id = 0; id < targets.size(); ++id) {
+		const RenderTarget& target = targets[id];
+		if (target.texture && !target.inUse && frame - target.lastUsedFrame >= FRAMES_KEPT) {
+			destroy(id);
+		}
+	}
+	++frame;
+}
+
+void RenderTargetPool::printStats() const {
+	std::cout << "RENDERTARGETPOOL::targets " << getTargetCount()
+		<< " | allocated " << allocatedBytes / (1024.0 * 1024.0) << " MB"
+		<< " | peak " << peakBytes / (1024.0 * 1024.0) << " MB"
+		<< " | created " << created << std::endl;
+}
+
+size_t RenderTargetPool::targetBytes(const RenderTarget& target) {
+	size_t pixels = (size_t)target.width * target.height;
+	size_t colorBytes = target.format == GL_RGBA8 ? 4 : 8;
+	return pixels * colorBytes + (target.depth ? pixels * 4 : 0);
+}
+
+void RenderTargetPool::destroy(unsigned int id) {
+	RenderTarget& target = targets[id];
+	allocatedBytes -= targetBytes(target);
+	glDeleteFramebuffers(1, &target.FBO);
+	glDeleteTextures(1, &target.texture);
+	if (target.depth) {
+		glDeleteRenderbuffers(1, &target.depth);
+	}
+	target.texture = 0;
+	target.depth = 0;
+	target.FBO = 0;
+	target.inUse = false;
+	freeIds.push_back(id);
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <vector>
+
+// texture with its framebuffer, optionally with a depth renderbuffer
+struct RenderTarget {
+	unsigned int texture;
+	unsigned int depth; // 0 = color only
+	unsigned int FBO;
+	int width, height;
+	GLenum format;      // GL_RGBA8 or GL_RGBA16F
+	bool inUse;
+	unsigned long long lastUsedFrame;
+};
+
+// Hands out render targets by size and format. A target goes back to the pool
+// as soon as its last reader is done with it, so passes whose lifetimes do not
+// overlap end up aliasing the same texture. Targets nobody asked for in a few
+// frames are deleted, e.g. the old sizes after a resize.
+class RenderTargetPool {
+public:
+	static const unsigned int FRAMES_KEPT = 3;
+
+	RenderTargetPool();
+	~RenderTargetPool();
+
+	// a free target of this kind, created when there is none
+	unsigned int acquire(int width, int height, GLenum format, bool depth = false);
+	void release(unsigned int id);
+	const RenderTarget& get(unsigned int id) const { return targets[id]; }
+
+	// delete stale targets
+	void endFrame();
+
+	size_t getAllocatedBytes() const { return allocatedBytes; }
+	size_t getPeakBytes() const { return peakBytes; }
+	unsigned int getTargetCount() const { return (unsigned int)(targets.size() - freeIds.size()); }
+	unsigned int getCreatedCount() const { return created; }
+	void resetPeak() { peakBytes = allocatedBytes; }
+	void printStats() const;
+
+	static size_t targetBytes(const RenderTarget& target);
+
+private:
+	std::vector<RenderTarget> targets;
+	std::vector<unsigned int> freeIds;
+	unsigned long long frame;
+	size_t allocatedBytes;
+	size_t peakBytes;
+	unsigned int created;
+
+	void destroy(unsigned int id);
+};
\ No newline at end of file
@@ -0,0 +1,21 @@
+#version 330 core
+// one direction of a 9 tap gaussian, 5 bilinear fetches
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D source;
+uniform vec2 direction; // one texel along x or y
+
+const float offsets[3] = float[](0.0f, 1.3846153846f, 3.2307692308f);
+const float weights[3] = float[](0.2270270270f, 0.3162162162f, 0.0702702703f);
+
+void main()
+{
+	vec3 color = texture(source, TexCoord).rgb * weights[0];
+	for (int i = 1; i < 3; ++i) {
+		color += texture(source, TexCoord + direction * offsets[i]).rgb * weights[i];
+		color += texture(source, TexCoord - direction * offsets[i]).rgb * weights[i];
+	}
+	FragColor = vec4(color, 1.0f);
+}
\ No newline at end of file
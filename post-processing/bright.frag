@@ -0,0 +1,23 @@
+#version 330 core
+// keeps what is brighter than the threshold, drawn into a smaller target
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D source;
+uniform vec2 texelSize; // of the source
+uniform float threshold;
+
+void main()
+{
+	// four bilinear taps average a 4x4 block, so the downsample does not flicker
+	vec3 color = texture(source, TexCoord + vec2(-texelSize.x, -texelSize.y)).rgb;
+	color += texture(source, TexCoord + vec2(texelSize.x, -texelSize.y)).rgb;
+	color += texture(source, TexCoord + vec2(-texelSize.x, texelSize.y)).rgb;
+	color += texture(source, TexCoord + vec2(texelSize.x, texelSize.y)).rgb;
+	color *= 0.25f;
+
+	float brightness = max(color.r, max(color.g, color.b));
+	color *= max(brightness - threshold, 0.0f) / max(brightness, 0.0001f);
+	FragColor = vec4(color, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#version 330 core
+// per pixel effects, PostProcessChain defines EFFECTS as the ones this pass runs, e.g.
+// #define EFFECTS color = bloom(color); color = tonemap(color); color = grade(color);
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D source;
+uniform float exposure;
+uniform float contrast;
+uniform float saturation;
+uniform vec3 tint;
+
+#ifdef USE_BLOOM
+uniform sampler2D bloomTexture;
+uniform float bloomIntensity;
+
+vec3 bloom(vec3 color)
+{
+	return color + texture(bloomTexture, TexCoord).rgb * bloomIntensity;
+}
+#endif
+
+// ACES curve fit, then gamma
+vec3 tonemap(vec3 color)
+{
+	color *= exposure;
+	color = clamp((color * (2.51f * color + 0.03f)) / (color * (2.43f * color + 0.59f) + 0.14f), 0.0f, 1.0f);
+	return pow(color, vec3(1.0f / 2.2f));
+}
+
+vec3 grade(vec3 color)
+{
+	color = (color - 0.5f) * contrast + 0.5f;
+	float luma = dot(color, vec3(0.2126f, 0.7152f, 0.0722f));
+	color = mix(vec3(luma), color, saturation) * tint;
+	return max(color, 0.0f);
+}
+
+void main()
+{
+	vec3 color = texture(source, TexCoord).rgb;
+	EFFECTS
+	FragColor = vec4(color, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#version 330 core
+// FXAA: blur along the edge direction found from the luma of the four diagonal neighbours
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D source;
+uniform vec2 texelSize;
+
+const float REDUCE_MIN = 1.0f / 128.0f;
+const float REDUCE_MUL = 1.0f / 8.0f;
+const float SPAN_MAX = 8.0f;
+const vec3 LUMA = vec3(0.299f, 0.587f, 0.114f);
+
+void main()
+{
+	vec3 rgbM = texture(source, TexCoord).rgb;
+	float lumaNW = dot(texture(source, TexCoord + vec2(-1.0f, -1.0f) * texelSize).rgb, LUMA);
+	float lumaNE = dot(texture(source, TexCoord + vec2(1.0f, -1.0f) * texelSize).rgb, LUMA);
+	float lumaSW = dot(texture(source, TexCoord + vec2(-1.0f, 1.0f) * texelSize).rgb, LUMA);
+	float lumaSE = dot(texture(source, TexCoord + vec2(1.0f, 1.0f) * texelSize).rgb, LUMA);
+	float lumaM = dot(rgbM, LUMA);
+	float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+	float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+	// flat areas are most of the screen, leave them alone
+	if (lumaMax - lumaMin < max(0.0312f, lumaMax * 0.125f)) {
+		FragColor = vec4(rgbM, 1.0f);
+		return;
+	}
+
+	vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));
+	float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25f * REDUCE_MUL, REDUCE_MIN);
+	float rcpDirMin = 1.0f / (min(abs(dir.x), abs(dir.y)) + dirReduce);
+	dir = clamp(dir * rcpDirMin, vec2(-SPAN_MAX), vec2(SPAN_MAX)) * texelSize;
+
+	vec3 rgbA = 0.5f * (texture(source, TexCoord + dir * (1.0f / 3.0f - 0.5f)).rgb
+		+ texture(source, TexCoord + dir * (2.0f / 3.0f - 0.5f)).rgb);
+	vec3 rgbB = rgbA * 0.5f + 0.25f * (texture(source, TexCoord - dir * 0.5f).rgb
+		+ texture(source, TexCoord + dir * 0.5f).rgb);
+	float lumaB = dot(rgbB, LUMA);
+	FragColor = vec4((lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB, 1.0f);
+}
\ No newline at end of file
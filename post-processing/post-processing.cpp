@@ -0,0 +1,287 @@
+// post-processing demo: a field of cubes, some of them glowing, rendered to an HDR target and run
+// through bloom, tonemapping, color grading and FXAA.
+// sweeps fused/unfused passes with full and half resolution bloom first and prints the GPU time
+// and target memory of the chain, then F toggles fusion and H the bloom resolution
+
+#include <cmath>
+#include <iostream>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../shader-lesson-1.4/Shader.h"
+#include "../geometry-heap/GeometryHeap.h"
+#include "PostProcessChain.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <std_image/stb_image.h>
+
+const unsigned int WIDTH = 1280;
+const unsigned int HEIGHT = 720;
+const int FIELD_SIZE = 30;
+const unsigned int SWEEP_FRAMES = 120;
+
+bool fused = true;
+bool halfResolutionBloom = true;
+bool settingsChanged = true;
+int windowWidth = WIDTH;
+int windowHeight = HEIGHT;
+
+void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+unsigned int loadTexture(const char* path);
+
+int main() {
+	// initialize GLFW
+	glfwInit();
+	// set version and core profile
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// create a window
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	// set callback to handle when window is resized
+	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+	glfwSetKeyCallback(window, keyCallback);
+
+	// initialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// no vsync, we want to see the frame time
+	glfwSwapInterval(0);
+
+	Shader shader("../coordinate-systems-1.6/les1.6-vShader.vert", "scene.frag");
+
+	// positions and texture coords
+	float vertices[] = {
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+	};
+
+	GeometryHeap* geometry = new GeometryHeap(1024, 0);
+	unsigned int cubeMesh = geometry->addMesh(vertices, 36);
+
+	stbi_set_flip_vertically_on_load(true);
+	unsigned int texture = loadTexture("../textures-lesson-1.5/container.jpg");
+
+	glfwGetFramebufferSize(window, &windowWidth, &windowHeight);
+	PostProcessChain* chain = new PostProcessChain(windowWidth, windowHeight);
+	chain->add(PostProcessChain::EFFECT_BLOOM);
+	chain->add(PostProcessChain::EFFECT_TONEMAP);
+	chain->add(PostProcessChain::EFFECT_COLOR_GRADE);
+	chain->add(PostProcessChain::EFFECT_FXAA);
+
+	glEnable(GL_DEPTH_TEST);
+
+	unsigned int query;
+	glGenQueries(1, &query);
+
+	bool sweeping = true;
+	unsigned int sweepFrame = 0;
+	double lastReport = glfwGetTime();
+	double lastFrame = lastReport;
+	double frameSum = 0.0, postSum = 0.0;
+	unsigned int frames = 0;
+
+	// render loop
+	while (!glfwWindowShouldClose(window)) {
+		float time = (float)glfwGetTime();
+		if (settingsChanged) {
+			chain->setFusion(fused);
+			chain->setBloomScale(halfResolutionBloom ? 0.5f : 1.0f);
+			chain->resize(windowWidth, windowHeight);
+			frameSum = postSum = 0.0;
+			frames = 0;
+			lastReport = glfwGetTime();
+			settingsChanged = false;
+		}
+
+		// scene into the HDR target
+		chain->beginScene();
+		glClearColor(0.02f, 0.02f, 0.03f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		glm::vec3 cameraPos = glm::vec3(sin(time * 0.1f) * 30.0f, 8.0f, cos(time * 0.1f) * 30.0f);
+		glm::mat4 view = glm::lookAt(cameraPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)windowWidth / (float)windowHeight, 0.1f, 100.0f);
+		shader.use();
+		shader.setInt("texture1", 0);
+		shader.setMat4("view", view);
+		shader.setMat4("projection", projection);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		geometry->bind();
+		for (int z = -FIELD_SIZE / 2; z < FIELD_SIZE / 2; ++z) {
+			for (int x = -FIELD_SIZE / 2; x < FIELD_SIZE / 2; ++x) {
+				// every seventh cube is far brighter than white
+				bool glowing = (x * 7 + z * 3) % 7 == 0;
+				glm::mat4 model = glm::mat4(1.0f);
+				model = glm::translate(model, glm::vec3(x * 2.0f, glowing ? -1.0f + sin(time + x) * 0.5f : -1.5f, z * 2.0f));
+				shader.setMat4("model", model);
+				shader.setFloat("intensity", glowing ? 8.0f : 1.0f);
+				geometry->draw(cubeMesh);
+			}
+		}
+		geometry->endFrame();
+
+		// GPU time of the post-processing chain alone
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		chain->apply();
+		glEndQuery(GL_TIME_ELAPSED);
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		GLuint64 postTime = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &postTime);
+		postSum += postTime / 1000000.0;
+		double now = glfwGetTime();
+		frameSum += (now - lastFrame) * 1000.0;
+		lastFrame = now;
+		++frames;
+
+		// the sweep steps through fused/unfused and both bloom sizes, then hands over to the keys
+		bool report = sweeping ? ++sweepFrame % SWEEP_FRAMES == 0 : now - lastReport > 1.0;
+		if (report) {
+			const RenderTargetPool& pool = chain->getPool();
+			std::cout << "POSTPROCESS::" << (fused ? "fused" : "unfused")
+				<< " | bloom " << (halfResolutionBloom ? "half" : "full") << " resolution"
+				<< " | passes " << chain->getPassCount()
+				<< " | frame " << frameSum / frames << " ms"
+				<< " | post GPU " << postSum / frames << " ms"
+				<< " | targets " << pool.getAllocatedBytes() / (1024.0 * 1024.0) << " MB"
+				<< " (" << chain->getUnpooledBytes() / (1024.0 * 1024.0) << " MB without reuse)" << std::endl;
+			frameSum = postSum = 0.0;
+			frames = 0;
+			lastReport = now;
+		}
+		if (sweeping && report) {
+			// fused+half, unfused+half, fused+full, unfused+full
+			fused = !fused;
+			if (fused) {
+				halfResolutionBloom = !halfResolutionBloom;
+				if (halfResolutionBloom) {
+					sweeping = false;
+					chain->printStats();
+				}
+			}
+			settingsChanged = true;
+		}
+	}
+
+	// deallocate objects
+	glDeleteQueries(1, &query);
+	delete chain;
+	delete geometry;
+	glDeleteTextures(1, &texture);
+
+	glfwTerminate();
+	return 0;
+}
+
+// whenever the window is resized this function gets called
+void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+	windowWidth = width;
+	windowHeight = height;
+	settingsChanged = true;
+}
+
+// react to key presses
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	if (action != GLFW_PRESS) {
+		return;
+	}
+	if (key == GLFW_KEY_ESCAPE) {
+		glfwSetWindowShouldClose(window, true);
+	}
+	if (key == GLFW_KEY_F) {
+		fused = !fused;
+		settingsChanged = true;
+	}
+	if (key == GLFW_KEY_H) {
+		halfResolutionBloom = !halfResolutionBloom;
+		settingsChanged = true;
+	}
+}
+
+// load an image into a mipmapped texture
+unsigned int loadTexture(const char* path) {
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width, height, nrChannels;
+	unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 4);
+	if (data) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else {
+		std::cout << "Failed to load texture" << std::endl;
+	}
+
+	stbi_image_free(data);
+	return texture;
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#version 330 core
+// one triangle that covers the screen, no vertex buffer needed
+out vec2 TexCoord;
+
+void main()
+{
+	vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	TexCoord = position;
+	gl_Position = vec4(position * 2.0f - 1.0f, 0.0f, 1.0f);
+}
\ No newline at end of file
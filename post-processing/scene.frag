@@ -0,0 +1,13 @@
+#version 330 core
+// textured cube in HDR, intensity above 1 makes it glow once bloom picks it up
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D texture1;
+uniform float intensity;
+
+void main()
+{
+	FragColor = vec4(texture(texture1, TexCoord).rgb * intensity, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#version 330 core
+// bilinear upscale of the rendered corner of the scene target, then sharpened to win back
+// some of the detail the lower resolution lost
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D source;
+uniform vec2 texelSize; // of the source
+uniform vec2 uvScale;   // rendered size / target size
+uniform float sharpness;
+
+vec3 fetch(vec2 uv)
+{
+	// never read past the rendered area, the rest of the target is stale
+	return texture(source, clamp(uv, 0.5f * texelSize, uvScale - 0.5f * texelSize)).rgb;
+}
+
+void main()
+{
+	vec2 uv = TexCoord * uvScale;
+	vec3 center = fetch(uv);
+	vec3 north = fetch(uv + vec2(0.0f, texelSize.y));
+	vec3 south = fetch(uv - vec2(0.0f, texelSize.y));
+	vec3 east = fetch(uv + vec2(texelSize.x, 0.0f));
+	vec3 west = fetch(uv - vec2(texelSize.x, 0.0f));
+
+	// unsharp mask, limited to the neighbourhood so edges do not ring
+	vec3 sharpened = center + (center - 0.25f * (north + south + east + west)) * sharpness;
+	vec3 low = min(center, min(min(north, south), min(east, west)));
+	vec3 high = max(center, max(max(north, south), max(east, west)));
+	FragColor = vec4(clamp(sharpened, low, high), 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "SceneGraph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SCENE_GRAPH_SSE
+#endif
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// out = parent * local, column major like glm
+static void multiply(const glm::mat4& parent, const glm::mat4& local, glm::mat4& out) {
+#ifdef SCENE_GRAPH_SSE
+	const float* a = &parent[0][0];
+	const float* b = &local[0][0];
+	float* result = &out[0][0];
+	__m128 a0 = _mm_loadu_ps(a);
+	__m128 a1 = _mm_loadu_ps(a + 4);
+	__m128 a2 = _mm_loadu_ps(a + 8);
+	__m128 a3 = _mm_loadu_ps(a + 12);
+	for (int column = 0; column < 4; ++column) {
+		const float* c = b + column * 4;
+		__m128 sum = _mm_mul_ps(a0, _mm_set1_ps(c[0]));
+		sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_set1_ps(c[1])));
+		sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_set1_ps(c[2])));
+		sum = _mm_add_ps(sum, _mm_mul_ps(a3, _mm_set1_ps(c[3])));
+		_mm_storeu_ps(result + column * 4, sum);
+	}
+#else
+	out = parent * local;
+#endif
+}
+
+SceneGraph::SceneGraph(unsigned int capacity, bool uploadToGPU)
+	: uploadToGPU(uploadToGPU), stamp(1), firstDirty(INVALID_NODE), buffer(0), bufferCapacity(0),
+	updatedCount(0), uploadRangeCount(0), uploadedBytes(0), updateTime(0.0), uploadTime(0.0),
+	updates(0), totalUpdated(0), totalUploaded(0) {
+	parents.reserve(capacity);
+	locals.reserve(capacity);
+	worlds.reserve(capacity);
+	changed.reserve(capacity);
+
+	if (uploadToGPU) {
+		bufferCapacity = std::max(capacity, 1u);
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)bufferCapacity * sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+}
+
+SceneGraph::~SceneGraph() {
+	if (buffer) {
+		glDeleteBuffers(1, &buffer);
+	}
+}
+
+unsigned int SceneGraph::addNode(unsigned int parent, const glm::mat4& local) {
+	unsigned int node = (unsigned int)parents.size();
+	if (parent != INVALID_NODE && parent >= node) {
+		std::cout << "ERROR::SCENEGRAPH::PARENT_NOT_FOUND " << parent << std::endl;
+		parent = INVALID_NODE;
+	}
+
+	parents.push_back(parent);
+	locals.push_back(local);
+	worlds.push_back(local);
+	changed.push_back(0);
+	setLocal(node, local);
+	return node;
+}
+
+void SceneGraph::setLocal(unsigned int node, const glm::mat4& local) {
+	locals[node] = local;
+	changed[node] = stamp;
+	firstDirty = std::min(firstDirty, node);
+}
+
+void SceneGraph::update() {
+	updatedCount = 0;
+	uploadRangeCount = 0;
+	uploadedBytes = 0;
+	updateTime = 0.0;
+	uploadTime = 0.0;
+	if (firstDirty == INVALID_NODE) {
+		return;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// parents come first, so a node whose parent changed this sweep is seen after it
+	ranges.clear();
+	const unsigned int count = (unsigned int)parents.size();
+	for (unsigned int node = firstDirty; node < count; ++node) {
+		unsigned int parent = parents[node];
+		bool parentChanged = parent != INVALID_NODE && changed[parent] == stamp;
+		if (changed[node] != stamp && !parentChanged) {
+			continue;
+		}
+
+		if (parent == INVALID_NODE) {
+			worlds[node] = locals[node];
+		}
+		else {
+			multiply(worlds[parent], locals[node], worlds[node]);
+		}
+		changed[node] = stamp;
+		++updatedCount;
+
+		if (!ranges.empty() && node - ranges.back().end <= MERGE_GAP) {
+			ranges.back().end = node + 1;
+		}
+		else {
+			ranges.push_back({ node, node + 1 });
+		}
+	}
+
+	// too many small ranges: keep widening the gap that gets merged
+	for (unsigned int gap = MERGE_GAP * 2; ranges.size() > MAX_UPLOAD_RANGES; gap *= 2) {
+		unsigned int merged = 0;
+		for (unsigned int i = 1; i < ranges.size(); ++i) {
+			if (ranges[i].begin - ranges[merged].end <= gap) {
+				ranges[merged].end = ranges[i].end;
+			}
+			else {
+				ranges[++merged] = ranges[i];
+			}
+		}
+		ranges.resize(merged + 1);
+	}
+	uploadRangeCount = (unsigned int)ranges.size();
+	for (const Range& range : ranges) {
+		uploadedBytes += (size_t)(range.end - range.begin) * sizeof(glm::mat4);
+	}
+
+	updateTime = elapsedMs(start);
+
+	start = std::chrono::high_resolution_clock::now();
+	upload();
+	uploadTime = elapsedMs(start);
+
+	// a new stamp makes every flag stale at once
+	++stamp;
+	firstDirty = INVALID_NODE;
+
+	++updates;
+	totalUpdated += updatedCount;
+	totalUploaded += uploadedBytes;
+}
+
+void SceneGraph::bindWorldMatrices(unsigned int attribute, unsigned int firstNode) {
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	for (unsigned int column = 0; column < 4; ++column) {
+		glVertexAttribPointer(attribute + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+			(void*)((size_t)firstNode * sizeof(glm::mat4) + column * sizeof(glm::vec4)));
+		glEnableVertexAttribArray(attribute + column);
+		glVertexAttribDivisor(attribute + column, 1);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SceneGraph::printStats() const {
+	double perUpdate = updates > 0 ? 1.0 / updates : 0.0;
+	std::cout << "SCENEGRAPH::nodes " << parents.size()
+		<< " | updates " << updates
+		<< " | nodes/update " << totalUpdated * perUpdate
+		<< " | uploaded/update " << totalUploaded * perUpdate / 1024.0 << " KB" << std::endl;
+}
+
+void SceneGraph::upload() {
+	if (!uploadToGPU) {
+		return;
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	if (parents.size() > bufferCapacity) {
+		// grow in place, the buffer name stays the same so VAOs pointing at it stay valid
+		bufferCapacity = std::max((unsigned int)parents.size(), bufferCapacity * 2);
+		glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)bufferCapacity * sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)worlds.size() * sizeof(glm::mat4), worlds.data());
+		uploadRangeCount = 1;
+		uploadedBytes = worlds.size() * sizeof(glm::mat4);
+	}
+	else {
+		for (const Range& range : ranges) {
+			glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)range.begin * sizeof(glm::mat4),
+				(GLsizeiptr)(range.end - range.begin) * sizeof(glm::mat4), &worlds[range.begin]);
+		}
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
\ No newline at end of file
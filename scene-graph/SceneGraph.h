@@ -0,0 +1,85 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Transform hierarchy in flat arrays. A node is only ever added after its
+// parent, so one front to back sweep sees every parent before its children.
+// Moving a node marks it dirty; update() recomputes the world matrices of the
+// dirty nodes and their subtrees only, and re-uploads just the ranges of the
+// GPU buffer that changed.
+//
+// GPU layout: one mat4 per node, in node order, meant to be read as an
+// instanced vertex attribute (see bindWorldMatrices).
+class SceneGraph {
+public:
+	static const unsigned int INVALID_NODE = 0xffffffff;
+	// changed nodes closer than this are uploaded as one range
+	static const unsigned int MERGE_GAP = 64;
+	// more ranges than this and a single span is cheaper than the calls
+	static const unsigned int MAX_UPLOAD_RANGES = 4096;
+
+	// uploadToGPU = false keeps everything on the CPU (benchmarks)
+	SceneGraph(unsigned int capacity = 0, bool uploadToGPU = true);
+	~SceneGraph();
+
+	// parent must already exist, INVALID_NODE for a root
+	unsigned int addNode(unsigned int parent, const glm::mat4& local);
+	void setLocal(unsigned int node, const glm::mat4& local);
+
+	// recompute dirty subtrees and upload what changed
+	void update();
+
+	const glm::mat4& getLocal(unsigned int node) const { return locals[node]; }
+	// valid after the update() that follows the last change
+	const glm::mat4& getWorld(unsigned int node) const { return worlds[node]; }
+	unsigned int getParent(unsigned int node) const { return parents[node]; }
+	unsigned int getNodeCount() const { return (unsigned int)parents.size(); }
+
+	// world matrices as a per instance mat4 at locations attribute..attribute+3
+	// of the bound VAO, instance 0 is firstNode
+	void bindWorldMatrices(unsigned int attribute, unsigned int firstNode = 0);
+	unsigned int getBuffer() const { return buffer; }
+
+	// stats of the last update
+	unsigned int getUpdatedCount() const { return updatedCount; }
+	unsigned int getUploadRangeCount() const { return uploadRangeCount; }
+	size_t getUploadedBytes() const { return uploadedBytes; }
+	double getUpdateTime() const { return updateTime; }
+	double getUploadTime() const { return uploadTime; }
+	void printStats() const;
+
+private:
+	// half open node range
+	struct Range {
+		unsigned int begin, end;
+	};
+
+	bool uploadToGPU;
+
+	std::vector<unsigned int> parents;
+	std::vector<glm::mat4> locals;
+	std::vector<glm::mat4> worlds;
+	// node changed in the update with this stamp, no need to clear flags
+	std::vector<unsigned int> changed;
+	unsigned int stamp;
+	unsigned int firstDirty; // INVALID_NODE when nothing is dirty
+
+	std::vector<Range> ranges;
+
+	unsigned int buffer;
+	unsigned int bufferCapacity; // in nodes
+
+	unsigned int updatedCount;
+	unsigned int uploadRangeCount;
+	size_t uploadedBytes;
+	double updateTime;
+	double uploadTime;
+	unsigned long long updates;
+	unsigned long long totalUpdated;
+	unsigned long long totalUploaded;
+
+	void upload();
+};
\ No newline at end of file
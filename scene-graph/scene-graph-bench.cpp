@@ -0,0 +1,62 @@
+// scene graph update benchmark, runs without a GL context
+// 1M nodes in an 8-ary tree, a share of random nodes moves every frame
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "SceneGraph.h"
+
+int main() {
+	const unsigned int NODE_COUNT = 1000000;
+	const unsigned int BRANCHING = 8;
+	const float dirtyRates[] = { 0.001f, 0.1f, 1.0f };
+	const int ITERATIONS = 50;
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+
+	// breadth first, so every parent is added before its children
+	SceneGraph scene(NODE_COUNT, false);
+	scene.addNode(SceneGraph::INVALID_NODE, glm::mat4(1.0f));
+	for (unsigned int i = 1; i < NODE_COUNT; ++i) {
+		glm::mat4 local = glm::translate(glm::mat4(1.0f), glm::vec3(offset(rng), offset(rng), offset(rng)));
+		scene.addNode((i - 1) / BRANCHING, local);
+	}
+	scene.update();
+	std::cout << NODE_COUNT << " nodes, first update " << scene.getUpdateTime() << " ms" << std::endl;
+
+	std::vector<unsigned int> moved;
+	for (float rate : dirtyRates) {
+		std::uniform_int_distribution<unsigned int> pick(0, NODE_COUNT - 1);
+		unsigned int movedCount = (unsigned int)(NODE_COUNT * rate);
+
+		double update = 0.0;
+		unsigned long long updated = 0, uploaded = 0, rangeCount = 0;
+		for (int i = 0; i < ITERATIONS; ++i) {
+			moved.clear();
+			for (unsigned int j = 0; j < movedCount; ++j) {
+				moved.push_back(rate >= 1.0f ? j : pick(rng));
+			}
+			for (unsigned int node : moved) {
+				glm::mat4 local = scene.getLocal(node);
+				local[3].y += 0.01f;
+				scene.setLocal(node, local);
+			}
+
+			scene.update();
+			update += scene.getUpdateTime();
+			updated += scene.getUpdatedCount();
+			uploaded += scene.getUploadedBytes();
+			rangeCount += scene.getUploadRangeCount();
+		}
+
+		std::cout << rate * 100.0f << "% dirty: update " << update / ITERATIONS << " ms"
+			<< " | recomputed " << updated / ITERATIONS << " nodes"
+			<< " | upload " << uploaded / ITERATIONS / 1024 << " KB in "
+			<< rangeCount / ITERATIONS << " ranges" << std::endl;
+	}
+
+	return 0;
+}
\ No newline at end of file
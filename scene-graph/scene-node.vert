@@ -0,0 +1,20 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+// world matrix of the node, one per instance from the scene graph buffer
+layout (location = 2) in mat4 aModel;
+
+out vec2 TexCoord;
+
+// written by FramePacer::latchCamera right before the draws
+layout (std140) uniform Camera
+{
+	mat4 view;
+	mat4 projection;
+};
+
+void main()
+{
+	gl_Position = projection * view * aModel * vec4(aPos, 1.0f);
+	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+}
\ No newline at end of file
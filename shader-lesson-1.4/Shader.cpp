@@ -1,68 +1,79 @@
 #include "Shader.h"
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath) {
-	// retrieve the vertex/fragment source code from filePath
-	std::string vertexCode;
-	std::string fragmentCode;
-	std::ifstream vShaderFile;
-	std::ifstream fShaderFile;
+// missing from headers generated for 3.3
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+
+// read a whole file, defines go after the #version line
+static std::string readShaderFile(const char* path, const char* defines) {
+	std::string code;
+	std::ifstream shaderFile;
 	// ensure filestream objects can now throw exceptions
-	vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-	fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+	shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
 
 	try {
-		// open files
-		vShaderFile.open(vertexPath);
-		fShaderFile.open(fragmentPath);
-		std::stringstream vShaderStream, fShaderStream;
-		// read file's buffer contents into streams
-		vShaderStream << vShaderFile.rdbuf();
-		fShaderStream << fShaderFile.rdbuf();
-		// close file handlers
-		vShaderFile.close();
-		fShaderFile.close();
-		// convert streams into string
-		vertexCode = vShaderStream.str();
-		fragmentCode = fShaderStream.str();
+		// open file
+		shaderFile.open(path);
+		std::stringstream shaderStream;
+		// read file's buffer contents into stream
+		shaderStream << shaderFile.rdbuf();
+		// close file handler
+		shaderFile.close();
+		// convert stream into string
+		code = shaderStream.str();
 	}
 	catch (std::ifstream::failure e) {
-		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
+		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ " << path << std::endl;
 	}
 
-	const char* vShaderCode = vertexCode.c_str();
-	const char* fShaderCode = fragmentCode.c_str();
+	if (defines) {
+		size_t lineEnd = code.find('\n');
+		code.insert(lineEnd == std::string::npos ? code.size() : lineEnd + 1, defines);
+	}
+	return code;
+}
 
-	// compile shaders
-	unsigned int vertex, fragment;
+static unsigned int compileShader(GLenum type, const std::string& code, const char* stage) {
+	const char* shaderCode = code.c_str();
 	int success;
 	char infolog[512];
 
-	// vertex shader
-	vertex = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertex, 1, &vShaderCode, NULL);
-	glCompileShader(vertex);
+	unsigned int shader = glCreateShader(type);
+	glShaderSource(shader, 1, &shaderCode, NULL);
+	glCompileShader(shader);
 	// print compiler errors if any
-	glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
 	if (!success) {
-		glGetShaderInfoLog(vertex, 512, NULL, infolog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED " << infolog << std::endl;
+		glGetShaderInfoLog(shader, 512, NULL, infolog);
+		std::cout << "ERROR::SHADER::" << stage << "::COMPILATION_FAILED " << infolog << std::endl;
 	}
+	return shader;
+}
 
-	// fragment shader
-	fragment = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragment, 1, &fShaderCode, NULL);
-	glCompileShader(fragment);
-	// print compiler errors if any
-	glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-	if (!success) {
-		glGetShaderInfoLog(fragment, 512, NULL, infolog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED " << infolog << std::endl;
+Shader::Shader(const char* vertexPath, const char* fragmentPath)
+	: Shader(vertexPath, fragmentPath, NULL, NULL) {
+}
+
+Shader::Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath, const char* defines) {
+	// retrieve the source code from filePath and compile shaders
+	unsigned int vertex = compileShader(GL_VERTEX_SHADER, readShaderFile(vertexPath, defines), "VERTEX");
+	unsigned int fragment = compileShader(GL_FRAGMENT_SHADER, readShaderFile(fragmentPath, defines), "FRAGMENT");
+	unsigned int geometry = 0;
+	if (geometryPath) {
+		geometry = compileShader(GL_GEOMETRY_SHADER, readShaderFile(geometryPath, defines), "GEOMETRY");
 	}
 
+	int success;
+	char infolog[512];
+
 	// shader program
 	ID = glCreateProgram();
 	glAttachShader(ID, vertex);
 	glAttachShader(ID, fragment);
+	if (geometry) {
+		glAttachShader(ID, geometry);
+	}
 	glLinkProgram(ID);
 	// print linking errors if any
 	glGetProgramiv(ID, GL_LINK_STATUS, &success);
@@ -74,6 +85,85 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
 	// delete shaders once linked
 	glDeleteShader(vertex);
 	glDeleteShader(fragment);
+	if (geometry) {
+		glDeleteShader(geometry);
+	}
+}
+
+Shader::Shader(const char* computePath) {
+	unsigned int compute = compileShader(GL_COMPUTE_SHADER, readShaderFile(computePath, NULL), "COMPUTE");
+
+	int success;
+	char infolog[512];
+
+	// shader program
+	ID = glCreateProgram();
+	glAttachShader(ID, compute);
+	glLinkProgram(ID);
+	// print linking errors if any
+	glGetProgramiv(ID, GL_LINK_STATUS, &success);
+	if (!success) {
+		glGetProgramInfoLog(ID, 512, NULL, infolog);
+		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED " << infolog << std::endl;
+	}
+
+	glDeleteShader(compute);
+}
+
+Shader::Shader(const std::string& vertexCode, const std::string& fragmentCode, bool checkLater) {
+	unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
+	const char* code = vertexCode.c_str();
+	glShaderSource(vertex, 1, &code, NULL);
+	glCompileShader(vertex);
+	unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
+	code = fragmentCode.c_str();
+	glShaderSource(fragment, 1, &code, NULL);
+	glCompileShader(fragment);
+
+	// no status queries here, those are what would wait for the compiler
+	ID = glCreateProgram();
+	glAttachShader(ID, vertex);
+	glAttachShader(ID, fragment);
+	glLinkProgram(ID);
+	// only flagged for deletion while attached, checkStatus can still ask them
+	glDeleteShader(vertex);
+	glDeleteShader(fragment);
+
+	if (!checkLater) {
+		checkStatus();
+	}
+}
+
+std::string Shader::readSource(const char* path, const char* defines) {
+	return readShaderFile(path, defines);
+}
+
+bool Shader::checkStatus() const {
+	int success;
+	char infolog[512];
+
+	glGetProgramiv(ID, GL_LINK_STATUS, &success);
+	if (success) {
+		return true;
+	}
+
+	// compile errors of the stages first, they usually explain the link error
+	unsigned int shaders[3];
+	GLsizei count = 0;
+	glGetAttachedShaders(ID, 3, &count, shaders);
+	for (GLsizei i = 0; i < count; ++i) {
+		glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &success);
+		if (!success) {
+			int type;
+			glGetShaderiv(shaders[i], GL_SHADER_TYPE, &type);
+			glGetShaderInfoLog(shaders[i], 512, NULL, infolog);
+			std::cout << "ERROR::SHADER::" << (type == GL_VERTEX_SHADER ? "VERTEX" : type == GL_FRAGMENT_SHADER ? "FRAGMENT" : "GEOMETRY")
+				<< "::COMPILATION_FAILED " << infolog << std::endl;
+		}
+	}
+	glGetProgramInfoLog(ID, 512, NULL, infolog);
+	std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED " << infolog << std::endl;
+	return false;
 }
 
 // activate shader
@@ -82,14 +172,33 @@ void Shader::use() {
 }
 
 // utility uniform functions
-void Shader::setBool(const std::string& name, bool value) const {
-	glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+void Shader::setBool(const char* name, bool value) const {
+	glUniform1i(glGetUniformLocation(ID, name), (int)value);
+}
+
+void Shader::setInt(const char* name, int value) const {
+	glUniform1i(glGetUniformLocation(ID, name), value);
+}
+
+void Shader::setFloat(const char* name, float value) const {
+	glUniform1f(glGetUniformLocation(ID, name), value);
+}
+
+void Shader::setVec2(const char* name, const glm::vec2& value) const {
+	glUniform2f(glGetUniformLocation(ID, name), value.x, value.y);
+}
+
+void Shader::setVec3(const char* name, const glm::vec3& value) const {
+	glUniform3f(glGetUniformLocation(ID, name), value.x, value.y, value.z);
 }
 
-void Shader::setInt(const std::string& name, int value) const {
-	glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+void Shader::setMat4(const char* name, const glm::mat4& value) const {
+	glUniformMatrix4fv(glGetUniformLocation(ID, name), 1, GL_FALSE, glm::value_ptr(value));
 }
 
-void Shader::setFloat(const std::string& name, float value) const {
-	glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+void Shader::bindUniformBlock(const char* name, unsigned int binding) const {
+	unsigned int index = glGetUniformBlockIndex(ID, name);
+	if (index != GL_INVALID_INDEX) {
+		glUniformBlockBinding(ID, index, binding);
+	}
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
 
 #include <string>
 #include <fstream>
@@ -12,10 +14,31 @@ public:
 	unsigned int ID; // program ID
 
 	Shader(const char* vertexPath, const char* fragmentPath);
+	// optional geometry stage; defines are inserted right after the #version line
+	// of every stage, e.g. "#define VIEW_COUNT 4\n"
+	Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath, const char* defines = NULL);
+	// compute program, needs a 4.3 context
+	explicit Shader(const char* computePath);
+	// from sources read earlier, e.g. on another thread. with checkLater the compile and link
+	// are only issued and checkStatus() reports errors, so drivers that compile in the
+	// background can do it while the caller goes on with other GL work
+	Shader(const std::string& vertexCode, const std::string& fragmentCode, bool checkLater);
+
+	// read a stage from disk, safe on any thread; defines go after the #version line
+	static std::string readSource(const char* path, const char* defines = NULL);
+	// waits for the link and prints the errors, true if the program is usable
+	bool checkStatus() const;
 
 	void use();
 
-	void setBool(const std::string& name, bool value) const;
-	void setInt(const std::string& name, int value) const;
-	void setFloat(const std::string& name, float value) const;
+	// names are plain C strings so calls with a literal never build a std::string
+	void setBool(const char* name, bool value) const;
+	void setInt(const char* name, int value) const;
+	void setFloat(const char* name, float value) const;
+	void setVec2(const char* name, const glm::vec2& value) const;
+	void setVec3(const char* name, const glm::vec3& value) const;
+	void setMat4(const char* name, const glm::mat4& value) const;
+
+	// attach a named uniform block to a buffer binding point
+	void bindUniformBlock(const char* name, unsigned int binding) const;
 };
\ No newline at end of file
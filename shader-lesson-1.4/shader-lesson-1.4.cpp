@@ -4,10 +4,16 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include "Shader.h"
+#include "../frame-memory/AllocationTracker.h"
+#include "../on-demand/RedrawScheduler.h"
 
 void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+void windowRefreshCallback(GLFWwindow* window);
 void processInput(GLFWwindow* window);
 
+// the triangle never changes, a frame is only drawn when the window needs one
+RedrawScheduler* scheduler = NULL;
+
 int main() {
 	// initialize GLFW
 	glfwInit();
@@ -31,6 +37,8 @@ int main() {
 	glfwMakeContextCurrent(window);
 	// set callback to handle when window is resized
 	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+	// uncovered or restored, the back buffer contents are gone
+	glfwSetWindowRefreshCallback(window, windowRefreshCallback);
 
 	// initialize GLAD
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
@@ -89,9 +97,18 @@ int main() {
 	// set wireframe mode
 	// glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+	scheduler = new RedrawScheduler(RedrawScheduler::MODE_ON_DEMAND);
+
 	// render loop
 	while (!glfwWindowShouldClose(window)) {
+		// sleeps until an event arrives instead of polling
+		scheduler->waitForEvents();
 		processInput(window);
+		if (!scheduler->beginFrame(window)) {
+			continue;
+		}
+
+		AllocationTracker::beginFrame();
 
 		// clear screen
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
@@ -107,9 +124,16 @@ int main() {
 		glBindVertexArray(VAO);
 		glDrawArrays(GL_TRIANGLES, 0, 3);
 
-		glfwSwapBuffers(window);
-		glfwPollEvents();
+		scheduler->endFrame(window);
+
+		AllocationTracker::endFrame();
 	}
+	// heap allocations per frame, should be 0 in steady state
+	AllocationTracker::report("shader-lesson-1.4");
+	// frames drawn and CPU time per minute, compare with RedrawScheduler::MODE_CONTINUOUS
+	scheduler->printStats();
+	delete scheduler;
+
 	// deallocate objects
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteBuffers(1, &VBO);
@@ -122,6 +146,12 @@ int main() {
 void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
 	// tell OpenGL the size of the window
 	glViewport(0, 0, width, height);
+	scheduler->invalidate();
+}
+
+// the system asks for the window contents again
+void windowRefreshCallback(GLFWwindow* window) {
+	scheduler->invalidate();
 }
 
 // react to key presses
@@ -0,0 +1,341 @@
+#include "Animation.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SKINNING_SSE
+#endif
+
+// identity value of every channel, rotation w and scale are 1
+static const float IDENTITY[Pose::CHANNELS] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+
+// a and b hold one group (8 channels x 4 lanes), out = nlerp of the two
+static void nlerpGroupScalar(const float* a, const float* b, float weight, float* out) {
+	for (int lane = 0; lane < 4; ++lane) {
+		float dot = 0.0f;
+		for (int c = 0; c < 4; ++c) {
+			dot += a[c * 4 + lane] * b[c * 4 + lane];
+		}
+		// take the short way round
+		float sign = dot < 0.0f ? -1.0f : 1.0f;
+		float rotation[4], length = 0.0f;
+		for (int c = 0; c < 4; ++c) {
+			rotation[c] = a[c * 4 + lane] + (b[c * 4 + lane] * sign - a[c * 4 + lane]) * weight;
+			length += rotation[c] * rotation[c];
+		}
+		float inverse = 1.0f / std::sqrt(length);
+		for (int c = 0; c < 4; ++c) {
+			out[c * 4 + lane] = rotation[c] * inverse;
+		}
+		for (int c = 4; c < 8; ++c) {
+			out[c * 4 + lane] = a[c * 4 + lane] + (b[c * 4 + lane] - a[c * 4 + lane]) * weight;
+		}
+	}
+}
+
+#ifdef SKINNING_SSE
+// same as nlerpGroupScalar with the channels already in registers, b is changed
+static inline void nlerpGroup(const __m128* a, __m128* b, __m128 weight, float* out) {
+	__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])),
+		_mm_add_ps(_mm_mul_ps(a[2], b[2]), _mm_mul_ps(a[3], b[3])));
+	// sign bit where the quaternions point apart
+	__m128 flip = _mm_and_ps(_mm_cmplt_ps(dot, _mm_setzero_ps()), _mm_set1_ps(-0.0f));
+	__m128 rotation[4];
+	__m128 length = _mm_setzero_ps();
+	for (int c = 0; c < 4; ++c) {
+		b[c] = _mm_xor_ps(b[c], flip);
+		rotation[c] = _mm_add_ps(a[c], _mm_mul_ps(_mm_sub_ps(b[c], a[c]), weight));
+		length = _mm_add_ps(length, _mm_mul_ps(rotation[c], rotation[c]));
+	}
+	__m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(length));
+	for (int c = 0; c < 4; ++c) {
+		_mm_storeu_ps(out + c * 4, _mm_mul_ps(rotation[c], inverse));
+	}
+	for (int c = 4; c < 8; ++c) {
+		_mm_storeu_ps(out + c * 4, _mm_add_ps(a[c], _mm_mul_ps(_mm_sub_ps(b[c], a[c]), weight)));
+	}
+}
+
+// 4 unsigned 16 bit values to floats
+static inline __m128 loadQuantized(const uint16_t* q) {
+	__m128i packed = _mm_loadl_epi64((const __m128i*)q);
+	return _mm_cvtepi32_ps(_mm_unpacklo_epi16(packed, _mm_setzero_si128()));
+}
+#endif
+
+void Pose::resize(unsigned int count) {
+	if (count == jointCount && !data.empty()) {
+		return;
+	}
+	jointCount = count;
+	data.resize((size_t)getGroupCount() * GROUP_FLOATS);
+	for (unsigned int group = 0; group < getGroupCount(); ++group) {
+		for (unsigned int c = 0; c < CHANNELS; ++c) {
+			std::fill_n(&data[group * GROUP_FLOATS + c * 4], 4, IDENTITY[c]);
+		}
+	}
+}
+
+void Pose::set(unsigned int joint, const JointTransform& transform) {
+	float* group = &data[(joint / 4) * GROUP_FLOATS + joint % 4];
+	const float values[CHANNELS] = { transform.rotation.x, transform.rotation.y, transform.rotation.z,
+		transform.rotation.w, transform.translation.x, transform.translation.y, transform.translation.z, transform.scale };
+	for (unsigned int c = 0; c < CHANNELS; ++c) {
+		group[c * 4] = values[c];
+	}
+}
+
+JointTransform Pose::get(unsigned int joint) const {
+	const float* group = &data[(joint / 4) * GROUP_FLOATS + joint % 4];
+	JointTransform transform;
+	transform.rotation = glm::quat(group[12], group[0], group[4], group[8]);
+	transform.translation = glm::vec3(group[16], group[20], group[24]);
+	transform.scale = group[28];
+	return transform;
+}
+
+void Pose::blend(const Pose& a, const Pose& b, float weight, Pose& out, bool useSIMD) {
+	out.resize(a.jointCount);
+	const float* pa = a.data.data();
+	const float* pb = b.data.data();
+	float* po = out.data.data();
+	unsigned int groups = a.getGroupCount();
+#ifdef SKINNING_SSE
+	if (useSIMD) {
+		__m128 w = _mm_set1_ps(weight);
+		for (unsigned int group = 0; group < groups; ++group) {
+			__m128 va[CHANNELS], vb[CHANNELS];
+			for (unsigned int c = 0; c < CHANNELS; ++c) {
+				va[c] = _mm_loadu_ps(pa + group * GROUP_FLOATS + c * 4);
+				vb[c] = _mm_loadu_ps(pb + group * GROUP_FLOATS + c * 4);
+			}
+			nlerpGroup(va, vb, w, po + group * GROUP_FLOATS);
+		}
+		return;
+	}
+#endif
+	for (unsigned int group = 0; group < groups; ++group) {
+		nlerpGroupScalar(pa + group * GROUP_FLOATS, pb + group * GROUP_FLOATS, weight, po + group * GROUP_FLOATS);
+	}
+}
+
+unsigned int Skeleton::addJoint(int parent, const glm::mat4& inverseBind) {
+	parents.push_back(parent);
+	for (int row = 0; row < 3; ++row) {
+		for (int column = 0; column < 4; ++column) {
+			inverseBinds.push_back(inverseBind[column][row]);
+		}
+	}
+	return (unsigned int)parents.size() - 1;
+}
+
+// out = a * b for 3x4 rows with an implied 0 0 0 1 row, out may be a
+static inline void multiplyAffine(const float* a, const float* b, float* out, bool useSIMD) {
+#ifdef SKINNING_SSE
+	if (useSIMD) {
+		__m128 b0 = _mm_loadu_ps(b);
+		__m128 b1 = _mm_loadu_ps(b + 4);
+		__m128 b2 = _mm_loadu_ps(b + 8);
+		for (int row = 0; row < 3; ++row) {
+			const float* r = a + row * 4;
+			__m128 sum = _mm_mul_ps(_mm_set1_ps(r[0]), b0);
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(r[1]), b1));
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(r[2]), b2));
+			sum = _mm_add_ps(sum, _mm_set_ps(r[3], 0.0f, 0.0f, 0.0f));
+			_mm_storeu_ps(out + row * 4, sum);
+		}
+		return;
+	}
+#endif
+	for (int row = 0; row < 3; ++row) {
+		float r[4] = { a[row * 4], a[row * 4 + 1], a[row * 4 + 2], a[row * 4 + 3] };
+		for (int column = 0; column < 4; ++column) {
+			out[row * 4 + column] = r[0] * b[column] + r[1] * b[4 + column] + r[2] * b[8 + column];
+		}
+		out[row * 4 + 3] += r[3];
+	}
+}
+
+// local matrices of the 4 joints of a group, 12 floats each
+static void groupLocals(const float* group, float* locals, bool useSIMD) {
+#ifdef SKINNING_SSE
+	if (useSIMD) {
+		__m128 x = _mm_loadu_ps(group), y = _mm_loadu_ps(group + 4);
+		__m128 z = _mm_loadu_ps(group + 8), w = _mm_loadu_ps(group + 12);
+		__m128 s = _mm_loadu_ps(group + 28);
+		__m128 two = _mm_set1_ps(2.0f), one = _mm_set1_ps(1.0f);
+		__m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+		__m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+		__m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+		__m128 s2 = _mm_mul_ps(s, two);
+		// one register per matrix element, lanes are the joints
+		__m128 m[12];
+		m[0] = _mm_mul_ps(s, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))));
+		m[1] = _mm_mul_ps(s2, _mm_sub_ps(xy, wz));
+		m[2] = _mm_mul_ps(s2, _mm_add_ps(xz, wy));
+		m[3] = _mm_loadu_ps(group + 16);
+		m[4] = _mm_mul_ps(s2, _mm_add_ps(xy, wz));
+		m[5] = _mm_mul_ps(s, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))));
+		m[6] = _mm_mul_ps(s2, _mm_sub_ps(yz, wx));
+		m[7] = _mm_loadu_ps(group + 20);
+		m[8] = _mm_mul_ps(s2, _mm_sub_ps(xz, wy));
+		m[9] = _mm_mul_ps(s2, _mm_add_ps(yz, wx));
+		m[10] = _mm_mul_ps(s, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))));
+		m[11] = _mm_loadu_ps(group + 24);
+		// transpose every row to joint order
+		for (int row = 0; row < 3; ++row) {
+			__m128 r0 = m[row * 4], r1 = m[row * 4 + 1], r2 = m[row * 4 + 2], r3 = m[row * 4 + 3];
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_storeu_ps(locals + row * 4, r0);
+			_mm_storeu_ps(locals + 12 + row * 4, r1);
+			_mm_storeu_ps(locals + 24 + row * 4, r2);
+			_mm_storeu_ps(locals + 36 + row * 4, r3);
+		}
+		return;
+	}
+#endif
+	for (int lane = 0; lane < 4; ++lane) {
+		float x = group[lane], y = group[4 + lane], z = group[8 + lane], w = group[12 + lane];
+		float s = group[28 + lane];
+		float* m = locals + lane * 12;
+		m[0] = s * (1.0f - 2.0f * (y * y + z * z));
+		m[1] = s * 2.0f * (x * y - w * z);
+		m[2] = s * 2.0f * (x * z + w * y);
+		m[3] = group[16 + lane];
+		m[4] = s * 2.0f * (x * y + w * z);
+		m[5] = s * (1.0f - 2.0f * (x * x + z * z));
+		m[6] = s * 2.0f * (y * z - w * x);
+		m[7] = group[20 + lane];
+		m[8] = s * 2.0f * (x * z - w * y);
+		m[9] = s * 2.0f * (y * z + w * x);
+		m[10] = s * (1.0f - 2.0f * (x * x + y * y));
+		m[11] = group[24 + lane];
+	}
+}
+
+void Skeleton::computePalette(const Pose& pose, const glm::mat4& world, float* palette, bool useSIMD) const {
+	float root[12];
+	for (int row = 0; row < 3; ++row) {
+		for (int column = 0; column < 4; ++column) {
+			root[row * 4 + column] = world[column][row];
+		}
+	}
+
+	// model matrices first, the palette doubles as storage for the parents
+	unsigned int jointCount = getJointCount();
+	float locals[48];
+	for (unsigned int group = 0; group * 4 < jointCount; ++group) {
+		groupLocals(pose.getData() + group * Pose::GROUP_FLOATS, locals, useSIMD);
+		unsigned int end = std::min(jointCount, group * 4 + 4);
+		for (unsigned int joint = group * 4; joint < end; ++joint) {
+			const float* parent = parents[joint] < 0 ? root : palette + parents[joint] * 12;
+			multiplyAffine(parent, locals + (joint - group * 4) * 12, palette + joint * 12, useSIMD);
+		}
+	}
+	// then move every one into bind space
+	for (unsigned int joint = 0; joint < jointCount; ++joint) {
+		multiplyAffine(palette + joint * 12, &inverseBinds[joint * 12], palette + joint * 12, useSIMD);
+	}
+}
+
+void AnimationClip::build(const JointTransform* source, unsigned int joints, unsigned int count,
+	float rate, bool loop) {
+	jointCount = joints;
+	keyCount = count;
+	sampleRate = rate;
+	looping = loop;
+	Pose pose(jointCount);
+	groupFloats = pose.getGroupCount() * Pose::GROUP_FLOATS;
+
+	// every key in the Pose layout, with the sign of each rotation following the previous key
+	std::vector<float> values((size_t)keyCount * groupFloats);
+	std::vector<glm::quat> previous(jointCount);
+	for (unsigned int key = 0; key < keyCount; ++key) {
+		for (unsigned int joint = 0; joint < jointCount; ++joint) {
+			JointTransform transform = source[(size_t)key * jointCount + joint];
+			if (key > 0 && glm::dot(transform.rotation, previous[joint]) < 0.0f) {
+				transform.rotation = -transform.rotation;
+			}
+			previous[joint] = transform.rotation;
+			pose.set(joint, transform);
+		}
+		std::copy(pose.getData(), pose.getData() + groupFloats, &values[(size_t)key * groupFloats]);
+	}
+
+	// range of every channel of every joint, padding lanes stay at the identity
+	offsets.assign(groupFloats, 0.0f);
+	scales.assign(groupFloats, 0.0f);
+	for (unsigned int i = 0; i < groupFloats; ++i) {
+		float low = values[i], high = values[i];
+		for (unsigned int key = 1; key < keyCount; ++key) {
+			low = std::min(low, values[(size_t)key * groupFloats + i]);
+			high = std::max(high, values[(size_t)key * groupFloats + i]);
+		}
+		offsets[i] = low;
+		scales[i] = (high - low) / 65535.0f;
+	}
+	keys.resize((size_t)keyCount * groupFloats);
+	for (size_t i = 0; i < keys.size(); ++i) {
+		unsigned int channel = (unsigned int)(i % groupFloats);
+		float q = scales[channel] > 0.0f ? (values[i] - offsets[channel]) / scales[channel] : 0.0f;
+		keys[i] = (uint16_t)std::min(65535.0f, std::max(0.0f, std::floor(q + 0.5f)));
+	}
+}
+
+size_t AnimationClip::getCompressedBytes() const {
+	return keys.size() * sizeof(uint16_t) + (offsets.size() + scales.size()) * sizeof(float);
+}
+
+void AnimationClip::sample(float time, Pose& pose, bool useSIMD) const {
+	pose.resize(jointCount);
+	if (keyCount == 0) {
+		return;
+	}
+	float position = std::max(0.0f, time * sampleRate);
+	unsigned int key0, key1;
+	if (looping) {
+		position = std::fmod(position, (float)keyCount);
+		key0 = std::min((unsigned int)position, keyCount - 1);
+		key1 = (key0 + 1) % keyCount;
+	}
+	else {
+		position = std::min(position, (float)(keyCount - 1));
+		key0 = (unsigned int)position;
+		key1 = std::min(key0 + 1, keyCount - 1);
+	}
+	float weight = position - key0;
+
+	const uint16_t* q0 = &keys[(size_t)key0 * groupFloats];
+	const uint16_t* q1 = &keys[(size_t)key1 * groupFloats];
+	float* out = pose.getData();
+	unsigned int groups = groupFloats / Pose::GROUP_FLOATS;
+#ifdef SKINNING_SSE
+	if (useSIMD) {
+		// both keys are decoded into registers and blended without touching memory in between
+		__m128 w = _mm_set1_ps(weight);
+		for (unsigned int group = 0; group < groups; ++group) {
+			__m128 a[Pose::CHANNELS], b[Pose::CHANNELS];
+			for (unsigned int c = 0; c < Pose::CHANNELS; ++c) {
+				unsigned int i = group * Pose::GROUP_FLOATS + c * 4;
+				__m128 offset = _mm_loadu_ps(&offsets[i]);
+				__m128 scale = _mm_loadu_ps(&scales[i]);
+				a[c] = _mm_add_ps(offset, _mm_mul_ps(loadQuantized(q0 + i), scale));
+				b[c] = _mm_add_ps(offset, _mm_mul_ps(loadQuantized(q1 + i), scale));
+			}
+			nlerpGroup(a, b, w, out + group * Pose::GROUP_FLOATS);
+		}
+		return;
+	}
+#endif
+	for (unsigned int group = 0; group < groups; ++group) {
+		float a[Pose::GROUP_FLOATS], b[Pose::GROUP_FLOATS];
+		for (unsigned int c = 0; c < Pose::GROUP_FLOATS; ++c) {
+			unsigned int i = group * Pose::GROUP_FLOATS + c;
+			a[c] = offsets[i] + q0[i] * scales[i];
+			b[c] = offsets[i] + q1[i] * scales[i];
+		}
+		nlerpGroupScalar(a, b, weight, out + group * Pose::GROUP_FLOATS);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// local transform of one joint relative to its parent, uniform scale only
+struct JointTransform {
+	glm::quat rotation;
+	glm::vec3 translation;
+	float scale;
+
+	JointTransform() : rotation(1.0f, 0.0f, 0.0f, 0.0f), translation(0.0f), scale(1.0f) {}
+};
+
+// Local transforms of every joint, stored as structure of arrays in groups of
+// 4 joints so one SSE register holds the same channel of 4 joints:
+//   group g: rx[4] ry[4] rz[4] rw[4] tx[4] ty[4] tz[4] s[4]
+// Lanes past the last joint hold the identity.
+class Pose {
+public:
+	static const unsigned int CHANNELS = 8;
+	static const unsigned int GROUP_FLOATS = CHANNELS * 4;
+
+	Pose() : jointCount(0) {}
+	explicit Pose(unsigned int jointCount) : jointCount(0) { resize(jointCount); }
+
+	void resize(unsigned int jointCount);
+	unsigned int getJointCount() const { return jointCount; }
+	unsigned int getGroupCount() const { return (jointCount + 3) / 4; }
+	float* getData() { return data.data(); }
+	const float* getData() const { return data.data(); }
+
+	void set(unsigned int joint, const JointTransform& transform);
+	JointTransform get(unsigned int joint) const;
+
+	// out = nlerp(a, b, weight) per joint, out may be a or b
+	static void blend(const Pose& a, const Pose& b, float weight, Pose& out, bool useSIMD = true);
+
+private:
+	unsigned int jointCount;
+	std::vector<float> data;
+};
+
+// Joint hierarchy plus the inverse bind matrices. Parents come before their
+// children, so one pass in joint order sees every parent finished.
+class Skeleton {
+public:
+	// returns the joint index, parent -1 for a root
+	unsigned int addJoint(int parent, const glm::mat4& inverseBind);
+	unsigned int getJointCount() const { return (unsigned int)parents.size(); }
+	int getParent(unsigned int joint) const { return parents[joint]; }
+
+	// skinning matrices: world * model(joint) * inverseBind(joint), written as the
+	// rows of the 3x4 affine part, 12 floats per joint
+	void computePalette(const Pose& pose, const glm::mat4& world, float* palette, bool useSIMD = true) const;
+
+private:
+	std::vector<int> parents;
+	std::vector<float> inverseBinds; // 3x4 rows, 12 floats per joint
+};
+
+// Keyframes sampled at a fixed rate, every channel of every joint quantized to
+// 16 bits against its own range over the clip: 8 channels * 2 bytes per joint
+// and key instead of 32 bytes of floats. Keys stay in the Pose group layout so
+// decoding 4 joints is one load and one multiply-add per channel.
+class AnimationClip {
+public:
+	AnimationClip() : jointCount(0), keyCount(0), sampleRate(30.0f), looping(true) {}
+
+	// keys[key * jointCount + joint], rotations are made to take the short way between keys
+	void build(const JointTransform* keys, unsigned int jointCount, unsigned int keyCount,
+		float sampleRate, bool looping = true);
+
+	// pose at time seconds, wraps around when looping and holds the last key otherwise
+	void sample(float time, Pose& pose, bool useSIMD = true) const;
+
+	// a looping clip blends its last key back into the first, a one shot clip ends on its last key
+	float getDuration() const {
+		if (looping) {
+			return keyCount / sampleRate;
+		}
+		return keyCount > 1 ? (keyCount - 1) / sampleRate : 0.0f;
+	}
+	unsigned int getJointCount() const { return jointCount; }
+	unsigned int getKeyCount() const { return keyCount; }
+	// size of the quantized keys and ranges, and what the same keys take as floats
+	size_t getCompressedBytes() const;
+	size_t getRawBytes() const { return (size_t)keyCount * jointCount * Pose::CHANNELS * sizeof(float); }
+
+private:
+	unsigned int jointCount;
+	unsigned int keyCount;
+	float sampleRate;
+	bool looping;
+	unsigned int groupFloats; // floats of one key in the Pose layout
+	// value = offset + q * scale, in the Pose layout
+	std::vector<float> offsets;
+	std::vector<float> scales;
+	std::vector<uint16_t> keys;
+};
\ No newline at end of file
@@ -0,0 +1,306 @@
+#include "SkinnedCrowd.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+#include "../geometry-heap/GeometryHeap.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SKINNING_SSE
+#endif
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void skinVertices(const SkinVertex* vertices, unsigned int count, const float* palette, float* out, bool useSIMD) {
+	const float toWeight = 1.0f / 255.0f;
+#ifdef SKINNING_SSE
+	if (useSIMD) {
+		for (unsigned int v = 0; v < count; ++v) {
+			const SkinVertex& vertex = vertices[v];
+			// weighted sum of the joint matrices, one register per row
+			__m128 r0 = _mm_setzero_ps(), r1 = _mm_setzero_ps(), r2 = _mm_setzero_ps();
+			for (int k = 0; k < 4; ++k) {
+				if (vertex.weights[k] == 0) {
+					continue;
+				}
+				__m128 weight = _mm_set1_ps(vertex.weights[k] * toWeight);
+				const float* matrix = palette + vertex.joints[k] * 12;
+				r0 = _mm_add_ps(r0, _mm_mul_ps(weight, _mm_loadu_ps(matrix)));
+				r1 = _mm_add_ps(r1, _mm_mul_ps(weight, _mm_loadu_ps(matrix + 4)));
+				r2 = _mm_add_ps(r2, _mm_mul_ps(weight, _mm_loadu_ps(matrix + 8)));
+			}
+			// three dot products with (x, y, z, 1), summed across after a transpose
+			__m128 position = _mm_set_ps(1.0f, vertex.position[2], vertex.position[1], vertex.position[0]);
+			r0 = _mm_mul_ps(r0, position);
+			r1 = _mm_mul_ps(r1, position);
+			r2 = _mm_mul_ps(r2, position);
+			__m128 r3 = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			float* target = out + (size_t)v * GeometryHeap::VERTEX_FLOATS;
+			// the 4th float is overwritten by the texture coords
+			_mm_storeu_ps(target, _mm_add_ps(_mm_add_ps(r0, r1), _mm_add_ps(r2, r3)));
+			target[3] = vertex.texCoord[0];
+			target[4] = vertex.texCoord[1];
+		}
+		return;
+	}
+#endif
+	for (unsigned int v = 0; v < count; ++v) {
+		const SkinVertex& vertex = vertices[v];
+		float matrix[12] = { 0.0f };
+		for (int k = 0; k < 4; ++k) {
+			if (vertex.weights[k] == 0) {
+				continue;
+			}
+			float weight = vertex.weights[k] * toWeight;
+			const float* joint = palette + vertex.joints[k] * 12;
+			for (int i = 0; i < 12; ++i) {
+				matrix[i] += weight * joint[i];
+			}
+		}
+		float* target = out + (size_t)v * GeometryHeap::VERTEX_FLOATS;
+		for (int row = 0; row < 3; ++row) {
+			target[row] = matrix[row * 4] * vertex.position[0] + matrix[row * 4 + 1] * vertex.position[1]
+				+ matrix[row * 4 + 2] * vertex.position[2] + matrix[row * 4 + 3];
+		}
+		target[3] = vertex.texCoord[0];
+		target[4] = vertex.texCoord[1];
+	}
+}
+
+SkinnedCrowd::SkinnedCrowd(ThreadPool& pool, const Skeleton& skeleton, const SkinnedMesh& mesh,
+	unsigned int maxCharacters, const char* vertexPath, const char* fragmentPath)
+	: pool(pool), skeleton(skeleton), mesh(mesh), uploadToGPU(vertexPath != NULL && fragmentPath != NULL),
+	useSIMD(true), threadCount(pool.getConcurrency()), characterCount(0),
+	vertexCount((unsigned int)mesh.vertices.size()), indexCount((unsigned int)mesh.indices.size()),
+	VAO(0), VBO(0), EBO(0), skinnedVAO(0), skinnedVBO(0), paletteBuffer(0), paletteTexture(0),
+	sampleTime(0.0), paletteTime(0.0), skinTime(0.0), uploadTime(0.0) {
+	clips[0] = clips[1] = NULL;
+	std::fill_n(shaders, (int)MODE_COUNT, (Shader*)NULL);
+	characters.resize(maxCharacters);
+	poses.resize(maxCharacters);
+	for (Character& character : characters) {
+		character.world = glm::mat4(1.0f);
+		character.timeOffset = 0.0f;
+		character.weight = 0.0f;
+	}
+
+	// palettes start at multiples of the uniform buffer offset alignment
+	int alignment = 16;
+	if (uploadToGPU) {
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		alignment = std::max(alignment, 16);
+	}
+	unsigned int alignFloats = alignment / sizeof(float);
+	paletteStride = (skeleton.getJointCount() * 12 + alignFloats - 1) / alignFloats * alignFloats;
+	palettes.assign((size_t)maxCharacters * paletteStride, 0.0f);
+	skinned.resize((size_t)maxCharacters * vertexCount * GeometryHeap::VERTEX_FLOATS);
+
+	if (!uploadToGPU) {
+		return;
+	}
+	if (skeleton.getJointCount() > MAX_JOINTS) {
+		std::cout << "ERROR::SKINNEDCROWD::TOO_MANY_JOINTS " << skeleton.getJointCount()
+			<< ", the uniform buffer mode holds " << MAX_JOINTS << std::endl;
+	}
+
+	shaders[MODE_GPU_TEXTURE_BUFFER] = new Shader(vertexPath, fragmentPath, NULL, "#define PALETTE_TEXTURE_BUFFER\n");
+	// the block is exactly one palette long, so every range bound to it covers it
+	std::string uniformDefines = "#define PALETTE_UNIFORM_BUFFER\n#define JOINT_COUNT "
+		+ std::to_string(skeleton.getJointCount()) + "\n";
+	shaders[MODE_GPU_UNIFORM_BUFFER] = new Shader(vertexPath, fragmentPath, NULL, uniformDefines.c_str());
+	shaders[MODE_GPU_UNIFORM_BUFFER]->bindUniformBlock("Palette", PALETTE_BINDING);
+	shaders[MODE_CPU] = new Shader(vertexPath, fragmentPath, NULL, "#define PRESKINNED\n");
+
+	// skinned on the GPU: the mesh once, joints as integers and weights normalized
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(SkinVertex), mesh.vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), mesh.indices.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(SkinVertex), (void*)offsetof(SkinVertex, position));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(SkinVertex), (void*)offsetof(SkinVertex, texCoord));
+	glEnableVertexAttribArray(1);
+	glVertexAttribIPointer(2, 4, GL_UNSIGNED_BYTE, sizeof(SkinVertex), (void*)offsetof(SkinVertex, joints));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SkinVertex), (void*)offsetof(SkinVertex, weights));
+	glEnableVertexAttribArray(3);
+
+	// skinned on the CPU: every character back to back, same indices with a base vertex
+	glGenVertexArrays(1, &skinnedVAO);
+	glGenBuffers(1, &skinnedVBO);
+	glBindVertexArray(skinnedVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, skinnedVBO);
+	glBufferData(GL_ARRAY_BUFFER, skinned.size() * sizeof(float), NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, GeometryHeap::VERTEX_FLOATS * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, GeometryHeap::VERTEX_FLOATS * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glBindVertexArray(0);
+
+	// one buffer of palettes, seen as RGBA32F texels and as uniform block ranges
+	glGenBuffers(1, &paletteBuffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, paletteBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, palettes.size() * sizeof(float), NULL, GL_STREAM_DRAW);
+	glGenTextures(1, &paletteTexture);
+	glBindTexture(GL_TEXTURE_BUFFER, paletteTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, paletteBuffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+SkinnedCrowd::~SkinnedCrowd() {
+	if (!uploadToGPU) {
+		return;
+	}
+	for (Shader* shader : shaders) {
+		glDeleteProgram(shader->ID);
+		delete shader;
+	}
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteVertexArrays(1, &skinnedVAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	glDeleteBuffers(1, &skinnedVBO);
+	glDeleteTextures(1, &paletteTexture);
+	glDeleteBuffers(1, &paletteBuffer);
+}
+
+const char* SkinnedCrowd::modeName(Mode mode) {
+	switch (mode) {
+	case MODE_GPU_TEXTURE_BUFFER: return "GPU, texture buffer";
+	case MODE_GPU_UNIFORM_BUFFER: return "GPU, uniform buffer";
+	case MODE_CPU: return "CPU";
+	default: return "unknown";
+	}
+}
+
+void SkinnedCrowd::setCharacter(unsigned int index, const glm::mat4& world, float timeOffset, float weight) {
+	characters[index].world = world;
+	characters[index].timeOffset = timeOffset;
+	characters[index].weight = weight;
+}
+
+void SkinnedCrowd::setCharacterCount(unsigned int count) {
+	characterCount = std::min(count, (unsigned int)characters.size());
+}
+
+const float* SkinnedCrowd::getSkinnedVertices(unsigned int character) const {
+	return &skinned[(size_t)character * vertexCount * GeometryHeap::VERTEX_FLOATS];
+}
+
+void SkinnedCrowd::forEachCharacter(const std::function<void(unsigned int, unsigned int)>& fn) {
+	// one chunk per thread, characters cost the same
+	unsigned int grain = std::max(1u, (characterCount + threadCount - 1) / std::max(1u, threadCount));
+	pool.parallelFor(characterCount, grain, fn);
+}
+
+void SkinnedCrowd::animate(float time) {
+	if (!clips[0] || !clips[1]) {
+		return;
+	}
+	// sampling and blending, then the palettes; timed apart, so two passes over the characters
+	auto start = std::chrono::high_resolution_clock::now();
+	forEachCharacter([&](unsigned int begin, unsigned int end) {
+		Pose second;
+		for (unsigned int i = begin; i < end; ++i) {
+			float localTime = time + characters[i].timeOffset;
+			clips[0]->sample(localTime, poses[i], useSIMD);
+			clips[1]->sample(localTime, second, useSIMD);
+			Pose::blend(poses[i], second, characters[i].weight, poses[i], useSIMD);
+		}
+	});
+	sampleTime = elapsedMs(start);
+
+	start = std::chrono::high_resolution_clock::now();
+	forEachCharacter([&](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; ++i) {
+			skeleton.computePalette(poses[i], characters[i].world, &palettes[(size_t)i * paletteStride], useSIMD);
+		}
+	});
+	paletteTime = elapsedMs(start);
+}
+
+void SkinnedCrowd::skin() {
+	auto start = std::chrono::high_resolution_clock::now();
+	forEachCharacter([&](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; ++i) {
+			skinVertices(mesh.vertices.data(), vertexCount, getPalette(i),
+				&skinned[(size_t)i * vertexCount * GeometryHeap::VERTEX_FLOATS], useSIMD);
+		}
+	});
+	skinTime = elapsedMs(start);
+}
+
+void SkinnedCrowd::upload(Mode mode) {
+	if (mode == MODE_CPU) {
+		skin();
+	}
+	else {
+		skinTime = 0.0;
+	}
+	if (!uploadToGPU) {
+		return;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	if (mode == MODE_CPU) {
+		size_t bytes = (size_t)characterCount * vertexCount * GeometryHeap::VERTEX_FLOATS * sizeof(float);
+		glBindBuffer(GL_ARRAY_BUFFER, skinnedVBO);
+		// orphan, last frame's vertices may still be in use
+		glBufferData(GL_ARRAY_BUFFER, skinned.size() * sizeof(float), NULL, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, skinned.data());
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	else {
+		glBindBuffer(GL_TEXTURE_BUFFER, paletteBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, palettes.size() * sizeof(float), NULL, GL_STREAM_DRAW);
+		glBufferSubData(GL_TEXTURE_BUFFER, 0, (size_t)characterCount * paletteStride * sizeof(float), palettes.data());
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	}
+	uploadTime = elapsedMs(start);
+}
+
+void SkinnedCrowd::draw(Mode mode, const glm::mat4& viewProjection) {
+	if (!uploadToGPU || characterCount == 0) {
+		return;
+	}
+	Shader& shader = *shaders[mode];
+	shader.use();
+	shader.setMat4("viewProjection", viewProjection);
+
+	if (mode == MODE_CPU) {
+		glBindVertexArray(skinnedVAO);
+		for (unsigned int i = 0; i < characterCount; ++i) {
+			glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, i * vertexCount);
+		}
+	}
+	else if (mode == MODE_GPU_TEXTURE_BUFFER) {
+		glActiveTexture(GL_TEXTURE0 + PALETTE_UNIT);
+		glBindTexture(GL_TEXTURE_BUFFER, paletteTexture);
+		shader.setInt("palettes", PALETTE_UNIT);
+		shader.setInt("paletteStride", paletteStride / 4);
+		glBindVertexArray(VAO);
+		glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, characterCount);
+		glActiveTexture(GL_TEXTURE0);
+	}
+	else {
+		glBindVertexArray(VAO);
+		GLsizeiptr paletteBytes = skeleton.getJointCount() * 12 * sizeof(float);
+		for (unsigned int i = 0; i < characterCount; ++i) {
+			glBindBufferRange(GL_UNIFORM_BUFFER, PALETTE_BINDING, paletteBuffer,
+				(GLintptr)i * paletteStride * sizeof(float), paletteBytes);
+			glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+		}
+	}
+	glBindVertexArray(0);
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "../shader-lesson-1.4/Shader.h"
+#include "../thread-pool/ThreadPool.h"
+#include "Animation.h"
+
+// position, texture coords and up to 4 joint influences, weights sum to 255
+struct SkinVertex {
+	float position[3];
+	float texCoord[2];
+	unsigned char joints[4];
+	unsigned char weights[4];
+};
+
+struct SkinnedMesh {
+	std::vector<SkinVertex> vertices;
+	std::vector<unsigned int> indices;
+};
+
+// skin count vertices with one palette (12 floats per joint) into the
+// GeometryHeap vertex format, 5 floats per vertex
+void skinVertices(const SkinVertex* vertices, unsigned int count, const float* palette, float* out,
+	bool useSIMD = true);
+
+// Many characters sharing one skeleton and mesh, each playing a blend of two
+// clips at its own time offset. Every frame the poses are sampled, blended and
+// turned into skinning palettes on the thread pool, with the world transform of
+// the character folded into the palette. Drawing then skins either
+//   on the GPU from a texture buffer holding every palette, one instanced draw,
+//   on the GPU from a uniform block bound to one palette per draw, or
+//   on the CPU (SIMD, threaded) into a streamed vertex buffer.
+// All palettes live in one buffer at a stride that is also a valid uniform
+// buffer offset, so both GPU paths read the same upload.
+class SkinnedCrowd {
+public:
+	enum Mode { MODE_GPU_TEXTURE_BUFFER, MODE_GPU_UNIFORM_BUFFER, MODE_CPU, MODE_COUNT };
+
+	// joints of the uniform buffer mode, 256 * 48 bytes fits the 16 KB block every driver has
+	static const unsigned int MAX_JOINTS = 256;
+	static const unsigned int PALETTE_UNIT = 4;
+	static const unsigned int PALETTE_BINDING = 2;
+
+	// without shader paths nothing touches GL (benchmarks)
+	SkinnedCrowd(ThreadPool& pool, const Skeleton& skeleton, const SkinnedMesh& mesh, unsigned int maxCharacters,
+		const char* vertexPath = NULL, const char* fragmentPath = NULL);
+	~SkinnedCrowd();
+
+	static const char* modeName(Mode mode);
+
+	// every character blends first and second
+	void setClips(const AnimationClip* first, const AnimationClip* second) { clips[0] = first; clips[1] = second; }
+	// weight 0 plays only the first clip, 1 only the second
+	void setCharacter(unsigned int index, const glm::mat4& world, float timeOffset, float weight);
+	void setCharacterCount(unsigned int count);
+	unsigned int getCharacterCount() const { return characterCount; }
+
+	// sample, blend and build the palette of every character
+	void animate(float time);
+	// CPU skinning of every character, upload() does this for MODE_CPU
+	void skin();
+	// palettes for the GPU modes, skinned vertices for MODE_CPU
+	void upload(Mode mode);
+	void draw(Mode mode, const glm::mat4& viewProjection);
+
+	void setUseSIMD(bool enabled) { useSIMD = enabled; }
+	void setThreadCount(unsigned int threads) { threadCount = threads; }
+
+	const float* getPalette(unsigned int character) const { return &palettes[(size_t)character * paletteStride]; }
+	const float* getSkinnedVertices(unsigned int character) const;
+	unsigned int getJointCount() const { return skeleton.getJointCount(); }
+	unsigned int getVertexCount() const { return vertexCount; }
+	// timings of the last frame in milliseconds
+	double getSampleTime() const { return sampleTime; }
+	double getPaletteTime() const { return paletteTime; }
+	double getSkinTime() const { return skinTime; }
+	double getUploadTime() const { return uploadTime; }
+
+private:
+	struct Character {
+		glm::mat4 world;
+		float timeOffset;
+		float weight;
+	};
+
+	ThreadPool& pool;
+	const Skeleton& skeleton;
+	const SkinnedMesh& mesh;
+	bool uploadToGPU;
+	bool useSIMD;
+	unsigned int threadCount;
+	const AnimationClip* clips[2];
+
+	std::vector<Character> characters;
+	unsigned int characterCount;
+	std::vector<Pose> poses;
+	unsigned int vertexCount, indexCount;
+	unsigned int paletteStride; // floats from one palette to the next
+	std::vector<float> palettes;
+	std::vector<float> skinned;
+
+	Shader* shaders[MODE_COUNT];
+	unsigned int VAO, VBO, EBO;
+	unsigned int skinnedVAO, skinnedVBO;
+	unsigned int paletteBuffer, paletteTexture;
+
+	double sampleTime, paletteTime, skinTime, uploadTime;
+
+	// run fn over [0, characterCount) on threadCount threads at most
+	void forEachCharacter(const std::function<void(unsigned int, unsigned int)>& fn);
+};
\ No newline at end of file
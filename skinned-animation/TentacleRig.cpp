@@ -0,0 +1,91 @@
+#include "TentacleRig.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+const float HEIGHT = 2.0f;
+// fixed mesh resolution, so skinning costs the same at every joint count
+const unsigned int RINGS = 128;
+const unsigned int SIDES = 16;
+const unsigned int KEYS = 60;
+const float SAMPLE_RATE = 30.0f;
+
+void buildTentacle(unsigned int jointCount, Skeleton& skeleton, SkinnedMesh& mesh,
+	AnimationClip& sway, AnimationClip& curl) {
+	jointCount = std::max(1u, std::min(jointCount, 256u));
+	float segment = HEIGHT / jointCount;
+
+	// joint j sits at j * segment, bind space is the tube as modelled
+	skeleton = Skeleton();
+	for (unsigned int joint = 0; joint < jointCount; ++joint) {
+		glm::mat4 inverseBind = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -(float)joint * segment, 0.0f));
+		skeleton.addJoint((int)joint - 1, inverseBind);
+	}
+
+	mesh.vertices.clear();
+	mesh.indices.clear();
+	for (unsigned int ring = 0; ring <= RINGS; ++ring) {
+		float v = (float)ring / RINGS;
+		float height = v * HEIGHT;
+		float radius = 0.2f - 0.15f * v;
+		// between the joint below and the one above
+		float along = std::min(std::max(height / segment, 0.0f), (float)(jointCount - 1));
+		unsigned int lower = std::min((unsigned int)along, jointCount - 1);
+		unsigned int upper = std::min(lower + 1, jointCount - 1);
+		unsigned char upperWeight = (unsigned char)std::floor((along - lower) * 255.0f + 0.5f);
+		for (unsigned int side = 0; side <= SIDES; ++side) {
+			float u = (float)side / SIDES;
+			float angle = 6.2831853f * u;
+			SkinVertex vertex;
+			vertex.position[0] = std::cos(angle) * radius;
+			vertex.position[1] = height;
+			vertex.position[2] = std::sin(angle) * radius;
+			vertex.texCoord[0] = u;
+			vertex.texCoord[1] = v;
+			vertex.joints[0] = (unsigned char)lower;
+			vertex.joints[1] = (unsigned char)upper;
+			vertex.joints[2] = vertex.joints[3] = 0;
+			vertex.weights[0] = 255 - upperWeight;
+			vertex.weights[1] = upperWeight;
+			vertex.weights[2] = vertex.weights[3] = 0;
+			mesh.vertices.push_back(vertex);
+		}
+	}
+	for (unsigned int ring = 0; ring < RINGS; ++ring) {
+		for (unsigned int side = 0; side < SIDES; ++side) {
+			unsigned int a = ring * (SIDES + 1) + side, b = a + SIDES + 1;
+			unsigned int quad[6] = { a, a + 1, b, a + 1, b + 1, b };
+			mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+		}
+	}
+
+	// the bend per joint shrinks as the chain gets longer, so every rig moves alike
+	float bend = 8.0f / jointCount;
+	std::vector<JointTransform> keys((size_t)KEYS * jointCount);
+	for (unsigned int key = 0; key < KEYS; ++key) {
+		float phase = 6.2831853f * key / KEYS;
+		for (unsigned int joint = 0; joint < jointCount; ++joint) {
+			JointTransform& transform = keys[(size_t)key * jointCount + joint];
+			transform.translation = glm::vec3(0.0f, joint == 0 ? 0.0f : segment, 0.0f);
+			transform.rotation = glm::angleAxis(0.12f * bend * std::sin(phase - joint * 6.0f / jointCount),
+				glm::vec3(0.0f, 0.0f, 1.0f));
+			transform.scale = joint == 0 ? 1.0f + 0.05f * std::sin(phase * 2.0f) : 1.0f;
+		}
+	}
+	sway.build(keys.data(), jointCount, KEYS, SAMPLE_RATE);
+
+	for (unsigned int key = 0; key < KEYS; ++key) {
+		float phase = 6.2831853f * key / KEYS;
+		for (unsigned int joint = 0; joint < jointCount; ++joint) {
+			JointTransform& transform = keys[(size_t)key * jointCount + joint];
+			float amount = 0.5f - 0.5f * std::cos(phase);
+			transform.translation = glm::vec3(0.0f, joint == 0 ? 0.0f : segment, 0.0f);
+			transform.rotation = glm::angleAxis(0.7f * bend * amount * (float)joint / jointCount, glm::vec3(1.0f, 0.0f, 0.0f))
+				* glm::angleAxis(0.05f * bend, glm::vec3(0.0f, 1.0f, 0.0f));
+			transform.scale = 1.0f;
+		}
+	}
+	curl.build(keys.data(), jointCount, KEYS, SAMPLE_RATE);
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Animation.h"
+#include "SkinnedCrowd.h"
+
+// Procedural test character: a tapered tube standing on the origin, 2 units
+// tall, with a chain of jointCount joints up its middle. Every ring of the tube
+// is weighted to the two joints around it. Two looping clips at 30 keys per
+// second come with it: a sway that travels up the chain and a slow curl.
+void buildTentacle(unsigned int jointCount, Skeleton& skeleton, SkinnedMesh& mesh,
+	AnimationClip& sway, AnimationClip& curl);
\ No newline at end of file
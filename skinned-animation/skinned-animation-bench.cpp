@@ -0,0 +1,81 @@
+// skeletal animation benchmark, runs without a GL context
+// 1024 characters blending two clips on rigs of 16 to 128 joints: characters per ms for
+// sampling + blending, palettes and CPU skinning, scalar/SIMD and 1/N threads
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../geometry-heap/GeometryHeap.h"
+#include "SkinnedCrowd.h"
+#include "TentacleRig.h"
+
+int main() {
+	const unsigned int jointCounts[] = { 16, 32, 64, 128 };
+	const unsigned int CHARACTERS = 1024;
+	const int ITERATIONS = 50;
+
+	ThreadPool& pool = ThreadPool::global();
+
+	struct Config { const char* name; bool simd; unsigned int threads; };
+	const Config configs[] = {
+		{ "scalar 1 thread", false, 1 },
+		{ "simd 1 thread", true, 1 },
+		{ "simd all threads", true, pool.getConcurrency() }
+	};
+
+	std::cout << "threads available: " << pool.getConcurrency() << std::endl;
+	for (unsigned int jointCount : jointCounts) {
+		Skeleton skeleton;
+		SkinnedMesh mesh;
+		AnimationClip sway, curl;
+		buildTentacle(jointCount, skeleton, mesh, sway, curl);
+		std::cout << jointCount << " joints | " << mesh.vertices.size() << " vertices"
+			<< " | clip " << sway.getCompressedBytes() / 1024.0 << " KB, "
+			<< sway.getRawBytes() / 1024.0 << " KB as floats" << std::endl;
+
+		SkinnedCrowd crowd(pool, skeleton, mesh, CHARACTERS);
+		crowd.setClips(&sway, &curl);
+		crowd.setCharacterCount(CHARACTERS);
+		for (unsigned int i = 0; i < CHARACTERS; ++i) {
+			glm::mat4 world = glm::translate(glm::mat4(1.0f), glm::vec3((float)(i % 32), 0.0f, (float)(i / 32)));
+			crowd.setCharacter(i, world, i * 0.37f, (i % 7) / 6.0f);
+		}
+
+		// the scalar result is kept to check the SIMD paths against it
+		std::vector<float> reference;
+		for (const Config& config : configs) {
+			crowd.setUseSIMD(config.simd);
+			crowd.setThreadCount(config.threads);
+
+			double sample = 0.0, palette = 0.0, skin = 0.0;
+			for (int i = 0; i < ITERATIONS; ++i) {
+				crowd.animate(i / 60.0f);
+				crowd.skin();
+				sample += crowd.getSampleTime();
+				palette += crowd.getPaletteTime();
+				skin += crowd.getSkinTime();
+			}
+
+			const float* skinned = crowd.getSkinnedVertices(0);
+			size_t floats = (size_t)CHARACTERS * crowd.getVertexCount() * GeometryHeap::VERTEX_FLOATS;
+			float difference = 0.0f;
+			if (reference.empty()) {
+				reference.assign(skinned, skinned + floats);
+			}
+			else {
+				for (size_t i = 0; i < floats; ++i) {
+					difference = std::max(difference, std::fabs(skinned[i] - reference[i]));
+				}
+			}
+
+			std::cout << "  " << config.name
+				<< ": sample+blend " << CHARACTERS * ITERATIONS / sample << " characters/ms"
+				<< " | palette " << CHARACTERS * ITERATIONS / palette << " characters/ms"
+				<< " | skin " << CHARACTERS * ITERATIONS / skin << " characters/ms"
+				<< " | max difference to scalar " << difference << std::endl;
+		}
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,207 @@
+// skinned animation demo: a field of tentacles, each blending a sway and a curl clip at its own
+// phase, skinned on the GPU from a texture buffer, on the GPU from a uniform block per draw or
+// on the CPU. sweeps every character count and mode first and prints the frame times, then
+// C cycles the character count and M the mode.
+// usage: skinned-animation [joints]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "SkinnedCrowd.h"
+#include "TentacleRig.h"
+
+const unsigned int WIDTH = 800;
+const unsigned int HEIGHT = 600;
+
+const unsigned int CHARACTER_COUNTS[] = { 64, 256, 1024 };
+const unsigned int CHARACTER_COUNT_OPTIONS = sizeof(CHARACTER_COUNTS) / sizeof(CHARACTER_COUNTS[0]);
+const unsigned int MAX_CHARACTERS = 1024;
+const unsigned int SWEEP_FRAMES = 120;
+
+unsigned int countOption = 0;
+SkinnedCrowd::Mode mode = SkinnedCrowd::MODE_GPU_TEXTURE_BUFFER;
+bool settingsChanged = true;
+int windowWidth = WIDTH;
+int windowHeight = HEIGHT;
+
+void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+int main(int argc, char** argv) {
+	unsigned int jointCount = argc > 1 ? (unsigned int)std::atoi(argv[1]) : 32;
+
+	// initialize GLFW
+	glfwInit();
+	// set version and core profile
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// create a window
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	// set callback to handle when window is resized
+	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+	glfwSetKeyCallback(window, keyCallback);
+
+	// initialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// no vsync, we want to see the frame time
+	glfwSwapInterval(0);
+
+	Skeleton skeleton;
+	SkinnedMesh mesh;
+	AnimationClip sway, curl;
+	buildTentacle(jointCount, skeleton, mesh, sway, curl);
+	std::cout << "SKINNING::" << skeleton.getJointCount() << " joints | " << mesh.vertices.size() << " vertices"
+		<< " | clips " << (sway.getCompressedBytes() + curl.getCompressedBytes()) / 1024.0 << " KB ("
+		<< (sway.getRawBytes() + curl.getRawBytes()) / 1024.0 << " KB as floats)" << std::endl;
+
+	SkinnedCrowd* crowd = new SkinnedCrowd(ThreadPool::global(), skeleton, mesh, MAX_CHARACTERS,
+		"skinned.vert", "skinned.frag");
+	crowd->setClips(&sway, &curl);
+
+	glEnable(GL_DEPTH_TEST);
+
+	unsigned int query;
+	glGenQueries(1, &query);
+
+	bool sweeping = true;
+	unsigned int sweepFrame = 0;
+	double lastReport = glfwGetTime();
+	double animateSum = 0.0, skinSum = 0.0, uploadSum = 0.0, drawSum = 0.0, gpuSum = 0.0;
+	unsigned int frames = 0;
+	float side = 1.0f;
+
+	// render loop
+	while (!glfwWindowShouldClose(window)) {
+		float time = (float)glfwGetTime();
+		if (settingsChanged) {
+			// square grid, the phase and the blend weight change across it
+			unsigned int count = CHARACTER_COUNTS[countOption];
+			unsigned int columns = (unsigned int)std::ceil(std::sqrt((float)count));
+			side = (float)columns;
+			crowd->setCharacterCount(count);
+			for (unsigned int i = 0; i < count; ++i) {
+				float x = (i % columns) - columns * 0.5f, z = (i / columns) - columns * 0.5f;
+				glm::mat4 world = glm::translate(glm::mat4(1.0f), glm::vec3(x, 0.0f, z));
+				world = glm::rotate(world, i * 0.7f, glm::vec3(0.0f, 1.0f, 0.0f));
+				crowd->setCharacter(i, world, (x + z) * 0.15f, (float)(i % columns) / columns);
+			}
+			animateSum = skinSum = uploadSum = drawSum = gpuSum = 0.0;
+			frames = 0;
+			lastReport = glfwGetTime();
+			settingsChanged = false;
+		}
+
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		float angle = time * 0.2f;
+		float distance = side * 0.8f + 4.0f;
+		glm::mat4 view = glm::lookAt(glm::vec3(sin(angle) * distance, distance * 0.5f, cos(angle) * distance),
+			glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)windowWidth / std::max(windowHeight, 1),
+			0.1f, 200.0f);
+
+		// poses and palettes, then whatever the mode uploads, then the draws
+		crowd->animate(time);
+		auto start = std::chrono::high_resolution_clock::now();
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		crowd->upload(mode);
+		crowd->draw(mode, projection * view);
+		glEndQuery(GL_TIME_ELAPSED);
+		double submit = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		animateSum += crowd->getSampleTime() + crowd->getPaletteTime();
+		skinSum += crowd->getSkinTime();
+		uploadSum += crowd->getUploadTime();
+		drawSum += submit - crowd->getSkinTime() - crowd->getUploadTime();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		GLuint64 gpuTime = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &gpuTime);
+		gpuSum += gpuTime / 1000000.0;
+		++frames;
+
+		// the sweep steps through every character count and mode, then hands over to the keys
+		bool report = sweeping ? ++sweepFrame % SWEEP_FRAMES == 0 : glfwGetTime() - lastReport > 1.0;
+		if (report) {
+			std::cout << "SKINNING::characters " << CHARACTER_COUNTS[countOption] << " | " << SkinnedCrowd::modeName(mode)
+				<< " | animate " << animateSum / frames << " ms"
+				<< " | skin " << skinSum / frames << " ms"
+				<< " | upload " << uploadSum / frames << " ms"
+				<< " | draw " << drawSum / frames << " ms"
+				<< " | GPU " << gpuSum / frames << " ms" << std::endl;
+			animateSum = skinSum = uploadSum = drawSum = gpuSum = 0.0;
+			frames = 0;
+			lastReport = glfwGetTime();
+		}
+		if (sweeping && report) {
+			mode = (SkinnedCrowd::Mode)(mode + 1);
+			if (mode == SkinnedCrowd::MODE_COUNT) {
+				mode = SkinnedCrowd::MODE_GPU_TEXTURE_BUFFER;
+				++countOption;
+			}
+			if (countOption == CHARACTER_COUNT_OPTIONS) {
+				countOption = 1;
+				sweeping = false;
+			}
+			settingsChanged = true;
+		}
+	}
+
+	// deallocate objects
+	glDeleteQueries(1, &query);
+	delete crowd;
+
+	glfwTerminate();
+	return 0;
+}
+
+// whenever the window is resized this function gets called
+void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+	windowWidth = width;
+	windowHeight = height;
+}
+
+// react to key presses
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	if (action != GLFW_PRESS) {
+		return;
+	}
+	if (key == GLFW_KEY_ESCAPE) {
+		glfwSetWindowShouldClose(window, true);
+	}
+	if (key == GLFW_KEY_C) {
+		countOption = (countOption + 1) % CHARACTER_COUNT_OPTIONS;
+		settingsChanged = true;
+	}
+	if (key == GLFW_KEY_M) {
+		mode = (SkinnedCrowd::Mode)((mode + 1) % SkinnedCrowd::MODE_COUNT);
+		settingsChanged = true;
+	}
+}
\ No newline at end of file
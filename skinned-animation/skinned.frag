@@ -0,0 +1,12 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+void main()
+{
+	// bands along the length show how the skin stretches
+	float band = step(0.5f, fract(TexCoord.y * 16.0f));
+	vec3 base = mix(vec3(0.55f, 0.2f, 0.35f), vec3(0.95f, 0.6f, 0.5f), TexCoord.y);
+	FragColor = vec4(base * (0.75f + 0.25f * band), 1.0f);
+}
\ No newline at end of file
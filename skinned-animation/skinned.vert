@@ -0,0 +1,55 @@
+#version 330 core
+// one of these is defined by SkinnedCrowd:
+// PALETTE_TEXTURE_BUFFER  every palette in one buffer texture, palette = instance
+// PALETTE_UNIFORM_BUFFER  one palette per draw in the Palette block, JOINT_COUNT joints
+// PRESKINNED              skinned on the CPU, positions are already in world space
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+#if !defined(PRESKINNED)
+layout (location = 2) in uvec4 aJoints;
+layout (location = 3) in vec4 aWeights;
+#endif
+
+out vec2 TexCoord;
+
+uniform mat4 viewProjection;
+
+// every joint is 3 rows of its 3x4 skinning matrix, world transform included
+#if defined(PALETTE_TEXTURE_BUFFER)
+uniform samplerBuffer palettes;
+uniform int paletteStride; // texels from one character to the next
+
+vec4 paletteRow(uint joint, int row)
+{
+	return texelFetch(palettes, gl_InstanceID * paletteStride + int(joint) * 3 + row);
+}
+#elif defined(PALETTE_UNIFORM_BUFFER)
+layout (std140) uniform Palette
+{
+	vec4 rows[JOINT_COUNT * 3];
+};
+
+vec4 paletteRow(uint joint, int row)
+{
+	return rows[int(joint) * 3 + row];
+}
+#endif
+
+void main()
+{
+#if defined(PRESKINNED)
+	vec3 position = aPos;
+#else
+	// blend the matrices, then transform once
+	vec4 row0 = vec4(0.0f), row1 = vec4(0.0f), row2 = vec4(0.0f);
+	for (int i = 0; i < 4; ++i) {
+		row0 += aWeights[i] * paletteRow(aJoints[i], 0);
+		row1 += aWeights[i] * paletteRow(aJoints[i], 1);
+		row2 += aWeights[i] * paletteRow(aJoints[i], 2);
+	}
+	vec4 local = vec4(aPos, 1.0f);
+	vec3 position = vec3(dot(row0, local), dot(row1, local), dot(row2, local));
+#endif
+	gl_Position = viewProjection * vec4(position, 1.0f);
+	TexCoord = aTexCoord;
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "SpriteBatch.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+SpriteBatch::SpriteBatch(const char* vertexPath, const char* fragmentPath, unsigned int bufferSprites)
+	: bufferSprites(std::max(bufferSprites, MAX_SPRITES)), bufferCursor(0), queued(0), currentTexture(0),
+	currentTarget(GL_TEXTURE_2D), projection(1.0f), frameSprites(0), frameFlushes(0),
+	totalSprites(0), totalFlushes(0), textureFlushes(0), fullFlushes(0), frames(0) {
+	shader = new Shader(vertexPath, fragmentPath);
+	arrayShader = new Shader(vertexPath, fragmentPath, NULL, "#define TEXTURE_ARRAY\n");
+	shader->use();
+	shader->setInt("sprite", 0);
+	arrayShader->use();
+	arrayShader->setInt("spriteArray", 0);
+	vertices.resize(MAX_SPRITES * 4);
+
+	// the same two triangles for every quad of a batch
+	std::vector<unsigned short> indices(MAX_SPRITES * 6);
+	for (unsigned int quad = 0; quad < MAX_SPRITES; ++quad) {
+		unsigned short first = (unsigned short)(quad * 4);
+		unsigned short corners[6] = { first, (unsigned short)(first + 1), (unsigned short)(first + 2),
+			(unsigned short)(first + 2), (unsigned short)(first + 3), first };
+		std::copy(corners, corners + 6, &indices[quad * 6]);
+	}
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, (size_t)this->bufferSprites * 4 * sizeof(SpriteVertex), NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), indices.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)(2 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SpriteVertex), (void*)(5 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+SpriteBatch::~SpriteBatch() {
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	glDeleteProgram(shader->ID);
+	glDeleteProgram(arrayShader->ID);
+	delete shader;
+	delete arrayShader;
+}
+
+void SpriteBatch::begin(int screenWidth, int screenHeight) {
+	projection = glm::ortho(0.0f, (float)screenWidth, (float)screenHeight, 0.0f, -1.0f, 1.0f);
+	queued = 0;
+	currentTexture = 0;
+	frameSprites = frameFlushes = 0;
+}
+
+void SpriteBatch::draw(unsigned int texture, const glm::vec4& rect, const glm::vec4& uv, unsigned int color) {
+	push(texture, GL_TEXTURE_2D, 0.0f, rect, uv, color);
+}
+
+void SpriteBatch::drawLayer(unsigned int arrayTexture, unsigned int layer, const glm::vec4& rect,
+	const glm::vec4& uv, unsigned int color) {
+	push(arrayTexture, GL_TEXTURE_2D_ARRAY, (float)layer, rect, uv, color);
+}
+
+void SpriteBatch::push(unsigned int texture, GLenum target, float layer, const glm::vec4& rect,
+	const glm::vec4& uv, unsigned int color) {
+	if (queued > 0 && (texture != currentTexture || target != currentTarget)) {
+		++textureFlushes;
+		flush();
+	}
+	else if (queued == MAX_SPRITES) {
+		++fullFlushes;
+		flush();
+	}
+	currentTexture = texture;
+	currentTarget = target;
+
+	// corners counter clockwise on screen: top left, bottom left, bottom right, top right.
+	// v runs the other way than y, images are loaded bottom row first
+	SpriteVertex* quad = &vertices[queued * 4];
+	float x0 = rect.x, y0 = rect.y, x1 = rect.x + rect.z, y1 = rect.y + rect.w;
+	quad[0] = { { x0, y0 }, { uv.x, uv.w, layer }, color };
+	quad[1] = { { x0, y1 }, { uv.x, uv.y, layer }, color };
+	quad[2] = { { x1, y1 }, { uv.z, uv.y, layer }, color };
+	quad[3] = { { x1, y0 }, { uv.z, uv.w, layer }, color };
+	++queued;
+	++frameSprites;
+}
+
+void SpriteBatch::end() {
+	if (queued > 0) {
+		flush();
+	}
+	++frames;
+	totalSprites += frameSprites;
+}
+
+void SpriteBatch::flush() {
+	// wrap around: orphan the buffer, the driver hands out fresh storage while the GPU reads the old one
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	if (bufferCursor + queued > bufferSprites) {
+		glBufferData(GL_ARRAY_BUFFER, (size_t)bufferSprites * 4 * sizeof(SpriteVertex), NULL, GL_STREAM_DRAW);
+		bufferCursor = 0;
+	}
+	// nothing the GPU may still read is touched, so no synchronization
+	size_t bytes = (size_t)queued * 4 * sizeof(SpriteVertex);
+	void* target = glMapBufferRange(GL_ARRAY_BUFFER, (size_t)bufferCursor * 4 * sizeof(SpriteVertex), bytes,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (target) {
+		std::memcpy(target, vertices.data(), bytes);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	Shader& program = currentTarget == GL_TEXTURE_2D_ARRAY ? *arrayShader : *shader;
+	program.use();
+	program.setMat4("projection", projection);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(currentTarget, currentTexture);
+	glBindVertexArray(VAO);
+	glDrawElementsBaseVertex(GL_TRIANGLES, queued * 6, GL_UNSIGNED_SHORT, 0, bufferCursor * 4);
+	glBindVertexArray(0);
+
+	bufferCursor += queued;
+	queued = 0;
+	++frameFlushes;
+	++totalFlushes;
+}
+
+void SpriteBatch::printStats() const {
+	double perFrame = frames > 0 ? 1.0 / frames : 0.0;
+	std::cout << "SPRITEBATCH::sprites/frame " << totalSprites * perFrame
+		<< " | draws/frame " << totalFlushes * perFrame
+		<< " | sprites/draw " << (totalFlushes > 0 ? (double)totalSprites / totalFlushes : 0.0)
+		<< " | flushes on texture change " << textureFlushes
+		<< " on full batch " << fullFlushes << std::endl;
+}
\ No newline at end of file
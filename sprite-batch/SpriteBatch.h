@@ -0,0 +1,77 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "../shader-lesson-1.4/Shader.h"
+
+// Collects screen space quads and draws them in as few calls as possible.
+// Quads are written to a CPU array and copied into a streamed vertex buffer
+// only when the batch is flushed: on a texture change, when MAX_SPRITES are
+// queued, or at end(). The index buffer is static, 6 16-bit indices per
+// quad, and every flush lands in the next free range of the vertex buffer
+// (mapped unsynchronized, orphaned when it wraps) drawn with a base vertex,
+// so a flush never waits for the GPU to finish with an earlier one.
+// Sprites from a texture array only flush when the array changes, so putting
+// all images into the layers of one array makes every draw a single batch.
+class SpriteBatch {
+public:
+	// quads per flush, 4 vertices each must fit 16-bit indices
+	static constexpr unsigned int MAX_SPRITES = 16384;
+
+	// bufferSprites: quads the streamed vertex buffer holds before it is orphaned
+	SpriteBatch(const char* vertexPath = "../sprite-batch/sprite.vert",
+		const char* fragmentPath = "../sprite-batch/sprite.frag", unsigned int bufferSprites = 4 * MAX_SPRITES);
+	~SpriteBatch();
+
+	// pixel coordinates with the origin at the top left
+	void begin(int screenWidth, int screenHeight);
+	// rect = x, y, width, height in pixels; uv = u0, v0, u1, v1; color packed by rgba()
+	void draw(unsigned int texture, const glm::vec4& rect, const glm::vec4& uv = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),
+		unsigned int color = 0xFFFFFFFF);
+	// same from one layer of a GL_TEXTURE_2D_ARRAY
+	void drawLayer(unsigned int arrayTexture, unsigned int layer, const glm::vec4& rect,
+		const glm::vec4& uv = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), unsigned int color = 0xFFFFFFFF);
+	void end();
+
+	static unsigned int rgba(unsigned char r, unsigned char g, unsigned char b, unsigned char a = 255) {
+		return r | (g << 8) | (b << 16) | ((unsigned int)a << 24);
+	}
+
+	// last frame, between begin() and end()
+	unsigned int getSpriteCount() const { return frameSprites; }
+	unsigned int getDrawCalls() const { return frameFlushes; }
+	// why batches were cut over the whole run
+	unsigned long long getTextureFlushes() const { return textureFlushes; }
+	unsigned long long getFullFlushes() const { return fullFlushes; }
+	void printStats() const;
+
+private:
+	struct SpriteVertex {
+		float position[2];
+		float texCoord[3]; // u, v, layer
+		unsigned int color;
+	};
+
+	Shader* shader;      // GL_TEXTURE_2D
+	Shader* arrayShader; // GL_TEXTURE_2D_ARRAY
+	unsigned int VAO, VBO, EBO;
+	unsigned int bufferSprites;
+	unsigned int bufferCursor; // next free quad in the vertex buffer
+
+	std::vector<SpriteVertex> vertices;
+	unsigned int queued;
+	unsigned int currentTexture;
+	GLenum currentTarget;
+	glm::mat4 projection;
+
+	unsigned int frameSprites, frameFlushes;
+	unsigned long long totalSprites, totalFlushes, textureFlushes, fullFlushes;
+	unsigned long long frames;
+
+	void push(unsigned int texture, GLenum target, float layer, const glm::vec4& rect, const glm::vec4& uv,
+		unsigned int color);
+	void flush();
+};
\ No newline at end of file
@@ -0,0 +1,352 @@
+// sprite batching demo: bouncing sprites drawn one glDrawElements per quad like textures-1.5,
+// batched with two separate textures (runs of 64 sprites share one) and batched from a texture
+// array holding both images. sweeps every sprite count and mode first and prints the CPU and
+// GPU time per frame with the sprite count that would still fit into a 60 FPS frame, then S
+// cycles the sprite count and M the mode.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../shader-lesson-1.4/Shader.h"
+#include "SpriteBatch.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <std_image/stb_image.h>
+
+const unsigned int WIDTH = 800;
+const unsigned int HEIGHT = 600;
+
+const unsigned int SPRITE_COUNTS[] = { 1000, 10000, 100000 };
+const unsigned int SPRITE_COUNT_OPTIONS = sizeof(SPRITE_COUNTS) / sizeof(SPRITE_COUNTS[0]);
+const unsigned int MAX_SPRITE_COUNT = 100000;
+// sprites in a row that use the same image
+const unsigned int RUN_LENGTH = 64;
+const unsigned int SWEEP_FRAMES = 120;
+const double FRAME_BUDGET_MS = 1000.0 / 60.0;
+
+enum Mode { MODE_PER_QUAD, MODE_BATCHED_TEXTURES, MODE_BATCHED_ARRAY, MODE_COUNT };
+const char* MODE_NAMES[] = { "one draw per quad", "batched, 2 textures", "batched, texture array" };
+
+struct Sprite {
+	glm::vec2 position;
+	glm::vec2 velocity;
+	float size;
+	unsigned int color;
+};
+
+unsigned int countOption = 0;
+Mode mode = MODE_PER_QUAD;
+bool settingsChanged = true;
+int windowWidth = WIDTH;
+int windowHeight = HEIGHT;
+
+void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+unsigned int loadTexture(const char* path);
+unsigned int loadTextureArray(const char* const* paths, int count);
+
+int main() {
+	// initialize GLFW
+	glfwInit();
+	// set version and core profile
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// create a window
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	// set callback to handle when window is resized
+	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+	glfwSetKeyCallback(window, keyCallback);
+
+	// initialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// no vsync, we want to see the frame time
+	glfwSwapInterval(0);
+
+	SpriteBatch* batch = new SpriteBatch("sprite.vert", "sprite.frag");
+	Shader* quadShader = new Shader("sprite.vert", "sprite.frag", NULL, "#define PER_QUAD\n");
+
+	stbi_set_flip_vertically_on_load(true);
+	const char* imagePaths[] = { "../textures-lesson-1.5/container.jpg", "../textures-lesson-1.5/awesomeface.png" };
+	unsigned int textures[2] = { loadTexture(imagePaths[0]), loadTexture(imagePaths[1]) };
+	unsigned int textureArray = loadTextureArray(imagePaths, 2);
+
+	// the per quad path: one quad of indices, the corners come from gl_VertexID
+	unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+	unsigned int quadVAO, quadEBO;
+	glGenVertexArrays(1, &quadVAO);
+	glGenBuffers(1, &quadEBO);
+	glBindVertexArray(quadVAO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadEBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+	glBindVertexArray(0);
+
+	std::vector<Sprite> sprites(MAX_SPRITE_COUNT);
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (Sprite& sprite : sprites) {
+		sprite.size = 16.0f + unit(rng) * 32.0f;
+		sprite.position = glm::vec2(unit(rng) * (WIDTH - sprite.size), unit(rng) * (HEIGHT - sprite.size));
+		float angle = unit(rng) * 6.2831853f;
+		sprite.velocity = glm::vec2(cos(angle), sin(angle)) * (40.0f + unit(rng) * 160.0f);
+		sprite.color = SpriteBatch::rgba((unsigned char)(155 + unit(rng) * 100), (unsigned char)(155 + unit(rng) * 100),
+			(unsigned char)(155 + unit(rng) * 100), 230);
+	}
+
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	unsigned int query;
+	glGenQueries(1, &query);
+
+	bool sweeping = true;
+	unsigned int sweepFrame = 0;
+	double lastReport = glfwGetTime();
+	double lastFrame = glfwGetTime();
+	double cpuSum = 0.0, gpuSum = 0.0;
+	unsigned long long drawSum = 0;
+	unsigned int frames = 0;
+
+	// render loop
+	while (!glfwWindowShouldClose(window)) {
+		double now = glfwGetTime();
+		float deltaTime = (float)std::min(now - lastFrame, 0.1);
+		lastFrame = now;
+		unsigned int spriteCount = SPRITE_COUNTS[countOption];
+		if (settingsChanged) {
+			cpuSum = gpuSum = 0.0;
+			drawSum = 0;
+			frames = 0;
+			lastReport = glfwGetTime();
+			settingsChanged = false;
+		}
+
+		// bounce off the window edges
+		for (unsigned int i = 0; i < spriteCount; ++i) {
+			Sprite& sprite = sprites[i];
+			sprite.position = sprite.position + sprite.velocity * deltaTime;
+			if (sprite.position.x < 0.0f || sprite.position.x + sprite.size > windowWidth) {
+				sprite.velocity.x = -sprite.velocity.x;
+				sprite.position.x = std::min(std::max(sprite.position.x, 0.0f), windowWidth - sprite.size);
+			}
+			if (sprite.position.y < 0.0f || sprite.position.y + sprite.size > windowHeight) {
+				sprite.velocity.y = -sprite.velocity.y;
+				sprite.position.y = std::min(std::max(sprite.position.y, 0.0f), windowHeight - sprite.size);
+			}
+		}
+
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		// CPU time of submitting the sprites, GPU time of drawing them
+		auto start = std::chrono::high_resolution_clock::now();
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		if (mode == MODE_PER_QUAD) {
+			quadShader->use();
+			quadShader->setInt("sprite", 0);
+			quadShader->setMat4("projection", glm::ortho(0.0f, (float)windowWidth, (float)windowHeight, 0.0f, -1.0f, 1.0f));
+			int rectLocation = glGetUniformLocation(quadShader->ID, "rect");
+			int uvLocation = glGetUniformLocation(quadShader->ID, "uvRect");
+			int colorLocation = glGetUniformLocation(quadShader->ID, "color");
+			glUniform4f(uvLocation, 0.0f, 0.0f, 1.0f, 1.0f);
+			glActiveTexture(GL_TEXTURE0);
+			glBindVertexArray(quadVAO);
+			for (unsigned int i = 0; i < spriteCount; ++i) {
+				const Sprite& sprite = sprites[i];
+				glBindTexture(GL_TEXTURE_2D, textures[(i / RUN_LENGTH) % 2]);
+				glUniform4f(rectLocation, sprite.position.x, sprite.position.y, sprite.size, sprite.size);
+				glUniform4f(colorLocation, (sprite.color & 0xFF) / 255.0f, ((sprite.color >> 8) & 0xFF) / 255.0f,
+					((sprite.color >> 16) & 0xFF) / 255.0f, (sprite.color >> 24) / 255.0f);
+				glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+			}
+			glBindVertexArray(0);
+			drawSum += spriteCount;
+		}
+		else {
+			batch->begin(windowWidth, windowHeight);
+			for (unsigned int i = 0; i < spriteCount; ++i) {
+				const Sprite& sprite = sprites[i];
+				glm::vec4 rect = glm::vec4(sprite.position.x, sprite.position.y, sprite.size, sprite.size);
+				unsigned int image = (i / RUN_LENGTH) % 2;
+				if (mode == MODE_BATCHED_ARRAY) {
+					batch->drawLayer(textureArray, image, rect, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), sprite.color);
+				}
+				else {
+					batch->draw(textures[image], rect, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), sprite.color);
+				}
+			}
+			batch->end();
+			drawSum += batch->getDrawCalls();
+		}
+		glEndQuery(GL_TIME_ELAPSED);
+		cpuSum += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		GLuint64 gpuTime = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &gpuTime);
+		gpuSum += gpuTime / 1000000.0;
+		++frames;
+
+		// the sweep steps through every sprite count and mode, then hands over to the keys
+		bool report = sweeping ? ++sweepFrame % SWEEP_FRAMES == 0 : glfwGetTime() - lastReport > 1.0;
+		if (report) {
+			// whichever side is slower limits the frame, the sprite cost is taken as linear
+			double cpu = cpuSum / frames, gpu = gpuSum / frames;
+			double cost = std::max(std::max(cpu, gpu), 1e-6);
+			std::cout << "SPRITEBATCH::sprites " << spriteCount << " | " << MODE_NAMES[mode]
+				<< " | CPU " << cpu << " ms"
+				<< " | GPU " << gpu << " ms"
+				<< " | draws/frame " << (double)drawSum / frames
+				<< " | sprites at 60 FPS ~" << (unsigned long long)(spriteCount * FRAME_BUDGET_MS / cost) << std::endl;
+			cpuSum = gpuSum = 0.0;
+			drawSum = 0;
+			frames = 0;
+			lastReport = glfwGetTime();
+		}
+		if (sweeping && report) {
+			mode = (Mode)(mode + 1);
+			if (mode == MODE_COUNT) {
+				mode = MODE_PER_QUAD;
+				++countOption;
+			}
+			if (countOption == SPRITE_COUNT_OPTIONS) {
+				countOption = SPRITE_COUNT_OPTIONS - 1;
+				mode = MODE_BATCHED_ARRAY;
+				sweeping = false;
+			}
+			settingsChanged = true;
+		}
+	}
+
+	batch->printStats();
+
+	// deallocate objects
+	glDeleteQueries(1, &query);
+	glDeleteVertexArrays(1, &quadVAO);
+	glDeleteBuffers(1, &quadEBO);
+	glDeleteTextures(2, textures);
+	glDeleteTextures(1, &textureArray);
+	glDeleteProgram(quadShader->ID);
+	delete quadShader;
+	delete batch;
+
+	glfwTerminate();
+	return 0;
+}
+
+// whenever the window is resized this function gets called
+void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+	windowWidth = width;
+	windowHeight = height;
+}
+
+// react to key presses
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	if (action != GLFW_PRESS) {
+		return;
+	}
+	if (key == GLFW_KEY_ESCAPE) {
+		glfwSetWindowShouldClose(window, true);
+	}
+	if (key == GLFW_KEY_S) {
+		countOption = (countOption + 1) % SPRITE_COUNT_OPTIONS;
+		settingsChanged = true;
+	}
+	if (key == GLFW_KEY_M) {
+		mode = (Mode)((mode + 1) % MODE_COUNT);
+		settingsChanged = true;
+	}
+}
+
+// load an image into a mipmapped texture
+unsigned int loadTexture(const char* path) {
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width, height, nrChannels;
+	unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 4);
+	if (data) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else {
+		std::cout << "Failed to load texture" << std::endl;
+	}
+
+	stbi_image_free(data);
+	return texture;
+}
+
+// images of the same size into the layers of one mipmapped array, the first one sets the size
+unsigned int loadTextureArray(const char* const* paths, int count) {
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int arrayWidth = 0, arrayHeight = 0;
+	for (int layer = 0; layer < count; ++layer) {
+		int width, height, nrChannels;
+		unsigned char* data = stbi_load(paths[layer], &width, &height, &nrChannels, 4);
+		if (!data) {
+			std::cout << "Failed to load texture" << std::endl;
+			continue;
+		}
+		if (arrayWidth == 0) {
+			arrayWidth = width;
+			arrayHeight = height;
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, count, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		}
+		if (width == arrayWidth && height == arrayHeight) {
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		}
+		else {
+			std::cout << "ERROR::SPRITEBATCH::LAYER_SIZE_MISMATCH " << paths[layer] << " is " << width << "x" << height
+				<< ", the array is " << arrayWidth << "x" << arrayHeight << std::endl;
+		}
+		stbi_image_free(data);
+	}
+	if (arrayWidth > 0) {
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	return texture;
+}
\ No newline at end of file
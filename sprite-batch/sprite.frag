@@ -0,0 +1,20 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 TexCoord;
+in vec4 Color;
+
+#if defined(TEXTURE_ARRAY)
+uniform sampler2DArray spriteArray;
+#else
+uniform sampler2D sprite;
+#endif
+
+void main()
+{
+#if defined(TEXTURE_ARRAY)
+	FragColor = texture(spriteArray, TexCoord) * Color;
+#else
+	FragColor = texture(sprite, TexCoord.xy) * Color;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#version 330 core
+// PER_QUAD is one draw per sprite with the quad in uniforms, for comparison;
+// otherwise the vertices come from SpriteBatch
+#if defined(PER_QUAD)
+uniform vec4 rect;  // x, y, width, height in pixels
+uniform vec4 uvRect;
+uniform vec4 color;
+#else
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec3 aTexCoord; // u, v, layer
+layout (location = 2) in vec4 aColor;
+#endif
+
+out vec3 TexCoord;
+out vec4 Color;
+
+uniform mat4 projection;
+
+void main()
+{
+#if defined(PER_QUAD)
+	// same corner order as SpriteBatch: top left, bottom left, bottom right, top right
+	vec2 corner = vec2(gl_VertexID >= 2 ? 1.0f : 0.0f, gl_VertexID == 1 || gl_VertexID == 2 ? 1.0f : 0.0f);
+	gl_Position = projection * vec4(rect.xy + corner * rect.zw, 0.0f, 1.0f);
+	TexCoord = vec3(mix(uvRect.x, uvRect.z, corner.x), mix(uvRect.w, uvRect.y, corner.y), 0.0f);
+	Color = color;
+#else
+	gl_Position = projection * vec4(aPos, 0.0f, 1.0f);
+	TexCoord = aTexCoord;
+	Color = aColor;
+#endif
+}
\ No newline at end of file
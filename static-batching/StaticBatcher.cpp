@@ -0,0 +1,209 @@
+#include "StaticBatcher.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+
+#include "../frustum/Frustum.h"
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+StaticBatcher::StaticBatcher(float cellSize)
+	: cellSize(cellSize), VAO(0), VBO(0), EBO(0), instanceCount(0), vertexBytes(0), indexBytes(0), buildTime(0.0),
+	visibleBatches(0), drawCalls(0), drawnTriangles(0), frames(0), totalDrawCalls(0), totalVisibleBatches(0) {
+}
+
+StaticBatcher::~StaticBatcher() {
+	if (VAO) {
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &VBO);
+		glDeleteBuffers(1, &EBO);
+	}
+}
+
+unsigned int StaticBatcher::addMesh(const float* vertices, unsigned int vertexCount, const unsigned int* indices,
+	unsigned int indexCount) {
+	SourceMesh mesh;
+	if (indices) {
+		mesh.vertices.assign(vertices, vertices + (size_t)vertexCount * VERTEX_FLOATS);
+		mesh.indices.assign(indices, indices + indexCount);
+	}
+	else {
+		// a cube as a triangle list has 36 vertices but only 24 different ones
+		std::map<std::array<float, VERTEX_FLOATS>, unsigned int> welded;
+		for (unsigned int i = 0; i < vertexCount; ++i) {
+			std::array<float, VERTEX_FLOATS> vertex;
+			std::copy(vertices + i * VERTEX_FLOATS, vertices + (i + 1) * VERTEX_FLOATS, vertex.begin());
+			auto found = welded.find(vertex);
+			if (found == welded.end()) {
+				found = welded.insert(std::make_pair(vertex, (unsigned int)(mesh.vertices.size() / VERTEX_FLOATS))).first;
+				mesh.vertices.insert(mesh.vertices.end(), vertex.begin(), vertex.end());
+			}
+			mesh.indices.push_back(found->second);
+		}
+	}
+
+	glm::vec3 min(INFINITY), max(-INFINITY);
+	for (size_t i = 0; i < mesh.vertices.size(); i += VERTEX_FLOATS) {
+		glm::vec3 position(mesh.vertices[i], mesh.vertices[i + 1], mesh.vertices[i + 2]);
+		min = glm::min(min, position);
+		max = glm::max(max, position);
+	}
+	mesh.center = (min + max) * 0.5f;
+	meshes.push_back(mesh);
+	return (unsigned int)meshes.size() - 1;
+}
+
+void StaticBatcher::addInstance(unsigned int mesh, unsigned int material, const glm::mat4& model) {
+	Instance instance;
+	instance.mesh = mesh;
+	instance.material = material;
+	instance.model = model;
+
+	// 21 bits per axis, z most significant so rows of cells along x end up next to each other
+	glm::vec3 center = glm::vec3(model * glm::vec4(meshes[mesh].center, 1.0f));
+	unsigned long long key = 0;
+	for (int axis = 2; axis >= 0; --axis) {
+		long long cell = (long long)std::floor(center[axis] / cellSize) + (1 << 20);
+		key = (key << 21) | (unsigned long long)std::min(std::max(cell, 0LL), (1LL << 21) - 1);
+	}
+	instance.cell = key;
+	instances.push_back(instance);
+}
+
+void StaticBatcher::build() {
+	auto start = std::chrono::high_resolution_clock::now();
+	std::sort(instances.begin(), instances.end(), [](const Instance& a, const Instance& b) {
+		return a.material != b.material ? a.material < b.material : a.cell < b.cell;
+	});
+
+	size_t vertexFloats = 0, indexTotal = 0;
+	for (const Instance& instance : instances) {
+		vertexFloats += meshes[instance.mesh].vertices.size();
+		indexTotal += meshes[instance.mesh].indices.size();
+	}
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	vertices.reserve(vertexFloats);
+	indices.reserve(indexTotal);
+
+	batches.clear();
+	for (size_t i = 0; i < instances.size(); ++i) {
+		const Instance& instance = instances[i];
+		if (i == 0 || instance.material != instances[i - 1].material || instance.cell != instances[i - 1].cell) {
+			Batch batch;
+			batch.material = instance.material;
+			batch.firstIndex = (unsigned int)indices.size();
+			batch.indexCount = 0;
+			batch.min = glm::vec3(INFINITY);
+			batch.max = glm::vec3(-INFINITY);
+			batches.push_back(batch);
+		}
+		Batch& batch = batches.back();
+
+		// pre-transformed, the bounds are exact instead of a box around a rotated box
+		const SourceMesh& mesh = meshes[instance.mesh];
+		unsigned int baseVertex = (unsigned int)(vertices.size() / VERTEX_FLOATS);
+		for (size_t v = 0; v < mesh.vertices.size(); v += VERTEX_FLOATS) {
+			glm::vec3 position = glm::vec3(instance.model * glm::vec4(mesh.vertices[v], mesh.vertices[v + 1], mesh.vertices[v + 2], 1.0f));
+			batch.min = glm::min(batch.min, position);
+			batch.max = glm::max(batch.max, position);
+			vertices.push_back(position.x);
+			vertices.push_back(position.y);
+			vertices.push_back(position.z);
+			vertices.insert(vertices.end(), mesh.vertices.begin() + v + 3, mesh.vertices.begin() + v + VERTEX_FLOATS);
+		}
+		for (unsigned int index : mesh.indices) {
+			indices.push_back(baseVertex + index);
+		}
+		batch.indexCount += (unsigned int)mesh.indices.size();
+	}
+
+	if (!VAO) {
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &VBO);
+		glGenBuffers(1, &EBO);
+	}
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	instanceCount = (unsigned int)instances.size();
+	vertexBytes = vertices.size() * sizeof(float);
+	indexBytes = indices.size() * sizeof(unsigned int);
+	// everything needed from now on is in the buffers and the batch list
+	std::vector<SourceMesh>().swap(meshes);
+	std::vector<Instance>().swap(instances);
+	buildTime = elapsedMs(start);
+}
+
+void StaticBatcher::draw(const glm::mat4& viewProjection, const std::function<void(unsigned int)>& bindMaterial) {
+	visibleBatches = drawCalls = 0;
+	drawnTriangles = 0;
+	if (batches.empty()) {
+		return;
+	}
+
+	glm::vec4 planes[6];
+	frustumPlanes(viewProjection, planes);
+
+	// a run of visible batches that follow each other in the index buffer is one draw
+	unsigned int runFirst = 0, runEnd = 0;
+	unsigned int material = 0xffffffff;
+	auto drawRun = [&]() {
+		if (runEnd > runFirst) {
+			glDrawElements(GL_TRIANGLES, runEnd - runFirst, GL_UNSIGNED_INT, (void*)((size_t)runFirst * sizeof(unsigned int)));
+			++drawCalls;
+			drawnTriangles += (runEnd - runFirst) / 3;
+		}
+		runFirst = runEnd = 0;
+	};
+
+	glBindVertexArray(VAO);
+	for (const Batch& batch : batches) {
+		if (!boxVisible(planes, batch.min, batch.max)) {
+			continue;
+		}
+		++visibleBatches;
+		if (batch.material != material) {
+			drawRun();
+			material = batch.material;
+			bindMaterial(material);
+		}
+		if (batch.firstIndex != runEnd) {
+			drawRun();
+			runFirst = batch.firstIndex;
+		}
+		runEnd = batch.firstIndex + batch.indexCount;
+	}
+	drawRun();
+	glBindVertexArray(0);
+
+	++frames;
+	totalDrawCalls += drawCalls;
+	totalVisibleBatches += visibleBatches;
+}
+
+void StaticBatcher::printStats() const {
+	double perFrame = frames > 0 ? 1.0 / frames : 0.0;
+	std::cout << "STATICBATCH::instances " << instanceCount
+		<< " | batches " << batches.size()
+		<< " | vertices " << vertexBytes / (1024.0 * 1024.0) << " MB"
+		<< " | indices " << indexBytes / (1024.0 * 1024.0) << " MB"
+		<< " | build " << buildTime << " ms"
+		<< " | visible batches/frame " << totalVisibleBatches * perFrame
+		<< " | draws/frame " << totalDrawCalls * perFrame << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <vector>
+
+// Merges static mesh instances into pre-transformed vertex and index buffers
+// at load time. Instances are grouped by material and by the cubic cell of
+// the world their bounds center falls into; each group becomes one batch,
+// a range of one shared index buffer with world space vertices, so the
+// model matrix is identity for all of them. Batches are stored sorted by
+// material, then cell (z, y, x), and draw() culls them per cell and joins
+// neighbouring visible batches of a material into one glDrawElements.
+// Anything that moves stays on the regular per object path.
+class StaticBatcher {
+public:
+	// position + texture coords, same as the GeometryHeap vertex format
+	static const unsigned int VERTEX_FLOATS = 5;
+
+	StaticBatcher(float cellSize = 16.0f);
+	~StaticBatcher();
+
+	// source mesh, VERTEX_FLOATS per vertex. without indices the vertices are a triangle
+	// list and equal vertices are welded
+	unsigned int addMesh(const float* vertices, unsigned int vertexCount, const unsigned int* indices = NULL,
+		unsigned int indexCount = 0);
+	void addInstance(unsigned int mesh, unsigned int material, const glm::mat4& model);
+	// transform, merge and upload every instance, once after all were added. sources are released
+	void build();
+
+	// draw the batches in the frustum, bindMaterial is called before the first draw of each material
+	void draw(const glm::mat4& viewProjection, const std::function<void(unsigned int)>& bindMaterial);
+
+	unsigned int getInstanceCount() const { return instanceCount; }
+	unsigned int getBatchCount() const { return (unsigned int)batches.size(); }
+	size_t getVertexBytes() const { return vertexBytes; }
+	size_t getIndexBytes() const { return indexBytes; }
+	double getBuildTime() const { return buildTime; }
+	// last draw
+	unsigned int getVisibleBatches() const { return visibleBatches; }
+	unsigned int getDrawCalls() const { return drawCalls; }
+	unsigned long long getDrawnTriangles() const { return drawnTriangles; }
+	void printStats() const;
+
+private:
+	struct SourceMesh {
+		std::vector<float> vertices;
+		std::vector<unsigned int> indices;
+		glm::vec3 center; // of the bounds
+	};
+
+	struct Instance {
+		unsigned int mesh;
+		unsigned int material;
+		glm::mat4 model;
+		unsigned long long cell;
+	};
+
+	struct Batch {
+		unsigned int material;
+		unsigned int firstIndex, indexCount;
+		glm::vec3 min, max;
+	};
+
+	float cellSize;
+	std::vector<SourceMesh> meshes;
+	std::vector<Instance> instances;
+	std::vector<Batch> batches;
+
+	unsigned int VAO, VBO, EBO;
+	unsigned int instanceCount;
+	size_t vertexBytes, indexBytes;
+	double buildTime;
+
+	unsigned int visibleBatches, drawCalls;
+	unsigned long long drawnTriangles;
+	unsigned long long frames, totalDrawCalls, totalVisibleBatches;
+};
\ No newline at end of file
@@ -0,0 +1,425 @@
+// static batching demo: a field of cubes that never move, in three materials, drawn either one
+// draw per cube with its own model matrix (culled per cube) or as pre-transformed batches of
+// StaticBatcher (culled per cell). a few spinning cubes stay on the per object path in both
+// modes. sweeps the camera-1.7 scene and two large ones in both modes first and prints draws
+// and frame times, then N cycles the scene and M the mode.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../shader-lesson-1.4/Shader.h"
+#include "StaticBatcher.h"
+#include "../frustum/Frustum.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <std_image/stb_image.h>
+
+const unsigned int WIDTH = 800;
+const unsigned int HEIGHT = 600;
+
+// the first scene is the ten cubes of camera-1.7
+const unsigned int CUBE_COUNTS[] = { 10, 10000, 40000 };
+const unsigned int SCENE_OPTIONS = sizeof(CUBE_COUNTS) / sizeof(CUBE_COUNTS[0]);
+const unsigned int MATERIAL_COUNT = 3;
+const float MATERIAL_MIX[MATERIAL_COUNT] = { 0.0f, 0.5f, 1.0f };
+const unsigned int DYNAMIC_CUBES = 8;
+const float CELL_SIZE = 16.0f;
+const unsigned int SWEEP_FRAMES = 120;
+
+enum Mode { MODE_PER_OBJECT, MODE_BATCHED, MODE_COUNT };
+const char* MODE_NAMES[] = { "one draw per object", "static batches" };
+
+struct StaticCube {
+	glm::mat4 model;
+	glm::vec3 center;
+	unsigned int material;
+};
+
+unsigned int sceneOption = 0;
+Mode mode = MODE_PER_OBJECT;
+bool sceneChanged = true;
+bool settingsChanged = true;
+int windowWidth = WIDTH;
+int windowHeight = HEIGHT;
+
+void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+unsigned int loadTexture(const char* path);
+
+int main() {
+	float vertices[] = {
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+	};
+
+	glm::vec3 cubePositions[] = {
+		glm::vec3(0.0f,  0.0f,  0.0f),
+		glm::vec3(2.0f,  5.0f, -15.0f),
+		glm::vec3(-1.5f, -2.2f, -2.5f),
+		glm::vec3(-3.8f, -2.0f, -12.3f),
+		glm::vec3(2.4f, -0.4f, -3.5f),
+		glm::vec3(-1.7f,  3.0f, -7.5f),
+		glm::vec3(1.3f, -2.0f, -2.5f),
+		glm::vec3(1.5f,  2.0f, -2.5f),
+		glm::vec3(1.5f,  0.2f, -1.5f),
+		glm::vec3(-1.3f,  1.0f, -1.5f)
+	};
+
+	// initialize GLFW
+	glfwInit();
+	// set version and core profile
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// create a window
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	// set callback to handle when window is resized
+	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+	glfwSetKeyCallback(window, keyCallback);
+
+	// initialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// no vsync, we want to see the frame time
+	glfwSwapInterval(0);
+
+	Shader* shader = new Shader("../coordinate-systems-1.6/les1.6-vShader.vert", "../coordinate-systems-1.6/les1.6-fShader.frag");
+	shader->use();
+	shader->setInt("texture1", 0);
+	shader->setInt("texture2", 1);
+
+	stbi_set_flip_vertically_on_load(true);
+	unsigned int texture = loadTexture("../textures-lesson-1.5/container.jpg");
+	unsigned int texture2 = loadTexture("../textures-lesson-1.5/awesomeface.png");
+
+	// the per object path draws the cube as it is in camera-1.7
+	unsigned int VAO, VBO;
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glBindVertexArray(0);
+
+	glEnable(GL_DEPTH_TEST);
+
+	unsigned int query;
+	glGenQueries(1, &query);
+
+	StaticBatcher* batcher = NULL;
+	std::vector<StaticCube> cubes;
+	float sceneRadius = 1.0f;
+	// frame time and draws of the per object mode, to compare the batches against
+	double objectFrameTime[SCENE_OPTIONS] = {};
+	double objectDraws[SCENE_OPTIONS] = {};
+
+	auto bindMaterial = [&](unsigned int material) {
+		shader->setFloat("percentage", MATERIAL_MIX[material]);
+	};
+
+	bool sweeping = true;
+	unsigned int sweepFrame = 0;
+	double lastReport = glfwGetTime();
+	double cpuSum = 0.0, gpuSum = 0.0;
+	unsigned long long drawSum = 0;
+	unsigned int frames = 0;
+
+	// render loop
+	while (!glfwWindowShouldClose(window)) {
+		float time = (float)glfwGetTime();
+		if (sceneChanged) {
+			// the static scene, sorted by material so the per object path switches as little as the batches
+			cubes.clear();
+			unsigned int count = CUBE_COUNTS[sceneOption];
+			std::mt19937 rng(11);
+			std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+			unsigned int columns = (unsigned int)std::ceil(std::sqrt((float)count));
+			for (unsigned int i = 0; i < count; ++i) {
+				StaticCube cube;
+				glm::vec3 position;
+				float angle = 20.0f * i;
+				if (count == 10) {
+					position = cubePositions[i];
+				}
+				else {
+					position = glm::vec3(((i % columns) - columns * 0.5f) * 2.0f, unit(rng) * 6.0f - 3.0f,
+						((i / columns) - columns * 0.5f) * 2.0f);
+					angle = unit(rng) * 360.0f;
+				}
+				cube.model = glm::rotate(glm::translate(glm::mat4(1.0f), position), glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+				cube.center = position;
+				cube.material = i % MATERIAL_COUNT;
+				cubes.push_back(cube);
+			}
+			std::stable_sort(cubes.begin(), cubes.end(), [](const StaticCube& a, const StaticCube& b) {
+				return a.material < b.material;
+			});
+			sceneRadius = count == 10 ? 8.0f : columns * 1.0f;
+
+			delete batcher;
+			batcher = new StaticBatcher(CELL_SIZE);
+			unsigned int cubeMesh = batcher->addMesh(vertices, 36);
+			for (const StaticCube& cube : cubes) {
+				batcher->addInstance(cubeMesh, cube.material, cube.model);
+			}
+			batcher->build();
+			batcher->printStats();
+			sceneChanged = false;
+		}
+		if (settingsChanged) {
+			cpuSum = gpuSum = 0.0;
+			drawSum = 0;
+			frames = 0;
+			lastReport = glfwGetTime();
+			settingsChanged = false;
+		}
+
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// slow orbit looking across the field, most of it is in view
+		float angle = time * 0.1f;
+		float distance = sceneRadius * 1.2f + 4.0f;
+		glm::mat4 view = glm::lookAt(glm::vec3(sin(angle) * distance, distance * 0.4f, cos(angle) * distance),
+			glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)windowWidth / std::max(windowHeight, 1),
+			0.1f, distance * 3.0f);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, texture2);
+		shader->use();
+		shader->setMat4("view", view);
+		shader->setMat4("projection", projection);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		unsigned int draws = 0;
+		if (mode == MODE_PER_OBJECT) {
+			// as camera-1.7 used to: a model matrix and a draw per cube, the ones outside the frustum skipped
+			glm::vec4 planes[6];
+			frustumPlanes(projection * view, planes);
+			const glm::vec3 extent(0.8661f); // half diagonal of the unit cube
+			unsigned int material = 0xffffffff;
+			glBindVertexArray(VAO);
+			for (const StaticCube& cube : cubes) {
+				if (!boxVisible(planes, cube.center - extent, cube.center + extent)) {
+					continue;
+				}
+				if (cube.material != material) {
+					material = cube.material;
+					bindMaterial(material);
+				}
+				shader->setMat4("model", cube.model);
+				glDrawArrays(GL_TRIANGLES, 0, 36);
+				++draws;
+			}
+		}
+		else {
+			shader->setMat4("model", glm::mat4(1.0f));
+			batcher->draw(projection * view, bindMaterial);
+			draws += batcher->getDrawCalls();
+		}
+
+		// the moving cubes take the regular path in both modes
+		glBindVertexArray(VAO);
+		bindMaterial(0);
+		for (unsigned int i = 0; i < DYNAMIC_CUBES; ++i) {
+			float orbit = time + i * 6.2831853f / DYNAMIC_CUBES;
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(sin(orbit) * 4.0f, 5.0f, cos(orbit) * 4.0f));
+			model = glm::rotate(model, time * 2.0f, glm::vec3(0.0f, 1.0f, 0.0f));
+			shader->setMat4("model", model);
+			glDrawArrays(GL_TRIANGLES, 0, 36);
+			++draws;
+		}
+		glBindVertexArray(0);
+		glEndQuery(GL_TIME_ELAPSED);
+		cpuSum += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		drawSum += draws;
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		GLuint64 gpuTime = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &gpuTime);
+		gpuSum += gpuTime / 1000000.0;
+		++frames;
+
+		// the sweep steps through every scene and mode, then hands over to the keys
+		bool report = sweeping ? ++sweepFrame % SWEEP_FRAMES == 0 : glfwGetTime() - lastReport > 1.0;
+		if (report) {
+			// submit and GPU time overlap, the slower one is the frame time
+			double cpu = cpuSum / frames, gpu = gpuSum / frames;
+			double frameTime = std::max(cpu, gpu);
+			double drawsPerFrame = (double)drawSum / frames;
+			std::cout << "STATICBATCH::cubes " << CUBE_COUNTS[sceneOption] << " + " << DYNAMIC_CUBES << " moving"
+				<< " | " << MODE_NAMES[mode]
+				<< " | draws/frame " << drawsPerFrame
+				<< " | CPU " << cpu << " ms"
+				<< " | GPU " << gpu << " ms";
+			if (mode == MODE_PER_OBJECT) {
+				objectFrameTime[sceneOption] = frameTime;
+				objectDraws[sceneOption] = drawsPerFrame;
+			}
+			else if (objectDraws[sceneOption] > 0.0) {
+				std::cout << " | vs one draw per object: " << objectDraws[sceneOption] / std::max(drawsPerFrame, 1.0)
+					<< "x fewer draws, frame " << objectFrameTime[sceneOption] << " -> " << frameTime << " ms";
+			}
+			std::cout << std::endl;
+			cpuSum = gpuSum = 0.0;
+			drawSum = 0;
+			frames = 0;
+			lastReport = glfwGetTime();
+		}
+		if (sweeping && report) {
+			mode = (Mode)(mode + 1);
+			if (mode == MODE_COUNT) {
+				mode = MODE_PER_OBJECT;
+				++sceneOption;
+				sceneChanged = true;
+			}
+			if (sceneOption == SCENE_OPTIONS) {
+				sceneOption = SCENE_OPTIONS - 1;
+				mode = MODE_BATCHED;
+				sceneChanged = false;
+				sweeping = false;
+			}
+			settingsChanged = true;
+		}
+	}
+
+	batcher->printStats();
+
+	// deallocate objects
+	glDeleteQueries(1, &query);
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteTextures(1, &texture);
+	glDeleteTextures(1, &texture2);
+	glDeleteProgram(shader->ID);
+	delete shader;
+	delete batcher;
+
+	glfwTerminate();
+	return 0;
+}
+
+// whenever the window is resized this function gets called
+void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+	windowWidth = width;
+	windowHeight = height;
+}
+
+// react to key presses
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	if (action != GLFW_PRESS) {
+		return;
+	}
+	if (key == GLFW_KEY_ESCAPE) {
+		glfwSetWindowShouldClose(window, true);
+	}
+	if (key == GLFW_KEY_N) {
+		sceneOption = (sceneOption + 1) % SCENE_OPTIONS;
+		sceneChanged = true;
+		settingsChanged = true;
+	}
+	if (key == GLFW_KEY_M) {
+		mode = (Mode)((mode + 1) % MODE_COUNT);
+		settingsChanged = true;
+	}
+}
+
+// load an image into a mipmapped texture
+unsigned int loadTexture(const char* path) {
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width, height, nrChannels;
+	unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 4);
+	if (data) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else {
+		std::cout << "Failed to load texture" << std::endl;
+	}
+
+	stbi_image_free(data);
+	return texture;
+}
\ No newline at end of file
@@ -0,0 +1,301 @@
+#include "TextureStreamer.h"
+
+#include <std_image/stb_image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+TextureStreamer::TextureStreamer(size_t budgetBytes, unsigned int workerCount)
+	: budgetBytes(budgetBytes), residentBytes(0), sourceBytes(0), frame(0),
+	uploadedBytes(0), evictedLevels(0), decodes(0), quit(false) {
+	for (unsigned int i = 0; i < std::max(1u, workerCount); ++i) {
+		workers.push_back(std::thread(&TextureStreamer::workerLoop, this));
+	}
+}
+
+TextureStreamer::~TextureStreamer() {
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		quit = true;
+	}
+	queueCondition.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	for (Entry& entry : entries) {
+		glDeleteTextures(1, &entry.texture);
+	}
+}
+
+unsigned int TextureStreamer::load(const std::string& path) {
+	Entry entry;
+	entry.path = path;
+	entry.width = 1;
+	entry.height = 1;
+	int channels;
+	if (!stbi_info(path.c_str(), &entry.width, &entry.height, &channels)) {
+		std::cout << "Failed to load texture " << path << std::endl;
+	}
+
+	entry.levelCount = 1 + (int)std::floor(std::log2((float)std::max(entry.width, entry.height)));
+	entry.tailLevel = 0;
+	while (entry.tailLevel < entry.levelCount - 1
+		&& std::max(entry.width >> entry.tailLevel, entry.height >> entry.tailLevel) > TAIL_SIZE) {
+		++entry.tailLevel;
+	}
+	entry.residentLevel = entry.levelCount;
+	entry.desiredLevel = entry.tailLevel;
+	entry.lastUsedFrame = 0;
+	entry.decodePending = false;
+
+	for (int level = 0; level < entry.levelCount; ++level) {
+		sourceBytes += levelBytes(entry, level);
+	}
+
+	// grey 1x1 placeholder until the mip tail arrives
+	const unsigned char grey[4] = { 128, 128, 128, 255 };
+	glGenTextures(1, &entry.texture);
+	glBindTexture(GL_TEXTURE_2D, entry.texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	unsigned int id = (unsigned int)entries.size();
+	entries.push_back(entry);
+	requestDecode(entries.back(), id);
+	return id;
+}
+
+void TextureStreamer::request(unsigned int id, float mipLevel) {
+	Entry& entry = entries[id];
+	int level = std::max(0, std::min(entry.tailLevel, (int)std::floor(mipLevel)));
+
+	// several users in the same frame: keep the finest request
+	if (entry.lastUsedFrame != frame) {
+		entry.desiredLevel = level;
+	}
+	else {
+		entry.desiredLevel = std::min(entry.desiredLevel, level);
+	}
+	entry.lastUsedFrame = frame;
+}
+
+void TextureStreamer::update(size_t uploadBytes) {
+	scratch.reset();
+
+	// pick up decoded chains
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		ready.swap(decoded);
+	}
+	for (auto& result : ready) {
+		Entry& entry = entries[result.first];
+		entry.decodePending = false;
+		entry.chain = result.second;
+		if (!entry.chain) {
+			// stays on the placeholder and is never asked for again
+			std::cout << "Failed to load texture " << entry.path << std::endl;
+			continue;
+		}
+
+		// first time around: the whole tail goes up at once, it is tiny
+		if (entry.residentLevel == entry.levelCount) {
+			for (int level = entry.levelCount - 1; level >= entry.tailLevel; --level) {
+				uploadLevel(entry, level);
+			}
+		}
+	}
+	ready.clear();
+
+	// textures furthest from what they want go first
+	unsigned int* wanting = scratch.allocate<unsigned int>(entries.size());
+	unsigned int wantingCount = 0;
+	for (unsigned int id = 0; id < entries.size(); ++id) {
+		const Entry& entry = entries[id];
+		if (entry.lastUsedFrame == frame && entry.residentLevel <= entry.tailLevel
+			&& entry.desiredLevel < entry.residentLevel) {
+			wanting[wantingCount++] = id;
+		}
+	}
+	std::sort(wanting, wanting + wantingCount, [this](unsigned int a, unsigned int b) {
+		return entries[a].residentLevel - entries[a].desiredLevel
+			> entries[b].residentLevel - entries[b].desiredLevel;
+	});
+
+	// one level per texture per frame, coarse to fine, within the upload budget
+	size_t uploadedThisFrame = 0;
+	for (unsigned int i = 0; i < wantingCount; ++i) {
+		unsigned int id = wanting[i];
+		Entry& entry = entries[id];
+		if (!entry.chain) {
+			requestDecode(entry, id);
+			continue;
+		}
+
+		size_t bytes = levelBytes(entry, entry.residentLevel - 1);
+		if (uploadedThisFrame + bytes > uploadBytes && uploadedThisFrame > 0) {
+			break;
+		}
+		if (!makeRoom(bytes)) {
+			continue;
+		}
+		uploadLevel(entry, entry.residentLevel - 1);
+		uploadedThisFrame += bytes;
+	}
+
+	// shrink back under budget if it was lowered, and drop CPU copies nobody needs
+	makeRoom(0);
+	for (Entry& entry : entries) {
+		if (entry.chain && entry.residentLevel <= entry.desiredLevel) {
+			entry.chain.reset();
+		}
+	}
+
+	++frame;
+}
+
+float TextureStreamer::estimateMip(int textureSize, float screenPixels) {
+	if (screenPixels <= 0.0f) {
+		return 1000.0f;
+	}
+	return std::max(0.0f, std::log2((float)textureSize / screenPixels));
+}
+
+void TextureStreamer::printStats() const {
+	unsigned int fullyResident = 0;
+	for (const Entry& entry : entries) {
+		if (entry.residentLevel == 0) {
+			++fullyResident;
+		}
+	}
+	std::cout << "TEXTURESTREAMER::textures " << entries.size()
+		<< " | resident " << residentBytes / (1024.0 * 1024.0) << " MB"
+		<< " / budget " << budgetBytes / (1024.0 * 1024.0) << " MB"
+		<< " | source " << sourceBytes / (1024.0 * 1024.0) << " MB"
+		<< " | fully resident " << fullyResident
+		<< " | uploaded " << uploadedBytes / (1024.0 * 1024.0) << " MB"
+		<< " | evicted levels " << evictedLevels
+		<< " | decodes " << decodes << std::endl;
+}
+
+void TextureStreamer::workerLoop() {
+	while (true) {
+		unsigned int id;
+		std::string path;
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueCondition.wait(lock, [this] { return quit || !decodeQueue.empty(); });
+			if (quit) {
+				return;
+			}
+			id = decodeQueue.front().first;
+			path = decodeQueue.front().second;
+			decodeQueue.pop_front();
+		}
+
+		std::shared_ptr<MipChain> chain = std::make_shared<MipChain>();
+		int channels;
+		unsigned char* data = stbi_load(path.c_str(), &chain->width, &chain->height, &channels, 4);
+		if (data) {
+			chain->levels = mipGenerator.generate(data, chain->width, chain->height, 4);
+			stbi_image_free(data);
+		}
+		else {
+			chain.reset();
+		}
+
+		std::lock_guard<std::mutex> lock(queueMutex);
+		decoded.push_back(std::make_pair(id, chain));
+	}
+}
+
+void TextureStreamer::requestDecode(Entry& entry, unsigned int id) {
+	if (entry.decodePending) {
+		return;
+	}
+	entry.decodePending = true;
+	++decodes;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		decodeQueue.push_back(std::make_pair(id, entry.path));
+	}
+	queueCondition.notify_one();
+}
+
+void TextureStreamer::uploadLevel(Entry& entry, int level) {
+	if (!entry.chain || level >= (int)entry.chain->levels.size()) {
+		return;
+	}
+
+	int width = std::max(1, entry.width >> level);
+	int height = std::max(1, entry.height >> level);
+
+	glBindTexture(GL_TEXTURE_2D, entry.texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+		entry.chain->levels[level].data.data());
+
+	if (entry.residentLevel == entry.levelCount) {
+		// replacing the placeholder: release its storage at level 0
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, entry.levelCount - 1);
+		if (level != 0) {
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		}
+	}
+	// levels below the base level are ignored for completeness
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	entry.residentLevel = level;
+	residentBytes += levelBytes(entry, level);
+	uploadedBytes += levelBytes(entry, level);
+}
+
+void TextureStreamer::evictLevel(Entry& entry) {
+	int level = entry.residentLevel;
+
+	glBindTexture(GL_TEXTURE_2D, entry.texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1);
+	// a zero sized image frees the level's storage
+	glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	entry.residentLevel = level + 1;
+	residentBytes -= levelBytes(entry, level);
+	++evictedLevels;
+}
+
+bool TextureStreamer::makeRoom(size_t bytes) {
+	while (residentBytes + bytes > budgetBytes) {
+		// least recently used texture that still has a level above its tail
+		Entry* victim = NULL;
+		for (Entry& entry : entries) {
+			if (entry.residentLevel >= entry.tailLevel || entry.lastUsedFrame == frame) {
+				continue;
+			}
+			if (!victim || entry.lastUsedFrame < victim->lastUsedFrame) {
+				victim = &entry;
+			}
+		}
+		if (!victim) {
+			// everything left is in use this frame
+			return false;
+		}
+		evictLevel(*victim);
+	}
+	return true;
+}
+
+size_t TextureStreamer::levelBytes(const Entry& entry, int level) {
+	size_t width = std::max(1, entry.width >> level);
+	size_t height = std::max(1, entry.height >> level);
+	return width * height * 4;
+}
\ No newline at end of file
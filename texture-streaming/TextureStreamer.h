@@ -0,0 +1,100 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../frame-memory/FrameArena.h"
+#include "../mipmap-generator/MipGenerator.h"
+
+// decoded image plus its CPU mip chain, RGBA8
+struct MipChain {
+	int width, height;
+	std::vector<MipLevel> levels;
+};
+
+// Streams texture mips in and out of GPU memory.
+// A texture starts as a 1x1 placeholder, gets its small mip tail as soon as a
+// worker has decoded it, and finer levels are uploaded only while something
+// on screen asks for them. Levels are dropped least recently used first when
+// the resident size goes over budget.
+class TextureStreamer {
+public:
+	// mips up to this size are always resident once decoded
+	static const int TAIL_SIZE = 64;
+
+	TextureStreamer(size_t budgetBytes, unsigned int workerCount = 2);
+	~TextureStreamer();
+
+	// only reads the image header, decoding happens in the background
+	unsigned int load(const std::string& path);
+	// GL texture name, always valid to bind
+	unsigned int getTexture(unsigned int id) const { return entries[id].texture; }
+	// largest side of the full resolution image
+	int getSize(unsigned int id) const { return std::max(entries[id].width, entries[id].height); }
+
+	// mark the texture as used this frame and ask for (at least) this mip level
+	void request(unsigned int id, float mipLevel);
+	// finish decodes, upload up to uploadBytes of new levels and evict over budget
+	void update(size_t uploadBytes = 4 * 1024 * 1024);
+
+	// mip level that maps one texel to one pixel for a texture covering screenPixels
+	static float estimateMip(int textureSize, float screenPixels);
+
+	size_t getResidentBytes() const { return residentBytes; }
+	size_t getSourceBytes() const { return sourceBytes; }
+	size_t getBudget() const { return budgetBytes; }
+	void setBudget(size_t bytes) { budgetBytes = bytes; }
+	void printStats() const;
+
+private:
+	struct Entry {
+		std::string path;
+		unsigned int texture;
+		int width, height;
+		int levelCount;
+		int tailLevel;      // coarsest level that is never evicted
+		int residentLevel;  // finest uploaded level, levelCount = placeholder only
+		int desiredLevel;
+		unsigned long long lastUsedFrame;
+		std::shared_ptr<MipChain> chain; // CPU copy while levels are still streaming in
+		bool decodePending;
+	};
+
+	std::vector<Entry> entries;
+	size_t budgetBytes;
+	size_t residentBytes;
+	size_t sourceBytes;
+	unsigned long long frame;
+
+	unsigned long long uploadedBytes;
+	unsigned int evictedLevels;
+	unsigned int decodes;
+
+	// worker pool: decode requests in, decoded chains out
+	std::vector<std::thread> workers;
+	std::mutex queueMutex;
+	std::condition_variable queueCondition;
+	std::deque<std::pair<unsigned int, std::string>> decodeQueue;
+	std::vector<std::pair<unsigned int, std::shared_ptr<MipChain>>> decoded;
+	std::vector<std::pair<unsigned int, std::shared_ptr<MipChain>>> ready; // swapped with decoded, keeps its capacity
+	bool quit;
+	MipGenerator mipGenerator;
+	// per update scratch lists
+	FrameArena scratch;
+
+	void workerLoop();
+	void requestDecode(Entry& entry, unsigned int id);
+	void uploadLevel(Entry& entry, int level);
+	void evictLevel(Entry& entry);
+	// evict least recently used levels not needed this frame until bytes fit
+	bool makeRoom(size_t bytes);
+	static size_t levelBytes(const Entry& entry, int level);
+};
\ No newline at end of file
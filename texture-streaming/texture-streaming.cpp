@@ -0,0 +1,200 @@
+// texture streaming demo: a field of textured quads flown over by the camera
+// usage: texture-streaming [budget MB] [image files...]
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "../shader-lesson-1.4/Shader.h"
+#include "../geometry-heap/GeometryHeap.h"
+#include "TextureStreamer.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <std_image/stb_image.h>
+
+const unsigned int WIDTH = 800;
+const unsigned int HEIGHT = 600;
+
+// quads per side of the field and distance between them
+const int GRID_SIZE = 48;
+const float GRID_SPACING = 3.0f;
+
+void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+
+int main(int argc, char** argv) {
+	double startTime = 0.0;
+
+	// initialize GLFW
+	glfwInit();
+	startTime = glfwGetTime();
+	// set version and core profile
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// create a window
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	// set callback to handle when window is resized
+	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+
+	// initialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	Shader shader("../coordinate-systems-1.6/les1.6-vShader.vert", "streaming.frag");
+
+	// default to the lesson textures, every quad gets its own copy
+	size_t budgetMB = argc > 1 ? std::stoul(argv[1]) : 256;
+	std::vector<std::string> paths;
+	for (int i = 2; i < argc; ++i) {
+		paths.push_back(argv[i]);
+	}
+	if (paths.empty()) {
+		paths.push_back("../textures-lesson-1.5/container.jpg");
+		paths.push_back("../textures-lesson-1.5/awesomeface.png");
+	}
+
+	stbi_set_flip_vertically_on_load(true);
+	TextureStreamer* streamer = new TextureStreamer(budgetMB * 1024 * 1024, 4);
+
+	std::vector<unsigned int> quadTextures;
+	for (int i = 0; i < GRID_SIZE * GRID_SIZE; ++i) {
+		quadTextures.push_back(streamer->load(paths[i % paths.size()]));
+	}
+	std::cout << "TEXTURESTREAMER::registered " << quadTextures.size() << " textures, "
+		<< streamer->getSourceBytes() / (1024.0 * 1024.0 * 1024.0) << " GB of source mips" << std::endl;
+
+	// one unit quad lying on the ground
+	float vertices[] = {
+		// positions          // texture coords
+		 0.5f, 0.0f,  0.5f,   1.0f, 0.0f,
+		 0.5f, 0.0f, -0.5f,   1.0f, 1.0f,
+		-0.5f, 0.0f, -0.5f,   0.0f, 1.0f,
+		-0.5f, 0.0f,  0.5f,   0.0f, 0.0f
+	};
+	unsigned int indices[] = {
+		0, 1, 3, // first triangle
+		1, 2, 3  // second triangle
+	};
+
+	GeometryHeap* geometry = new GeometryHeap(1024, 1024);
+	unsigned int quadMesh = geometry->addMesh(vertices, 4, indices, 6);
+
+	shader.use();
+	shader.setInt("texture1", 0);
+
+	glEnable(GL_DEPTH_TEST);
+
+	const float fov = 45.0f;
+	const float quadSize = 2.5f;
+	bool firstFrame = true;
+	double lastReport = 0.0;
+
+	// render loop
+	while (!glfwWindowShouldClose(window)) {
+		processInput(window);
+
+		// scripted fly over the field
+		float time = (float)glfwGetTime();
+		glm::vec3 cameraPos = glm::vec3(0.0f, 2.0f, GRID_SIZE * GRID_SPACING * 0.5f - time * 4.0f);
+		glm::vec3 cameraFront = glm::normalize(glm::vec3(0.0f, -0.3f, -1.0f));
+		glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(fov), (float)WIDTH / (float)HEIGHT, 0.1f, 200.0f);
+
+		// clear screen
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		shader.use();
+		shader.setMat4("view", view);
+		shader.setMat4("projection", projection);
+		geometry->bind();
+		glActiveTexture(GL_TEXTURE0);
+
+		// pixels covered by one world unit at distance 1
+		float pixelsPerUnit = HEIGHT / (2.0f * tan(glm::radians(fov) * 0.5f));
+
+		for (int z = 0; z < GRID_SIZE; ++z) {
+			for (int x = 0; x < GRID_SIZE; ++x) {
+				glm::vec3 position = glm::vec3((x - GRID_SIZE / 2) * GRID_SPACING, 0.0f,
+					(z - GRID_SIZE / 2) * GRID_SPACING);
+
+				// skip what is behind the camera, it ages out of the LRU
+				glm::vec3 toQuad = position - cameraPos;
+				float depth = glm::dot(toQuad, cameraFront);
+				if (depth < 0.1f) {
+					continue;
+				}
+
+				// CPU estimate of the on screen size
+				unsigned int id = quadTextures[z * GRID_SIZE + x];
+				float screenPixels = quadSize * pixelsPerUnit / depth;
+				streamer->request(id, TextureStreamer::estimateMip(streamer->getSize(id), screenPixels));
+
+				glm::mat4 model = glm::mat4(1.0f);
+				model = glm::translate(model, position);
+				model = glm::scale(model, glm::vec3(quadSize));
+				shader.setMat4("model", model);
+
+				glBindTexture(GL_TEXTURE_2D, streamer->getTexture(id));
+				geometry->draw(quadMesh);
+			}
+		}
+		geometry->endFrame();
+
+		streamer->update();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		if (firstFrame) {
+			std::cout << "TEXTURESTREAMER::time to first frame "
+				<< (glfwGetTime() - startTime) * 1000.0 << " ms" << std::endl;
+			streamer->printStats();
+			firstFrame = false;
+		}
+		if (glfwGetTime() - lastReport > 1.0) {
+			streamer->printStats();
+			lastReport = glfwGetTime();
+		}
+	}
+
+	// deallocate objects
+	delete streamer;
+	delete geometry;
+
+	glfwTerminate();
+	return 0;
+}
+
+// whenever the window is resized this function gets called
+void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+	// tell OpenGL the size of the window
+	glViewport(0, 0, width, height);
+}
+
+// react to key presses
+void processInput(GLFWwindow* window) {
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+		glfwSetWindowShouldClose(window, true);
+	}
+}
\ No newline at end of file
@@ -4,12 +4,20 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include "shader-lesson-1.4/Shader.h"
+#include "../frame-memory/AllocationTracker.h"
+#include "../pipeline-stats/PipelineStats.h"
+#include "../pipeline-stats/OverdrawView.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <std_image/stb_image.h>
 
 void framebufferResizeCallback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+PipelineStats* pipelineStats = NULL;
+OverdrawView* overdrawView = NULL;
+bool showOverdraw = false;
 
 int main() {
 	// initialize GLFW
@@ -34,6 +42,7 @@ int main() {
 	glfwMakeContextCurrent(window);
 	// set callback to handle when window is resized
 	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+	glfwSetKeyCallback(window, keyCallback);
 
 	// initialize GLAD
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
@@ -150,14 +159,28 @@ int main() {
 	// set wireframe mode
 	// glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+	// press I to count the pipeline for the quad, O to cycle the overdraw heat map
+	pipelineStats = new PipelineStats();
+	overdrawView = new OverdrawView();
+
 	// render loop
 	while (!glfwWindowShouldClose(window)) {
+		AllocationTracker::beginFrame();
+
 		processInput(window);
 
 		// clear screen
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
 
+		int framebufferWidth, framebufferHeight;
+		glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+		pipelineStats->beginFrame(framebufferWidth, framebufferHeight);
+		if (showOverdraw) {
+			overdrawView->resize(framebufferWidth, framebufferHeight);
+			overdrawView->begin();
+		}
+
 		// bind textures
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_2D, texture);
@@ -170,14 +193,32 @@ int main() {
 
 		// draw triangle
 		glBindVertexArray(VAO);
+		pipelineStats->begin("scene", "quad");
 		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+		pipelineStats->end();
+
+		if (showOverdraw) {
+			overdrawView->end(0);
+		}
+		pipelineStats->endFrame();
 
 		glfwSwapBuffers(window);
 		glfwPollEvents();
+
+		AllocationTracker::endFrame();
 	}
+	// heap allocations per frame, should be 0 in steady state
+	AllocationTracker::report("textures-1.5");
+	pipelineStats->report();
+	overdrawView->printStats();
+
 	// deallocate objects
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteBuffers(1, &VBO);
+	delete pipelineStats;
+	pipelineStats = NULL;
+	delete overdrawView;
+	overdrawView = NULL;
 
 	glfwTerminate();
 	return 0;
@@ -194,4 +235,24 @@ void processInput(GLFWwindow* window) {
 	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
 		glfwSetWindowShouldClose(window, true);
 	}
+}
+
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	// pipeline statistics on/off, reported on exit
+	if (key == GLFW_KEY_I && action == GLFW_PRESS && pipelineStats) {
+		pipelineStats->setEnabled(!pipelineStats->isEnabled());
+	}
+	// overdraw heat map: off, every rasterized fragment, fragments that passed the depth test
+	if (key == GLFW_KEY_O && action == GLFW_PRESS && overdrawView) {
+		if (!showOverdraw) {
+			showOverdraw = true;
+			overdrawView->setCount(OverdrawView::COUNT_RASTERIZED);
+		}
+		else if (overdrawView->getCount() == OverdrawView::COUNT_RASTERIZED) {
+			overdrawView->setCount(OverdrawView::COUNT_DEPTH_PASSED);
+		}
+		else {
+			showOverdraw = false;
+		}
+	}
 }
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned int threadCount) : pending(0), quit(false) {
+	if (threadCount == 0) {
+		unsigned int hardware = std::thread::hardware_concurrency();
+		threadCount = hardware > 1 ? hardware - 1 : 1;
+	}
+	for (unsigned int i = 0; i < threadCount; ++i) {
+		workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	jobCondition.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::submit(std::function<void()> job) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(std::move(job));
+		++pending;
+	}
+	jobCondition.notify_one();
+}
+
+void ThreadPool::wait() {
+	std::unique_lock<std::mutex> lock(mutex);
+	idleCondition.wait(lock, [this] { return pending == 0; });
+}
+
+void ThreadPool::parallelFor(unsigned int count, unsigned int grain,
+	const std::function<void(unsigned int, unsigned int)>& fn) {
+	if (count == 0) {
+		return;
+	}
+	grain = std::max(1u, grain);
+	unsigned int chunks = (count + grain - 1) / grain;
+	if (chunks == 1) {
+		fn(0, count);
+		return;
+	}
+
+	// shared with the helpers, which may only get to run after we returned
+	struct State {
+		std::atomic<unsigned int> next;
+		std::atomic<unsigned int> done;
+	};
+	std::shared_ptr<State> state = std::make_shared<State>();
+	state->next = 0;
+	state->done = 0;
+	const std::function<void(unsigned int, unsigned int)>* body = &fn;
+
+	auto work = [state, body, count, grain, chunks]() {
+		unsigned int chunk;
+		while ((chunk = state->next.fetch_add(1)) < chunks) {
+			unsigned int begin = chunk * grain;
+			(*body)(begin, std::min(count, begin + grain));
+			state->done.fetch_add(1);
+		}
+	};
+
+	unsigned int helpers = std::min((unsigned int)workers.size(), chunks - 1);
+	for (unsigned int i = 0; i < helpers; ++i) {
+		submit(work);
+	}
+	work();
+
+	// helpers that start late find no chunk left and never touch fn
+	while (state->done.load() < chunks) {
+		std::this_thread::yield();
+	}
+}
+
+ThreadPool& ThreadPool::global() {
+	static ThreadPool pool;
+	return pool;
+}
+
+void ThreadPool::workerLoop() {
+	while (true) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobCondition.wait(lock, [this] { return quit || !jobs.empty(); });
+			if (quit && jobs.empty()) {
+				return;
+			}
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+
+		job();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--pending == 0) {
+			idleCondition.notify_all();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads shared by the CPU side systems.
+class ThreadPool {
+public:
+	// 0 = one worker per hardware thread, minus the calling thread
+	ThreadPool(unsigned int threadCount = 0);
+	~ThreadPool();
+
+	// fire and forget, use wait() to block until every job has run
+	void submit(std::function<void()> job);
+	void wait();
+
+	// split [0, count) into chunks of grain items and run fn(begin, end) on them.
+	// the calling thread works too and the call returns once every chunk is done
+	void parallelFor(unsigned int count, unsigned int grain,
+		const std::function<void(unsigned int, unsigned int)>& fn);
+
+	// workers plus the calling thread
+	unsigned int getConcurrency() const { return (unsigned int)workers.size() + 1; }
+
+	// process wide pool, created on first use
+	static ThreadPool& global();
+
+private:
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+	std::mutex mutex;
+	std::condition_variable jobCondition;
+	std::condition_variable idleCondition;
+	unsigned int pending;
+	bool quit;
+
+	void workerLoop();
+};
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "WeightedBlendedOIT.h"
+
+#include <algorithm>
+
+WeightedBlendedOIT::WeightedBlendedOIT(int width, int height, const char* compositeVertexPath,
+	const char* compositeFragmentPath)
+	: width(width), height(height) {
+	compositeShader = new Shader(compositeVertexPath, compositeFragmentPath);
+	compositeShader->use();
+	compositeShader->setInt("accumulation", ACCUMULATION_UNIT);
+	compositeShader->setInt("weight", WEIGHT_UNIT);
+	// the composite triangle is made from gl_VertexID
+	glGenVertexArrays(1, &emptyVAO);
+	createTargets();
+}
+
+WeightedBlendedOIT::~WeightedBlendedOIT() {
+	deleteTargets();
+	glDeleteVertexArrays(1, &emptyVAO);
+	glDeleteProgram(compositeShader->ID);
+	delete compositeShader;
+}
+
+static unsigned int createTexture(GLenum internalFormat, GLenum format, GLenum type, int width, int height) {
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return texture;
+}
+
+void WeightedBlendedOIT::createTargets() {
+	sceneColor = createTexture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, width, height);
+	accumulation = createTexture(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, width, height);
+	weight = createTexture(GL_R16F, GL_RED, GL_HALF_FLOAT, width, height);
+	glGenRenderbuffers(1, &depth);
+	glBindRenderbuffer(GL_RENDERBUFFER, depth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &sceneFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sceneColor, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cout << "ERROR::OIT::SCENE_FRAMEBUFFER_INCOMPLETE " << width << "x" << height << std::endl;
+	}
+
+	// same depth buffer, so transparent fragments behind opaque ones are rejected
+	glGenFramebuffers(1, &accumulationFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, accumulationFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accumulation, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, weight, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+	GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(2, drawBuffers);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cout << "ERROR::OIT::ACCUMULATION_FRAMEBUFFER_INCOMPLETE " << width << "x" << height << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void WeightedBlendedOIT::deleteTargets() {
+	glDeleteFramebuffers(1, &sceneFBO);
+	glDeleteFramebuffers(1, &accumulationFBO);
+	glDeleteTextures(1, &sceneColor);
+	glDeleteTextures(1, &accumulation);
+	glDeleteTextures(1, &weight);
+	glDeleteRenderbuffers(1, &depth);
+}
+
+void WeightedBlendedOIT::resize(int newWidth, int newHeight) {
+	// a minimized window reports 0 x 0
+	newWidth = std::max(newWidth, 1);
+	newHeight = std::max(newHeight, 1);
+	if (newWidth == width && newHeight == height) {
+		return;
+	}
+	width = newWidth;
+	height = newHeight;
+	deleteTargets();
+	createTargets();
+}
+
+void WeightedBlendedOIT::beginOpaque() {
+	glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+	glViewport(0, 0, width, height);
+	glEnable(GL_DEPTH_TEST);
+	glDepthMask(GL_TRUE);
+	glDisable(GL_BLEND);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void WeightedBlendedOIT::beginTransparent() {
+	glBindFramebuffer(GL_FRAMEBUFFER, accumulationFBO);
+	// nothing accumulated, everything revealed
+	const float clearAccumulation[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	const float clearWeight[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	glClearBufferfv(GL_COLOR, 0, clearAccumulation);
+	glClearBufferfv(GL_COLOR, 1, clearWeight);
+
+	glEnable(GL_DEPTH_TEST);
+	glDepthMask(GL_FALSE);
+	glEnable(GL_BLEND);
+	glBlendEquation(GL_FUNC_ADD);
+	glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void WeightedBlendedOIT::composite() {
+	glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+	glDisable(GL_DEPTH_TEST);
+	glDepthMask(GL_TRUE);
+	// the composite writes the average color with alpha = coverage
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	compositeShader->use();
+	glActiveTexture(GL_TEXTURE0 + ACCUMULATION_UNIT);
+	glBindTexture(GL_TEXTURE_2D, accumulation);
+	glActiveTexture(GL_TEXTURE0 + WEIGHT_UNIT);
+	glBindTexture(GL_TEXTURE_2D, weight);
+	glBindVertexArray(emptyVAO);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+	glActiveTexture(GL_TEXTURE0);
+
+	glDisable(GL_BLEND);
+	glEnable(GL_DEPTH_TEST);
+}
+
+void WeightedBlendedOIT::present(unsigned int outputFBO) {
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneFBO);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, outputFBO);
+	glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, outputFBO);
+}
+
+size_t WeightedBlendedOIT::getTargetBytes() const {
+	// RGBA8 + depth 24 (4 bytes as stored) + RGBA16F + R16F
+	return (size_t)width * height * (4 + 4 + 8 + 2);
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "../shader-lesson-1.4/Shader.h"
+
+// Weighted blended order-independent transparency (McGuire and Bavoil 2013).
+// Transparent surfaces are drawn in any order into two targets that share the
+// depth buffer of the opaque pass:
+//   accumulation RGBA16F  rgb += premultiplied color * weight, a *= 1 - alpha
+//   weight       R16F     r += alpha * weight
+// Both blend with (ONE, ONE) for color and (ZERO, ONE_MINUS_SRC_ALPHA) for
+// alpha, so it runs on 3.3 without per target blend functions. The weight falls
+// off with depth, which stands in for the order. A fullscreen pass then puts
+// the weighted average color over the opaque image with the total coverage
+// 1 - product(1 - alpha). Nothing is sorted, the CPU only issues the draws.
+class WeightedBlendedOIT {
+public:
+	// texture units the composite reads from
+	static const unsigned int ACCUMULATION_UNIT = 0;
+	static const unsigned int WEIGHT_UNIT = 1;
+
+	WeightedBlendedOIT(int width, int height, const char* compositeVertexPath = "../post-processing/post.vert",
+		const char* compositeFragmentPath = "../transparency/oit-composite.frag");
+	~WeightedBlendedOIT();
+
+	void resize(int width, int height);
+
+	// bind the scene target (RGBA8 + depth) and clear it, draw the opaque geometry after this
+	void beginOpaque();
+	// bind the accumulation targets with the scene depth, depth test on, depth writes off,
+	// blending set up; draw the transparent geometry in any order after this
+	void beginTransparent();
+	// blend the accumulated layers over the scene target
+	void composite();
+	// copy the scene target into outputFBO
+	void present(unsigned int outputFBO = 0);
+
+	// the scene target, for transparency drawn the usual way between beginOpaque and present
+	unsigned int getSceneFBO() const { return sceneFBO; }
+	// bytes of every target, the scene color and depth included
+	size_t getTargetBytes() const;
+
+private:
+	int width, height;
+	Shader* compositeShader;
+	unsigned int emptyVAO;
+
+	unsigned int sceneColor, depth, sceneFBO;
+	unsigned int accumulation, weight, accumulationFBO;
+
+	void createTargets();
+	void deleteTargets();
+};
\ No newline at end of file
@@ -0,0 +1,19 @@
+#version 330 core
+out vec4 FragColor;
+
+uniform sampler2D accumulation;
+uniform sampler2D weight;
+
+void main()
+{
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	vec4 sum = texelFetch(accumulation, pixel, 0);
+	// product of (1 - alpha) of every layer
+	float revealage = sum.a;
+	if (revealage >= 1.0f) {
+		discard;
+	}
+	// with enough layers both sums overflow the half floats, clamped they still give a finite average
+	vec3 average = min(sum.rgb, vec3(65504.0f)) / clamp(texelFetch(weight, pixel, 0).r, 1e-4f, 65504.0f);
+	FragColor = vec4(average, 1.0f - revealage);
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#version 330 core
+// WEIGHTED_BLENDED writes the two WeightedBlendedOIT targets, otherwise plain alpha blending
+#if defined(WEIGHTED_BLENDED)
+layout (location = 0) out vec4 Accumulation;
+layout (location = 1) out float Weight;
+#else
+out vec4 FragColor;
+#endif
+
+in vec2 TexCoord;
+in vec4 Color;
+in float ViewDepth;
+
+uniform sampler2D texture1;
+
+void main()
+{
+	vec4 color = texture(texture1, TexCoord) * Color;
+	if (color.a < 0.01f) {
+		discard;
+	}
+#if defined(WEIGHTED_BLENDED)
+	// near and opaque layers weigh more, equation 7 of the paper
+	float w = color.a * clamp(10.0f / (1e-5f + pow(ViewDepth / 5.0f, 2.0f) + pow(ViewDepth / 200.0f, 6.0f)), 1e-2f, 3e3f);
+	Accumulation = vec4(color.rgb * color.a * w, color.a);
+	Weight = color.a * w;
+#else
+	FragColor = color;
+#endif
+}
\ No newline at end of file
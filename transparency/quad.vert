@@ -0,0 +1,22 @@
+#version 330 core
+// camera facing quads: the corner comes from gl_VertexID, everything else is per instance
+layout (location = 0) in vec4 aPositionSize;
+layout (location = 1) in vec4 aColor;
+
+out vec2 TexCoord;
+out vec4 Color;
+out float ViewDepth;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+	vec2 corner = vec2(gl_VertexID & 1, (gl_VertexID >> 1) & 1);
+	vec4 viewPosition = view * vec4(aPositionSize.xyz, 1.0f);
+	viewPosition.xy += (corner - 0.5f) * aPositionSize.w;
+	gl_Position = projection * viewPosition;
+	TexCoord = corner;
+	Color = aColor;
+	ViewDepth = -viewPosition.z;
+}
\ No newline at end of file
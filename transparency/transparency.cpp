@@ -0,0 +1,417 @@
+// transparency demo: a cloud of translucent textured quads around a few opaque cubes, drawn
+// unsorted (wrong, for reference), sorted back to front on the CPU every frame, and with
+// weighted blended order-independent transparency that needs no sorting at all.
+// sweeps every quad count and mode first and prints the CPU and GPU times, then Q cycles the
+// quad count and M the mode.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../shader-lesson-1.4/Shader.h"
+#include "../geometry-heap/GeometryHeap.h"
+#include "WeightedBlendedOIT.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <std_image/stb_image.h>
+
+const unsigned int WIDTH = 800;
+const unsigned int HEIGHT = 600;
+
+const unsigned int QUAD_COUNTS[] = { 10000, 100000 };
+const unsigned int QUAD_COUNT_OPTIONS = sizeof(QUAD_COUNTS) / sizeof(QUAD_COUNTS[0]);
+const unsigned int MAX_QUADS = 100000;
+const unsigned int SWEEP_FRAMES = 120;
+
+enum Mode { MODE_UNSORTED, MODE_SORTED, MODE_WEIGHTED_BLENDED, MODE_COUNT };
+const char* MODE_NAMES[] = { "unsorted", "sorted", "weighted blended OIT" };
+
+// one translucent quad, what the instance buffer holds
+struct QuadInstance {
+	float position[3];
+	float size;
+	unsigned char color[4];
+};
+
+unsigned int quadOption = 0;
+Mode mode = MODE_UNSORTED;
+bool settingsChanged = true;
+int windowWidth = WIDTH;
+int windowHeight = HEIGHT;
+
+void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+unsigned int loadTexture(const char* path);
+void sortBackToFront(const std::vector<QuadInstance>& quads, unsigned int count, const glm::vec3& cameraPos,
+	const glm::vec3& forward, std::vector<uint64_t>& keys, std::vector<QuadInstance>& sorted);
+
+int main() {
+	// initialize GLFW
+	glfwInit();
+	// set version and core profile
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// create a window
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	// set callback to handle when window is resized
+	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+	glfwSetKeyCallback(window, keyCallback);
+
+	// initialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// no vsync, we want to see the frame time
+	glfwSwapInterval(0);
+
+	WeightedBlendedOIT* oit = new WeightedBlendedOIT(WIDTH, HEIGHT);
+	Shader* cubeShader = new Shader("../coordinate-systems-1.6/les1.6-vShader.vert",
+		"../coordinate-systems-1.6/les1.6-fShader.frag");
+	Shader* blendShader = new Shader("quad.vert", "quad.frag");
+	Shader* oitShader = new Shader("quad.vert", "quad.frag", NULL, "#define WEIGHTED_BLENDED\n");
+
+	// positions and texture coords
+	float vertices[] = {
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+	};
+
+	GeometryHeap* geometry = new GeometryHeap(1024, 0);
+	unsigned int cubeMesh = geometry->addMesh(vertices, 36);
+
+	stbi_set_flip_vertically_on_load(true);
+	unsigned int texture = loadTexture("../textures-lesson-1.5/container.jpg");
+	unsigned int texture2 = loadTexture("../textures-lesson-1.5/awesomeface.png");
+
+	// the cloud: random spots in a box, random tint and opacity
+	std::vector<QuadInstance> quads(MAX_QUADS);
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (QuadInstance& quad : quads) {
+		quad.position[0] = (unit(rng) - 0.5f) * 40.0f;
+		quad.position[1] = unit(rng) * 12.0f - 2.0f;
+		quad.position[2] = (unit(rng) - 0.5f) * 40.0f;
+		quad.size = 0.6f + unit(rng) * 0.8f;
+		quad.color[0] = (unsigned char)(128 + unit(rng) * 127);
+		quad.color[1] = (unsigned char)(128 + unit(rng) * 127);
+		quad.color[2] = (unsigned char)(128 + unit(rng) * 127);
+		quad.color[3] = (unsigned char)(50 + unit(rng) * 100);
+	}
+	std::vector<QuadInstance> sorted(MAX_QUADS);
+	std::vector<uint64_t> sortKeys;
+
+	// per instance attributes only, the corners come from gl_VertexID
+	unsigned int quadVAO, quadVBO;
+	glGenVertexArrays(1, &quadVAO);
+	glGenBuffers(1, &quadVBO);
+	glBindVertexArray(quadVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+	glBufferData(GL_ARRAY_BUFFER, MAX_QUADS * sizeof(QuadInstance), quads.data(), GL_STREAM_DRAW);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(QuadInstance), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribDivisor(0, 1);
+	glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(QuadInstance), (void*)(4 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glVertexAttribDivisor(1, 1);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	// the buffer holds the quads in creation order, sorting replaces that
+	bool bufferInCreationOrder = true;
+
+	unsigned int query;
+	glGenQueries(1, &query);
+
+	bool sweeping = true;
+	unsigned int sweepFrame = 0;
+	double lastReport = glfwGetTime();
+	double sortSum = 0.0, uploadSum = 0.0, submitSum = 0.0, gpuSum = 0.0;
+	unsigned int frames = 0;
+
+	// render loop
+	while (!glfwWindowShouldClose(window)) {
+		float time = (float)glfwGetTime();
+		unsigned int quadCount = QUAD_COUNTS[quadOption];
+		if (settingsChanged) {
+			sortSum = uploadSum = submitSum = gpuSum = 0.0;
+			frames = 0;
+			lastReport = glfwGetTime();
+			settingsChanged = false;
+		}
+		oit->resize(windowWidth, windowHeight);
+
+		float angle = time * 0.2f;
+		glm::vec3 cameraPos = glm::vec3(sin(angle) * 30.0f, 10.0f, cos(angle) * 30.0f);
+		glm::vec3 target = glm::vec3(0.0f, 2.0f, 0.0f);
+		glm::mat4 view = glm::lookAt(cameraPos, target, glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)windowWidth / std::max(windowHeight, 1),
+			0.1f, 100.0f);
+
+		// the camera moves every frame, so sorted blending has to sort and upload every frame
+		auto start = std::chrono::high_resolution_clock::now();
+		if (mode == MODE_SORTED) {
+			sortBackToFront(quads, quadCount, cameraPos, glm::normalize(target - cameraPos), sortKeys, sorted);
+			sortSum += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			start = std::chrono::high_resolution_clock::now();
+			glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+			glBufferData(GL_ARRAY_BUFFER, MAX_QUADS * sizeof(QuadInstance), NULL, GL_STREAM_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, quadCount * sizeof(QuadInstance), sorted.data());
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			uploadSum += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			bufferInCreationOrder = false;
+		}
+		else if (!bufferInCreationOrder) {
+			// back to the static buffer, once
+			glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+			glBufferData(GL_ARRAY_BUFFER, MAX_QUADS * sizeof(QuadInstance), quads.data(), GL_STREAM_DRAW);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			bufferInCreationOrder = true;
+		}
+
+		start = std::chrono::high_resolution_clock::now();
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		oit->beginOpaque();
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		// a ring of opaque cubes the cloud goes around and through
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, texture2);
+		cubeShader->use();
+		cubeShader->setInt("texture1", 0);
+		cubeShader->setInt("texture2", 1);
+		cubeShader->setFloat("percentage", 0.2f);
+		cubeShader->setMat4("view", view);
+		cubeShader->setMat4("projection", projection);
+		geometry->bind();
+		for (int i = 0; i < 12; ++i) {
+			float cubeAngle = 6.2831853f * i / 12;
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(sin(cubeAngle) * 10.0f, 1.0f, cos(cubeAngle) * 10.0f));
+			model = glm::scale(model, glm::vec3(3.0f));
+			cubeShader->setMat4("model", model);
+			geometry->draw(cubeMesh);
+		}
+
+		// the cloud, every quad a textured billboard
+		Shader* quadShader = mode == MODE_WEIGHTED_BLENDED ? oitShader : blendShader;
+		if (mode == MODE_WEIGHTED_BLENDED) {
+			oit->beginTransparent();
+		}
+		else {
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			glDepthMask(GL_FALSE);
+		}
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture2);
+		quadShader->use();
+		quadShader->setInt("texture1", 0);
+		quadShader->setMat4("view", view);
+		quadShader->setMat4("projection", projection);
+		glBindVertexArray(quadVAO);
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, quadCount);
+		glBindVertexArray(0);
+		if (mode == MODE_WEIGHTED_BLENDED) {
+			oit->composite();
+		}
+		else {
+			glDepthMask(GL_TRUE);
+			glDisable(GL_BLEND);
+		}
+		oit->present();
+		glEndQuery(GL_TIME_ELAPSED);
+		submitSum += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		geometry->endFrame();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		GLuint64 gpuTime = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &gpuTime);
+		gpuSum += gpuTime / 1000000.0;
+		++frames;
+
+		// the sweep steps through every quad count and mode, then hands over to the keys
+		bool report = sweeping ? ++sweepFrame % SWEEP_FRAMES == 0 : glfwGetTime() - lastReport > 1.0;
+		if (report) {
+			std::cout << "TRANSPARENCY::quads " << quadCount << " | " << MODE_NAMES[mode]
+				<< " | sort " << sortSum / frames << " ms"
+				<< " | upload " << uploadSum / frames << " ms"
+				<< " | submit " << submitSum / frames << " ms"
+				<< " | GPU " << gpuSum / frames << " ms" << std::endl;
+			sortSum = uploadSum = submitSum = gpuSum = 0.0;
+			frames = 0;
+			lastReport = glfwGetTime();
+		}
+		if (sweeping && report) {
+			mode = (Mode)(mode + 1);
+			if (mode == MODE_COUNT) {
+				mode = MODE_UNSORTED;
+				++quadOption;
+			}
+			if (quadOption == QUAD_COUNT_OPTIONS) {
+				quadOption = QUAD_COUNT_OPTIONS - 1;
+				mode = MODE_WEIGHTED_BLENDED;
+				sweeping = false;
+			}
+			settingsChanged = true;
+		}
+	}
+
+	// deallocate objects
+	glDeleteQueries(1, &query);
+	glDeleteVertexArrays(1, &quadVAO);
+	glDeleteBuffers(1, &quadVBO);
+	delete geometry;
+	glDeleteTextures(1, &texture);
+	glDeleteTextures(1, &texture2);
+	glDeleteProgram(cubeShader->ID);
+	glDeleteProgram(blendShader->ID);
+	glDeleteProgram(oitShader->ID);
+	delete cubeShader;
+	delete blendShader;
+	delete oitShader;
+	delete oit;
+
+	glfwTerminate();
+	return 0;
+}
+
+// float bits that sort like the floats when compared as unsigned integers
+static uint32_t sortableBits(float value) {
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+// what sorted alpha blending pays every frame: a depth key per quad, a sort and a gather
+void sortBackToFront(const std::vector<QuadInstance>& quads, unsigned int count, const glm::vec3& cameraPos,
+	const glm::vec3& forward, std::vector<uint64_t>& keys, std::vector<QuadInstance>& sorted) {
+	keys.resize(count);
+	for (unsigned int i = 0; i < count; ++i) {
+		const QuadInstance& quad = quads[i];
+		float depth = (quad.position[0] - cameraPos.x) * forward.x + (quad.position[1] - cameraPos.y) * forward.y
+			+ (quad.position[2] - cameraPos.z) * forward.z;
+		// farthest first: inverted depth in the high bits, the index in the low ones
+		keys[i] = (uint64_t)(~sortableBits(depth)) << 32 | i;
+	}
+	std::sort(keys.begin(), keys.end());
+	for (unsigned int i = 0; i < count; ++i) {
+		sorted[i] = quads[(uint32_t)keys[i]];
+	}
+}
+
+// whenever the window is resized this function gets called
+void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+	windowWidth = width;
+	windowHeight = height;
+}
+
+// react to key presses
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	if (action != GLFW_PRESS) {
+		return;
+	}
+	if (key == GLFW_KEY_ESCAPE) {
+		glfwSetWindowShouldClose(window, true);
+	}
+	if (key == GLFW_KEY_Q) {
+		quadOption = (quadOption + 1) % QUAD_COUNT_OPTIONS;
+		settingsChanged = true;
+	}
+	if (key == GLFW_KEY_M) {
+		mode = (Mode)((mode + 1) % MODE_COUNT);
+		settingsChanged = true;
+	}
+}
+
+// load an image into a mipmapped texture
+unsigned int loadTexture(const char* path) {
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width, height, nrChannels;
+	unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 4);
+	if (data) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else {
+		std::cout << "Failed to load texture" << std::endl;
+	}
+
+	stbi_image_free(data);
+	return texture;
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "GreedyMesher.h"
+
+void GreedyMesher::mesh(const unsigned short* padded, std::vector<unsigned int>& vertices, unsigned int& faceCount) {
+	const int stride[3] = { 1, PADDED_SIZE, PADDED_SIZE * PADDED_SIZE };
+	unsigned short mask[CHUNK_SIZE * CHUNK_SIZE];
+	faceCount = 0;
+
+	for (int d = 0; d < 3; ++d) {
+		// u, v span the slice, u x v = d so corners in u, v order wind counter clockwise seen from +d
+		int u = (d + 1) % 3;
+		int v = (d + 2) % 3;
+
+		for (int direction = 1; direction >= -1; direction -= 2) {
+			unsigned int normal = d * 2 + (direction < 0 ? 1 : 0);
+			int neighbourOffset = direction * stride[d];
+
+			for (int layer = 0; layer < CHUNK_SIZE; ++layer) {
+				// faces of this layer that look into air
+				int x[3];
+				x[d] = layer;
+				for (int j = 0; j < CHUNK_SIZE; ++j) {
+					x[v] = j;
+					for (int i = 0; i < CHUNK_SIZE; ++i) {
+						x[u] = i;
+						int index = paddedIndex(x[0], x[1], x[2]);
+						unsigned short block = padded[index];
+						bool exposed = block != 0 && padded[index + neighbourOffset] == 0;
+						mask[j * CHUNK_SIZE + i] = exposed ? block : 0;
+						faceCount += exposed ? 1 : 0;
+					}
+				}
+
+				// grow each face right, then down while the whole row matches
+				int plane = direction > 0 ? layer + 1 : layer;
+				for (int j = 0; j < CHUNK_SIZE; ++j) {
+					for (int i = 0; i < CHUNK_SIZE; ++i) {
+						unsigned short block = mask[j * CHUNK_SIZE + i];
+						if (block == 0) {
+							continue;
+						}
+
+						int width = 1;
+						while (i + width < CHUNK_SIZE && mask[j * CHUNK_SIZE + i + width] == block) {
+							++width;
+						}
+						int height = 1;
+						for (; j + height < CHUNK_SIZE; ++height) {
+							const unsigned short* row = mask + (j + height) * CHUNK_SIZE + i;
+							int k = 0;
+							while (k < width && row[k] == block) {
+								++k;
+							}
+							if (k < width) {
+								break;
+							}
+						}
+						for (int h = 0; h < height; ++h) {
+							for (int k = 0; k < width; ++k) {
+								mask[(j + h) * CHUNK_SIZE + i + k] = 0;
+							}
+						}
+
+						int corners[4][3];
+						for (int c = 0; c < 4; ++c) {
+							corners[c][d] = plane;
+							corners[c][u] = i;
+							corners[c][v] = j;
+						}
+						corners[1][u] += width;
+						corners[2][u] += width;
+						corners[2][v] += height;
+						corners[3][v] += height;
+
+						// back faces wind the other way round
+						const int forward[4] = { 0, 1, 2, 3 };
+						const int backward[4] = { 0, 3, 2, 1 };
+						const int* order = direction > 0 ? forward : backward;
+						for (int c = 0; c < 4; ++c) {
+							const int* corner = corners[order[c]];
+							vertices.push_back(packVertex(corner[0], corner[1], corner[2], normal, block));
+						}
+						i += width - 1;
+					}
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
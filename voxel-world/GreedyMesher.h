@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+
+// Greedy meshing of one 32^3 voxel chunk. Faces between a solid block and air
+// are collected slice by slice and merged into the largest rectangles of the
+// same block type, so a flat field of blocks becomes a handful of quads.
+//
+// vertex format, one 32 bit word: x, y, z (6 bits each, 0..32 inside the
+// chunk), normal (3 bits, +x -x +y -y +z -z) and block type (11 bits).
+// 4 vertices per quad, drawn with a shared 0 1 2 2 3 0 index pattern.
+class GreedyMesher {
+public:
+	static const int CHUNK_SIZE = 32;
+	// chunk plus one block of its neighbours on every side
+	static const int PADDED_SIZE = CHUNK_SIZE + 2;
+	static const int PADDED_VOLUME = PADDED_SIZE * PADDED_SIZE * PADDED_SIZE;
+	// a checkerboard: every other block solid, every face exposed
+	static const unsigned int MAX_QUADS = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE / 2 * 6;
+
+	static int paddedIndex(int x, int y, int z) {
+		return (x + 1) + (y + 1) * PADDED_SIZE + (z + 1) * PADDED_SIZE * PADDED_SIZE;
+	}
+
+	// padded holds block types (0 = air), appends 4 vertices per quad.
+	// faceCount is the number of exposed block faces before merging
+	static void mesh(const unsigned short* padded, std::vector<unsigned int>& vertices, unsigned int& faceCount);
+
+	static unsigned int packVertex(int x, int y, int z, unsigned int normal, unsigned int block) {
+		return (unsigned int)x | (unsigned int)y << 6 | (unsigned int)z << 12 | normal << 18 | block << 21;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,575 @@
+#include "VoxelWorld.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "../frustum/Frustum.h"
+
+// block types generateTerrain uses
+const unsigned short STONE = 1;
+const unsigned short DIRT = 2;
+const unsigned short GRASS = 3;
+const unsigned short SAND = 4;
+
+const unsigned int INVALID_RANGE = OffsetAllocator::INVALID_OFFSET;
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// smallest index width that holds the palette and divides 64
+static unsigned int bitsFor(size_t paletteSize) {
+	unsigned int bits = 0;
+	while (((size_t)1 << bits) < paletteSize) {
+		bits = bits == 0 ? 1 : bits * 2;
+	}
+	return bits;
+}
+
+unsigned short VoxelChunk::get(unsigned int index) const {
+	if (bits == 0) {
+		return palette[0];
+	}
+	unsigned int perWord = 64 / bits;
+	unsigned long long word = data[index / perWord];
+	unsigned int shift = (index % perWord) * bits;
+	return palette[(word >> shift) & ((1ull << bits) - 1)];
+}
+
+void VoxelChunk::set(unsigned int index, unsigned short block) {
+	if (get(index) == block) {
+		return;
+	}
+
+	unsigned int entry = 0;
+	while (entry < palette.size() && palette[entry] != block) {
+		++entry;
+	}
+	if (entry == palette.size()) {
+		palette.push_back(block);
+		unsigned int needed = bitsFor(palette.size());
+		if (needed > bits) {
+			setBits(needed);
+		}
+	}
+
+	unsigned int perWord = 64 / bits;
+	unsigned long long& word = data[index / perWord];
+	unsigned int shift = (index % perWord) * bits;
+	unsigned long long mask = ((1ull << bits) - 1) << shift;
+	word = (word & ~mask) | ((unsigned long long)entry << shift);
+}
+
+void VoxelChunk::pack(const unsigned short* blocks) {
+	palette.clear();
+	palette.push_back(blocks[0]);
+	// runs of the same block are the common case, remember the last lookup
+	std::vector<unsigned char> entries(VoxelWorld::CHUNK_VOLUME);
+	unsigned short lastBlock = blocks[0];
+	unsigned int lastEntry = 0;
+	bool wide = false;
+	for (int i = 0; i < VoxelWorld::CHUNK_VOLUME; ++i) {
+		if (blocks[i] != lastBlock) {
+			lastBlock = blocks[i];
+			lastEntry = 0;
+			while (lastEntry < palette.size() && palette[lastEntry] != lastBlock) {
+				++lastEntry;
+			}
+			if (lastEntry == palette.size()) {
+				palette.push_back(lastBlock);
+			}
+			wide = wide || lastEntry > 255;
+		}
+		entries[i] = (unsigned char)lastEntry;
+	}
+
+	if (wide) {
+		// more than 256 types in one chunk, rare enough to go the slow way
+		bits = 0;
+		data.clear();
+		std::vector<unsigned short> copy(blocks, blocks + VoxelWorld::CHUNK_VOLUME);
+		palette.assign(1, copy[0]);
+		for (int i = 0; i < VoxelWorld::CHUNK_VOLUME; ++i) {
+			set(i, copy[i]);
+		}
+		return;
+	}
+
+	bits = bitsFor(palette.size());
+	data.assign(bits == 0 ? 0 : VoxelWorld::CHUNK_VOLUME * bits / 64, 0);
+	if (bits > 0) {
+		unsigned int perWord = 64 / bits;
+		for (int i = 0; i < VoxelWorld::CHUNK_VOLUME; ++i) {
+			data[i / perWord] |= (unsigned long long)entries[i] << ((i % perWord) * bits);
+		}
+	}
+}
+
+void VoxelChunk::unpack(unsigned short* blocks) const {
+	if (bits == 0) {
+		std::fill(blocks, blocks + VoxelWorld::CHUNK_VOLUME, palette[0]);
+		return;
+	}
+	unsigned int perWord = 64 / bits;
+	unsigned long long mask = (1ull << bits) - 1;
+	for (size_t w = 0; w < data.size(); ++w) {
+		unsigned long long word = data[w];
+		for (unsigned int i = 0; i < perWord; ++i) {
+			blocks[w * perWord + i] = palette[(word >> (i * bits)) & mask];
+		}
+	}
+}
+
+void VoxelChunk::setBits(unsigned int newBits) {
+	std::vector<unsigned long long> old;
+	old.swap(data);
+	unsigned int oldBits = bits;
+	bits = newBits;
+	data.assign(VoxelWorld::CHUNK_VOLUME * bits / 64, 0);
+	if (oldBits == 0) {
+		// every block was entry 0, which is all zero bits
+		return;
+	}
+
+	unsigned int oldPerWord = 64 / oldBits;
+	unsigned int perWord = 64 / bits;
+	unsigned long long oldMask = (1ull << oldBits) - 1;
+	for (int i = 0; i < VoxelWorld::CHUNK_VOLUME; ++i) {
+		unsigned long long entry = (old[i / oldPerWord] >> ((i % oldPerWord) * oldBits)) & oldMask;
+		data[i / perWord] |= entry << ((i % perWord) * bits);
+	}
+}
+
+VoxelWorld::VoxelWorld(int chunksX, int chunksY, int chunksZ, ThreadPool& pool, bool uploadToGPU)
+	: chunksX(chunksX), chunksY(chunksY), chunksZ(chunksZ), pool(pool), uploadToGPU(uploadToGPU),
+	threadCount(pool.getConcurrency()), VAO(0), VBO(0), EBO(0), vertexAllocator(0),
+	meshedChunks(0), meshTime(0.0), chunkMeshTime(0.0), uploadTime(0.0), drawnChunks(0), drawnTriangles(0) {
+	chunks.resize((size_t)chunksX * chunksY * chunksZ);
+	for (VoxelChunk& chunk : chunks) {
+		chunk.palette.assign(1, 0);
+		chunk.bits = 0;
+		chunk.dirty = false;
+		chunk.vertexOffset = INVALID_RANGE;
+		chunk.quadCount = 0;
+		chunk.faceCount = 0;
+		chunk.solidCount = 0;
+		chunk.meshTime = 0.0;
+	}
+
+	if (!uploadToGPU) {
+		return;
+	}
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
+
+	// every chunk draws from the start of one 0 1 2 2 3 0 pattern, offset by its base vertex
+	std::vector<unsigned int> indices(GreedyMesher::MAX_QUADS * 6);
+	for (unsigned int quad = 0; quad < GreedyMesher::MAX_QUADS; ++quad) {
+		const unsigned int pattern[6] = { 0, 1, 2, 2, 3, 0 };
+		for (int i = 0; i < 6; ++i) {
+			indices[quad * 6 + i] = quad * 4 + pattern[i];
+		}
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+	glBufferData(GL_COPY_WRITE_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	growVertexBuffer(1024 * 1024);
+}
+
+VoxelWorld::~VoxelWorld() {
+	if (uploadToGPU) {
+		glDeleteVertexArrays(1, &VAO);
+		glDeleteBuffers(1, &VBO);
+		glDeleteBuffers(1, &EBO);
+	}
+}
+
+unsigned short VoxelWorld::getBlock(int x, int y, int z) const {
+	glm::ivec3 size = getSizeInBlocks();
+	if (x < 0 || y < 0 || z < 0 || x >= size.x || y >= size.y || z >= size.z) {
+		return 0;
+	}
+	const VoxelChunk& chunk = chunks[chunkIndex(x / CHUNK_SIZE, y / CHUNK_SIZE, z / CHUNK_SIZE)];
+	return chunk.get((x % CHUNK_SIZE) + (y % CHUNK_SIZE) * CHUNK_SIZE + (z % CHUNK_SIZE) * CHUNK_SIZE * CHUNK_SIZE);
+}
+
+void VoxelWorld::setBlock(int x, int y, int z, unsigned short block) {
+	glm::ivec3 size = getSizeInBlocks();
+	if (x < 0 || y < 0 || z < 0 || x >= size.x || y >= size.y || z >= size.z) {
+		return;
+	}
+
+	int cx = x / CHUNK_SIZE, cy = y / CHUNK_SIZE, cz = z / CHUNK_SIZE;
+	int lx = x % CHUNK_SIZE, ly = y % CHUNK_SIZE, lz = z % CHUNK_SIZE;
+	VoxelChunk& chunk = chunks[chunkIndex(cx, cy, cz)];
+	unsigned int index = lx + ly * CHUNK_SIZE + lz * CHUNK_SIZE * CHUNK_SIZE;
+	if (chunk.get(index) == block) {
+		return;
+	}
+	chunk.set(index, block);
+
+	// the neighbour's face on the shared side may appear or disappear too
+	markDirty(cx, cy, cz);
+	if (lx == 0) markDirty(cx - 1, cy, cz);
+	if (lx == CHUNK_SIZE - 1) markDirty(cx + 1, cy, cz);
+	if (ly == 0) markDirty(cx, cy - 1, cz);
+	if (ly == CHUNK_SIZE - 1) markDirty(cx, cy + 1, cz);
+	if (lz == 0) markDirty(cx, cy, cz - 1);
+	if (lz == CHUNK_SIZE - 1) markDirty(cx, cy, cz + 1);
+}
+
+void VoxelWorld::generateTerrain(unsigned int seed) {
+	glm::ivec3 size = getSizeInBlocks();
+	float phase = seed * 0.7f;
+	float scale = size.y / 512.0f;
+	int seaLevel = (int)(size.y * 0.3f);
+
+	// one chunk column per job: heights once, then every chunk above them
+	pool.parallelFor(chunksX * chunksZ, 1, [&](unsigned int begin, unsigned int end) {
+		std::vector<unsigned short> blocks(CHUNK_VOLUME);
+		int heights[CHUNK_SIZE * CHUNK_SIZE];
+		for (unsigned int column = begin; column < end; ++column) {
+			int cx = column % chunksX;
+			int cz = column / chunksX;
+			for (int lz = 0; lz < CHUNK_SIZE; ++lz) {
+				for (int lx = 0; lx < CHUNK_SIZE; ++lx) {
+					float x = (float)(cx * CHUNK_SIZE + lx);
+					float z = (float)(cz * CHUNK_SIZE + lz);
+					float height = size.y * 0.35f
+						+ scale * 60.0f * std::sin(x * 0.011f + phase) * std::cos(z * 0.013f - phase)
+						+ scale * 20.0f * std::sin(x * 0.037f + z * 0.029f + phase * 2.0f)
+						+ 5.0f * std::sin(x * 0.13f) * std::sin(z * 0.11f + phase);
+					heights[lz * CHUNK_SIZE + lx] = std::max(1, std::min(size.y - 1, (int)height));
+				}
+			}
+
+			for (int cy = 0; cy < chunksY; ++cy) {
+				for (int lz = 0; lz < CHUNK_SIZE; ++lz) {
+					for (int ly = 0; ly < CHUNK_SIZE; ++ly) {
+						int y = cy * CHUNK_SIZE + ly;
+						unsigned short* row = &blocks[ly * CHUNK_SIZE + lz * CHUNK_SIZE * CHUNK_SIZE];
+						for (int lx = 0; lx < CHUNK_SIZE; ++lx) {
+							int height = heights[lz * CHUNK_SIZE + lx];
+							unsigned short block = 0;
+							if (y < height - 4) {
+								block = STONE;
+							}
+							else if (y < height) {
+								block = DIRT;
+							}
+							else if (y == height) {
+								block = height <= seaLevel ? SAND : GRASS;
+							}
+							row[lx] = block;
+						}
+					}
+				}
+				VoxelChunk& chunk = chunks[chunkIndex(cx, cy, cz)];
+				chunk.pack(blocks.data());
+				chunk.dirty = true;
+			}
+		}
+	});
+}
+
+int VoxelWorld::surfaceHeight(int x, int z) const {
+	for (int y = getSizeInBlocks().y - 1; y >= 0; --y) {
+		if (getBlock(x, y, z) != 0) {
+			return y;
+		}
+	}
+	return -1;
+}
+
+void VoxelWorld::update() {
+	meshedChunks = 0;
+	meshTime = 0.0;
+	chunkMeshTime = 0.0;
+	uploadTime = 0.0;
+
+	dirtyList.clear();
+	for (unsigned int i = 0; i < chunks.size(); ++i) {
+		if (chunks[i].dirty) {
+			dirtyList.push_back(i);
+		}
+	}
+	if (dirtyList.empty()) {
+		return;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// a few jobs per thread, chunks near the surface take much longer than empty ones
+	unsigned int count = (unsigned int)dirtyList.size();
+	unsigned int threads = std::max(1u, std::min(threadCount, pool.getConcurrency()));
+	unsigned int grain = threads == 1 ? count : std::max(1u, count / (threads * 4));
+	pool.parallelFor(count, grain, [this](unsigned int begin, unsigned int end) {
+		std::vector<unsigned short> padded(GreedyMesher::PADDED_VOLUME);
+		std::vector<unsigned short> blocks(CHUNK_VOLUME);
+		for (unsigned int i = begin; i < end; ++i) {
+			auto chunkStart = std::chrono::high_resolution_clock::now();
+			unsigned int index = dirtyList[i];
+			VoxelChunk& chunk = chunks[index];
+			int cx = index % chunksX;
+			int cy = (index / chunksX) % chunksY;
+			int cz = index / (chunksX * chunksY);
+
+			chunk.vertices.clear();
+			chunk.faceCount = 0;
+			chunk.solidCount = 0;
+			if (chunk.bits == 0) {
+				// one type all over: all air has no faces, all solid only where a neighbour is open
+				chunk.solidCount = chunk.palette[0] != 0 ? CHUNK_VOLUME : 0;
+				if (chunk.solidCount > 0 && !buried(cx, cy, cz)) {
+					fillPadded(cx, cy, cz, padded.data(), blocks.data());
+					GreedyMesher::mesh(padded.data(), chunk.vertices, chunk.faceCount);
+				}
+			}
+			else {
+				fillPadded(cx, cy, cz, padded.data(), blocks.data());
+				GreedyMesher::mesh(padded.data(), chunk.vertices, chunk.faceCount);
+				for (int block = 0; block < CHUNK_VOLUME; ++block) {
+					chunk.solidCount += blocks[block] != 0 ? 1 : 0;
+				}
+			}
+			chunk.quadCount = (unsigned int)chunk.vertices.size() / 4;
+			chunk.dirty = false;
+			chunk.meshTime = elapsedMs(chunkStart);
+		}
+	});
+	meshTime = elapsedMs(start);
+	meshedChunks = count;
+
+	start = std::chrono::high_resolution_clock::now();
+	for (unsigned int index : dirtyList) {
+		VoxelChunk& chunk = chunks[index];
+		chunkMeshTime += chunk.meshTime;
+		if (uploadToGPU) {
+			upload(chunk);
+		}
+		// only the GPU copy is kept
+		std::vector<unsigned int>().swap(chunk.vertices);
+	}
+	uploadTime = elapsedMs(start);
+}
+
+void VoxelWorld::draw(Shader& shader, const glm::mat4& viewProjection) {
+	drawnChunks = 0;
+	drawnTriangles = 0;
+	if (!uploadToGPU) {
+		return;
+	}
+
+	glm::vec4 planes[6];
+	frustumPlanes(viewProjection, planes);
+
+	int originLocation = glGetUniformLocation(shader.ID, "chunkOrigin");
+	const float radius = CHUNK_SIZE * 0.8661f; // half diagonal
+	glBindVertexArray(VAO);
+	for (int cz = 0; cz < chunksZ; ++cz) {
+		for (int cy = 0; cy < chunksY; ++cy) {
+			for (int cx = 0; cx < chunksX; ++cx) {
+				const VoxelChunk& chunk = chunks[chunkIndex(cx, cy, cz)];
+				if (chunk.quadCount == 0 || chunk.vertexOffset == INVALID_RANGE) {
+					continue;
+				}
+
+				glm::vec3 origin = glm::vec3(cx, cy, cz) * (float)CHUNK_SIZE;
+				glm::vec3 center = origin + glm::vec3(CHUNK_SIZE * 0.5f);
+				if (!sphereVisible(planes, center, radius)) {
+					continue;
+				}
+
+				glUniform3f(originLocation, origin.x, origin.y, origin.z);
+				glDrawElementsBaseVertex(GL_TRIANGLES, chunk.quadCount * 6, GL_UNSIGNED_INT, (void*)0, chunk.vertexOffset);
+				++drawnChunks;
+				drawnTriangles += chunk.quadCount * 2;
+			}
+		}
+	}
+	glBindVertexArray(0);
+}
+
+void VoxelWorld::markAllDirty() {
+	for (VoxelChunk& chunk : chunks) {
+		chunk.dirty = true;
+	}
+}
+
+unsigned long long VoxelWorld::getSolidBlocks() const {
+	unsigned long long count = 0;
+	for (const VoxelChunk& chunk : chunks) {
+		count += chunk.solidCount;
+	}
+	return count;
+}
+
+unsigned long long VoxelWorld::getExposedFaces() const {
+	unsigned long long count = 0;
+	for (const VoxelChunk& chunk : chunks) {
+		count += chunk.faceCount;
+	}
+	return count;
+}
+
+unsigned long long VoxelWorld::getQuads() const {
+	unsigned long long count = 0;
+	for (const VoxelChunk& chunk : chunks) {
+		count += chunk.quadCount;
+	}
+	return count;
+}
+
+size_t VoxelWorld::getBlockMemory() const {
+	size_t bytes = 0;
+	for (const VoxelChunk& chunk : chunks) {
+		bytes += chunk.memoryBytes();
+	}
+	return bytes;
+}
+
+void VoxelWorld::printStats() const {
+	glm::ivec3 size = getSizeInBlocks();
+	unsigned long long solid = getSolidBlocks();
+	unsigned long long faces = getExposedFaces();
+	unsigned long long quads = getQuads();
+	std::cout << "VOXELWORLD::" << size.x << "x" << size.y << "x" << size.z
+		<< " | chunks " << chunks.size()
+		<< " | solid blocks " << solid
+		<< " | block memory " << getBlockMemory() / (1024.0 * 1024.0) << " MB"
+		<< " (dense " << (double)size.x * size.y * size.z * sizeof(unsigned short) / (1024.0 * 1024.0) << " MB)"
+		<< " | triangles: cubes " << solid * 12
+		<< ", culled faces " << faces * 2
+		<< ", greedy " << quads * 2
+		<< " | mesh memory " << quads * 4 * sizeof(unsigned int) / (1024.0 * 1024.0) << " MB" << std::endl;
+}
+
+void VoxelWorld::markDirty(int cx, int cy, int cz) {
+	if (cx < 0 || cy < 0 || cz < 0 || cx >= chunksX || cy >= chunksY || cz >= chunksZ) {
+		return;
+	}
+	chunks[chunkIndex(cx, cy, cz)].dirty = true;
+}
+
+bool VoxelWorld::buried(int cx, int cy, int cz) const {
+	const int offsets[6][3] = { { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+	for (int n = 0; n < 6; ++n) {
+		int nx = cx + offsets[n][0], ny = cy + offsets[n][1], nz = cz + offsets[n][2];
+		if (nx < 0 || ny < 0 || nz < 0 || nx >= chunksX || ny >= chunksY || nz >= chunksZ) {
+			return false;
+		}
+		const VoxelChunk& neighbour = chunks[chunkIndex(nx, ny, nz)];
+		if (neighbour.bits != 0 || neighbour.palette[0] == 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void VoxelWorld::fillPadded(int cx, int cy, int cz, unsigned short* padded, unsigned short* blocks) const {
+	std::memset(padded, 0, GreedyMesher::PADDED_VOLUME * sizeof(unsigned short));
+
+	// interior, unpacked whole words at a time and then moved into place row by row
+	chunks[chunkIndex(cx, cy, cz)].unpack(blocks);
+	for (int z = 0; z < CHUNK_SIZE; ++z) {
+		for (int y = 0; y < CHUNK_SIZE; ++y) {
+			std::memcpy(&padded[GreedyMesher::paddedIndex(0, y, z)], &blocks[y * CHUNK_SIZE + z * CHUNK_SIZE * CHUNK_SIZE],
+				CHUNK_SIZE * sizeof(unsigned short));
+		}
+	}
+
+	// the one layer of each face neighbour that touches this chunk
+	const int offsets[6][3] = { { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+	for (int n = 0; n < 6; ++n) {
+		int nx = cx + offsets[n][0], ny = cy + offsets[n][1], nz = cz + offsets[n][2];
+		if (nx < 0 || ny < 0 || nz < 0 || nx >= chunksX || ny >= chunksY || nz >= chunksZ) {
+			continue;
+		}
+		const VoxelChunk& neighbour = chunks[chunkIndex(nx, ny, nz)];
+		int axis = offsets[n][0] != 0 ? 0 : (offsets[n][1] != 0 ? 1 : 2);
+		int side = offsets[n][axis] < 0 ? CHUNK_SIZE - 1 : 0; // layer read from the neighbour
+		int target = offsets[n][axis] < 0 ? -1 : CHUNK_SIZE;  // where it goes in the padded block
+		for (int j = 0; j < CHUNK_SIZE; ++j) {
+			for (int i = 0; i < CHUNK_SIZE; ++i) {
+				int local[3], padPos[3];
+				local[axis] = side;
+				padPos[axis] = target;
+				local[(axis + 1) % 3] = padPos[(axis + 1) % 3] = i;
+				local[(axis + 2) % 3] = padPos[(axis + 2) % 3] = j;
+				padded[GreedyMesher::paddedIndex(padPos[0], padPos[1], padPos[2])] =
+					neighbour.get(local[0] + local[1] * CHUNK_SIZE + local[2] * CHUNK_SIZE * CHUNK_SIZE);
+			}
+		}
+	}
+}
+
+void VoxelWorld::upload(VoxelChunk& chunk) {
+	if (chunk.vertexOffset != INVALID_RANGE) {
+		vertexAllocator.free(chunk.vertexOffset);
+		chunk.vertexOffset = INVALID_RANGE;
+	}
+	unsigned int vertexCount = (unsigned int)chunk.vertices.size();
+	if (vertexCount == 0) {
+		return;
+	}
+
+	chunk.vertexOffset = vertexAllocator.allocate(vertexCount);
+	if (chunk.vertexOffset == INVALID_RANGE) {
+		growVertexBuffer(vertexAllocator.getSize() + vertexCount);
+		chunk.vertexOffset = vertexAllocator.allocate(vertexCount);
+	}
+
+	// upload through the copy target so the VAO bindings stay untouched
+	glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)chunk.vertexOffset * sizeof(unsigned int),
+		(GLsizeiptr)vertexCount * sizeof(unsigned int), chunk.vertices.data());
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void VoxelWorld::growVertexBuffer(unsigned int minimumCapacity) {
+	unsigned int oldCapacity = vertexAllocator.getSize();
+	unsigned int capacity = std::max(oldCapacity * 2, minimumCapacity);
+
+	unsigned int newVBO;
+	glGenBuffers(1, &newVBO);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newVBO);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity * sizeof(unsigned int), NULL, GL_STATIC_DRAW);
+	// meshes keep their offsets, copy everything on the GPU
+	if (oldCapacity > 0) {
+		glBindBuffer(GL_COPY_READ_BUFFER, VBO);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)oldCapacity * sizeof(unsigned int));
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	if (VBO) {
+		glDeleteBuffers(1, &VBO);
+	}
+	VBO = newVBO;
+	if (oldCapacity == 0) {
+		vertexAllocator.reset(capacity);
+	}
+	else {
+		vertexAllocator.grow(capacity);
+	}
+	setupVertexArray();
+}
+
+void VoxelWorld::setupVertexArray() {
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+	// one packed word per vertex, read as an integer
+	glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(unsigned int), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "../geometry-heap/OffsetAllocator.h"
+#include "../shader-lesson-1.4/Shader.h"
+#include "../thread-pool/ThreadPool.h"
+#include "GreedyMesher.h"
+
+// 32^3 blocks, palette compressed: every block stores an index into the
+// chunk's own list of block types, packed into as few bits as the list needs.
+// a chunk of one type (all air, all stone) stores no indices at all
+struct VoxelChunk {
+	std::vector<unsigned short> palette;
+	std::vector<unsigned long long> data;
+	unsigned int bits; // 0, 1, 2, 4, 8 or 16, never straddles a word
+	bool dirty;
+
+	// mesh, vertices only live here until uploaded
+	std::vector<unsigned int> vertices;
+	unsigned int vertexOffset;
+	unsigned int quadCount;
+	unsigned int faceCount;
+	unsigned int solidCount;
+	double meshTime;
+
+	unsigned short get(unsigned int index) const;
+	void set(unsigned int index, unsigned short block);
+	// replace the whole chunk from 32^3 block types, x fastest
+	void pack(const unsigned short* blocks);
+	void unpack(unsigned short* blocks) const;
+	size_t memoryBytes() const { return palette.size() * sizeof(unsigned short) + data.size() * sizeof(unsigned long long); }
+
+private:
+	void setBits(unsigned int newBits);
+};
+
+// Grid of palette compressed chunks. Edits mark the touched chunk (and the
+// neighbour sharing the face) dirty; update() greedy meshes every dirty chunk
+// in parallel on the thread pool and uploads the results into one shared
+// vertex buffer, ranges handed out by an OffsetAllocator.
+class VoxelWorld {
+public:
+	static const int CHUNK_SIZE = GreedyMesher::CHUNK_SIZE;
+	static const int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+	// size in chunks. uploadToGPU = false keeps everything on the CPU (benchmarks)
+	VoxelWorld(int chunksX, int chunksY, int chunksZ, ThreadPool& pool, bool uploadToGPU = true);
+	~VoxelWorld();
+
+	// 0 = air, block types 1..2047
+	unsigned short getBlock(int x, int y, int z) const;
+	void setBlock(int x, int y, int z, unsigned short block);
+	// fills every chunk with rolling hills: stone, dirt, grass on top, sand low down
+	void generateTerrain(unsigned int seed);
+	// height of the highest solid block in a column, -1 for none
+	int surfaceHeight(int x, int z) const;
+
+	// mesh and upload every dirty chunk
+	void update();
+	// draw the chunks inside the frustum, shader needs chunkOrigin, view and projection set
+	void draw(Shader& shader, const glm::mat4& viewProjection);
+
+	void setThreadCount(unsigned int threads) { threadCount = threads; }
+	void markAllDirty();
+
+	glm::ivec3 getSizeInBlocks() const { return glm::ivec3(chunksX * CHUNK_SIZE, chunksY * CHUNK_SIZE, chunksZ * CHUNK_SIZE); }
+	// stats of the last update
+	unsigned int getMeshedChunks() const { return meshedChunks; }
+	double getMeshTime() const { return meshTime; }       // wall clock, ms
+	double getChunkMeshTime() const { return chunkMeshTime; } // summed over the chunks, ms
+	double getUploadTime() const { return uploadTime; }
+	// whole world
+	unsigned long long getSolidBlocks() const;
+	unsigned long long getExposedFaces() const;
+	unsigned long long getQuads() const;
+	size_t getBlockMemory() const;
+	// last draw
+	unsigned int getDrawnChunks() const { return drawnChunks; }
+	unsigned long long getDrawnTriangles() const { return drawnTriangles; }
+	void printStats() const;
+
+private:
+	int chunksX, chunksY, chunksZ;
+	std::vector<VoxelChunk> chunks;
+	ThreadPool& pool;
+	bool uploadToGPU;
+	unsigned int threadCount;
+
+	unsigned int VAO, VBO, EBO;
+	OffsetAllocator vertexAllocator;
+	std::vector<unsigned int> dirtyList;
+
+	unsigned int meshedChunks;
+	double meshTime;
+	double chunkMeshTime;
+	double uploadTime;
+	unsigned int drawnChunks;
+	unsigned long long drawnTriangles;
+
+	int chunkIndex(int cx, int cy, int cz) const { return cx + cy * chunksX + cz * chunksX * chunksY; }
+	void markDirty(int cx, int cy, int cz);
+	// solid chunk with solid chunks all around, nothing of it can be seen
+	bool buried(int cx, int cy, int cz) const;
+	// chunk plus the face layers of its neighbours, air outside the world.
+	// blocks is CHUNK_VOLUME scratch
+	void fillPadded(int cx, int cy, int cz, unsigned short* padded, unsigned short* blocks) const;
+	void upload(VoxelChunk& chunk);
+	void growVertexBuffer(unsigned int minimumCapacity);
+	void setupVertexArray();
+};
\ No newline at end of file
@@ -0,0 +1,68 @@
+// voxel meshing benchmark, runs without a GL context
+// 512^3 terrain: full mesh on 1 and N threads, then remeshing after small edits
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "VoxelWorld.h"
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int main() {
+	const int WORLD_CHUNKS = 16; // 512 blocks
+	const int EDITS = 100;
+	const int EDIT_RADIUS = 4;
+
+	ThreadPool& pool = ThreadPool::global();
+	VoxelWorld world(WORLD_CHUNKS, WORLD_CHUNKS, WORLD_CHUNKS, pool, false);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	world.generateTerrain(1);
+	std::cout << "threads available: " << pool.getConcurrency() << std::endl;
+	std::cout << "generate " << elapsedMs(start) << " ms" << std::endl;
+
+	const unsigned int threadCounts[] = { 1, pool.getConcurrency() };
+	for (unsigned int threads : threadCounts) {
+		world.setThreadCount(threads);
+		world.markAllDirty();
+		world.update();
+		std::cout << "full mesh, " << threads << " thread(s): " << world.getMeshTime() << " ms"
+			<< " | " << world.getMeshedChunks() << " chunks"
+			<< " | " << world.getChunkMeshTime() / world.getMeshedChunks() * 1000.0 << " us/chunk average" << std::endl;
+	}
+	world.printStats();
+
+	// dig spheres at random spots on the surface, only the chunks they touch are remeshed
+	std::mt19937 rng(7);
+	glm::ivec3 size = world.getSizeInBlocks();
+	std::uniform_int_distribution<int> pickX(EDIT_RADIUS, size.x - EDIT_RADIUS - 1);
+	std::uniform_int_distribution<int> pickZ(EDIT_RADIUS, size.z - EDIT_RADIUS - 1);
+	double editTime = 0.0, remeshTime = 0.0;
+	unsigned int remeshed = 0;
+	for (int edit = 0; edit < EDITS; ++edit) {
+		int cx = pickX(rng), cz = pickZ(rng);
+		int cy = world.surfaceHeight(cx, cz);
+
+		start = std::chrono::high_resolution_clock::now();
+		for (int z = -EDIT_RADIUS; z <= EDIT_RADIUS; ++z) {
+			for (int y = -EDIT_RADIUS; y <= EDIT_RADIUS; ++y) {
+				for (int x = -EDIT_RADIUS; x <= EDIT_RADIUS; ++x) {
+					if (x * x + y * y + z * z <= EDIT_RADIUS * EDIT_RADIUS) {
+						world.setBlock(cx + x, cy + y, cz + z, 0);
+					}
+				}
+			}
+		}
+		editTime += elapsedMs(start);
+
+		world.update();
+		remeshTime += world.getMeshTime();
+		remeshed += world.getMeshedChunks();
+	}
+	std::cout << EDITS << " edits (radius " << EDIT_RADIUS << "): set blocks " << editTime / EDITS << " ms"
+		<< " | remesh " << remeshTime / EDITS << " ms for " << (double)remeshed / EDITS << " chunks/edit" << std::endl;
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,230 @@
+// voxel world demo: rolling terrain of a few million blocks, greedy meshed per 32^3 chunk
+// usage: voxel-world [chunks per side], 16 = 512^3 blocks
+// prints the meshing stats once and the frame time every second, E digs holes and remeshes
+// only the chunks they touch
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../shader-lesson-1.4/Shader.h"
+#include "VoxelWorld.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <std_image/stb_image.h>
+
+const unsigned int WIDTH = 800;
+const unsigned int HEIGHT = 600;
+const int EDIT_RADIUS = 6;
+
+bool digRequested = false;
+int windowWidth = WIDTH;
+int windowHeight = HEIGHT;
+
+void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+unsigned int loadTexture(const char* path);
+
+int main(int argc, char** argv) {
+	int worldChunks = argc > 1 ? std::stoi(argv[1]) : 16;
+
+	// initialize GLFW
+	glfwInit();
+	// set version and core profile
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// create a window
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	// set callback to handle when window is resized
+	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+	glfwSetKeyCallback(window, keyCallback);
+
+	// initialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// no vsync, we want to see the frame time
+	glfwSwapInterval(0);
+
+	Shader shader("voxel.vert", "voxel.frag");
+
+	stbi_set_flip_vertically_on_load(true);
+	unsigned int texture = loadTexture("../textures-lesson-1.5/container.jpg");
+
+	shader.use();
+	shader.setInt("texture1", 0);
+	shader.setVec3("blockColors[0]", glm::vec3(1.0f, 0.0f, 1.0f));
+	shader.setVec3("blockColors[1]", glm::vec3(0.55f, 0.55f, 0.6f)); // stone
+	shader.setVec3("blockColors[2]", glm::vec3(0.6f, 0.42f, 0.25f)); // dirt
+	shader.setVec3("blockColors[3]", glm::vec3(0.35f, 0.75f, 0.3f)); // grass
+	shader.setVec3("blockColors[4]", glm::vec3(0.95f, 0.88f, 0.6f)); // sand
+	shader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.4f, -1.0f, -0.3f)));
+
+	// generate and mesh everything up front
+	ThreadPool& pool = ThreadPool::global();
+	VoxelWorld* world = new VoxelWorld(worldChunks, worldChunks, worldChunks, pool);
+	auto start = std::chrono::high_resolution_clock::now();
+	world->generateTerrain(1);
+	double generateTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	world->update();
+	std::cout << "VOXELWORLD::generate " << generateTime << " ms"
+		<< " | mesh " << world->getMeshTime() << " ms on " << pool.getConcurrency() << " threads"
+		<< " (" << world->getChunkMeshTime() / world->getMeshedChunks() * 1000.0 << " us/chunk)"
+		<< " | upload " << world->getUploadTime() << " ms" << std::endl;
+	world->printStats();
+
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+
+	glm::ivec3 size = world->getSizeInBlocks();
+	glm::vec3 center = glm::vec3(size.x * 0.5f, size.y * 0.35f, size.z * 0.5f);
+	std::mt19937 rng(7);
+
+	double lastFrame = glfwGetTime();
+	double lastReport = lastFrame;
+	double frameSum = 0.0;
+	unsigned long long triangleSum = 0;
+	unsigned int chunkSum = 0;
+	unsigned int frames = 0;
+
+	// render loop
+	while (!glfwWindowShouldClose(window)) {
+		float time = (float)glfwGetTime();
+
+		// dig holes where the camera is looking, only the touched chunks get remeshed
+		if (digRequested) {
+			std::uniform_int_distribution<int> pick(-size.x / 4, size.x / 4);
+			for (int hole = 0; hole < 10; ++hole) {
+				int cx = (int)center.x + pick(rng);
+				int cz = (int)center.z + pick(rng);
+				int cy = world->surfaceHeight(cx, cz);
+				for (int z = -EDIT_RADIUS; z <= EDIT_RADIUS; ++z) {
+					for (int y = -EDIT_RADIUS; y <= EDIT_RADIUS; ++y) {
+						for (int x = -EDIT_RADIUS; x <= EDIT_RADIUS; ++x) {
+							if (x * x + y * y + z * z <= EDIT_RADIUS * EDIT_RADIUS) {
+								world->setBlock(cx + x, cy + y, cz + z, 0);
+							}
+						}
+					}
+				}
+			}
+			world->update();
+			std::cout << "VOXELWORLD::dig 10 holes | remeshed " << world->getMeshedChunks() << " chunks in "
+				<< world->getMeshTime() << " ms | upload " << world->getUploadTime() << " ms" << std::endl;
+			digRequested = false;
+		}
+
+		// clear screen
+		glClearColor(0.55f, 0.7f, 0.9f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture);
+
+		// camera circles high above the terrain
+		float radius = size.x * 0.6f;
+		glm::vec3 cameraPos = center + glm::vec3(sin(time * 0.05f) * radius, size.y * 0.35f, cos(time * 0.05f) * radius);
+		glm::mat4 view = glm::lookAt(cameraPos, center, glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)windowWidth / (float)windowHeight, 1.0f, size.x * 2.0f);
+		shader.use();
+		shader.setMat4("view", view);
+		shader.setMat4("projection", projection);
+		world->draw(shader, projection * view);
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		double now = glfwGetTime();
+		frameSum += (now - lastFrame) * 1000.0;
+		lastFrame = now;
+		triangleSum += world->getDrawnTriangles();
+		chunkSum += world->getDrawnChunks();
+		++frames;
+		if (now - lastReport > 1.0) {
+			std::cout << "VOXELWORLD::frame " << frameSum / frames << " ms"
+				<< " | chunks drawn " << chunkSum / frames
+				<< " | triangles " << triangleSum / frames << std::endl;
+			frameSum = 0.0;
+			triangleSum = 0;
+			chunkSum = 0;
+			frames = 0;
+			lastReport = now;
+		}
+	}
+
+	// deallocate objects
+	delete world;
+	glDeleteTextures(1, &texture);
+
+	glfwTerminate();
+	return 0;
+}
+
+// whenever the window is resized this function gets called
+void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+	// tell OpenGL the size of the window
+	glViewport(0, 0, width, height);
+	windowWidth = width;
+	windowHeight = height;
+}
+
+// react to key presses
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	if (action != GLFW_PRESS) {
+		return;
+	}
+	if (key == GLFW_KEY_ESCAPE) {
+		glfwSetWindowShouldClose(window, true);
+	}
+	if (key == GLFW_KEY_E) {
+		digRequested = true;
+	}
+}
+
+// load an image into a mipmapped texture
+unsigned int loadTexture(const char* path) {
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width, height, nrChannels;
+	unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 4);
+	if (data) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else {
+		std::cout << "Failed to load texture" << std::endl;
+	}
+
+	stbi_image_free(data);
+	return texture;
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec3 Normal;
+flat in uint Block;
+
+uniform sampler2D texture1;
+uniform vec3 blockColors[8];
+uniform vec3 lightDirection;
+
+void main()
+{
+	float light = 0.35 + 0.65 * max(dot(Normal, -lightDirection), 0.0);
+	vec3 color = texture(texture1, TexCoord).rgb * blockColors[min(Block, 7u)];
+	FragColor = vec4(color * light, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#version 330 core
+// x, y, z: 6 bits each, normal: 3 bits, block type: 11 bits (see GreedyMesher.h)
+layout (location = 0) in uint aPacked;
+
+out vec2 TexCoord;
+out vec3 Normal;
+flat out uint Block;
+
+uniform vec3 chunkOrigin;
+uniform mat4 view;
+uniform mat4 projection;
+
+const vec3 NORMALS[6] = vec3[6](
+	vec3(1.0, 0.0, 0.0), vec3(-1.0, 0.0, 0.0),
+	vec3(0.0, 1.0, 0.0), vec3(0.0, -1.0, 0.0),
+	vec3(0.0, 0.0, 1.0), vec3(0.0, 0.0, -1.0));
+
+void main()
+{
+	vec3 local = vec3(float(aPacked & 63u), float((aPacked >> 6) & 63u), float((aPacked >> 12) & 63u));
+	uint normal = (aPacked >> 18) & 7u;
+	vec3 position = chunkOrigin + local;
+
+	// merged quads span several blocks, the texture repeats once per block
+	uint axis = normal / 2u;
+	TexCoord = axis == 0u ? position.zy : (axis == 1u ? position.xz : position.xy);
+	Normal = NORMALS[normal];
+	Block = aPacked >> 21;
+	gl_Position = projection * view * vec4(position, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,524 @@
+#include "WorldStreamer.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#include "../frustum/Frustum.h"
+
+// file layout: header, one table entry per cell (x fastest), then the instances of every cell
+struct WorldFileHeader {
+	char magic[4]; // "WCEL"
+	unsigned int version;
+	int cellsX, cellsZ;
+	float cellSize;
+	float minY, maxY;
+	unsigned int reserved;
+};
+
+struct WorldFileCell {
+	unsigned long long offset; // bytes from the start of the file
+	unsigned int instanceCount;
+	unsigned int reserved;
+};
+
+static const unsigned int WORLD_FILE_VERSION = 1;
+static const unsigned int INVALID_RANGE = OffsetAllocator::INVALID_OFFSET;
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+bool WorldStreamer::writeWorld(const char* path, int cellsX, int cellsZ, float cellSize,
+	unsigned int cubesPerCell, unsigned int seed) {
+	std::FILE* out = std::fopen(path, "wb");
+	if (!out) {
+		std::cout << "ERROR::WORLDSTREAMER::WRITE_FAILED " << path << std::endl;
+		return false;
+	}
+
+	// dense and sparse areas, so some cells cost far more than others
+	std::vector<WorldFileCell> table(cellsX * cellsZ);
+	unsigned long long offset = sizeof(WorldFileHeader) + table.size() * sizeof(WorldFileCell);
+	for (int cz = 0; cz < cellsZ; ++cz) {
+		for (int cx = 0; cx < cellsX; ++cx) {
+			float density = 0.5f + 0.5f * std::sin(cx * 0.7f) * std::cos(cz * 0.45f);
+			WorldFileCell& entry = table[cz * cellsX + cx];
+			entry.offset = offset;
+			entry.instanceCount = (unsigned int)(cubesPerCell * (0.25f + 1.5f * density));
+			entry.reserved = 0;
+			offset += entry.instanceCount * sizeof(Instance);
+		}
+	}
+
+	WorldFileHeader header;
+	std::memcpy(header.magic, "WCEL", 4);
+	header.version = WORLD_FILE_VERSION;
+	header.cellsX = cellsX;
+	header.cellsZ = cellsZ;
+	header.cellSize = cellSize;
+	header.minY = 1e30f;
+	header.maxY = -1e30f;
+	header.reserved = 0;
+	std::fwrite(&header, sizeof(header), 1, out);
+	std::fwrite(table.data(), sizeof(WorldFileCell), table.size(), out);
+
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<Instance> instances;
+	for (int cz = 0; cz < cellsZ; ++cz) {
+		for (int cx = 0; cx < cellsX; ++cx) {
+			instances.resize(table[cz * cellsX + cx].instanceCount);
+			for (Instance& instance : instances) {
+				float x = (cx + unit(rng)) * cellSize;
+				float z = (cz + unit(rng)) * cellSize;
+				// rolling ground with cubes scattered above it
+				float ground = 4.0f * std::sin(x * 0.02f) * std::cos(z * 0.03f);
+				instance.position[0] = x;
+				instance.position[1] = ground + unit(rng) * unit(rng) * 24.0f;
+				instance.position[2] = z;
+				instance.angle = unit(rng) * 360.0f;
+				instance.scale = 0.5f + unit(rng) * 1.5f;
+				// the half diagonal of the biggest cube still fits in this
+				header.minY = std::min(header.minY, instance.position[1] - instance.scale);
+				header.maxY = std::max(header.maxY, instance.position[1] + instance.scale);
+			}
+			std::fwrite(instances.data(), sizeof(Instance), instances.size(), out);
+		}
+	}
+
+	// the height range is only known now
+	std::fseek(out, 0, SEEK_SET);
+	std::fwrite(&header, sizeof(header), 1, out);
+	bool ok = std::ferror(out) == 0;
+	std::fclose(out);
+	if (!ok) {
+		std::cout << "ERROR::WORLDSTREAMER::WRITE_FAILED " << path << std::endl;
+	}
+	return ok;
+}
+
+WorldStreamer::WorldStreamer(const float* meshVertices, unsigned int meshVertexCount, unsigned int vertexCapacity,
+	unsigned int workerCount)
+	: cellsX(0), cellsZ(0), cellSize(1.0f), minY(0.0f), maxY(0.0f), lastCamera(0.0f),
+	vertexAllocator(vertexCapacity), inFlight(0), quit(false),
+	residentCells(0), pendingCells(0), updateTime(0.0), frameUploadedVertices(0), missingCells(0), drawnCells(0) {
+	settings.loadRadius = 160.0f;
+	settings.unloadRadius = 200.0f;
+	settings.prefetchSeconds = 1.5f;
+	settings.uploadBudgetMs = 2.0;
+	settings.async = true;
+	mesh.assign(meshVertices, meshVertices + meshVertexCount * VERTEX_FLOATS);
+	resetStats();
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCapacity * VERTEX_FLOATS * sizeof(float), NULL, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	for (unsigned int i = 0; i < std::max(1u, workerCount); ++i) {
+		workers.push_back(std::thread(&WorldStreamer::workerLoop, this));
+	}
+}
+
+WorldStreamer::~WorldStreamer() {
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		quit = true;
+	}
+	queueCondition.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+}
+
+bool WorldStreamer::open(const char* path) {
+	unloadAll();
+	cells.clear();
+	if (!file.open(path)) {
+		return false;
+	}
+
+	const WorldFileHeader* header = (const WorldFileHeader*)file.data();
+	if (file.size() < sizeof(WorldFileHeader) || std::memcmp(header->magic, "WCEL", 4) != 0
+		|| header->version != WORLD_FILE_VERSION) {
+		std::cout << "ERROR::WORLDSTREAMER::NOT_A_WORLD_FILE " << path << std::endl;
+		file.close();
+		return false;
+	}
+	size_t cellCount = (size_t)header->cellsX * header->cellsZ;
+	const WorldFileCell* table = (const WorldFileCell*)(file.data() + sizeof(WorldFileHeader));
+	if (file.size() < sizeof(WorldFileHeader) + cellCount * sizeof(WorldFileCell)) {
+		std::cout << "ERROR::WORLDSTREAMER::TRUNCATED " << path << std::endl;
+		file.close();
+		return false;
+	}
+
+	cellsX = header->cellsX;
+	cellsZ = header->cellsZ;
+	cellSize = header->cellSize;
+	minY = header->minY;
+	maxY = header->maxY;
+	cells.resize(cellCount);
+	for (size_t i = 0; i < cellCount; ++i) {
+		Cell& cell = cells[i];
+		cell.state = STATE_UNLOADED;
+		cell.cancelled = false;
+		cell.priority = 0.0f;
+		cell.fileOffset = table[i].offset;
+		cell.instanceCount = table[i].instanceCount;
+		if (cell.fileOffset + (unsigned long long)cell.instanceCount * sizeof(Instance) > file.size()) {
+			std::cout << "ERROR::WORLDSTREAMER::TRUNCATED " << path << std::endl;
+			cell.instanceCount = 0;
+		}
+		cell.vertexOffset = INVALID_RANGE;
+		cell.vertexCount = 0;
+		cell.uploadedVertices = 0;
+		cell.min = cell.max = glm::vec3(0.0f);
+	}
+	// room for every cell in the scratch lists
+	wanted.reserve(cellCount);
+	uploading.reserve(cellCount);
+	finished.reserve(cellCount);
+	ready.reserve(cellCount);
+	return true;
+}
+
+glm::vec2 WorldStreamer::cellCenter(unsigned int index) const {
+	return (glm::vec2((float)(index % cellsX), (float)(index / cellsX)) + glm::vec2(0.5f)) * cellSize;
+}
+
+void WorldStreamer::update(const glm::vec3& cameraPos, const glm::vec3& velocity) {
+	auto start = std::chrono::high_resolution_clock::now();
+	lastCamera = cameraPos;
+	frameUploadedVertices = 0;
+	++updates;
+
+	// take back what no worker has started, it is queued again below in the new order.
+	// anything still marked queued after that is on a worker
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		for (unsigned int index : loadQueue) {
+			cells[index].state = STATE_UNLOADED;
+		}
+		loadQueue.clear();
+		ready.swap(finished);
+	}
+	for (Loaded& loaded : ready) {
+		accept(loaded);
+	}
+	ready.clear();
+
+	// distance to the camera, or to where it is heading when that is closer
+	glm::vec2 camera(cameraPos.x, cameraPos.z);
+	glm::vec2 ahead = camera + glm::vec2(velocity.x, velocity.z) * settings.prefetchSeconds;
+	wanted.clear();
+	uploading.clear();
+	pendingCells = 0;
+	for (unsigned int index = 0; index < cells.size(); ++index) {
+		Cell& cell = cells[index];
+		if (cell.state == STATE_QUEUED) {
+			cell.state = STATE_LOADING;
+		}
+		glm::vec2 center = cellCenter(index);
+		cell.priority = std::min(glm::distance(center, camera), glm::distance(center, ahead));
+
+		if (cell.priority > settings.unloadRadius) {
+			if (cell.state != STATE_UNLOADED) {
+				unloadCell(cell);
+			}
+			continue;
+		}
+		if (cell.state == STATE_LOADING) {
+			// wanted again before the worker was done
+			cell.cancelled = false;
+		}
+		if (cell.state == STATE_UNLOADED && cell.priority < settings.loadRadius) {
+			wanted.push_back(index);
+		}
+		if (cell.state == STATE_LOADED) {
+			uploading.push_back(index);
+		}
+	}
+
+	// nearest first, and the ones on the way before the ones left behind
+	auto nearer = [this](unsigned int a, unsigned int b) { return cells[a].priority < cells[b].priority; };
+	std::sort(wanted.begin(), wanted.end(), nearer);
+	if (settings.async) {
+		if (!wanted.empty()) {
+			std::lock_guard<std::mutex> lock(queueMutex);
+			for (unsigned int index : wanted) {
+				cells[index].state = STATE_QUEUED;
+				loadQueue.push_back(index);
+			}
+		}
+		queueCondition.notify_all();
+	}
+	else {
+		// all of it right here, the way a loader without streaming would
+		for (unsigned int index : wanted) {
+			Loaded loaded;
+			loaded.cell = index;
+			loadCell(index, loaded);
+			cells[index].state = STATE_LOADING;
+			accept(loaded);
+			uploading.push_back(index);
+		}
+	}
+
+	// a slice at least every update, then only while there is budget left
+	std::sort(uploading.begin(), uploading.end(), nearer);
+	double elapsed = 0.0;
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	for (unsigned int index : uploading) {
+		Cell& cell = cells[index];
+		if (settings.uploadBudgetMs > 0.0 && elapsed >= settings.uploadBudgetMs) {
+			break;
+		}
+		if (cell.vertexOffset == INVALID_RANGE && cell.vertexCount > 0) {
+			cell.vertexOffset = vertexAllocator.allocate(cell.vertexCount);
+			if (cell.vertexOffset == INVALID_RANGE) {
+				// stays loaded and tries again once cells behind the camera are gone
+				++allocationFailures;
+				continue;
+			}
+		}
+		if (uploadCell(cell, settings.uploadBudgetMs, elapsed)) {
+			cell.state = STATE_RESIDENT;
+			++residentCells;
+			// only the GPU copy is kept
+			std::vector<float>().swap(cell.vertices);
+		}
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	for (const Cell& cell : cells) {
+		if (cell.state == STATE_QUEUED || cell.state == STATE_LOADING || cell.state == STATE_LOADED) {
+			++pendingCells;
+		}
+	}
+	updateTime = elapsedMs(start);
+	maxUpdateTime = std::max(maxUpdateTime, updateTime);
+}
+
+void WorldStreamer::accept(Loaded& loaded) {
+	Cell& cell = cells[loaded.cell];
+	// still queued when it was picked up and finished between two updates
+	if (cell.state != STATE_LOADING && cell.state != STATE_QUEUED) {
+		return;
+	}
+	if (cell.cancelled) {
+		// the camera moved away while it was loading
+		cell.cancelled = false;
+		cell.state = STATE_UNLOADED;
+		++cancels;
+		return;
+	}
+	cell.vertices.swap(loaded.vertices);
+	cell.vertexCount = (unsigned int)(cell.vertices.size() / VERTEX_FLOATS);
+	cell.uploadedVertices = 0;
+	cell.min = loaded.min;
+	cell.max = loaded.max;
+	cell.state = STATE_LOADED;
+	loadTimeSum += loaded.loadTime;
+	++loads;
+}
+
+bool WorldStreamer::uploadCell(Cell& cell, double budgetMs, double& elapsed) {
+	while (cell.uploadedVertices < cell.vertexCount) {
+		if (budgetMs > 0.0 && elapsed >= budgetMs) {
+			return false;
+		}
+		auto start = std::chrono::high_resolution_clock::now();
+		unsigned int count = std::min(SLICE_VERTICES, cell.vertexCount - cell.uploadedVertices);
+		glBufferSubData(GL_ARRAY_BUFFER,
+			(GLintptr)(cell.vertexOffset + cell.uploadedVertices) * VERTEX_FLOATS * sizeof(float),
+			(GLsizeiptr)count * VERTEX_FLOATS * sizeof(float),
+			cell.vertices.data() + (size_t)cell.uploadedVertices * VERTEX_FLOATS);
+		cell.uploadedVertices += count;
+		frameUploadedVertices += count;
+		uploadedBytes += (unsigned long long)count * VERTEX_FLOATS * sizeof(float);
+		elapsed += elapsedMs(start);
+	}
+	return true;
+}
+
+void WorldStreamer::unloadCell(Cell& cell) {
+	if (cell.state == STATE_LOADING) {
+		// the worker finishes it, the result is thrown away
+		cell.cancelled = true;
+		return;
+	}
+	if (cell.vertexOffset != INVALID_RANGE) {
+		vertexAllocator.free(cell.vertexOffset);
+		cell.vertexOffset = INVALID_RANGE;
+	}
+	if (cell.state == STATE_RESIDENT) {
+		--residentCells;
+	}
+	if (cell.state == STATE_LOADED || cell.state == STATE_RESIDENT) {
+		++unloads;
+	}
+	std::vector<float>().swap(cell.vertices);
+	cell.vertexCount = 0;
+	cell.uploadedVertices = 0;
+	cell.state = STATE_UNLOADED;
+}
+
+void WorldStreamer::unloadAll() {
+	{
+		std::unique_lock<std::mutex> lock(queueMutex);
+		for (unsigned int index : loadQueue) {
+			cells[index].state = STATE_UNLOADED;
+		}
+		loadQueue.clear();
+		idleCondition.wait(lock, [this] { return inFlight == 0; });
+		finished.clear();
+	}
+	for (Cell& cell : cells) {
+		if (cell.state == STATE_QUEUED || cell.state == STATE_LOADING) {
+			cell.state = STATE_UNLOADED;
+		}
+		cell.cancelled = false;
+		unloadCell(cell);
+	}
+	pendingCells = 0;
+}
+
+void WorldStreamer::draw(const glm::mat4& viewProjection) {
+	drawnCells = 0;
+	missingCells = 0;
+
+	glm::vec4 planes[6];
+	frustumPlanes(viewProjection, planes);
+	// a cell this close is all inside the load radius, it should be there
+	float nearRadius = settings.loadRadius - cellSize * 0.7072f;
+	glm::vec2 camera(lastCamera.x, lastCamera.z);
+
+	glBindVertexArray(VAO);
+	for (unsigned int index = 0; index < cells.size(); ++index) {
+		const Cell& cell = cells[index];
+		if (cell.state != STATE_RESIDENT) {
+			glm::vec2 center = cellCenter(index);
+			glm::vec3 min(center.x - cellSize * 0.5f, minY, center.y - cellSize * 0.5f);
+			glm::vec3 max(center.x + cellSize * 0.5f, maxY, center.y + cellSize * 0.5f);
+			if (cell.instanceCount > 0 && glm::distance(center, camera) < nearRadius
+				&& boxVisible(planes, min, max)) {
+				++missingCells;
+			}
+			continue;
+		}
+		if (cell.vertexCount == 0 || !boxVisible(planes, cell.min, cell.max)) {
+			continue;
+		}
+		glDrawArrays(GL_TRIANGLES, cell.vertexOffset, cell.vertexCount);
+		++drawnCells;
+	}
+	glBindVertexArray(0);
+	missingSum += missingCells;
+}
+
+void WorldStreamer::workerLoop() {
+	while (true) {
+		unsigned int index;
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueCondition.wait(lock, [this] { return quit || !loadQueue.empty(); });
+			if (quit) {
+				return;
+			}
+			index = loadQueue.front();
+			loadQueue.pop_front();
+			++inFlight;
+		}
+
+		Loaded loaded;
+		loaded.cell = index;
+		loadCell(index, loaded);
+
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			finished.push_back(std::move(loaded));
+			--inFlight;
+		}
+		idleCondition.notify_all();
+	}
+}
+
+void WorldStreamer::loadCell(unsigned int index, Loaded& loaded) const {
+	auto start = std::chrono::high_resolution_clock::now();
+	// only the table fields are read here, they do not change after open()
+	const Cell& cell = cells[index];
+	// the pages of the file come in here, on whichever thread loads the cell
+	const Instance* instances = (const Instance*)(file.data() + cell.fileOffset);
+	unsigned int meshVertexCount = (unsigned int)(mesh.size() / VERTEX_FLOATS);
+
+	loaded.vertices.resize((size_t)cell.instanceCount * meshVertexCount * VERTEX_FLOATS);
+	loaded.min = glm::vec3(1e30f);
+	loaded.max = glm::vec3(-1e30f);
+	float* out = loaded.vertices.data();
+	for (unsigned int i = 0; i < cell.instanceCount; ++i) {
+		const Instance& instance = instances[i];
+		glm::mat4 model = glm::translate(glm::mat4(1.0f),
+			glm::vec3(instance.position[0], instance.position[1], instance.position[2]));
+		model = glm::rotate(model, glm::radians(instance.angle), glm::vec3(1.0f, 0.3f, 0.5f));
+		model = glm::scale(model, glm::vec3(instance.scale));
+		for (unsigned int v = 0; v < meshVertexCount; ++v) {
+			const float* source = &mesh[v * VERTEX_FLOATS];
+			glm::vec3 position = glm::vec3(model * glm::vec4(source[0], source[1], source[2], 1.0f));
+			loaded.min = glm::min(loaded.min, position);
+			loaded.max = glm::max(loaded.max, position);
+			out[0] = position.x;
+			out[1] = position.y;
+			out[2] = position.z;
+			out[3] = source[3];
+			out[4] = source[4];
+			out += VERTEX_FLOATS;
+		}
+	}
+	if (cell.instanceCount == 0) {
+		loaded.min = loaded.max = glm::vec3(0.0f);
+	}
+	loaded.loadTime = elapsedMs(start);
+}
+
+void WorldStreamer::resetStats() {
+	updates = 0;
+	loads = unloads = cancels = allocationFailures = 0;
+	uploadedBytes = 0;
+	loadTimeSum = maxUpdateTime = 0.0;
+	missingSum = 0;
+}
+
+void WorldStreamer::printStats() const {
+	std::cout << "WORLDSTREAMER::cells " << cellsX << "x" << cellsZ << " of " << cellSize
+		<< " | resident " << residentCells
+		<< " | loads " << loads << " (" << (loads > 0 ? loadTimeSum / loads : 0.0) << " ms each)"
+		<< " | unloads " << unloads
+		<< " | wasted loads " << cancels
+		<< " | uploaded " << uploadedBytes / (1024.0 * 1024.0) << " MB"
+		<< " | slowest update " << maxUpdateTime << " ms"
+		<< " | missing cells " << (updates > 0 ? (double)missingSum / updates : 0.0) << "/frame"
+		<< " | buffer " << vertexAllocator.getUsed() * (VERTEX_FLOATS * sizeof(float)) / (1024.0 * 1024.0)
+		<< " of " << vertexAllocator.getSize() * (VERTEX_FLOATS * sizeof(float)) / (1024.0 * 1024.0) << " MB";
+	if (allocationFailures > 0) {
+		std::cout << " | buffer full " << allocationFailures << " times";
+	}
+	std::cout << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../geometry-heap/OffsetAllocator.h"
+#include "../mesh-import/MappedFile.h"
+
+// Streams a large static world in and out around the camera.
+// The world is a grid of square cells on the XZ plane stored in one file: a
+// header, a table with the instance range of every cell, then the instances
+// (position, rotation, scale of one mesh). The file is mapped, never read as
+// a whole. Cells within the load radius of the camera, or of where it will be
+// prefetchSeconds from now, are queued nearest first; workers transform their
+// instances into world space vertices, which the main thread uploads in slices
+// into one shared vertex buffer until the per frame budget is used up. Cells
+// are dropped past the unload radius. A cell is drawn once all of it is up.
+class WorldStreamer {
+public:
+	// position + texture coords, same as the GeometryHeap vertex format
+	static constexpr unsigned int VERTEX_FLOATS = 5;
+	// vertices per glBufferSubData, the budget is checked between slices
+	static constexpr unsigned int SLICE_VERTICES = 4096;
+
+	// one instance on disk
+	struct Instance {
+		float position[3];
+		float angle; // degrees, around (1, 0.3, 0.5) like the camera-1.7 cubes
+		float scale;
+	};
+
+	struct Settings {
+		float loadRadius;      // cells with their center closer than this are loaded
+		float unloadRadius;    // and dropped again once they are further than this
+		float prefetchSeconds; // look ahead along the velocity, 0 = camera position only
+		double uploadBudgetMs; // per update, 0 = upload whatever is ready
+		bool async;            // false: load on the main thread as soon as a cell is needed
+	};
+
+	// write a generated world: cellsX * cellsZ cells of about cubesPerCell instances
+	static bool writeWorld(const char* path, int cellsX, int cellsZ, float cellSize,
+		unsigned int cubesPerCell, unsigned int seed);
+
+	// mesh: VERTEX_FLOATS per vertex, a triangle list, copied.
+	// vertexCapacity: size of the shared vertex buffer in vertices
+	WorldStreamer(const float* meshVertices, unsigned int meshVertexCount, unsigned int vertexCapacity,
+		unsigned int workerCount = 2);
+	~WorldStreamer();
+
+	bool open(const char* path);
+	void setSettings(const Settings& settings) { this->settings = settings; }
+	const Settings& getSettings() const { return settings; }
+
+	// pick the cells to load and drop, take in finished loads and upload within the budget
+	void update(const glm::vec3& cameraPos, const glm::vec3& velocity);
+	// resident cells in the frustum, model matrix is identity
+	void draw(const glm::mat4& viewProjection);
+	// drop every cell, waits for loads in flight
+	void unloadAll();
+
+	glm::vec2 getWorldSize() const { return glm::vec2(cellsX, cellsZ) * cellSize; }
+	unsigned int getResidentCells() const { return residentCells; }
+	// queued, loading or waiting for upload after the last update, 0 = caught up
+	unsigned int getPendingCells() const { return pendingCells; }
+	// last update
+	double getUpdateTime() const { return updateTime; }
+	unsigned int getUploadedVertices() const { return frameUploadedVertices; }
+	// last draw: cells in the frustum and near the camera that are not resident yet
+	unsigned int getMissingCells() const { return missingCells; }
+	unsigned int getDrawnCells() const { return drawnCells; }
+	void resetStats();
+	void printStats() const;
+
+private:
+	enum State { STATE_UNLOADED, STATE_QUEUED, STATE_LOADING, STATE_LOADED, STATE_RESIDENT };
+
+	struct Cell {
+		State state;
+		bool cancelled;  // no longer wanted while a worker had it
+		float priority;  // distance to the nearer of camera and prefetch point
+		unsigned long long fileOffset;
+		unsigned int instanceCount;
+		std::vector<float> vertices; // only until uploaded
+		unsigned int vertexOffset, vertexCount, uploadedVertices;
+		glm::vec3 min, max;
+	};
+
+	// a load a worker finished
+	struct Loaded {
+		unsigned int cell;
+		std::vector<float> vertices;
+		glm::vec3 min, max;
+		double loadTime;
+	};
+
+	Settings settings;
+	MappedFile file;
+	int cellsX, cellsZ;
+	float cellSize;
+	float minY, maxY; // of every instance, bounds of the cells not loaded yet
+	std::vector<Cell> cells;
+	std::vector<float> mesh;
+	glm::vec3 lastCamera;
+
+	unsigned int VAO, VBO;
+	OffsetAllocator vertexAllocator;
+
+	// workers: cell ids in, vertices out
+	std::vector<std::thread> workers;
+	std::mutex queueMutex;
+	std::condition_variable queueCondition;
+	std::condition_variable idleCondition;
+	std::deque<unsigned int> loadQueue;
+	std::vector<Loaded> finished;
+	std::vector<Loaded> ready; // swapped with finished, keeps its capacity
+	unsigned int inFlight;
+	bool quit;
+	// per update scratch lists, kept for their capacity
+	std::vector<unsigned int> wanted;
+	std::vector<unsigned int> uploading;
+
+	unsigned int residentCells, pendingCells;
+	double updateTime;
+	unsigned int frameUploadedVertices;
+	unsigned int missingCells, drawnCells;
+
+	// since resetStats
+	unsigned long long updates;
+	unsigned int loads, unloads, cancels, allocationFailures;
+	unsigned long long uploadedBytes;
+	double loadTimeSum, maxUpdateTime;
+	unsigned long long missingSum;
+
+	void workerLoop();
+	void loadCell(unsigned int index, Loaded& loaded) const;
+	void accept(Loaded& loaded);
+	// slices of the cell's vertices until the deadline, true when all of them are up
+	bool uploadCell(Cell& cell, double budgetMs, double& elapsed);
+	void unloadCell(Cell& cell);
+	glm::vec2 cellCenter(unsigned int index) const;
+};
\ No newline at end of file
@@ -0,0 +1,341 @@
+// world streaming demo: a scripted fly-through of a cube world far bigger than the camera-1.7
+// field, streamed from disk in cells around the camera. runs the same path three times: cells
+// loaded on the main thread as they come into range, loaded by workers but uploaded the moment
+// they are done, and loaded by workers with prefetch along the flight direction and uploads
+// spread over frames within a budget. prints frames over budget (hitches), the worst frame and
+// the cells that should have been on screen but were not there yet, then M cycles the mode.
+// usage: world-streaming [world file], the file is generated when it does not exist
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../shader-lesson-1.4/Shader.h"
+#include "WorldStreamer.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <std_image/stb_image.h>
+
+const unsigned int WIDTH = 800;
+const unsigned int HEIGHT = 600;
+
+// 2 km square, a bit over a million cubes
+const int WORLD_CELLS = 64;
+const float CELL_SIZE = 32.0f;
+const unsigned int CUBES_PER_CELL = 300;
+const unsigned int VERTEX_CAPACITY = 2 * 1024 * 1024;
+
+// the path is stepped by a fixed time per frame, so every mode flies exactly the same frames
+const float FLY_SPEED = 60.0f; // units per second, roughly, the loop is faster on the straights
+const float FRAME_STEP = 1.0f / 60.0f;
+const unsigned int FLY_FRAMES = 1200;
+// frames before the flight starts, while the start area settles, not counted
+const unsigned int SETTLE_FRAMES = 600;
+const double FRAME_BUDGET_MS = 1000.0 / 60.0;
+const float CAMERA_HEIGHT = 20.0f;
+
+enum Mode { MODE_SYNC, MODE_ASYNC, MODE_STREAMED, MODE_COUNT };
+const char* MODE_NAMES[] = { "load on the main thread", "worker loads, unbudgeted upload", "worker loads, prefetch, upload budget" };
+
+Mode mode = MODE_SYNC;
+bool settingsChanged = true;
+int windowWidth = WIDTH;
+int windowHeight = HEIGHT;
+
+void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+unsigned int loadTexture(const char* path);
+glm::vec3 flightPath(float time, const glm::vec2& worldSize);
+
+int main(int argc, char** argv) {
+	float vertices[] = {
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+	};
+
+	// initialize GLFW
+	glfwInit();
+	// set version and core profile
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// create a window
+	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+	// set callback to handle when window is resized
+	glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+	glfwSetKeyCallback(window, keyCallback);
+
+	// initialize GLAD
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// no vsync, we want to see the frame time
+	glfwSwapInterval(0);
+
+	Shader* shader = new Shader("../coordinate-systems-1.6/les1.6-vShader.vert", "../coordinate-systems-1.6/les1.6-fShader.frag");
+	shader->use();
+	shader->setInt("texture1", 0);
+	shader->setInt("texture2", 1);
+	shader->setFloat("percentage", 0.2f);
+	shader->setMat4("model", glm::mat4(1.0f));
+
+	stbi_set_flip_vertically_on_load(true);
+	unsigned int texture = loadTexture("../textures-lesson-1.5/container.jpg");
+	unsigned int texture2 = loadTexture("../textures-lesson-1.5/awesomeface.png");
+
+	// the world lives on disk, written once
+	const char* worldPath = argc > 1 ? argv[1] : "world.cells";
+	std::FILE* existing = std::fopen(worldPath, "rb");
+	if (existing) {
+		std::fclose(existing);
+	}
+	else {
+		auto start = std::chrono::high_resolution_clock::now();
+		if (!WorldStreamer::writeWorld(worldPath, WORLD_CELLS, WORLD_CELLS, CELL_SIZE, CUBES_PER_CELL, 7)) {
+			glfwTerminate();
+			return -1;
+		}
+		std::cout << "WORLDSTREAM::wrote " << worldPath << " in "
+			<< std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count()
+			<< " ms" << std::endl;
+	}
+
+	WorldStreamer* streamer = new WorldStreamer(vertices, 36, VERTEX_CAPACITY, 2);
+	if (!streamer->open(worldPath)) {
+		delete streamer;
+		glfwTerminate();
+		return -1;
+	}
+	glm::vec2 worldSize = streamer->getWorldSize();
+
+	glEnable(GL_DEPTH_TEST);
+
+	bool sweeping = true;
+	unsigned int runFrame = 0;
+	double lastReport = glfwGetTime();
+	// per run, or per second once the sweep is done
+	unsigned int frames = 0, hitches = 0;
+	double frameSum = 0.0, worstFrame = 0.0, worstStreaming = 0.0;
+	unsigned long long missingSum = 0;
+	auto lastFrameStart = std::chrono::high_resolution_clock::now();
+
+	// render loop
+	while (!glfwWindowShouldClose(window)) {
+		if (settingsChanged) {
+			// the same start for every mode: nothing resident, then settle before the flight
+			WorldStreamer::Settings settings = streamer->getSettings();
+			settings.async = mode != MODE_SYNC;
+			settings.prefetchSeconds = mode == MODE_STREAMED ? 1.5f : 0.0f;
+			settings.uploadBudgetMs = mode == MODE_STREAMED ? 2.0 : 0.0;
+			streamer->setSettings(settings);
+			streamer->unloadAll();
+			for (unsigned int i = 0; i < SETTLE_FRAMES; ++i) {
+				streamer->update(flightPath(0.0f, worldSize), glm::vec3(0.0f));
+				if (streamer->getPendingCells() == 0) {
+					break;
+				}
+				glfwWaitEventsTimeout(0.001);
+			}
+			streamer->resetStats();
+			runFrame = 0;
+			frames = hitches = 0;
+			frameSum = worstFrame = worstStreaming = 0.0;
+			missingSum = 0;
+			lastReport = glfwGetTime();
+			lastFrameStart = std::chrono::high_resolution_clock::now();
+			settingsChanged = false;
+		}
+
+		// the whole frame, from one start to the next, is what the player sees
+		auto frameStart = std::chrono::high_resolution_clock::now();
+		double frameTime = std::chrono::duration<double, std::milli>(frameStart - lastFrameStart).count();
+		lastFrameStart = frameStart;
+		if (runFrame > 0) {
+			frameSum += frameTime;
+			worstFrame = std::max(worstFrame, frameTime);
+			hitches += frameTime > FRAME_BUDGET_MS ? 1 : 0;
+			++frames;
+		}
+
+		float time = runFrame * FRAME_STEP;
+		glm::vec3 cameraPos = flightPath(time, worldSize);
+		glm::vec3 velocity = (flightPath(time + FRAME_STEP, worldSize) - cameraPos) / FRAME_STEP;
+		glm::vec3 cameraFront = glm::normalize(glm::normalize(velocity) + glm::vec3(0.0f, -0.25f, 0.0f));
+
+		streamer->update(cameraPos, velocity);
+		worstStreaming = std::max(worstStreaming, streamer->getUpdateTime());
+
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)windowWidth / std::max(windowHeight, 1),
+			0.1f, streamer->getSettings().loadRadius);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, texture2);
+		shader->use();
+		shader->setMat4("view", view);
+		shader->setMat4("projection", projection);
+		streamer->draw(projection * view);
+		missingSum += streamer->getMissingCells();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+		++runFrame;
+
+		// the sweep flies the path once per mode, then the flight goes on with reports every second
+		bool report = sweeping ? runFrame == FLY_FRAMES : glfwGetTime() - lastReport > 1.0;
+		if (report && frames > 0) {
+			std::cout << "WORLDSTREAM::" << MODE_NAMES[mode]
+				<< " | frames " << frames
+				<< " | hitches " << hitches << " (over " << FRAME_BUDGET_MS << " ms)"
+				<< " | average " << frameSum / frames << " ms"
+				<< " | worst " << worstFrame << " ms"
+				<< " | slowest streaming update " << worstStreaming << " ms"
+				<< " | missing cells " << (double)missingSum / frames << "/frame" << std::endl;
+			streamer->printStats();
+			frames = hitches = 0;
+			frameSum = worstFrame = worstStreaming = 0.0;
+			missingSum = 0;
+			lastReport = glfwGetTime();
+		}
+		if (sweeping && report) {
+			mode = (Mode)(mode + 1);
+			if (mode == MODE_COUNT) {
+				mode = MODE_STREAMED;
+				sweeping = false;
+			}
+			else {
+				settingsChanged = true;
+			}
+		}
+	}
+
+	// deallocate objects
+	delete streamer;
+	glDeleteTextures(1, &texture);
+	glDeleteTextures(1, &texture2);
+	glDeleteProgram(shader->ID);
+	delete shader;
+
+	glfwTerminate();
+	return 0;
+}
+
+// a loop over the world with long straights and turns, the same position for the same time
+glm::vec3 flightPath(float time, const glm::vec2& worldSize) {
+	float angle = time * FLY_SPEED / (worldSize.x * 0.9f);
+	glm::vec2 center = worldSize * 0.5f;
+	glm::vec2 position = center + glm::vec2(std::sin(angle) * 0.4f, std::sin(angle * 2.0f) * 0.3f) * worldSize;
+	return glm::vec3(position.x, CAMERA_HEIGHT, position.y);
+}
+
+// whenever the window is resized this function gets called
+void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+	glViewport(0, 0, width, height);
+	windowWidth = width;
+	windowHeight = height;
+}
+
+// react to key presses
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	if (action != GLFW_PRESS) {
+		return;
+	}
+	if (key == GLFW_KEY_ESCAPE) {
+		glfwSetWindowShouldClose(window, true);
+	}
+	if (key == GLFW_KEY_M) {
+		mode = (Mode)((mode + 1) % MODE_COUNT);
+		settingsChanged = true;
+	}
+}
+
+// load an image into a mipmapped texture
+unsigned int loadTexture(const char* path) {
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width, height, nrChannels;
+	unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 4);
+	if (data) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else {
+		std::cout << "Failed to load texture" << std::endl;
+	}
+
+	stbi_image_free(data);
+	return texture;
+}
\ No newline at end of file